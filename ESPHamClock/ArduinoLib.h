@@ -148,6 +148,7 @@ typedef enum {
     X(DEBUG_GIMBAL,     "gimbal")           \
     X(DEBUG_IO,         "io")               \
     X(DEBUG_WEB,        "liveweb")          \
+    X(DEBUG_MAP,        "map")              \
     X(DEBUG_MENUS,      "menus")            \
     X(DEBUG_NMEA,       "NMEA")             \
     X(DEBUG_NVRAM,      "NVRAM")            \
@@ -185,6 +186,8 @@ extern int liveweb_max;
 extern int liveweb_to;
 extern const int liveweb_maxmax;
 extern int restful_port;
+extern int map_workers;
+extern const int map_workers_max;
 extern bool skip_skip;
 extern bool init_iploc;
 extern bool want_kbcursor;
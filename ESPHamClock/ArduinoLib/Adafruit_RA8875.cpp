@@ -30,6 +30,9 @@
 #include <string.h>
 #include <errno.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
 #include <ctype.h>
 #include <dirent.h>
 #include <math.h>
@@ -147,26 +150,75 @@ Adafruit_RA8875::Adafruit_RA8875(uint8_t CS, uint8_t RST)
         // init the protected region flag
         pr_draw = false;
 
+        // nothing drawn yet
+        fb_dirty = false;
+        canvas_seq = 0;
+        draw_depth = 0;
+        ds_wakes = ds_frames = ds_retries = ds_locks = ds_draws = 0;
+
+        // prep for handoffs with the display thread
+        if (pthread_mutex_init (&fb_wait_lock, NULL) || pthread_cond_init (&fb_wait_cv, NULL)
+                                                     || pthread_cond_init (&fb_done_cv, NULL)) {
+            ::printf ("fb_wait_lock: %s\n", strerror(errno));
+            exit(1);
+        }
+        fb_wake[0] = fb_wake[1] = -1;
+#if defined(_USE_X11)
+        if (pipe (fb_wake) < 0) {
+            ::printf ("fb_wake: %s\n", strerror(errno));
+            exit(1);
+        }
+        for (int i = 0; i < 2; i++)
+            fcntl (fb_wake[i], F_SETFL, fcntl (fb_wake[i], F_GETFL) | O_NONBLOCK);
+#endif // _USE_X11
+
         // insure earth map pointers are NULL until set
         DEARTH_BIG = NULL;
         NEARTH_BIG = NULL;
+        fb_earth = NULL;
 
         // not ready until proven
         ready = false;
 
         // reset until known
         screen_w = screen_h = 0;
+
+        // no one to tell about input or drawing until set
+        input_notify = NULL;
+        pr_notify = NULL;
+
+        // RGB2GRAY is a sum of independent r g b terms so each may be looked up separately
+        for (int i = 0; i < 256; i++) {
+            gray_lut[0][i] = RGB2GRAY(i,0,0);
+            gray_lut[1][i] = RGB2GRAY(0,i,0);
+            gray_lut[2][i] = RGB2GRAY(0,0,i);
+        }
 }
 
 /* set mmap'ed location and size of day and night images, size in units of uint16_t
  */
 void Adafruit_RA8875::setEarthPix (char *day_pixels, char *night_pixels, int width, int height)
 {
+        // plotEarthRow() may be reading the old images
+        notifyPR();
+
         DEARTH_BIG = (uint16_t*) day_pixels;
         NEARTH_BIG = (uint16_t*) night_pixels;
 
         EARTH_BIG_W = width;
         EARTH_BIG_H = height;
+        EARTH_BIG_XS = width/360.0F;
+        EARTH_BIG_YS = height/180.0F;
+
+        // earth layer for restoreEarthRow(), here because plotEarthRow() may be called from several threads
+        if (!fb_earth && fb_nbytes > 0) {
+            fb_earth = (fbpix_t *) malloc (fb_nbytes);
+            if (!fb_earth) {
+                ::printf ("Can not malloc(%d) for earth layer\n", fb_nbytes);
+                exit(1);
+            }
+            memset (fb_earth, 0, fb_nbytes);
+        }
 }
 
 #if defined(_USE_X11)
@@ -213,6 +265,7 @@ bool Adafruit_RA8875::begin (int not_used)
             exit(1);
         }
         memset (fb_stage, 1, fb_nbytes);        // unlikely color
+        markAllDirty();
 
         // prep for mouse and keyboard info
         if (pthread_mutex_init (&mouse_lock, NULL)) {
@@ -325,6 +378,7 @@ bool Adafruit_RA8875::begin (int not_used)
 	    exit(1);
 	}
 	memset (fb_stage, 1, fb_nbytes);        // unlikely color
+        markAllDirty();
 
 	// create XImage using staging area
 	img = XCreateImage(display, visual, visdepth, ZPixmap, 0, (char*)fb_stage, FB_XRES, FB_YRES,
@@ -518,6 +572,7 @@ bool Adafruit_RA8875::begin (int not_used)
 	    exit(1);
 	}
 	memset (fb_stage, 1, fb_nbytes);        // unlikely color
+        markAllDirty();
 
 	// set up a reentrantable lock
 	pthread_mutexattr_t fb_attr;
@@ -750,6 +805,9 @@ bool Adafruit_RA8875::getBackingStore (uint8_t *&backing_store, int x0, int y0,
             return (false);
         }
 
+        // caller will draw here then restore what we save
+        checkPR (x0, y0, w, h);
+
         const size_t row_bytes = w * sizeof(fbpix_t);
         backing_store = (uint8_t *) malloc (row_bytes * h);
         // TODO : check for failure
@@ -786,13 +844,17 @@ bool Adafruit_RA8875::setBackingStore (uint8_t *&backing_store, int x0, int y0,
         const size_t row_bytes = w * sizeof(fbpix_t);
         // TODO : check for failure
 
-        fbpix_t *fb_row = &fb_canvas[y0*FB_XRES + x0];
-        uint8_t *bs_walk = backing_store;
-        for (int y = y0; y < y0+h; y++) {
-            memcpy (fb_row, bs_walk, row_bytes);
-            bs_walk += row_bytes;
-            fb_row += FB_XRES;
-        }
+        checkPR (x0, y0, w, h);
+        beginDraw();
+            fbpix_t *fb_row = &fb_canvas[y0*FB_XRES + x0];
+            uint8_t *bs_walk = backing_store;
+            for (int y = y0; y < y0+h; y++) {
+                memcpy (fb_row, bs_walk, row_bytes);
+                bs_walk += row_bytes;
+                fb_row += FB_XRES;
+            }
+            markDirty (x0, y0, w, h);
+        endDraw();
 
         free (backing_store);
         backing_store = NULL;
@@ -803,17 +865,105 @@ bool Adafruit_RA8875::setBackingStore (uint8_t *&backing_store, int x0, int y0,
 /* return pixels as packed RGB bytes
  */
 bool Adafruit_RA8875::getRawPix(uint8_t *rgb24, int npix)
+{
+        uint32_t gen;
+        return (getRawPix (rgb24, npix, gen));
+}
+
+/* same but also pass back the generation of fb_stage for use with getRawPixChanges()
+ */
+bool Adafruit_RA8875::getRawPix(uint8_t *rgb24, int npix, uint32_t &gen)
 {
         if (npix != FB_XRES * FB_YRES) {
             ::printf ("getRawPix: %d != %d\n", npix, FB_XRES * FB_YRES);
             return (false);
         }
-        for (int i = 0; i < npix; i++) {
-            uint32_t p32 = FBPIXTORGB32(fb_stage[i]);
-            *rgb24++ = p32 >> 16;
-            *rgb24++ = p32 >> 8;
-            *rgb24++ = p32;
+	pthread_mutex_lock (&fb_lock);
+            ds_locks++;
+            for (int i = 0; i < npix; i++) {
+                uint32_t p32 = FBPIXTORGB32(fb_stage[i]);
+                *rgb24++ = p32 >> 16;
+                *rgb24++ = p32 >> 8;
+                *rgb24++ = p32;
+            }
+            gen = stage_gen;
+	pthread_mutex_unlock (&fb_lock);
+        return (true);
+}
+
+/* refresh rows [y0,y0+ny) of rgb24, a full image of packed RGB bytes, from fb_stage.
+ */
+bool Adafruit_RA8875::getRawPixRows (uint8_t *rgb24, int npix, int y0, int ny)
+{
+        if (npix != FB_XRES * FB_YRES || y0 < 0 || ny < 0 || y0 + ny > FB_YRES) {
+            ::printf ("getRawPixRows: %d %d %d out of bounds\n", npix, y0, ny);
+            return (false);
+        }
+        rgb24 += 3*y0*FB_XRES;
+	pthread_mutex_lock (&fb_lock);
+            ds_locks++;
+            for (int i = y0*FB_XRES; i < (y0+ny)*FB_XRES; i++) {
+                uint32_t p32 = FBPIXTORGB32(fb_stage[i]);
+                *rgb24++ = p32 >> 16;
+                *rgb24++ = p32 >> 8;
+                *rgb24++ = p32;
+            }
+	pthread_mutex_unlock (&fb_lock);
+        return (true);
+}
+
+/* update rgb24, a full image of packed RGB bytes as of fb_stage generation gen, to the current fb_stage.
+ * only tiles that have changed since gen are examined. each blk_w x blk_h block of rgb24 whose pixels really
+ * changed is marked in blk_changed[], which is in row major order and must be cleared by the caller.
+ * pass back the new generation.
+ */
+bool Adafruit_RA8875::getRawPixChanges (uint8_t *rgb24, int npix, uint32_t &gen, uint8_t *blk_changed,
+int blk_w, int blk_h)
+{
+        if (npix != FB_XRES * FB_YRES) {
+            ::printf ("getRawPixChanges: %d != %d\n", npix, FB_XRES * FB_YRES);
+            return (false);
         }
+
+        const int blk_ncols = FB_XRES/blk_w;
+        uint8_t seg_rgb[DIRTY_TILE*3];
+
+	pthread_mutex_lock (&fb_lock);
+            ds_locks++;
+            for (int ti = 0; ti < DT_ROWS*DT_COLS; ti++) {
+
+                // skip if tile has not changed since gen, beware wrap
+                if ((int32_t)(dt_stage_gen[ti] - gen) <= 0)
+                    continue;
+
+                // check each row segment of tile within each block
+                int x0 = (ti % DT_COLS) * DIRTY_TILE;
+                int y0 = (ti / DT_COLS) * DIRTY_TILE;
+                int x1 = x0 + DIRTY_TILE < FB_XRES ? x0 + DIRTY_TILE : FB_XRES;
+                int y1 = y0 + DIRTY_TILE < FB_YRES ? y0 + DIRTY_TILE : FB_YRES;
+                for (int y = y0; y < y1; y++) {
+                    for (int sx0 = x0; sx0 < x1; ) {
+                        int bx = sx0/blk_w;
+                        int sx1 = (bx+1)*blk_w < x1 ? (bx+1)*blk_w : x1;
+                        uint8_t *seg_p = seg_rgb;
+                        for (int x = sx0; x < sx1; x++) {
+                            uint32_t p32 = FBPIXTORGB32(fb_stage[y*FB_XRES + x]);
+                            *seg_p++ = p32 >> 16;
+                            *seg_p++ = p32 >> 8;
+                            *seg_p++ = p32;
+                        }
+                        uint8_t *rgb_p = &rgb24[3*(y*FB_XRES + sx0)];
+                        if (memcmp (rgb_p, seg_rgb, seg_p - seg_rgb) != 0) {
+                            memcpy (rgb_p, seg_rgb, seg_p - seg_rgb);
+                            blk_changed[(y/blk_h)*blk_ncols + bx] = 1;
+                        }
+                        sx0 = sx1;
+                    }
+                }
+            }
+            gen = stage_gen;
+	pthread_mutex_unlock (&fb_lock);
+
         return (true);
 }
 
@@ -1028,19 +1178,11 @@ void Adafruit_RA8875::drawPixel(int16_t x, int16_t y, uint16_t color16)
 	fbpix_t fbpix = RGB16TOFBPIX(color16);
 	x *= SCALESZ;
 	y *= SCALESZ;
-	pthread_mutex_lock(&fb_lock);
-	    if (SCALESZ == 2) {
-		plotfb (x, y, fbpix);
-		plotfb (x, y+1, fbpix);
-		plotfb (x+1, y, fbpix);
-		plotfb (x+1, y+1, fbpix);
-	    } else {
-		for (uint8_t dx = 0; dx < SCALESZ; dx++)
-		    for (uint8_t dy = 0; dy < SCALESZ; dy++)
-			plotfb (x+dx, y+dy, fbpix);
-	    }
-	    fb_dirty = true;
-	pthread_mutex_unlock (&fb_lock);
+	beginDraw();
+	    fbpix = spanColor (fbpix);
+	    for (uint8_t dy = 0; dy < SCALESZ; dy++)
+		plotSpan (x, y+dy, SCALESZ, fbpix);
+	endDraw();
 }
 
 void Adafruit_RA8875::drawPixels (uint16_t * p, uint32_t count, int16_t x, int16_t y)
@@ -1054,10 +1196,9 @@ void Adafruit_RA8875::drawPixels (uint16_t * p, uint32_t count, int16_t x, int16
 void Adafruit_RA8875::drawPixelRaw(int16_t x, int16_t y, uint16_t color16)
 {
 	fbpix_t fbpix = RGB16TOFBPIX(color16);
-	pthread_mutex_lock(&fb_lock);
+	beginDraw();
 	    plotfb (x, y, fbpix);
-	    fb_dirty = true;
-	pthread_mutex_unlock (&fb_lock);
+	endDraw();
 }
 
 /* line in app coords
@@ -1069,10 +1210,9 @@ void Adafruit_RA8875::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, u
 	y0 *= SCALESZ;
 	x1 *= SCALESZ;
 	y1 *= SCALESZ;
-	pthread_mutex_lock(&fb_lock);
+	beginDraw();
 	    plotLineRaw (x0, y0, x1, y1, 1, fbpix);
-	    fb_dirty = true;
-	pthread_mutex_unlock (&fb_lock);
+	endDraw();
 }
 
 // non-standard -- add thickness arg
@@ -1085,10 +1225,9 @@ uint16_t color16)
 	x1 *= SCALESZ;
 	y1 *= SCALESZ;
         thickness *= SCALESZ;
-	pthread_mutex_lock(&fb_lock);
+	beginDraw();
 	    plotLineRaw (x0, y0, x1, y1, thickness, fbpix);
-	    fb_dirty = true;
-	pthread_mutex_unlock (&fb_lock);
+	endDraw();
 }
 
 /* non-standard -- draw line in underlying raw coord system
@@ -1097,14 +1236,13 @@ void Adafruit_RA8875::drawLineRaw(int16_t x0, int16_t y0, int16_t x1, int16_t y1
 uint16_t color16)
 {
 	fbpix_t fbpix = RGB16TOFBPIX(color16);
-	pthread_mutex_lock(&fb_lock);
+	beginDraw();
 	    plotLineRaw (x0, y0, x1, y1, thickness, fbpix);
             // if (thickness >= 3) {
                 // round cap style??
                 // plotFillCircle (x1, y1, thickness/2, fbpix);
             // }
-	    fb_dirty = true;
-	pthread_mutex_unlock (&fb_lock);
+	endDraw();
 }
 
 /* Adafruit's drawRect of width w draws from x0 through x0+w-1, ie, it draws w pixels wide and skips w-2
@@ -1222,12 +1360,11 @@ void Adafruit_RA8875::drawTriangleRaw (int16_t x0, int16_t y0, int16_t x1, int16
     uint16_t color16)
 {
 	fbpix_t fbpix = RGB16TOFBPIX(color16);
-	pthread_mutex_lock (&fb_lock);
+	beginDraw();
 	    plotLineRaw (x0, y0, x1, y1, 1, fbpix);
 	    plotLineRaw (x1, y1, x2, y2, 1, fbpix);
 	    plotLineRaw (x2, y2, x0, y0, 1, fbpix);
-	    fb_dirty = true;
-	pthread_mutex_unlock (&fb_lock);
+	endDraw();
 }
 
 void Adafruit_RA8875::fillTriangle (int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2,
@@ -1255,7 +1392,7 @@ void Adafruit_RA8875::fillTriangleRaw (int16_t x0, int16_t y0, int16_t x1, int16
         if (y1 > y2)
            swap2 (x1, y1, x2, y2);
 
-	pthread_mutex_lock (&fb_lock);
+	beginDraw();
 
             // fill top subtri -- beware flat
             if (y1 != y0 && y2 != y0) {
@@ -1274,7 +1411,7 @@ void Adafruit_RA8875::fillTriangleRaw (int16_t x0, int16_t y0, int16_t x1, int16
                 }
             }
 
-	pthread_mutex_unlock (&fb_lock);
+	endDraw();
 }
 
 /********************************************************************************************************
@@ -1284,51 +1421,240 @@ void Adafruit_RA8875::fillTriangleRaw (int16_t x0, int16_t y0, int16_t x1, int16
  */
 
 
+/* mark the tiles touching the given rectangle of fb pixels as changed in fb_canvas.
+ */
+void Adafruit_RA8875::markDirty (int16_t x, int16_t y, int16_t w, int16_t h)
+{
+        // clamp to canvas
+        int x1 = x + w;
+        int y1 = y + h;
+        if (x < 0)
+            x = 0;
+        if (y < 0)
+            y = 0;
+        if (x1 > FB_XRES)
+            x1 = FB_XRES;
+        if (y1 > FB_YRES)
+            y1 = FB_YRES;
+        if (x >= x1 || y >= y1)
+            return;
+
+        int tc0 = x/DIRTY_TILE;
+        int tc1 = (x1-1)/DIRTY_TILE;
+        for (int tr = y/DIRTY_TILE; tr <= (y1-1)/DIRTY_TILE; tr++)
+            memset (&dt_canvas[tr*DT_COLS + tc0], 1, tc1 - tc0 + 1);
+}
+
+/* mark all of fb_canvas as changed
+ */
+void Adafruit_RA8875::markAllDirty()
+{
+        memset (dt_canvas, 1, sizeof(dt_canvas));
+}
+
+/* begin drawing into fb_canvas from the main thread. calls may nest, the canvas is marked as being drawn
+ * until the outermost endDraw().
+ */
+void Adafruit_RA8875::beginDraw()
+{
+        if (draw_depth++ == 0) {
+            canvas_seq.store (canvas_seq.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence (std::memory_order_release);
+        }
+}
+
+/* finish drawing into fb_canvas. after the outermost call the new pixels are published to the display
+ * thread, which is woken if it was not already going to look.
+ */
+void Adafruit_RA8875::endDraw()
+{
+        if (--draw_depth == 0) {
+            canvas_seq.store (canvas_seq.load (std::memory_order_relaxed) + 1, std::memory_order_release);
+            ds_draws.store (ds_draws.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            setDirty();
+        }
+}
+
+/* note fb_canvas or the cursor has changed, waking the display thread the first time since it last looked.
+ * N.B. this may be called from any thread
+ */
+void Adafruit_RA8875::setDirty()
+{
+        if (!fb_dirty.exchange (true))
+            wakeDisplay();
+}
+
+/* pass back display thread statistics
+ */
+void Adafruit_RA8875::getDisplayStats (DisplayStats &ds)
+{
+        ds.n_wakes = ds_wakes;
+        ds.n_frames = ds_frames;
+        ds.n_retries = ds_retries;
+        ds.n_locks = ds_locks;
+        ds.n_draws = ds_draws;
+}
+
+/* copy each changed tile of fb_canvas into fb_stage, respecting the protected region unless pr_draw.
+ * tiles that really changed are stamped with a new stage_gen and coalesced into dt_runs[] along each tile row.
+ * the main thread does not lock fb_canvas so if it drew while we were copying, the tiles we copied may be
+ * torn; they are all marked to be copied again on the next frame.
+ * return whether anything changed.
+ * N.B. we assume fb_lock is held and fb_dirty has already been reset
+ */
+bool Adafruit_RA8875::stageDirty()
+{
+        const bool pr_on = pr_w > 0 && pr_h > 0;
+        const int pr_x1 = pr_x + pr_w;
+        const int pr_y1 = pr_y + pr_h;
+        const uint32_t gen = stage_gen + 1;
+        uint8_t copied[DT_ROWS*DT_COLS];
+
+        // wait for any primitive in progress to finish
+        uint32_t seq0;
+        while ((seq0 = canvas_seq.load (std::memory_order_acquire)) & 1)
+            sched_yield();
+
+        ds_frames++;
+        dt_n_runs = 0;
+        memset (copied, 0, sizeof(copied));
+
+        for (int tr = 0; tr < DT_ROWS; tr++) {
+
+            int y0 = tr*DIRTY_TILE;
+            int y1 = y0 + DIRTY_TILE < FB_YRES ? y0 + DIRTY_TILE : FB_YRES;
+            bool tr_pr = pr_on && y0 < pr_y1 && y1 > pr_y;
+            DirtyRun *run = NULL;
+
+            for (int tc = 0; tc < DT_COLS; tc++) {
+
+                int ti = tr*DT_COLS + tc;
+                int x0 = tc*DIRTY_TILE;
+                int x1 = x0 + DIRTY_TILE < FB_XRES ? x0 + DIRTY_TILE : FB_XRES;
+
+                // the protected region is always checked when it is drawn because drawing there may
+                // come from other threads that do not use beginDraw()
+                bool in_pr = tr_pr && x0 < pr_x1 && x1 > pr_x;
+                if (!dt_canvas[ti] && !(in_pr && pr_draw))
+                    continue;
+                dt_canvas[ti] = 0;
+                copied[ti] = 1;
+
+                // copy each row of tile, less any portion in the protected region unless drawing it
+                bool changed = false;
+                for (int y = y0; y < y1; y++) {
+                    int sx0[2] = {x0, 0}, sx1[2] = {x1, 0};
+                    int n_seg = 1;
+                    if (in_pr && !pr_draw && y >= pr_y && y < pr_y1) {
+                        sx1[0] = x0 > pr_x ? x0 : pr_x;                 // left of pr
+                        sx0[1] = x1 < pr_x1 ? x1 : pr_x1;               // right of pr
+                        sx1[1] = x1;
+                        n_seg = 2;
+                    }
+                    for (int i = 0; i < n_seg; i++) {
+                        int n_bytes = (sx1[i] - sx0[i])*sizeof(fbpix_t);
+                        if (n_bytes <= 0)
+                            continue;
+                        fbpix_t *canvas_p = &fb_canvas[y*FB_XRES + sx0[i]];
+                        fbpix_t *stage_p = &fb_stage[y*FB_XRES + sx0[i]];
+                        if (memcmp (stage_p, canvas_p, n_bytes) != 0) {
+                            memcpy (stage_p, canvas_p, n_bytes);
+                            changed = true;
+                        }
+                    }
+                }
+
+                // stamp and add to run
+                if (changed) {
+                    dt_stage_gen[ti] = gen;
+                    if (run && run->x + run->w == x0)
+                        run->w += x1 - x0;
+                    else {
+                        run = &dt_runs[dt_n_runs++];
+                        run->x = x0;
+                        run->y = y0;
+                        run->w = x1 - x0;
+                        run->h = y1 - y0;
+                    }
+                }
+            }
+        }
+
+        // check whether any drawing overlapped the copy
+        std::atomic_thread_fence (std::memory_order_acquire);
+        if (canvas_seq.load (std::memory_order_relaxed) != seq0) {
+            for (int ti = 0; ti < DT_ROWS*DT_COLS; ti++)
+                if (copied[ti])
+                    dt_canvas[ti] = 1;
+            fb_dirty = true;
+            ds_retries++;
+        }
+
+        if (dt_n_runs > 0)
+            stage_gen = gen;
+
+        return (dt_n_runs > 0);
+}
+
 /* plot rect to native resolution
  */
 void Adafruit_RA8875::plotDrawRect (int16_t x0, int16_t y0, int16_t w, int16_t h, fbpix_t fbpix)
 {
-	pthread_mutex_lock (&fb_lock);
+	beginDraw();
             if (w > 0) {
                 plotLineRaw (x0, y0, x0+w, y0, 1, fbpix);
                 plotLineRaw (x0+w, y0, x0+w, y0+h, 1, fbpix);
                 plotLineRaw (x0+w, y0+h, x0, y0+h, 1, fbpix);
                 plotLineRaw (x0, y0+h, x0, y0, 1, fbpix);
-                fb_dirty = true;
             }
-	pthread_mutex_unlock (&fb_lock);
+	endDraw();
 }
 
 /* plot a filled rect to native resolution
  */
 void Adafruit_RA8875::plotFillRect (int16_t x0, int16_t y0, int16_t w, int16_t h, fbpix_t fbpix)
 {
-	pthread_mutex_lock (&fb_lock);
-	    for (uint16_t y = y0; y < y0+h; y++)
-		for (uint16_t x = x0; x < x0+w; x++)
-		    plotfb (x, y, fbpix);
-	    fb_dirty = true;
-	pthread_mutex_unlock (&fb_lock);
+	beginDraw();
+	    fbpix = spanColor (fbpix);
+	    for (int16_t y = y0; y < y0+h; y++)
+		plotSpan (x0, y, w, fbpix);
+	endDraw();
 }
 
 /* plot circle to underlying raw coord system
  */
 void Adafruit_RA8875::plotDrawCircle (int16_t x0, int16_t y0, uint16_t r0, fbpix_t fbpix)
 {
-        // scan a circle from radius r0-1/2 to r0+1/2 to include a whole pixel.
-        // radius (r0+1/2)^2 = r0^2 + r0 + 1/4 so we use 2x everywhere to avoid floats
-        uint32_t iradius2 = 4*r0*(r0 - 1) + 1;
-        uint32_t oradius2 = 4*r0*(r0 + 1) + 1;
-	pthread_mutex_lock (&fb_lock);
-	    for (int32_t dy = -2*r0; dy <= 2*r0; dy += 2) {
-                for (int32_t dx = -2*r0; dx <= 2*r0; dx += 2) {
-                    uint32_t xy2 = dx*dx + dy*dy;
-                    if (xy2 >= iradius2 && xy2 <= oradius2)
-			plotfb (x0+dx/2, y0+dy/2, fbpix);
+        // draw each pixel whose center is within 1/2 pixel of radius r0, ie, whose dx^2 + dy^2 is
+        // within (r0-1/2)^2 .. (r0+1/2)^2. with integers this is r0^2 - r0 < dx^2 + dy^2 <= r0^2 + r0.
+        // walk down one quadrant midpoint style shrinking the outer and inner half widths xo and xi,
+        // then draw the spans between them in all four quadrants.
+        if (r0 == 0)
+            return;
+        const int32_t r = r0;
+        const int32_t o2 = r*r + r;
+        const int32_t i2 = r*r - r;
+        int32_t xo = r;
+        int32_t xi = r - 1;
+	beginDraw();
+            fbpix = spanColor (fbpix);
+	    for (int32_t dy = 0; dy <= r; dy++) {
+                int32_t dy2 = dy*dy;
+                while (xo*xo + dy2 > o2)
+                    xo--;
+                while (xi >= 0 && xi*xi + dy2 > i2)
+                    xi--;
+                int32_t ys[2] = {y0+dy, y0-dy};
+                for (int i = 0; i < (dy > 0 ? 2 : 1); i++) {
+                    if (xi < 0)
+                        plotSpan (x0-xo, ys[i], 2*xo+1, fbpix);
+                    else if (xo > xi) {
+                        plotSpan (x0-xo, ys[i], xo-xi, fbpix);
+                        plotSpan (x0+xi+1, ys[i], xo-xi, fbpix);
+                    }
                 }
             }
-	    fb_dirty = true;
-	pthread_mutex_unlock (&fb_lock);
+	endDraw();
 
 }
 
@@ -1336,19 +1662,22 @@ void Adafruit_RA8875::plotDrawCircle (int16_t x0, int16_t y0, uint16_t r0, fbpix
  */
 void Adafruit_RA8875::plotFillCircle(int16_t x0, int16_t y0, uint16_t r0, fbpix_t fbpix)
 {
-        // scan a circle of radius r0+1/2 to include whole pixel.
-        // radius (r0+1/2)^2 = r0^2 + r0 + 1/4 so we use 2x everywhere to avoid floats
-        uint32_t radius2 = 4*r0*(r0 + 1) + 1;
-	pthread_mutex_lock (&fb_lock);
-	    for (int32_t dy = -2*r0; dy <= 2*r0; dy += 2) {
-                for (int32_t dx = -2*r0; dx <= 2*r0; dx += 2) {
-                    uint32_t xy2 = dx*dx + dy*dy;
-                    if (xy2 <= radius2)
-			plotfb (x0+dx/2, y0+dy/2, fbpix);
-                }
+        // draw each pixel whose center is within radius r0+1/2, ie, dx^2 + dy^2 <= r0^2 + r0 with integers.
+        // walk down one quadrant midpoint style shrinking the half width xo then draw the span above and below.
+        const int32_t r = r0;
+        const int32_t o2 = r*r + r;
+        int32_t xo = r;
+	beginDraw();
+            fbpix = spanColor (fbpix);
+	    for (int32_t dy = 0; dy <= r; dy++) {
+                int32_t dy2 = dy*dy;
+                while (xo*xo + dy2 > o2)
+                    xo--;
+                plotSpan (x0-xo, y0+dy, 2*xo+1, fbpix);
+                if (dy > 0)
+                    plotSpan (x0-xo, y0-dy, 2*xo+1, fbpix);
             }
-	    fb_dirty = true;
-	pthread_mutex_unlock (&fb_lock);
+	endDraw();
 }
 
 
@@ -1650,32 +1979,79 @@ int16_t thick, fbpix_t color)
 
 
 
-/* place the given raw pixel at the given raw frame buffer location.
+/* return color as it should be drawn according to gray_type.
+ * done once per span or pixel by callers before plotSpan() or plotfb().
  */
-void Adafruit_RA8875::plotfb (int16_t x, int16_t y, fbpix_t color)
+fbpix_t Adafruit_RA8875::spanColor (fbpix_t color)
 {
-        // perform gray_type
-        switch (gray_type) {
-        case GRAY_OFF:
-        case GRAY_MAP:
-            // no change -- color ok
-            break;
-        case GRAY_ALL: {
+        if (gray_type == GRAY_ALL) {
             uint32_t rgb = FBPIXTORGB32(color);
-            int r = (rgb >> 16) & 0xff;
-            int g = (rgb >> 8) & 0xff;
-            int b = rgb & 0xff;
-            int gray = RGB2GRAY(r,g,b);
+            int gray = gray_lut[0][(rgb >> 16) & 0xff] + gray_lut[1][(rgb >> 8) & 0xff] + gray_lut[2][rgb & 0xff];
             color = RGB32TOFBPIX ((gray<<16) | (gray<<8) | (gray));
-            }
-            break;
         }
+        return (color);
+}
 
-        int index = y*FB_XRES + x;
-        if (index < 0 || index >= FB_XRES*FB_YRES)
+/* place the given raw pixel at the given raw frame buffer location.
+ */
+void Adafruit_RA8875::plotfb (int16_t x, int16_t y, fbpix_t color)
+{
+        if (x < 0 || x >= FB_XRES || y < 0 || y >= FB_YRES)
             ::printf ("no! %d %d\n", x, y);
-        else
-            fb_canvas[index] = color;
+        else {
+            checkPR (x, y, 1, 1);
+            fb_canvas[y*FB_XRES + x] = spanColor (color);
+            dt_canvas[(y/DIRTY_TILE)*DT_COLS + x/DIRTY_TILE] = 1;
+        }
+}
+
+/* fill w raw pixels starting at x,y with color, clipped to the frame buffer.
+ * color must already have been passed through spanColor().
+ * N.B. we assume we are within beginDraw()
+ */
+void Adafruit_RA8875::plotSpan (int16_t x, int16_t y, int16_t w, fbpix_t color)
+{
+        // clip
+        if (y < 0 || y >= FB_YRES)
+            return;
+        if (x < 0) {
+            w += x;
+            x = 0;
+        }
+        if (x + w > FB_XRES)
+            w = FB_XRES - x;
+        if (w <= 0)
+            return;
+        checkPR (x, y, w, 1);
+
+        // lead in singly to 8 byte alignment
+        fbpix_t *p = &fb_canvas[y*FB_XRES + x];
+        int n = w;
+        while (n > 0 && ((uintptr_t)p & 7)) {
+            *p++ = color;
+            n--;
+        }
+
+        // then fill 32 bytes at a time with color replicated into 64 bit words
+        const int PIX_PER_WORD = 8/sizeof(fbpix_t);
+        uint64_t word = color;
+        for (unsigned b = 8*sizeof(fbpix_t); b < 64; b *= 2)
+            word |= word << b;
+        while (n >= 4*PIX_PER_WORD) {
+            memcpy (p, &word, 8);
+            memcpy (p + PIX_PER_WORD, &word, 8);
+            memcpy (p + 2*PIX_PER_WORD, &word, 8);
+            memcpy (p + 3*PIX_PER_WORD, &word, 8);
+            p += 4*PIX_PER_WORD;
+            n -= 4*PIX_PER_WORD;
+        }
+
+        // finish singly
+        while (n-- > 0)
+            *p++ = color;
+
+        int t0 = x/DIRTY_TILE;
+        memset (&dt_canvas[(y/DIRTY_TILE)*DT_COLS + t0], 1, (x+w-1)/DIRTY_TILE - t0 + 1);
 }
 
 /* plot hi res earth lat0,lng0 at app's screen location x0,y0.
@@ -1689,17 +2065,64 @@ float dlatr, float dlngr, float dlatd, float dlngd, float fract_day)
         if (!DEARTH_BIG || !NEARTH_BIG)
             return;
 
+        plotEarthPixel (x0, y0, lat0, lng0, dlatr, dlngr, dlatd, dlngd, fract_day);
+        markDirty (x0*SCALESZ, y0*SCALESZ, SCALESZ, SCALESZ);
+}
+
+/* plot a span of n hi res earth pixels starting at app's screen location x0,y0 and going right.
+ * lat[] and lng[] are the n locations in degrees plus one more beyond the right end, lat_dn[] and lng_dn[]
+ * are the n locations one app row down. Neighbors that are not on the map are marked with NAN.
+ * fract_day[] is as for plotEarth.
+ */
+void Adafruit_RA8875::plotEarthRow (uint16_t x0, uint16_t y0, int n, const float *lat, const float *lng,
+const float *lat_dn, const float *lng_dn, const float *fract_day)
+{
+        // beware of no map files
+        if (!DEARTH_BIG || !NEARTH_BIG)
+            return;
+
+        for (int i = 0; i < n; i++) {
+
+            // neighbors off the map have no gradient
+            float dlatr = 0, dlngr = 0, dlatd = 0, dlngd = 0;
+            if (!isnan (lat[i+1])) {
+                dlatr = lat[i+1] - lat[i];
+                dlngr = lng[i+1] - lng[i];
+            }
+            if (!isnan (lat_dn[i])) {
+                dlatd = lat_dn[i] - lat[i];
+                dlngd = lng_dn[i] - lng[i];
+            }
+
+            plotEarthPixel (x0+i, y0, lat[i], lng[i], dlatr, dlngr, dlatd, dlngd, fract_day[i]);
+        }
+        markDirty (x0*SCALESZ, y0*SCALESZ, n*SCALESZ, SCALESZ);
+}
+
+/* workhorse for plotEarth() and plotEarthRow().
+ * N.B. we assume the map files are ready
+ */
+void Adafruit_RA8875::plotEarthPixel (uint16_t x0, uint16_t y0, float lat0, float lng0,
+float dlatr, float dlngr, float dlatd, float dlngd, float fract_day)
+{
         // beware lng wrap across date line
         if (dlngr < -180) dlngr += 360;
         if (dlngd < -180) dlngd += 360;
         if (dlngr >  180) dlngr -= 360;
         if (dlngd >  180) dlngd -= 360;
 
-        // scale app step size to our step size
-        dlatr /= SCALESZ;
-        dlngr /= SCALESZ;
-        dlatd /= SCALESZ;
-        dlngd /= SCALESZ;
+        // work directly in earth pixels, scaled app step size to our step size.
+        // offset by one full map so truncation is also floor.
+        float ex0 = (lng0+180+360)*EARTH_BIG_XS + 0.5F;
+        float ey0 = (90-lat0+180)*EARTH_BIG_YS + 0.5F;
+        float dexr = dlngr*EARTH_BIG_XS/SCALESZ;
+        float deyr = -dlatr*EARTH_BIG_YS/SCALESZ;
+        float dexd = dlngd*EARTH_BIG_XS/SCALESZ;
+        float deyd = -dlatd*EARTH_BIG_YS/SCALESZ;
+
+        // day weight in 1/256 steps for integer blending
+        int day_w = fract_day*256;
+        int night_w = 256 - day_w;
 
         // ditto starting loc
 	x0 *= SCALESZ;
@@ -1707,39 +2130,56 @@ float dlatr, float dlngr, float dlatd, float dlngd, float fract_day)
 
 	for (int r = 0; r < SCALESZ; r++) {
 	    fbpix_t *frow = &fb_canvas[(y0+r)*FB_XRES + x0];
+	    fbpix_t *erow = fb_earth ? &fb_earth[(y0+r)*FB_XRES + x0] : frow;
 	    for (int c = 0; c < SCALESZ; c++) {
-                float lat = lat0 + dlatr*c + dlatd*r;
-                float lng = lng0 + dlngr*c + dlngd*r;
-                int ex = (int)((lng+180)*EARTH_BIG_W/360 + EARTH_BIG_W + 0.5F);
-                int ey = (int)((90-lat)*EARTH_BIG_H/180 + EARTH_BIG_H + 0.5F);
-                ex = (ex + EARTH_BIG_W) % EARTH_BIG_W;
-                ey = (ey + EARTH_BIG_H) % EARTH_BIG_H;
+                int ex = (int)(ex0 + dexr*c + dexd*r);
+                int ey = (int)(ey0 + deyr*c + deyd*r);
+                while (ex >= EARTH_BIG_W)
+                    ex -= EARTH_BIG_W;
+                while (ex < 0)
+                    ex += EARTH_BIG_W;
+                while (ey >= EARTH_BIG_H)
+                    ey -= EARTH_BIG_H;
+                while (ey < 0)
+                    ey += EARTH_BIG_H;
 		uint16_t c16; 
-		if (fract_day == 0) {
+		if (day_w <= 0) {
 		    c16 = EPIXEL(NEARTH_BIG,ey,ex);
-		} else if (fract_day == 1) {
+		} else if (day_w >= 256) {
 		    c16 = EPIXEL(DEARTH_BIG,ey,ex);
 		} else {
 		    // blend from day to night
 		    uint16_t day_pix = EPIXEL(DEARTH_BIG,ey,ex);
 		    uint16_t night_pix = EPIXEL(NEARTH_BIG,ey,ex);
-		    uint8_t day_r = RGB565_R(day_pix);
-		    uint8_t day_g = RGB565_G(day_pix);
-		    uint8_t day_b = RGB565_B(day_pix);
-		    uint8_t night_r = RGB565_R(night_pix);
-		    uint8_t night_g = RGB565_G(night_pix);
-		    uint8_t night_b = RGB565_B(night_pix);
-		    float fract_night = 1 - fract_day;
-		    uint8_t twi_r = (fract_day*day_r + fract_night*night_r);
-		    uint8_t twi_g = (fract_day*day_g + fract_night*night_g);
-		    uint8_t twi_b = (fract_day*day_b + fract_night*night_b);
+		    uint8_t twi_r = (day_w*RGB565_R(day_pix) + night_w*RGB565_R(night_pix)) >> 8;
+		    uint8_t twi_g = (day_w*RGB565_G(day_pix) + night_w*RGB565_G(night_pix)) >> 8;
+		    uint8_t twi_b = (day_w*RGB565_B(day_pix) + night_w*RGB565_B(night_pix)) >> 8;
 		    c16 = RGB565 (twi_r, twi_g, twi_b);
 		}
-		*frow++ = RGB16TOFBPIX(c16);
+		*frow++ = *erow++ = RGB16TOFBPIX(c16);
 	    }
 	}
 }
 
+/* redraw a span of n app pixels starting at app's screen location x0,y0 and going right with the earth
+ * pixels most recently drawn there by plotEarth() or plotEarthRow(). This erases anything drawn on top.
+ */
+void Adafruit_RA8875::restoreEarthRow (uint16_t x0, uint16_t y0, int n)
+{
+        // nothing yet
+        if (!fb_earth)
+            return;
+
+	x0 *= SCALESZ;
+	y0 *= SCALESZ;
+
+	for (int r = 0; r < SCALESZ; r++) {
+            int i = (y0+r)*FB_XRES + x0;
+            memcpy (&fb_canvas[i], &fb_earth[i], n*SCALESZ*sizeof(fbpix_t));
+        }
+        markDirty (x0, y0, n*SCALESZ, SCALESZ);
+}
+
 void Adafruit_RA8875::plotChar (char ch)
 {
 	if (ch < current_font->first || ch > current_font->last)
@@ -1749,27 +2189,190 @@ void Adafruit_RA8875::plotChar (char ch)
 	int16_t x = cursor_x + gp->xOffset;
 	int16_t y = cursor_y + gp->yOffset;
 	uint16_t bitn = 0;
-	pthread_mutex_lock (&fb_lock);
+	beginDraw();
+	    // draw each run of set bits in each glyph row as one span
+	    fbpix_t color = spanColor (text_color);
 	    for (uint16_t r = 0; r < gp->height; r++) {
-		for (uint16_t c = 0; c < gp->width; c++) {
-		    uint8_t bit = bp[bitn/8] & (1 << (7-(bitn%8)));
-		    if (bit)
-			plotfb (x+c, y+r, text_color);
-		    bitn++;
+		int16_t run0 = -1;                              // start of current run, if >= 0
+		for (uint16_t c = 0; c < gp->width; c++, bitn++) {
+		    bool bit = bp[bitn/8] & (1 << (7-(bitn%8)));
+		    if (bit && run0 < 0)
+			run0 = c;
+		    else if (!bit && run0 >= 0) {
+			plotSpan (x+run0, y+r, c-run0, color);
+			run0 = -1;
+		    }
 		}
+		if (run0 >= 0)
+		    plotSpan (x+run0, y+r, gp->width-run0, color);
 	    }
-	    fb_dirty = true;
-	pthread_mutex_unlock (&fb_lock);
+	endDraw();
 
 	cursor_x += gp->xAdvance;
 }
 
+/* time the span raster primitives against the original per-pixel methods they replaced, which are
+ * reproduced here for reference. each method draws the same shapes starting from the same canvas so
+ * we can also check they agree. the canvas is restored afterwards.
+ */
+void Adafruit_RA8875::benchmarkDraw (DrawBench &db)
+{
+        #define BENCH_N 500                                     // n of each shape per method
+        static const char bench_str[] = "HamClock 0123456789";  // text drawn each iteration
+
+        memset (&db, 0, sizeof(db));
+
+        // we use the whole canvas
+        notifyPR();
+
+        fbpix_t *saved = (fbpix_t *) malloc (fb_nbytes);
+        fbpix_t *ref = (fbpix_t *) malloc (fb_nbytes);
+        if (!saved || !ref) {
+            ::printf ("benchmarkDraw: no memory\n");
+            free (saved);
+            free (ref);
+            return;
+        }
+
+        const int16_t rect_w = 60*SCALESZ, rect_h = 30*SCALESZ;
+        const uint16_t radius = 20*SCALESZ;
+        const uint16_t save_cursor_x = cursor_x, save_cursor_y = cursor_y;
+        const fbpix_t save_text_color = text_color;
+
+	beginDraw();
+
+            memcpy (saved, fb_canvas, fb_nbytes);
+
+            // pass 0 is per-pixel, 1 is span
+            for (int pass = 0; pass < 2; pass++) {
+
+                const bool span = pass == 1;
+                struct timeval tv0, tv1;
+                memcpy (fb_canvas, saved, fb_nbytes);
+
+                // filled rectangles
+                gettimeofday (&tv0, NULL);
+                for (int i = 0; i < BENCH_N; i++) {
+                    int16_t x0 = 25*SCALESZ + (i*37) % (FB_XRES-100*SCALESZ);
+                    int16_t y0 = 25*SCALESZ + (i*53) % (FB_YRES-100*SCALESZ);
+                    fbpix_t c = RGB16TOFBPIX((uint16_t)(i*2654435761U >> 16));
+                    if (span)
+                        plotFillRect (x0, y0, rect_w, rect_h, c);
+                    else {
+                        for (uint16_t y = y0; y < y0+rect_h; y++)
+                            for (uint16_t x = x0; x < x0+rect_w; x++)
+                                plotfb (x, y, c);
+                    }
+                }
+                gettimeofday (&tv1, NULL);
+                float fill_rate = BENCH_N/((tv1.tv_sec-tv0.tv_sec) + 1e-6F*(tv1.tv_usec-tv0.tv_usec));
+
+                // filled then outlined circles
+                gettimeofday (&tv0, NULL);
+                for (int i = 0; i < BENCH_N; i++) {
+                    int16_t x0 = 25*SCALESZ + (i*41) % (FB_XRES-100*SCALESZ);
+                    int16_t y0 = 25*SCALESZ + (i*29) % (FB_YRES-100*SCALESZ);
+                    fbpix_t c = RGB16TOFBPIX((uint16_t)(i*2246822519U >> 16));
+                    if (span) {
+                        plotFillCircle (x0, y0, radius, c);
+                        plotDrawCircle (x0, y0, radius, ~c);
+                    } else {
+                        uint32_t iradius2 = 4*radius*(radius - 1) + 1;
+                        uint32_t oradius2 = 4*radius*(radius + 1) + 1;
+                        for (int32_t dy = -2*radius; dy <= 2*radius; dy += 2) {
+                            for (int32_t dx = -2*radius; dx <= 2*radius; dx += 2) {
+                                uint32_t xy2 = dx*dx + dy*dy;
+                                if (xy2 <= oradius2)
+                                    plotfb (x0+dx/2, y0+dy/2, c);
+                            }
+                        }
+                        for (int32_t dy = -2*radius; dy <= 2*radius; dy += 2) {
+                            for (int32_t dx = -2*radius; dx <= 2*radius; dx += 2) {
+                                uint32_t xy2 = dx*dx + dy*dy;
+                                if (xy2 >= iradius2 && xy2 <= oradius2)
+                                    plotfb (x0+dx/2, y0+dy/2, ~c);
+                            }
+                        }
+                    }
+                }
+                gettimeofday (&tv1, NULL);
+                float circle_rate = 2*BENCH_N/((tv1.tv_sec-tv0.tv_sec) + 1e-6F*(tv1.tv_usec-tv0.tv_usec));
+
+                // text
+                float text_rate = 0;
+                if (current_font) {
+                    int n_chars = 0;
+                    gettimeofday (&tv0, NULL);
+                    for (int i = 0; i < BENCH_N; i++) {
+                        cursor_x = 25*SCALESZ + (i*43) % (FB_XRES-400*SCALESZ);
+                        cursor_y = 50*SCALESZ + (i*31) % (FB_YRES-100*SCALESZ);
+                        text_color = RGB16TOFBPIX((uint16_t)(i*3266489917U >> 16));
+                        for (const char *cp = bench_str; *cp; cp++, n_chars++) {
+                            if (span)
+                                plotChar (*cp);
+                            else {
+                                char ch = *cp;
+                                if (ch < current_font->first || ch > current_font->last)
+                                    continue;
+                                GFXglyph *gp = &current_font->glyph[ch-current_font->first];
+                                uint8_t *bp = &current_font->bitmap[gp->bitmapOffset];
+                                int16_t x = cursor_x + gp->xOffset;
+                                int16_t y = cursor_y + gp->yOffset;
+                                uint16_t bitn = 0;
+                                for (uint16_t r = 0; r < gp->height; r++) {
+                                    for (uint16_t c = 0; c < gp->width; c++) {
+                                        uint8_t bit = bp[bitn/8] & (1 << (7-(bitn%8)));
+                                        if (bit)
+                                            plotfb (x+c, y+r, text_color);
+                                        bitn++;
+                                    }
+                                }
+                                cursor_x += gp->xAdvance;
+                            }
+                        }
+                    }
+                    gettimeofday (&tv1, NULL);
+                    text_rate = n_chars/((tv1.tv_sec-tv0.tv_sec) + 1e-6F*(tv1.tv_usec-tv0.tv_usec));
+                }
+
+                // record
+                if (span) {
+                    db.fill_span = fill_rate;
+                    db.circle_span = circle_rate;
+                    db.text_span = text_rate;
+                    db.same = memcmp (ref, fb_canvas, fb_nbytes) == 0;
+                } else {
+                    db.fill_pix = fill_rate;
+                    db.circle_pix = circle_rate;
+                    db.text_pix = text_rate;
+                    memcpy (ref, fb_canvas, fb_nbytes);
+                }
+            }
+
+            // restore
+            memcpy (fb_canvas, saved, fb_nbytes);
+            cursor_x = save_cursor_x;
+            cursor_y = save_cursor_y;
+            text_color = save_text_color;
+            markAllDirty();
+
+	endDraw();
+
+        ::printf ("DRAWBENCH: fill %.0f/%.0f circle %.0f/%.0f text %.0f/%.0f per sec span/pixel, %s\n",
+                db.fill_span, db.fill_pix, db.circle_span, db.circle_pix, db.text_span, db.text_pix,
+                db.same ? "same" : "DIFFERENT");
+
+        free (saved);
+        free (ref);
+}
+
 /* store the desired protect drawing region
  * we silently enforce it being wholy within FB_XRES x FB_YRES
  */
 void Adafruit_RA8875::setPR (uint16_t x, uint16_t y, uint16_t w, uint16_t h)
 {
         if (x + w <= FB_XRES && y + h <= FB_YRES) {
+            notifyPR();
             pr_x = x*SCALESZ;
             pr_y = y*SCALESZ;
             pr_w = w*SCALESZ;
@@ -1781,13 +2384,84 @@ void Adafruit_RA8875::setPR (uint16_t x, uint16_t y, uint16_t w, uint16_t h)
  */
 void Adafruit_RA8875::drawPR(void)
 {
-        // set flag to inform the drawing thread to draw the pr region, wait until finished.
-        // if you know of a better way with mutexes etc let me know
-        pr_draw = true;
-        while (pr_draw)
-            usleep (1000);
+        // set flag to inform the display thread to draw the pr region, wait until it says it has.
+        pthread_mutex_lock (&fb_wait_lock);
+            pr_draw = true;
+        pthread_mutex_unlock (&fb_wait_lock);
+        wakeDisplay();
+        pthread_mutex_lock (&fb_wait_lock);
+            while (pr_draw)
+                pthread_cond_wait (&fb_done_cv, &fb_wait_lock);
+        pthread_mutex_unlock (&fb_wait_lock);
+}
+
+/* called by the display thread after each frame, pr tells whether it included the protected region.
+ */
+void Adafruit_RA8875::finishFrame (bool pr)
+{
+        pthread_mutex_lock (&fb_wait_lock);
+            if (pr)
+                pr_draw = false;
+            pthread_cond_broadcast (&fb_done_cv);
+        pthread_mutex_unlock (&fb_wait_lock);
+}
+
+#if !defined(_USE_X11)
+
+/* wake the display thread if it is waiting in waitDisplay()
+ * N.B. this may be called from any thread
+ */
+void Adafruit_RA8875::wakeDisplay()
+{
+        // lock so the signal can not slip in between waitDisplay() checking its flags and waiting
+        pthread_mutex_lock (&fb_wait_lock);
+            pthread_cond_signal (&fb_wait_cv);
+        pthread_mutex_unlock (&fb_wait_lock);
 }
 
+/* called by the display thread to wait until it is time for a frame: at once if pr_draw, else when fb_dirty
+ * but not before next_tv. if neither is set after idle_ms just return anyway.
+ * return whether it is time for a frame.
+ */
+bool Adafruit_RA8875::waitDisplay (const struct timeval &next_tv, int idle_ms)
+{
+        struct timeval now;
+        gettimeofday (&now, NULL);
+        struct timespec next_ts, idle_ts;
+        next_ts.tv_sec = next_tv.tv_sec;
+        next_ts.tv_nsec = next_tv.tv_usec*1000L;
+        idle_ts.tv_sec = now.tv_sec + idle_ms/1000;
+        idle_ts.tv_nsec = (now.tv_usec + (idle_ms%1000)*1000L)*1000L;
+        if (idle_ts.tv_nsec >= 1000000000L) {
+            idle_ts.tv_sec += 1;
+            idle_ts.tv_nsec -= 1000000000L;
+        }
+
+        bool frame = false;
+        pthread_mutex_lock (&fb_wait_lock);
+            for (;;) {
+                if (pr_draw) {
+                    frame = true;
+                    break;
+                }
+                bool dirty = fb_dirty;
+                const struct timespec &until = dirty ? next_ts : idle_ts;
+                gettimeofday (&now, NULL);
+                if (now.tv_sec > until.tv_sec
+                                || (now.tv_sec == until.tv_sec && now.tv_usec*1000L >= until.tv_nsec)) {
+                    frame = dirty;
+                    break;
+                }
+                pthread_cond_timedwait (&fb_wait_cv, &fb_wait_lock, &until);
+            }
+        pthread_mutex_unlock (&fb_wait_lock);
+
+        ds_wakes++;
+        return (frame);
+}
+
+#endif // !_USE_X11
+
 
 /* return a typed character and current modifier keys if interested (may be NULL), else CHAR_NONE
  */
@@ -1821,6 +2495,51 @@ void Adafruit_RA8875::putChar (char c, bool ctrl, bool shift)
         if (++kb_qtail == KB_N)
             kb_qtail = 0;
     pthread_mutex_unlock (&kb_lock);
+
+    notifyInput();
+}
+
+/* set function to call whenever a key or mouse button is queued or the mouse moves, such as to wake the
+ * app main loop.
+ * N.B. fp is called from whatever thread queued the input.
+ */
+void Adafruit_RA8875::setInputNotify (void (*fp)(void))
+{
+    input_notify = fp;
+}
+
+/* tell the app a key or mouse button has been queued or the mouse has moved, if it cares.
+ */
+void Adafruit_RA8875::notifyInput (void)
+{
+    if (input_notify)
+        (*input_notify)();
+}
+
+/* set function to call before the main thread draws the given app rectangle within the protected rectangle,
+ * such as to stop anything else drawing there. it is called with the whole screen before the protected
+ * rectangle or the earth images change.
+ * N.B. fp is called from the main thread, often from within beginDraw().
+ */
+void Adafruit_RA8875::setPRNotify (void (*fp)(int x, int y, int w, int h))
+{
+    pr_notify = fp;
+}
+
+/* tell the app the main thread is taking over the whole screen, if it cares.
+ */
+void Adafruit_RA8875::notifyPR (void)
+{
+    if (pr_notify)
+        (*pr_notify)(0, 0, APP_WIDTH, APP_HEIGHT);
+}
+
+/* tell the app if the given fb rectangle overlaps the protected rectangle, in app coords.
+ */
+void Adafruit_RA8875::checkPR (int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    if (pr_notify && x < pr_x + pr_w && x + w > pr_x && y < pr_y + pr_h && y + h > pr_y)
+        (*pr_notify)(x/SCALESZ, y/SCALESZ, (x+w-1)/SCALESZ - x/SCALESZ + 1, (y+h-1)/SCALESZ - y/SCALESZ + 1);
 }
 
 
@@ -1850,68 +2569,39 @@ void *Adafruit_RA8875::fbThreadHelper(void *me)
 // _USE_X11
 void Adafruit_RA8875::drawCanvas()
 {
-        // send one block containing the rectangular bounding box of the changed pixels. smaller
-        // transations would send fewer pixels but each transaction is expensive.. found no happy medium.
-
-        bool any_change = false;
-
-        // bounding box
-        int bb_x0 = 0, bb_y0 = 0, bb_x1 = 0, bb_y1 = 0;
-
-        for (int y = 0; y < FB_YRES; y++) {
-
-            // we assume protected region is at lower right
-            int max_x = pr_draw || pr_w == 0 || y < pr_y ? FB_XRES : pr_x;
-
-            // handy start of this row
-            fbpix_t *stage_p = &fb_stage[y*FB_XRES];
-            fbpix_t *canvas_p = &fb_canvas[y*FB_XRES];
-
-            for (int x = 0; x < FB_XRES; x++) {
-
-                int max_y = pr_draw || pr_h == 0 || x < pr_x ? FB_YRES : pr_y;
-                if (x >= max_x && y >= max_y)
-                    continue;
-
-                if (stage_p[x] != canvas_p[x]) {
-
-                    // update pixel
-                    stage_p[x] = canvas_p[x];
+        // copy the changed tiles to fb_stage
+        if (!stageDirty())
+            return;
 
-                    // update bounding box
-                    if (!any_change) {
-                        bb_x0 = bb_x1 = x;
-                        bb_y0 = bb_y1 = y;
-                    }
-                    if (x < bb_x0)
-                        bb_x0 = x;
-                    if (x > bb_x1)
-                        bb_x1 = x;
-                    if (y > bb_y1)
-                        bb_y1 = y;
-                    // y can't get any smaller
-
-                    // found something to do
-                    any_change = true;
-                }
+        // send each run of changed tiles. each transaction is expensive so if there are many just send
+        // one block containing their bounding box.
+        if (dt_n_runs > DT_MAXRUNS) {
+            int bb_x0 = FB_XRES, bb_y0 = FB_YRES, bb_x1 = 0, bb_y1 = 0;
+            for (int i = 0; i < dt_n_runs; i++) {
+                const DirtyRun &r = dt_runs[i];
+                if (r.x < bb_x0)
+                    bb_x0 = r.x;
+                if (r.y < bb_y0)
+                    bb_y0 = r.y;
+                if (r.x + r.w > bb_x1)
+                    bb_x1 = r.x + r.w;
+                if (r.y + r.h > bb_y1)
+                    bb_y1 = r.y + r.h;
             }
+            dt_runs[0].x = bb_x0;
+            dt_runs[0].y = bb_y0;
+            dt_runs[0].w = bb_x1 - bb_x0;
+            dt_runs[0].h = bb_y1 - bb_y0;
+            dt_n_runs = 1;
         }
-
-        if (any_change) {
-
-            // update bounding box (inclusive of both edges)
-            int nx = bb_x1-bb_x0+1;
-            int ny = bb_y1-bb_y0+1;
-            XPutImage(display, pixmap, black_gc, img, bb_x0, bb_y0, bb_x0, bb_y0, nx, ny);
-            XCopyArea(display, pixmap, win, black_gc, bb_x0, bb_y0, nx, ny, FB_X0+bb_x0, FB_Y0+bb_y0);
-
-            // struct timeval tv;
-            // gettimeofday(&tv, NULL);
-            // ::printf ("XCopyArea %ld.%06ld [%6d, %6d] %6d x %6d = %6d\n", tv.tv_sec, tv.tv_usec, bb_x0, bb_y0, nx, ny, nx*ny);
-
-            // let server catch up before next loop
-            XSync (display, false);
+        for (int i = 0; i < dt_n_runs; i++) {
+            const DirtyRun &r = dt_runs[i];
+            XPutImage(display, pixmap, black_gc, img, r.x, r.y, r.x, r.y, r.w, r.h);
+            XCopyArea(display, pixmap, win, black_gc, r.x, r.y, r.w, r.h, FB_X0+r.x, FB_Y0+r.y);
         }
+
+        // let server catch up before next loop
+        XSync (display, false);
 }
 
 // _USE_X11
@@ -1921,11 +2611,68 @@ void Adafruit_RA8875::X11OptionsEngageNow (bool fs)
         options_fullscreen = fs;
 
         // trigger
-        options_engage = true;
+        pthread_mutex_lock (&fb_wait_lock);
+            options_engage = true;
+        pthread_mutex_unlock (&fb_wait_lock);
+        wakeDisplay();
 
         // wait here
-        while (options_engage)
-            usleep (1000);
+        pthread_mutex_lock (&fb_wait_lock);
+            while (options_engage)
+                pthread_cond_wait (&fb_done_cv, &fb_wait_lock);
+        pthread_mutex_unlock (&fb_wait_lock);
+}
+
+/* wake the display thread if it is waiting in waitDisplay()
+ * N.B. this may be called from any thread
+ */
+// _USE_X11
+void Adafruit_RA8875::wakeDisplay()
+{
+        // pipe is nonblocking so a full pipe just means a wakeup is pending
+        if (write (fb_wake[1], "", 1) < 0 && errno != EAGAIN)
+            ::printf ("fb_wake: %s\n", strerror(errno));
+}
+
+/* called by the display thread to wait until it is time for a frame: at once if pr_draw, else when fb_dirty
+ * but not before next_tv. also return early if X events arrive or options_engage. if nothing happens return
+ * after idle_ms anyway.
+ * return whether it is time for a frame.
+ */
+// _USE_X11
+bool Adafruit_RA8875::waitDisplay (const struct timeval &next_tv, int idle_ms)
+{
+        struct timeval now;
+        gettimeofday (&now, NULL);
+        int next_ms = (next_tv.tv_sec - now.tv_sec)*1000 + (next_tv.tv_usec - now.tv_usec)/1000;
+
+        // don't wait at all if there is something to do now, including events already read by Xlib because
+        // they no longer make the connection readable. N.B. XPending() also flushes our requests.
+        int timeout = idle_ms;
+        if (pr_draw || options_engage || XPending (display) > 0)
+            timeout = 0;
+        else if (fb_dirty)
+            timeout = next_ms > 0 ? next_ms : 0;
+
+        // wait for the X server or wakeDisplay()
+        if (timeout > 0) {
+            struct pollfd pfd[2];
+            pfd[0].fd = ConnectionNumber (display);
+            pfd[0].events = POLLIN;
+            pfd[1].fd = fb_wake[0];
+            pfd[1].events = POLLIN;
+            if (poll (pfd, 2, timeout) < 0 && errno != EINTR)
+                ::printf ("fb poll: %s\n", strerror(errno));
+        }
+
+        // drain, we look at the flags themselves
+        char buf[64];
+        while (read (fb_wake[0], buf, sizeof(buf)) > 0)
+            continue;
+
+        ds_wakes++;
+        gettimeofday (&now, NULL);
+        return (pr_draw || (fb_dirty && !timercmp (&now, &next_tv, <)));
 }
 
 /* called with KeySym and XKeyEvent state to request PRIMARY or CLIPBOARD selection for pasting.
@@ -2028,6 +2775,7 @@ void Adafruit_RA8875::encodeKeyEvent (XKeyEvent *event)
             if (++kb_qtail == KB_N)
                 kb_qtail = 0;
             pthread_mutex_unlock (&kb_lock);
+            notifyInput();
         }
 }
 
@@ -2141,6 +2889,11 @@ void Adafruit_RA8875::fbThread ()
         XMapRaised(display,win);
         XDefineCursor (display, win, app_cursor);
 
+        // whether to show changes this time, and earliest time for next frame
+        bool frame = true;
+        struct timeval next_tv;
+        gettimeofday (&next_tv, NULL);
+
         for(;;)
         {
 
@@ -2191,7 +2944,10 @@ void Adafruit_RA8875::fbThread ()
                                 SubstructureNotifyMask | SubstructureRedirectMask, &event);
 
                 // done until trigger again
-                options_engage = false;
+                pthread_mutex_lock (&fb_wait_lock);
+                    options_engage = false;
+                    pthread_cond_broadcast (&fb_done_cv);
+                pthread_mutex_unlock (&fb_wait_lock);
             }
 
 	    // handle events but don't block if none
@@ -2238,6 +2994,7 @@ void Adafruit_RA8875::fbThread ()
 			mouse_downs++;
 
 		    pthread_mutex_unlock (&mouse_lock);
+                    notifyInput();
 
                     // record time of mouse situation change for cursor fade
                     gettimeofday (&mouse_tv, NULL);
@@ -2254,6 +3011,7 @@ void Adafruit_RA8875::fbThread ()
 			mouse_ups++;
 
 		    pthread_mutex_unlock (&mouse_lock);
+                    notifyInput();
 
                     // record time of mouse situation change for cursor fade
                     gettimeofday (&mouse_tv, NULL);
@@ -2283,6 +3041,9 @@ void Adafruit_RA8875::fbThread ()
                     // record time of mouse situation change for cursor fade
                     gettimeofday (&mouse_tv, NULL);
 
+                    // app may want to show what is now under the cursor
+                    notifyInput();
+
 		    break;
 
                 case MapNotify:
@@ -2302,6 +3063,8 @@ void Adafruit_RA8875::fbThread ()
 		    XFillRectangle (display, win, black_gc, 0, FB_Y0 + FB_YRES, fb_si.xres, FB_Y0+1);
                     // invalidate staging area to get a full refresh
                     memset (fb_stage, ~0, fb_nbytes);
+                    markAllDirty();
+                    fb_dirty = true;
 
                     saveWinGeom();
 
@@ -2318,13 +3081,21 @@ void Adafruit_RA8875::fbThread ()
 	    }
 
 	    // show any changes
-            pthread_mutex_lock (&fb_lock);
-                if (fb_dirty || pr_draw) {
-                    drawCanvas();
+            if (frame) {
+                bool pr = pr_draw;
+                pthread_mutex_lock (&fb_lock);
+                    ds_locks++;
                     fb_dirty = false;
-                    pr_draw = false;
-                }
-            pthread_mutex_unlock (&fb_lock);
+                    drawCanvas();
+                pthread_mutex_unlock (&fb_lock);
+                finishFrame (pr);
+
+                // let scene build a while before next update
+                gettimeofday (&next_tv, NULL);
+                next_tv.tv_usec += REFRESH_US;
+                next_tv.tv_sec += next_tv.tv_usec/1000000;
+                next_tv.tv_usec %= 1000000;
+            }
 
             // implement auto-repeat
             if (event.type == KeyPress) {
@@ -2337,8 +3108,8 @@ void Adafruit_RA8875::fbThread ()
                 }
             }
 
-            // let scene build a while before next update
-            usleep (REFRESH_US);
+            // sleep until something changes, or keep checking for auto-repeat while a key is down
+            frame = waitDisplay (next_tv, event.type == KeyPress ? REFRESH_US/1000 : 1000);
 
         }
 
@@ -2419,51 +3190,47 @@ void Adafruit_RA8875::fbThread ()
 {
         // just copy canvas to stage as required
 
+        // earliest time for next frame
+        struct timeval next_tv;
+        gettimeofday (&next_tv, NULL);
+
         for(;;) {
 
             // all set
             ready = true;
 
+            // sleep until there is something to show
+            bool frame = waitDisplay (next_tv, 1000);
+
             // get mouse idle time
             struct timeval tv;
             gettimeofday (&tv, NULL);
             mouse_idle = (tv.tv_sec - mouse_tv.tv_sec)*1000 + (tv.tv_usec - mouse_tv.tv_usec)/1000;
 
             // show any changes
-            pthread_mutex_lock (&fb_lock);
-                if (fb_dirty || pr_draw) {
-                    drawCanvas();
+            if (frame) {
+                bool pr = pr_draw;
+                pthread_mutex_lock (&fb_lock);
+                    ds_locks++;
                     fb_dirty = false;
-                    pr_draw = false;
-                }
-            pthread_mutex_unlock (&fb_lock);
-
-            // let scene build a while before next update
-            usleep (REFRESH_US);
+                    drawCanvas();
+                pthread_mutex_unlock (&fb_lock);
+                finishFrame (pr);
+
+                // let scene build a while before next update
+                next_tv = tv;
+                next_tv.tv_usec += REFRESH_US;
+                next_tv.tv_sec += next_tv.tv_usec/1000000;
+                next_tv.tv_usec %= 1000000;
+            }
         }
 }
 
 // _WEB_ONLY
 void Adafruit_RA8875::drawCanvas()
 {
-        for (int y = 0; y < FB_YRES; y++) {
-
-            // we assume protected region is at lower right
-            int max_x = pr_draw || pr_w == 0 || y < pr_y ? FB_XRES : pr_x;
-
-            // handy start of this row
-            fbpix_t *stage_p = &fb_stage[y*FB_XRES];
-            fbpix_t *canvas_p = &fb_canvas[y*FB_XRES];
-
-            for (int x = 0; x < FB_XRES; x++) {
-
-                int max_y = pr_draw || pr_h == 0 || x < pr_x ? FB_YRES : pr_y;
-                if (x >= max_x && y >= max_y)
-                    continue;
-
-                stage_p[x] = canvas_p[x];
-            }
-        }
+        // just update fb_stage, liveweb picks up the changes from there
+        (void) stageDirty();
 }
 
 // _WEB_ONLY
@@ -2693,27 +3460,28 @@ void Adafruit_RA8875::mouseThread (void)
 
 		pthread_mutex_lock (&mouse_lock);
 
+                    bool changed = false;
                     if (iev.type == EV_ABS && iev.code == ABS_X) {
                         mouse_x = iev.value;
-                        fb_dirty = true;
+                        changed = true;
                     } else if (iev.type == EV_ABS && iev.code == ABS_Y) {
                         mouse_y = iev.value;
-                        fb_dirty = true;
+                        changed = true;
                     } else if (iev.type == EV_REL && iev.code == REL_X) {
                         mouse_x += iev.value;
-                        fb_dirty = true;
+                        changed = true;
                     } else if (iev.type == EV_REL && iev.code == REL_Y) {
                         mouse_y += iev.value;
-                        fb_dirty = true;
+                        changed = true;
                     } else if (iev.type == EV_KEY && (iev.code == BTN_TOUCH || iev.code == BTN_LEFT)) {
                         if (iev.value > 0)
                             mouse_downs++;
                         else
                             mouse_ups++;
-                        fb_dirty = true;
+                        changed = true;
                     }
 
-                    if (fb_dirty) {
+                    if (changed) {
                         // insure in range
                         if (mouse_x < FB_X0)
                             mouse_x = FB_X0;
@@ -2726,10 +3494,15 @@ void Adafruit_RA8875::mouseThread (void)
 
                         // record time of mouse situation change for cursor drawing
                         gettimeofday (&mouse_tv, NULL);
+                        setDirty();
                     }
 
 		pthread_mutex_unlock (&mouse_lock);
 
+                    // app may want to show what is now under the cursor
+                    if (changed)
+                        notifyInput();
+
             } else {
 
                 // close and rety later if disappeared
@@ -2826,8 +3599,9 @@ void Adafruit_RA8875::kbThread ()
                         ks.shift = false;
                         if (++kb_qtail == KB_N)
                             kb_qtail = 0;
-                        fb_dirty = true;
+                        setDirty();
                     pthread_mutex_unlock (&kb_lock);
+                    notifyInput();
                 }
 	    } else {
                 if (nr < 0)
@@ -2869,28 +3643,8 @@ void Adafruit_RA8875::setCursorIfVis (uint16_t row, uint16_t col, fbpix_t color)
 // _USE_FB0
 void Adafruit_RA8875::drawCanvas()
 {
-        // put only the unproteced region unless pr_draw is set
-        if (pr_draw) {
-            // draw everything
-            memcpy (fb_stage, fb_canvas, fb_nbytes);
-        } else {
-            // draw only around the protected area
-            uint16_t bw = FB_XRES*BYTESPFBPIX;                                  // bytes wide
-            uint16_t pr_r = pr_x + pr_w;                                        // right of PR
-            uint16_t pr_b = pr_y + pr_h;                                        // bottom of PR
-            fbpix_t *s_row = fb_stage;                                          // next stage row
-            fbpix_t *c_row = fb_canvas;                                         // next canvas row
-            for (uint16_t y = 0; y < FB_YRES; y++, c_row += FB_XRES, s_row += FB_XRES) {
-                if (y < pr_y) {
-                    memcpy (s_row, c_row, bw);                                  // above
-                } else if (y < pr_b) {
-                    memcpy (s_row, c_row, pr_x*BYTESPFBPIX);                    // left
-                    memcpy (s_row+pr_r, c_row+pr_r, (FB_XRES-pr_r)*BYTESPFBPIX);// right
-                } else {
-                    memcpy (s_row, c_row, bw);                                  // below
-                }
-            }
-        }
+        // copy just the changed tiles to fb_stage, fbThread then pushes dt_runs to the display
+        (void) stageDirty();
 }
 
 /* thread that runs forever to update display buffer whenever fb_canvas changes
@@ -2901,29 +3655,66 @@ void Adafruit_RA8875::fbThread ()
         // init cursor timeout off soon
         gettimeofday (&mouse_tv, NULL);
 
-        // update screen periodically
+        // first push is the whole screen including borders
+        bool full_push = true;
+
+        // earliest time for next frame
+        struct timeval next_tv;
+        gettimeofday (&next_tv, NULL);
+
+        // update screen whenever it changes
 	for (;;) {
 
             // all set
             ready = true;
 
-	    // get stable copy of canvas into staging area
-	    pthread_mutex_lock (&fb_lock);
-		bool is_new = fb_dirty || pr_draw;
-		if (is_new) {
+            // sleep until there is something to show or, while the cursor is showing, it is time to erase it
+            int idle_ms = 1000;
+            if (full_push && mouse_idle < MOUSE_FADE && MOUSE_FADE - mouse_idle < idle_ms)
+                idle_ms = MOUSE_FADE - mouse_idle;
+            bool is_new = waitDisplay (next_tv, idle_ms);
+
+	    // get stable copy of canvas into staging area.
+            // N.B. only this thread runs stageDirty() so dt_runs[] remains valid after unlocking
+            if (is_new) {
+                bool pr = pr_draw;
+                pthread_mutex_lock (&fb_lock);
+                    ds_locks++;
+                    fb_dirty = false;
                     drawCanvas();
-		    fb_dirty = false;
-                    pr_draw = false;
-		}
-	    pthread_mutex_unlock (&fb_lock);
+                    is_new = dt_n_runs > 0;
+                pthread_mutex_unlock (&fb_lock);
+                finishFrame (pr);
+            }
 
             // get mouse idle time
             struct timeval tv;
             gettimeofday (&tv, NULL);
             mouse_idle = (tv.tv_sec - mouse_tv.tv_sec)*1000 + (tv.tv_usec - mouse_tv.tv_usec)/1000;
+            bool cursor_on = mouse_idle < MOUSE_FADE;
+
+            // no need to go crazy
+            next_tv = tv;
+            next_tv.tv_usec += 20000;
+            next_tv.tv_sec += next_tv.tv_usec/1000000;
+            next_tv.tv_usec %= 1000000;
+
+            // without a cursor now or on the previous push just copy the changed runs directly to the display
+            if (is_new && !full_push && !cursor_on) {
+                for (int i = 0; i < dt_n_runs; i++) {
+                    const DirtyRun &r = dt_runs[i];
+                    for (int y = r.y; y < r.y + r.h; y++)
+                        memcpy (fb_fb + (FB_Y0+y)*fb_si.xres + FB_X0 + r.x, fb_stage + y*FB_XRES + r.x,
+                                        r.w*BYTESPFBPIX);
+                }
+                is_new = false;
+            }
 
-            // copy fb_stage to hardware display if new or mouse moved
-            if (is_new || mouse_idle < MOUSE_FADE) {
+            // copy all of fb_stage to hardware display if first time, mouse moved or to erase cursor
+            if (is_new || full_push || cursor_on) {
+
+                // copy again next time to erase cursor if it's on now
+                full_push = cursor_on;
 
                 // copy to cursor layer
                 memcpy (fb_cursor, fb_stage, fb_nbytes);
@@ -2971,9 +3762,6 @@ void Adafruit_RA8875::fbThread ()
                 // black bottom border
                 memset (fb_fb+(FB_Y0+FB_YRES)*fb_si.xres, 0, FB_Y0*fb_rowbytes);
             }
-
-	    // no need to go crazy
-            usleep (20000);
 	}
 }
 
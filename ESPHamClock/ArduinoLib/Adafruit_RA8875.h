@@ -10,6 +10,7 @@
 #include <stdint.h>
 #include <pthread.h>
 #include <sys/time.h>
+#include <atomic>
 
 #ifdef _USE_X11
 
@@ -172,6 +173,13 @@ class Adafruit_RA8875 {
 	void plotEarth (uint16_t x0, uint16_t y0, float lat0, float lng0,
             float dlatr, float dlngr, float dlatd, float dlngd, float fract_day);
 
+	// same but for a span of n app pixels along one row
+	void plotEarthRow (uint16_t x0, uint16_t y0, int n, const float *lat, const float *lng,
+            const float *lat_dn, const float *lng_dn, const float *fract_day);
+
+	// redraw a span of n app pixels with whatever earth was last plotted there
+	void restoreEarthRow (uint16_t x0, uint16_t y0, int n);
+
         // methods to implement a protected rectangle drawn only with drawPR()
         void setPR (uint16_t x, uint16_t y, uint16_t w, uint16_t h);
         void drawPR(void);
@@ -186,6 +194,12 @@ class Adafruit_RA8875 {
         void putChar (char c, bool ctrl, bool shift);
         char getChar(bool *ctrl, bool *shift);
 
+        // function to call from any thread after a key or mouse button is queued
+        void setInputNotify (void (*fp)(void));
+
+        // function to call before the main thread draws app rectangle x,y,w,h within the protected rectangle
+        void setPRNotify (void (*fp)(int x, int y, int w, int h));
+
         // set and get current mouse position
         bool getMouse (uint16_t *x, uint16_t *y);
         void setMouse (int x, int y);
@@ -207,6 +221,10 @@ class Adafruit_RA8875 {
         bool getBackingStore (uint8_t *&bs, int x0, int y0, int w, int h);
         bool setBackingStore (uint8_t *&bs, int x0, int y0, int w, int h);
         bool getRawPix (uint8_t *rgb24, int npix);
+        bool getRawPix (uint8_t *rgb24, int npix, uint32_t &gen);
+        bool getRawPixChanges (uint8_t *rgb24, int npix, uint32_t &gen, uint8_t *blk_changed,
+            int blk_w, int blk_h);
+        bool getRawPixRows (uint8_t *rgb24, int npix, int y0, int ny);
 
 
         // control whether to display gray
@@ -214,6 +232,26 @@ class Adafruit_RA8875 {
             gray_type = g;
         };
 
+        // display thread activity since startup, for comparing with how often the canvas is drawn
+        typedef struct {
+            uint32_t n_wakes;                           // times display thread woke up
+            uint32_t n_frames;                          // times fb_stage was refreshed from fb_canvas
+            uint32_t n_retries;                         // frames restaged because drawing overlapped the copy
+            uint32_t n_locks;                           // fb_lock acquisitions by display thread and readers
+            uint32_t n_draws;                           // outermost drawing primitives
+        } DisplayStats;
+        void getDisplayStats (DisplayStats &ds);
+
+        // time the span raster primitives against the original per-pixel methods, operations per second.
+        // canvas is restored afterwards.
+        typedef struct {
+            float fill_span, fill_pix;                  // filled rectangles
+            float circle_span, circle_pix;              // filled plus outline circles
+            float text_span, text_pix;                  // characters in current font, 0 if no font
+            bool same;                                  // whether both methods drew identical pixels
+        } DrawBench;
+        void benchmarkDraw (DrawBench &db);
+
     protected:
 
 	// 0: normal 2: 180 degs
@@ -309,6 +347,13 @@ class Adafruit_RA8875 {
         int kb_qhead, kb_qtail;
 	pthread_mutex_t kb_lock;
 
+        void (*input_notify)(void);
+        void notifyInput (void);
+
+        void (*pr_notify)(int x, int y, int w, int h);
+        void notifyPR (void);
+        void checkPR (int16_t x, int16_t y, int16_t w, int16_t h);
+
         struct timeval mouse_tv;
         int mouse_idle;
         #define MOUSE_FADE 30000        // ms
@@ -316,14 +361,31 @@ class Adafruit_RA8875 {
         // total display size
         volatile int screen_w, screen_h;
 
-	// frame buffer is drawn in separate thread protected by fb_lock
+	// the main thread draws into fb_canvas without locking, bracketing each primitive with beginDraw()
+	// and endDraw(). canvas_seq is odd while a primitive is in progress so the display thread can tell
+	// whether its copy of fb_canvas into fb_stage overlapped any drawing. fb_lock protects fb_stage for
+	// its readers. the display thread sleeps in waitDisplay() until fb_dirty, pr_draw or options_engage is
+	// set, then those waiting for it are told of its progress on fb_done_cv.
         static void *fbThreadHelper(void *me);
         #define APP_WIDTH  800
         #define APP_HEIGHT 480
 	void fbThread ();
 	pthread_mutex_t fb_lock;
 	struct fb_var_screeninfo fb_si;
-	volatile bool fb_dirty;
+	std::atomic<bool> fb_dirty;
+	std::atomic<uint32_t> canvas_seq;
+	int draw_depth;                         // nesting of beginDraw(), main thread only
+	void beginDraw (void);
+	void endDraw (void);
+	void setDirty (void);
+	pthread_mutex_t fb_wait_lock;           // guards waiting on fb_wait_cv and fb_done_cv
+	pthread_cond_t fb_wait_cv;              // display thread waits here for something to do
+	pthread_cond_t fb_done_cv;              // others wait here for the display thread
+	int fb_wake[2];                         // X11 waits in poll() so is woken with a pipe instead
+	void wakeDisplay (void);
+	bool waitDisplay (const struct timeval &next_tv, int idle_ms);
+	void finishFrame (bool pr);
+	std::atomic<uint32_t> ds_wakes, ds_frames, ds_retries, ds_locks, ds_draws;
 	fbpix_t *fb_canvas;             // main drawing image buffer
 	fbpix_t *fb_stage;              // temp image during staging to fb hw
 	int fb_nbytes;                  // bytes in each in-memory image buffer
@@ -338,6 +400,8 @@ class Adafruit_RA8875 {
 
         // full res helpers
 	void plotfb (int16_t x, int16_t y, fbpix_t color);
+        fbpix_t spanColor (fbpix_t color);
+        void plotSpan (int16_t x, int16_t y, int16_t w, fbpix_t color);
         void plotDrawRect (int16_t x0, int16_t y0, int16_t w, int16_t h, fbpix_t fbpix);
         void plotFillRect (int16_t x0, int16_t y0, int16_t w, int16_t h, fbpix_t fbpix);
         void plotDrawCircle (int16_t x0, int16_t y0, uint16_t r0, fbpix_t fbpix);
@@ -354,6 +418,14 @@ class Adafruit_RA8875 {
         uint16_t *DEARTH_BIG;
         uint16_t *NEARTH_BIG;
         int EARTH_BIG_H, EARTH_BIG_W;
+        float EARTH_BIG_XS, EARTH_BIG_YS;       // earth pixels per degree lng and lat
+
+        // copy of just the earth pixels, allocated on first use
+        fbpix_t *fb_earth;
+
+        // shared by plotEarth() and plotEarthRow()
+        void plotEarthPixel (uint16_t x0, uint16_t y0, float lat0, float lng0,
+            float dlatr, float dlngr, float dlatd, float dlngd, float fract_day);
 
         // handy macro to implement the 2d nature of the arrays
         #define EPIXEL(a,r,c)   ((a)[(r)*EARTH_BIG_W + (c)])
@@ -364,8 +436,27 @@ class Adafruit_RA8875 {
             int16_t ty = y0; y0 = y1; y1 = ty;
         }
 
-        // set whether to display gray
+        // set whether to display gray, GRAY_ALL uses gray_lut to convert each r g b to its share of gray
         GrayDpy_t gray_type;
+        uint8_t gray_lut[3][256];
+
+        // dirty region tracking in tiles of DIRTY_TILE x DIRTY_TILE fb pixels.
+        // drawing marks dt_canvas, stageDirty() copies just those tiles to fb_stage and stamps dt_stage_gen.
+        #define DIRTY_TILE      16
+        #define DT_COLS         ((FB_XRES+DIRTY_TILE-1)/DIRTY_TILE)
+        #define DT_ROWS         ((FB_YRES+DIRTY_TILE-1)/DIRTY_TILE)
+        #define DT_MAXRUNS      64              // more runs than this are sent as one bounding box
+        typedef struct {
+            uint16_t x, y, w, h;                // fb pixels
+        } DirtyRun;
+        uint8_t dt_canvas[DT_ROWS*DT_COLS];     // set when tile drawn on since last copied to fb_stage
+        uint32_t dt_stage_gen[DT_ROWS*DT_COLS]; // stage_gen when tile last changed in fb_stage
+        uint32_t stage_gen;                     // incremented each time stageDirty() changes fb_stage
+        DirtyRun dt_runs[DT_ROWS*DT_COLS];      // runs of tiles along each tile row changed by stageDirty()
+        int dt_n_runs;                          // n used in dt_runs[]
+        void markDirty (int16_t x, int16_t y, int16_t w, int16_t h);
+        void markAllDirty (void);
+        bool stageDirty (void);
 
 };
 
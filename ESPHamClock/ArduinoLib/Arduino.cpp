@@ -379,6 +379,8 @@ static void usage (const char *errfmt, ...)
             fprintf (stderr, " -g   : init DE using geolocation with current public IP; requires -k\n");
             fprintf (stderr, " -h   : print this help summary then exit\n");
             fprintf (stderr, " -i i : init DE using geolocation with IP i; requires -k\n");
+            fprintf (stderr, " -j n : render earth map with n worker threads, max %d; default 0 renders in main thread\n",
+                                    map_workers_max);
             fprintf (stderr, " -k   : start in normal mode, ie, don't offer Setup or wait for Skips\n");
             fprintf (stderr, " -l l : set Mercator or Robinson center longitude to l degrees, +E; requires -k\n");
             fprintf (stderr, " -m   : enable demo mode\n");
@@ -507,6 +509,14 @@ static void crackArgs (int ac, char *av[])
                     init_locip = *++av;
                     ac--;
                     break;
+                case 'j':
+                    if (ac < 2)
+                        usage ("missing n workers for -j");
+                    map_workers = atoi(*++av);
+                    if (map_workers < 0 || map_workers > map_workers_max)
+                        usage ("-j must be [0,%d]", map_workers_max);
+                    ac--;
+                    break;
                 case 'k':                       // fallthru
                 case 'K':
                     skip_skip = true;
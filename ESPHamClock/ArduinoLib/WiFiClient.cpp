@@ -2,17 +2,178 @@
  */
 
 #include <signal.h>
+#include <poll.h>
 
 #include "IPAddress.h"
 #include "WiFiClient.h"
 
+
+/* pool of idle keep-alive connections keyed by host:port and a cache of host lookups, shared by all
+ * clients in all threads.
+ */
+#define POOL_MAX        8                       // max idle connections kept
+#define POOL_DEF_KA_S   5                       // assumed peer idle timeout if not stated
+#define POOL_MARGIN_S   1                       // retire idle connection this much before peer would
+#define DNS_MAX         8                       // max hosts remembered
+#define DNS_TTL_S       300                     // secs to trust a lookup, getaddrinfo() does not report TTL
+#define DRAIN_MAX       16384                   // max unread body bytes to drain in order to reuse
+
+typedef struct {
+        char key[80];                           // host:port
+        int fd;                                 // open connection
+        time_t expires;                         // close if still idle at this time
+} PoolConn;
+
+typedef struct {
+        char host[64];                          // name as given to connect()
+        struct in_addr addr;                    // its address
+        time_t expires;                         // lookup again at this time
+} DNSEntry;
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static PoolConn pool[POOL_MAX];                 // oldest first
+static int n_pool;
+static DNSEntry dns_cache[DNS_MAX];
+static WiFiPoolStats pool_stats;
+
+/* take the newest idle connection to key from the pool that still looks usable, else return -1.
+ */
+static int poolGet (const char *key)
+{
+        time_t now = time(NULL);
+
+        for (;;) {
+
+            // find newest for key
+            int fd = -1;
+            time_t expires = 0;
+            pthread_mutex_lock (&pool_lock);
+            for (int i = n_pool; --i >= 0; ) {
+                if (strcmp (pool[i].key, key) == 0) {
+                    fd = pool[i].fd;
+                    expires = pool[i].expires;
+                    memmove (&pool[i], &pool[i+1], (n_pool-i-1)*sizeof(PoolConn));
+                    n_pool--;
+                    break;
+                }
+            }
+            pthread_mutex_unlock (&pool_lock);
+            if (fd < 0)
+                return (-1);
+
+            // an idle connection should have nothing to read: if it does, it's EOF or junk so discard
+            struct pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            if (now < expires && poll (&pfd, 1, 0) == 0)
+                return (fd);
+
+            if (debugLevel (DEBUG_NET, 1))
+                printf ("WiFiCl: dropping stale pooled %s fd %d\n", key, fd);
+            close (fd);
+        }
+}
+
+/* add fd to the pool as an idle connection to key that the peer will keep open for keepalive_s.
+ */
+static void poolPut (const char *key, int fd, int keepalive_s)
+{
+        pthread_mutex_lock (&pool_lock);
+
+        // make room by closing the oldest
+        if (n_pool == POOL_MAX) {
+            close (pool[0].fd);
+            memmove (&pool[0], &pool[1], (POOL_MAX-1)*sizeof(PoolConn));
+            n_pool--;
+        }
+
+        PoolConn &pc = pool[n_pool++];
+        snprintf (pc.key, sizeof(pc.key), "%s", key);
+        pc.fd = fd;
+        pc.expires = time(NULL) + keepalive_s - POOL_MARGIN_S;
+        pool_stats.n_pooled++;
+
+        pthread_mutex_unlock (&pool_lock);
+}
+
+/* fill sa with the address of host:port, using the cache if possible.
+ * return whether successful.
+ */
+static bool dnsLookup (const char *host, int port, struct sockaddr_in &sa)
+{
+        memset (&sa, 0, sizeof(sa));
+        sa.sin_family = AF_INET;
+        sa.sin_port = htons (port);
+
+        // check cache
+        time_t now = time(NULL);
+        bool found = false;
+        pthread_mutex_lock (&pool_lock);
+        for (int i = 0; i < DNS_MAX; i++) {
+            if (now < dns_cache[i].expires && strcmp (dns_cache[i].host, host) == 0) {
+                sa.sin_addr = dns_cache[i].addr;
+                found = true;
+                break;
+            }
+        }
+        if (found)
+            pool_stats.dns_hits++;
+        else
+            pool_stats.dns_misses++;
+        pthread_mutex_unlock (&pool_lock);
+        if (found)
+            return (true);
+
+        /* lookup host address.
+         * N.B. must call freeaddrinfo(aip) after successful call before returning
+         */
+        struct addrinfo hints, *aip;
+        memset (&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        int error = ::getaddrinfo (host, NULL, &hints, &aip);
+        if (error) {
+            printf ("WiFiCl: getaddrinfo(%s:%d): %s\n", host, port, gai_strerror(error));
+            return (false);
+        }
+        sa.sin_addr = ((struct sockaddr_in *)aip->ai_addr)->sin_addr;
+        freeaddrinfo (aip);
+
+        // add to cache, replacing the one expiring first
+        if (strlen (host) < sizeof(dns_cache[0].host)) {
+            pthread_mutex_lock (&pool_lock);
+            int oldest = 0;
+            for (int i = 1; i < DNS_MAX; i++)
+                if (dns_cache[i].expires < dns_cache[oldest].expires)
+                    oldest = i;
+            DNSEntry &de = dns_cache[oldest];
+            strcpy (de.host, host);
+            de.addr = sa.sin_addr;
+            de.expires = now + DNS_TTL_S;
+            pthread_mutex_unlock (&pool_lock);
+        }
+
+        return (true);
+}
+
+/* return a copy of the pool and DNS stats.
+ * non-standard
+ */
+void WiFiClient::getPoolStats (WiFiPoolStats &s)
+{
+        pthread_mutex_lock (&pool_lock);
+        s = pool_stats;
+        s.n_idle = n_pool;
+        pthread_mutex_unlock (&pool_lock);
+}
+
+
 // default constructor
 WiFiClient::WiFiClient()
 {
-        // init
-	socket = -1;
-	n_peek = 0;
-        next_peek = 0;
+        init (-1);
+        capture = NULL;
 }
 
 // constructor handed an open socket to use
@@ -21,10 +182,24 @@ WiFiClient::WiFiClient(int fd)
         if (fd >= 0 && debugLevel (DEBUG_NET, 1))
             printf ("WiFiCl: new WiFiClient inheriting fd %d\n", fd);
 
-        // init
+        init (fd);
+        capture = NULL;
+}
+
+// start fresh using fd, unframed and not eligible for the pool
+void WiFiClient::init (int fd)
+{
 	socket = fd;
 	n_peek = 0;
         next_peek = 0;
+        pool_key[0] = '\0';
+        body_left = -1;
+        chunked = false;
+        n_chunks = 0;
+        body_done = false;
+        keepalive_s = 0;
+        reused = false;
+        resend.clear();
 }
 
 // return whether this socket is active
@@ -100,37 +275,62 @@ int WiFiClient::tout (int to_ms, int fd)
 
 bool WiFiClient::connect(const char *host, int port)
 {
-        struct addrinfo hints, *aip;
-        char port_str[16];
+        char key[sizeof(pool_key)];
         int sockfd;
 
-        /* lookup host address.
-         * N.B. must call freeaddrinfo(aip) after successful call before returning
-         */
-        memset (&hints, 0, sizeof(hints));
-        hints.ai_family = AF_INET;
-        hints.ai_socktype = SOCK_STREAM;
-        snprintf (port_str, sizeof(port_str), "%d", port);
-        int error = ::getaddrinfo (host, port_str, &hints, &aip);
-        if (error) {
-            printf ("WiFiCl: getaddrinfo(%s:%d): %s\n", host, port, gai_strerror(error));
-            return (false);
+        /* reuse an idle connection to the same host:port if one is still good */
+        snprintf (key, sizeof(key), "%s:%d", host, port);
+        sockfd = poolGet (key);
+        if (sockfd >= 0) {
+            if (debugLevel (DEBUG_NET, 1))
+                printf ("WiFiCl: reusing %s fd %d\n", key, sockfd);
+            init (sockfd);
+            strcpy (pool_key, key);
+            reused = true;
+            pthread_mutex_lock (&pool_lock);
+            pool_stats.n_reused++;
+            pthread_mutex_unlock (&pool_lock);
+            return (true);
         }
 
+        /* else open a new one */
+        sockfd = openNew (host, port);
+        if (sockfd < 0)
+            return (false);
+
+        // init much like constructors
+        init (sockfd);
+        strcpy (pool_key, key);
+
+        return (true);
+}
+
+/* open a new connection to host:port.
+ * return socket else -1.
+ */
+int WiFiClient::openNew (const char *host, int port)
+{
+        struct timeval tv0, tv1;
+        struct sockaddr_in sa;
+        int sockfd;
+
+        /* lookup host address */
+        gettimeofday (&tv0, NULL);
+        if (!dnsLookup (host, port, sa))
+            return (-1);
+
         /* create socket */
-        sockfd = ::socket (aip->ai_family, aip->ai_socktype, aip->ai_protocol);
+        sockfd = ::socket (AF_INET, SOCK_STREAM, 0);
         if (sockfd < 0) {
-            freeaddrinfo (aip);
             printf ("WiFiCl: socket(%s:%d): %s\n", host, port, strerror(errno));
-	    return (false);
+	    return (-1);
         }
 
         /* connect */
-        if (connect_to (sockfd, aip->ai_addr, aip->ai_addrlen, 8000) < 0) {
+        if (connect_to (sockfd, (struct sockaddr *)&sa, sizeof(sa), 8000) < 0) {
             printf ("WiFiCl: connect(%s:%d): %s\n", host, port, strerror(errno));
-            freeaddrinfo (aip);
             close (sockfd);
-            return (false);
+            return (-1);
         }
 
         /* handle write errors inline */
@@ -139,14 +339,46 @@ bool WiFiClient::connect(const char *host, int port)
         /* ok start fresh */
         if (debugLevel (DEBUG_NET, 1))
             printf ("WiFiCl: new %s:%d fd %d\n", host, port, sockfd);
-        freeaddrinfo (aip);
+        gettimeofday (&tv1, NULL);
+        pthread_mutex_lock (&pool_lock);
+        pool_stats.n_new++;
+        pool_stats.new_ms += (tv1.tv_sec-tv0.tv_sec)*1000.0 + (tv1.tv_usec-tv0.tv_usec)/1000.0;
+        pthread_mutex_unlock (&pool_lock);
 
-        // init much like constructors
-	socket = sockfd;
-	n_peek = 0;
-        next_peek = 0;
+        return (sockfd);
+}
 
-        return (true);
+/* the peer closed a reused connection before replying, probably because it timed out the idle connection
+ * just as we sent: send everything again once on a new connection to the same host:port.
+ * return whether successful.
+ */
+bool WiFiClient::resendFresh()
+{
+        std::string req;
+        req.swap (resend);
+
+        char key[sizeof(pool_key)], host[sizeof(pool_key)];
+        strcpy (key, pool_key);
+        strcpy (host, key);
+        char *colon = strrchr (host, ':');
+        *colon = '\0';
+        int port = atoi (colon+1);
+
+        if (debugLevel (DEBUG_NET, 1))
+            printf ("WiFiCl: pooled %s:%d fd %d closed before reply, resending %d bytes\n", host, port,
+                                socket, (int)req.size());
+        closeSocket();
+
+        int sockfd = openNew (host, port);
+        if (sockfd < 0)
+            return (false);
+        init (sockfd);
+        strcpy (pool_key, key);
+        pthread_mutex_lock (&pool_lock);
+        pool_stats.n_resent++;
+        pthread_mutex_unlock (&pool_lock);
+
+        return (write ((const uint8_t *) req.data(), req.size()) == (int)req.size());
 }
 
 bool WiFiClient::connect(IPAddress ip, int port)
@@ -164,23 +396,101 @@ void WiFiClient::setNoDelay(bool on)
             printf ("WiFiCl: TCP_NODELAY(%d): %s\n", on, strerror(errno));     // not fatal
 }
 
+/* done with this connection: return it to the pool if the peer will keep it open and the response body
+ * is complete, else close it.
+ */
 void WiFiClient::stop()
+{
+        // callers often stop as soon as they have what they want so consume any small remainder now
+        if (socket >= 0 && pool_key[0] && keepalive_s != 0 && body_left >= 0 && !body_done) {
+            int n_drain = 0;
+            while (n_drain < DRAIN_MAX && available(0)) {
+                int n = n_peek - next_peek;
+                if (n > body_left)
+                    n = body_left;
+                next_peek += n;
+                consumed (n);
+                n_drain += n;
+            }
+        }
+
+	if (socket >= 0 && pool_key[0] && keepalive_s != 0 && body_done && next_peek == n_peek) {
+            int ka_s = keepalive_s > 0 ? keepalive_s : POOL_DEF_KA_S;
+            if (ka_s > POOL_MARGIN_S) {
+                if (debugLevel (DEBUG_NET, 1))
+                    printf ("WiFiCl: pooling %s fd %d for %d s\n", pool_key, socket, ka_s);
+                poolPut (pool_key, socket, ka_s);
+                init (-1);
+                return;
+            }
+        }
+
+        closeSocket();
+}
+
+/* close the connection regardless.
+ */
+void WiFiClient::closeSocket()
 {
 	if (socket >= 0) {
             if (debugLevel (DEBUG_NET, 1))
                 printf ("WiFiCl: stopping fd %d\n", socket);
 	    shutdown (socket, SHUT_RDWR);
 	    close (socket);
-	    socket = -1;
-	    n_peek = 0;
-            next_peek = 0;
+            init (-1);
 	} else if (debugLevel (DEBUG_NET, 2))
             printf ("WiFiCl: fd %d already stopped\n", socket);
 }
 
+/* declare how the response body that follows is delimited, as found in its header:
+ * content_length >= 0 for that many bytes, else chunked or, if neither, until EOF.
+ * keepalive_s is how long the peer will keep the connection open after the body, 0 if it will close
+ * or < 0 if it did not say. Unless reading until EOF, read() and friends then report EOF at the end of
+ * the body and stop() may keep the connection for reuse.
+ * non-standard
+ */
+void WiFiClient::frameBody (long content_length, bool is_chunked, int ka_s)
+{
+        chunked = is_chunked;
+        n_chunks = 0;
+        if (chunked) {
+            body_left = 0;                      // first size line still to come
+            body_done = false;
+            keepalive_s = ka_s;
+        } else if (content_length >= 0) {
+            body_left = content_length;
+            body_done = content_length == 0;
+            keepalive_s = ka_s;
+        } else {
+            body_left = -1;
+            body_done = false;
+            keepalive_s = 0;                    // framed only by EOF
+        }
+
+        if (debugLevel (DEBUG_NET, 2))
+            printf ("WiFiCl: fd %d body %s %ld keepalive %d\n", socket, chunked ? "chunked" : "length",
+                                    body_left, keepalive_s);
+}
+
 bool WiFiClient::connected()
 {
-	return (socket >= 0);
+	return (socket >= 0 || capture != NULL);
+}
+
+/* append all subsequent output to *sp instead of sending it, or resume sending if sp is NULL.
+ * non-standard
+ */
+void WiFiClient::captureOutput (std::string *sp)
+{
+        capture = sp;
+}
+
+/* return socket file descriptor, -1 if closed.
+ * non-standard
+ */
+int WiFiClient::fd()
+{
+        return (socket);
 }
 
 /* return whether more is available after waiting up to ms.
@@ -197,7 +507,7 @@ bool WiFiClient::pending(int ms)
         int s = select (socket+1, &rset, NULL, NULL, &tv);
         if (s < 0) {
             printf ("WiFiCl: fd %d select(%d ms): %s\n", socket, ms, strerror(errno));
-	    stop();
+	    closeSocket();
 	    return (false);
 	}
 
@@ -209,10 +519,90 @@ bool WiFiClient::pending(int ms)
         return (more);
 }
 
-/* return next value in peek or wait up to given time to add more.
- * return 1 if read() or readArray() will return immediately else 0 if nothing more.
+/* return 1 if read() or readArray() will return more body immediately, waiting up to the given time for
+ * more to arrive, else 0 if nothing more.
  */
 int WiFiClient::available (int pending_ms)
+{
+        // end of a framed body looks like EOF
+        if (body_left == 0 && (body_done || !chunked || !nextChunk (pending_ms)))
+            return (0);
+
+        return (rawAvailable (pending_ms));
+}
+
+/* account for n body bytes having been consumed from peek.
+ */
+void WiFiClient::consumed (int n)
+{
+        if (body_left >= 0) {
+            body_left -= n;
+            if (body_left == 0 && !chunked)
+                body_done = true;
+        }
+}
+
+/* read the next raw line up to '\n' without the '\r\n', waiting up to pending_ms for each byte.
+ * return whether complete.
+ */
+bool WiFiClient::rawLine (char *line, int line_len, int pending_ms)
+{
+        int n = 0;
+        while (rawAvailable (pending_ms)) {
+            char c = peek[next_peek++];
+            if (c == '\n') {
+                line[n] = '\0';
+                return (true);
+            }
+            if (c != '\r' && n < line_len-1)
+                line[n++] = c;
+        }
+        return (false);
+}
+
+/* advance to the next chunk of a chunked body, return whether it contains more data.
+ */
+bool WiFiClient::nextChunk (int pending_ms)
+{
+        char line[64];
+
+        // data of each chunk is followed by CRLF
+        if (n_chunks > 0 && (!rawLine (line, sizeof(line), pending_ms) || line[0] != '\0'))
+            goto bad;
+
+        // next size in hex, ignoring any extensions
+        if (!rawLine (line, sizeof(line), pending_ms))
+            goto bad;
+        char *endp;
+        body_left = strtol (line, &endp, 16);
+        if (endp == line || body_left < 0)
+            goto bad;
+        n_chunks++;
+        if (body_left > 0)
+            return (true);
+
+        // last chunk: skip trailer through blank line
+        do {
+            if (!rawLine (line, sizeof(line), pending_ms))
+                goto bad;
+        } while (line[0] != '\0');
+        body_done = true;
+        return (false);
+
+    bad:
+
+        // out of sync so never reuse
+        if (debugLevel (DEBUG_NET, 1))
+            printf ("WiFiCl: fd %d bad chunk framing\n", socket);
+        body_left = 0;
+        keepalive_s = 0;
+        return (false);
+}
+
+/* return next value in peek or wait up to given time to add more, regardless of body framing.
+ * return 1 if more is in peek else 0 if nothing more.
+ */
+int WiFiClient::rawAvailable (int pending_ms)
 {
         // certainly none if closed
         if (socket < 0)
@@ -228,7 +618,13 @@ int WiFiClient::available (int pending_ms)
 
         // read more
 	int nr = ::read(socket, peek, sizeof(peek));
+        if (nr <= 0 && reused)
+            return (resendFresh() ? rawAvailable (pending_ms) : 0);
 	if (nr > 0) {
+            if (reused) {
+                reused = false;
+                resend.clear();
+            }
             if (debugLevel (DEBUG_NET, 2))
                 printf ("WiFiCl: available read(%d,%ld) %d\n", socket, (long)sizeof(peek), nr);
             if (debugLevel (DEBUG_NET, 3))
@@ -239,12 +635,12 @@ int WiFiClient::available (int pending_ms)
 	} else if (nr == 0) {
             if (debugLevel (DEBUG_NET, 1))
                 printf ("WiFiCl: available read(%d) EOF\n", socket);
-	    stop();
+	    closeSocket();
 	    return (0);
         } else {
             if (debugLevel (DEBUG_NET, 1))
                 printf ("WiFiCl: available read(%d): %s\n", socket, strerror(errno));
-	    stop();
+	    closeSocket();
 	    return (0);
 	}
 }
@@ -256,6 +652,7 @@ int WiFiClient::read()
 {
         if (available (READ_PENDING_MS)) {
             uint8_t p = peek[next_peek++];
+            consumed (1);
             if (debugLevel (DEBUG_NET, 3)) {
                 int n_more = n_peek - next_peek;
                 if (isprint (p))
@@ -277,9 +674,12 @@ int WiFiClient::readArray (uint8_t *array, long count)
 
         if (available (READ_PENDING_MS)) {
             int n_available = n_peek - next_peek;
+            if (body_left >= 0 && n_available > body_left)
+                n_available = body_left;
             n_return = count > n_available ? n_available : count;
             memcpy (array, &peek[next_peek], n_return);
             next_peek += n_return;
+            consumed (n_return);
         }
 
         if (debugLevel (DEBUG_NET, 2))
@@ -287,26 +687,68 @@ int WiFiClient::readArray (uint8_t *array, long count)
         return (n_return);
 }
 
+/* wait as long as READ_PENDING_MS for more bytes then return a pointer directly into the read-ahead buffer
+ * and set n to the count available there, limited to the current body. nothing is consumed, caller must
+ * follow with skip() for however much it uses. the pointer is valid only until the next read of any kind.
+ * return NULL with n = 0 when no more.
+ */
+const uint8_t *WiFiClient::readSpan (int &n)
+{
+        n = 0;
+        if (!available (READ_PENDING_MS))
+            return (NULL);
+
+        n = n_peek - next_peek;
+        if (body_left >= 0 && n > body_left)
+            n = body_left;
+
+        if (debugLevel (DEBUG_NET, 2))
+            printf ("WiFiCl: readSpan(%d) %d\n", socket, n);
+        return (&peek[next_peek]);
+}
+
+/* consume n bytes of the span most recently returned by readSpan().
+ */
+void WiFiClient::skip (int n)
+{
+        if (n > n_peek - next_peek)
+            n = n_peek - next_peek;
+        next_peek += n;
+        consumed (n);
+}
+
 int WiFiClient::write (const uint8_t *buf, int n)
 {
+        // just collect if capturing
+        if (capture) {
+            capture->append ((const char *) buf, n);
+            return (n);
+        }
+
         // can't if closed
         if (socket < 0)
             return (0);
 
+        // keep a copy until the reply starts in case the peer closed a reused connection meanwhile
+        if (reused)
+            resend.append ((const char *) buf, n);
+
 	int nw = 0;
 	for (int ntot = 0; ntot < n; ntot += nw) {
 	    nw = ::write (socket, buf+ntot, n-ntot);
 	    if (nw < 0) {
                 // select says it won't block but it still might be temporarily EAGAIN
+                if (errno != EAGAIN && reused)
+                    return (resendFresh() ? n : 0);
                 if (errno != EAGAIN) {
                     printf ("WiFiCl: write(%d) after %d: %s\n", socket, ntot, strerror(errno));
-                    stop();             // avoid repeated failed attempts
+                    closeSocket();      // avoid repeated failed attempts
                     return (0);
                 } else
                     nw = 0;             // act like nothing happened
 	    } else if (nw == 0) {
                 printf ("WiFiCl: write(%d) returns 0 after %d\n", socket, ntot);
-                stop();             // avoid repeated failed attempts
+                closeSocket();      // avoid repeated failed attempts
                 return (0);
             }
 	}
@@ -435,3 +877,137 @@ IPAddress WiFiClient::remoteIP()
         sscanf (s, "%d.%d.%d.%d", &oct0, &oct1, &oct2, &oct3);
 	return (IPAddress(oct0,oct1,oct2,oct3));
 }
+
+
+
+#if defined(_UNIT_TEST)
+
+/* stand-alone check that a pooled connection the server closes is never fatal to the next request:
+ *    g++ -Wall -O2 -I. -IArduinoLib -D_UNIT_TEST -o x.wificlient ArduinoLib/WiFiClient.cpp -lpthread
+ *    ./x.wificlient
+ * the server answers each connection's first request then closes it, either while it sits idle in the pool
+ * or just after reading the next request, as when its keep-alive timer fires as the request arrives.
+ */
+
+static int test_listen_fd;                      // test server listening socket
+static bool test_close_idle;                    // whether server closes at once, else after next request
+
+bool debugLevel (DebugSubsys s, int level) { (void)s; (void)level; return (false); }
+
+/* read one request from fd through its blank line, return whether complete.
+ */
+static bool testReadRequest (int fd)
+{
+        char buf[1000];
+        int n = 0;
+        while (n < (int)sizeof(buf)-1 && ::read (fd, &buf[n], 1) == 1) {
+            buf[++n] = '\0';
+            if (n >= 4 && strcmp (&buf[n-4], "\r\n\r\n") == 0)
+                return (true);
+        }
+        return (false);
+}
+
+/* thread that serves each connection as described above, forever.
+ */
+static void *testServer (void *unused)
+{
+        (void) unused;
+
+        static const char reply[] = "HTTP/1.1 200 OK\r\nContent-Length: 5\r\nKeep-Alive: timeout=30\r\n\r\nhello";
+        for (;;) {
+            int fd = accept (test_listen_fd, NULL, NULL);
+            if (fd < 0)
+                break;
+            if (testReadRequest (fd) && ::write (fd, reply, strlen(reply)) > 0) {
+                if (!test_close_idle)
+                    (void) testReadRequest (fd);
+            }
+            close (fd);
+        }
+
+        return (NULL);
+}
+
+/* send one GET on a new or pooled connection and return whether the whole reply arrived.
+ */
+static bool testGET (int port)
+{
+        WiFiClient client;
+        if (!client.connect ("127.0.0.1", port))
+            return (false);
+        client.print ("GET /test HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+
+        // status line and header
+        char line[100];
+        bool ok = false;
+        for (;;) {
+            int n = 0, c;
+            while ((c = client.read()) >= 0 && c != '\n')
+                if (c != '\r' && n < (int)sizeof(line)-1)
+                    line[n++] = c;
+            line[n] = '\0';
+            if (c < 0)
+                return (false);
+            if (strncmp (line, "HTTP/1.1 200", 12) == 0)
+                ok = true;
+            if (n == 0)
+                break;
+        }
+        client.frameBody (5, false, 30);
+
+        // body
+        char body[10];
+        int n = 0, c;
+        while ((c = client.read()) >= 0 && n < (int)sizeof(body)-1)
+            body[n++] = c;
+        body[n] = '\0';
+        client.stop();
+
+        return (ok && strcmp (body, "hello") == 0);
+}
+
+int main (int ac, char *av[])
+{
+        (void) ac; (void) av;
+
+        // start server on any free port
+        struct sockaddr_in sa;
+        socklen_t sa_len = sizeof(sa);
+        memset (&sa, 0, sizeof(sa));
+        sa.sin_family = AF_INET;
+        sa.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+        test_listen_fd = ::socket (AF_INET, SOCK_STREAM, 0);
+        if (test_listen_fd < 0 || bind (test_listen_fd, (struct sockaddr *)&sa, sizeof(sa)) < 0
+                        || listen (test_listen_fd, 5) < 0
+                        || getsockname (test_listen_fd, (struct sockaddr *)&sa, &sa_len) < 0) {
+            printf ("test server: %s\n", strerror(errno));
+            return (1);
+        }
+        int port = ntohs (sa.sin_port);
+        pthread_t tid;
+        pthread_create (&tid, NULL, testServer, NULL);
+
+        int n_bad = 0;
+        for (int i = 0; i < 2; i++) {
+            test_close_idle = i == 0;
+            WiFiPoolStats s0, s1;
+            WiFiClient::getPoolStats (s0);
+            bool ok1 = testGET (port);
+            if (test_close_idle)
+                usleep (100000);                // let the close arrive before the next connect()
+            bool ok2 = testGET (port);
+            WiFiClient::getPoolStats (s1);
+            bool ok = ok1 && ok2 && s1.n_new - s0.n_new == 2
+                        && s1.n_resent - s0.n_resent == (test_close_idle ? 0U : 1U);
+            printf (">> server closes %-20s: %s, %lu new %lu reused %lu resent\n",
+                        test_close_idle ? "idle connection" : "as request arrives", ok ? "ok" : "FAILED",
+                        s1.n_new - s0.n_new, s1.n_reused - s0.n_reused, s1.n_resent - s0.n_resent);
+            if (!ok)
+                n_bad++;
+        }
+
+        return (n_bad);
+}
+
+#endif // _UNIT_TEST
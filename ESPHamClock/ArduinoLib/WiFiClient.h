@@ -23,6 +23,7 @@
 #include <netinet/tcp.h>
 #include <netdb.h>
 #include <arpa/inet.h>
+#include <string>
 
 /* version of Arduino WiFiClient that runs on rasp pi
  */
@@ -30,6 +31,19 @@
 #include "Arduino.h"
 #include "IPAddress.h"
 
+/* non-standard connection pool and DNS cache stats, see WiFiClient::getPoolStats()
+ */
+typedef struct {
+    unsigned long n_new;                        // connections opened
+    unsigned long n_reused;                     // connections taken from the pool instead
+    unsigned long n_pooled;                     // connections returned to the pool
+    unsigned long n_resent;                     // requests sent again after a reused connection closed
+    double new_ms;                              // total ms spent opening new connections, including DNS
+    unsigned long dns_hits;                     // host lookups found in cache
+    unsigned long dns_misses;                   // host lookups requiring getaddrinfo()
+    int n_idle;                                 // connections now idle in the pool
+} WiFiPoolStats;
+
 class WiFiClient {
 
     public:
@@ -61,6 +75,14 @@ class WiFiClient {
 	void flush(void){};
 	IPAddress remoteIP(void);
 
+        // non-standard
+        void captureOutput (std::string *sp);
+        int fd(void);
+        void frameBody (long content_length, bool chunked, int keepalive_s);
+        const uint8_t *readSpan (int &n);
+        void skip (int n);
+        static void getPoolStats (WiFiPoolStats &s);
+
     private:
 
         const int READ_PENDING_MS = 10000;      // max read wait time, ms
@@ -68,10 +90,27 @@ class WiFiClient {
   	uint8_t peek[4096*10];                  // read-ahead buffer
   	int n_peek;                             // n useful values in peek[]
         int next_peek;                          // next peek[] index to use
+        std::string *capture;                   // if set, append all output here instead of sending
+        char pool_key[80];                      // host:port if eligible for the pool, else empty
+        long body_left;                         // bytes left in body or current chunk, -1 if read to EOF
+        bool chunked;                           // body uses chunked transfer encoding
+        int n_chunks;                           // chunks started so far
+        bool body_done;                         // framed body has been fully consumed
+        int keepalive_s;                        // secs peer keeps us idle, 0 if closing, -1 if unstated
+        bool reused;                            // socket came from the pool and no reply has started yet
+        std::string resend;                     // all written since reuse, in case peer closed meanwhile
 
+        void init (int fd);
         int connect_to (int sockfd, struct sockaddr *serv_addr, int addrlen, int to_ms);
+        int openNew (const char *host, int port);
+        bool resendFresh (void);
         int tout (int to_ms, int fd);
         bool pending(int ms);
+        void closeSocket (void);
+        int rawAvailable (int pending_ms);
+        bool rawLine (char *line, int line_len, int pending_ms);
+        bool nextChunk (int pending_ms);
+        void consumed (int n);
         void logBuffer (const uint8_t *buf, int nbuf);
 
 };
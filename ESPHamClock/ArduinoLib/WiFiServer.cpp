@@ -162,3 +162,9 @@ WiFiClient WiFiServer::next()
 	WiFiClient result(cli_fd);
         return (result);
 }
+
+// non-standard: return listening socket file descriptor, -1 if not running
+int WiFiServer::fd()
+{
+        return (socket);
+}
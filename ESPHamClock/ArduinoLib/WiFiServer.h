@@ -14,6 +14,7 @@ class WiFiServer {
 
         // non-standard
         WiFiClient next();
+        int fd();
 
     private:
 
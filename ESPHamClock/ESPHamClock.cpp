@@ -271,6 +271,9 @@ void setup()
     }
     Serial.println("RA8875 found");
 
+    // wake the main loop as soon as a key or mouse button arrives
+    tft.setInputNotify (wakeMainLoop);
+
     // Adafruit assumed ESP8266 would run at 80 MHz, but we run it at 160
     extern uint32_t spi_speed;
     spi_speed *= 2;
@@ -695,6 +698,9 @@ void loop()
         // check for touch events
         checkTouch();
     }
+
+    // sleep until something has work to do
+    waitMainLoop();
 }
 
 
@@ -855,6 +861,9 @@ static void checkTouch()
 
     drainTouch();
 
+    // whatever this does will probably show on the map
+    hurryMapSweep();
+
     // check all touch locations, ones that can be over map checked first and beware showing PANE_0
     LatLong ll;
     if (inBox (s, view_btn_b)) {
@@ -1564,15 +1573,6 @@ const SCoord raw2appSCoord (const SCoord &s_raw)
     return (s_app);
 }
 
-/* return whether coordinate s is over the maidenhead key around the edges.
- * N.B. assumes key is only shown in mercator projection.
- */
-static bool overMaidKey (const SCoord &s)
-{
-    return (map_proj == MAPP_MERCATOR && mapgrid_choice == MAPGRID_MAID       
-                        && (inBox(s,maidlbltop_b) || inBox(s,maidlblright_b)) );
-}
-
 /* return whether s is over the map globe, depending on the current projection.
  */
 static bool overGlobe (const SCoord &s)
@@ -1624,11 +1624,41 @@ bool overMapScale (const SCoord &s)
     return (mapScaleIsUp() && inBox(s,mapscale_b));
 }
 
+/* fill b[] with each box now drawn on top of the map, return count.
+ * N.B. main thread only; the map render workers use a copy taken when their sweep starts.
+ */
+int getMapOverlays (SBox b[MAX_MAP_OVERLAYS])
+{
+    int n = 0;
+    if (rss_on)
+        b[n++] = rss_bnr_b;
+    b[n++] = view_btn_b;
+    if (map_proj == MAPP_MERCATOR && mapgrid_choice == MAPGRID_MAID) {   // key only shown in mercator
+        b[n++] = maidlbltop_b;
+        b[n++] = maidlblright_b;
+    }
+    if (mapScaleIsUp())
+        b[n++] = mapscale_b;
+    return (n);
+}
+
+/* return whether coordinate s is under something drawn on top of the map
+ */
+bool overMapOverlay (const SCoord &s)
+{
+    SBox b[MAX_MAP_OVERLAYS];
+    int n = getMapOverlays (b);
+    for (int i = 0; i < n; i++)
+        if (inBox (s, b[i]))
+            return (true);
+    return (false);
+}
+
 /* return whether coordinate s is over a usable map location
  */
 bool overMap (const SCoord &s)
 {
-    return (overGlobe(s) && !overRSS(s) && !inBox(s,view_btn_b) && !overMaidKey(s) && !overMapScale(s));
+    return (overGlobe(s) && !overMapOverlay(s));
 }
 
 /* return whether box b is over a usable map location
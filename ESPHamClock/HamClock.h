@@ -21,6 +21,8 @@
 #include <math.h>
 #include <signal.h>
 #include <dirent.h>
+#include <poll.h>
+#include <utime.h>
 #include <sys/file.h>
 
 
@@ -161,62 +163,45 @@ typedef struct {
 #define NV_COREMAPSTYLE_LEN     10
 
 
-/* allows reading from array, WiFiClient or FILE
+/* allows reading from array, WiFiClient or FILE, see genreader.cpp.
+ * bytes are served from whole spans of the source: the array itself, the file mapped into memory or the
+ * client read-ahead buffer, so getChar() is just a pointer bump and getLine() returns lines in place.
  */
-extern bool getTCPChar (WiFiClient &client, char *cp);
 class GenReader 
 {
     public:
         
         // instantiate to read from a WiFiClient client, with optional content_length
         // N.B. caller is expected to stop client
-        GenReader (WiFiClient &client, long content_length = 0) {
-            my_type = GR_CLIENT;
-            my_client = &client;
-            my_clen = content_length;   // ignored if 0
-        }
+        GenReader (WiFiClient &client, long content_length = 0);
 
-        // instantiate to read from a FILE *p
-        // N.B. caller is expected to fclose
-        GenReader (FILE *fp) {
-            my_type = GR_FILE;
-            my_fp = fp;
-        }
+        // instantiate to read from a FILE *p starting at its current position
+        // N.B. caller is expected to fclose, but only after this GenReader is gone
+        GenReader (FILE *fp);
 
         // instantiate to read from a memory array
-        GenReader (const char *a, int n_a)
-        {
-            my_type = GR_ARRAY;
-            my_array = a;
-            my_array_end = a + n_a;
-        }
+        GenReader (const char *a, int n_a);
+
+        // return any file or client to where we actually stopped reading
+        ~GenReader();
 
         // return next byte from the source
         bool getChar (char *bp) {
-            switch (my_type) {
-            case GR_ARRAY:
-                if (my_array < my_array_end) {
-                    *bp = *my_array++;
-                    return (true);
-                }
-                return(false);
-                break;
-            case GR_FILE: {
-                int i = fgetc(my_fp);
-                if (i == EOF || feof(my_fp) || ferror(my_fp))
-                    return (false);
-                *bp = (char)i;
-                return (true);
-                }
-                break;
-            case GR_CLIENT:
-                return ((!my_clen || my_clen-- > 0) && getTCPChar (*my_client, bp));
-                break;
-            default:
+            if (my_next == my_end && !refill())
                 return (false);
-            }
+            *bp = *my_next++;
+            return (true);
         }
 
+        // return next line without \r\n, and whether there was one
+        bool getLine (const char *&line, int &len);
+
+        // return whatever remains in the current span, and whether there was any
+        bool getSpan (const char *&span, int &len);
+
+        // return the entire remainder at once if it is all in memory, else false
+        bool getAll (const char *&all, long &len);
+
         // type tests
         bool isFile(void) { return (my_type == GR_FILE); }
         bool isClient(void) { return (my_type == GR_CLIENT); }
@@ -233,9 +218,28 @@ class GenReader
         GRType my_type;
         FILE *my_fp;
         WiFiClient *my_client;  // pointer to avoid having to init the reference everywhere with a dummy
-        long my_clen;
-        const char *my_array;
-        const char *my_array_end;
+        long my_clen;           // client bytes not yet spanned, if content length was given
+        bool my_has_clen;       // whether my_clen applies
+
+        const char *my_span;    // current span
+        const char *my_next;    // next unread byte in span
+        const char *my_end;     // one past last byte in span
+
+        char *my_map;           // file mapped into memory, if possible
+        size_t my_map_len;      // bytes mapped
+        char *my_buf;           // else file read buffer
+        long my_buf_os;         // file offset of my_buf[0]
+
+        char *my_line;          // getLine() copy of a line spanning refills
+        int my_line_mem;        // bytes malloced for my_line
+
+        void init (void);
+        bool refill (void);
+        void release (void);
+
+        // no copies, we own memory
+        GenReader (const GenReader &) = delete;
+        GenReader &operator= (const GenReader &) = delete;
 };
 
 
@@ -1114,6 +1118,9 @@ extern void wdDelay(int ms);
 extern bool timesUp (uint32_t *prev, uint32_t dt);
 extern const SCoord raw2appSCoord (const SCoord &s_raw);
 extern bool overMap (const SCoord &s);
+extern bool overMapOverlay (const SCoord &s);
+#define MAX_MAP_OVERLAYS 5                      // max boxes drawn on top of the map
+extern int getMapOverlays (SBox b[MAX_MAP_OVERLAYS]);
 extern bool overMap (const SBox &b);
 extern bool overRSS (const SCoord &s);
 extern bool overRSS (const SBox &b);
@@ -1228,10 +1235,11 @@ extern void drawADIFSpotsOnMap (void);
 extern void loadADIFFile (GenReader &gr, int &n_good, int &n_bad);
 extern void freshenADIFFile (void);
 extern void drawADIFPane (const SBox &box, const char *filename);
-extern bool getClosestADIFSpot (LatLong &ll, DXSpot *sp, LatLong *llp);
+extern bool getClosestADIFSpot (LatLong &ll, DXSpot *sp, LatLong *llp, int *n_near);
 extern bool checkADIFFilename (const char *fn, Message &ynot);
 extern bool getADIFPaneSpot (const SCoord &ms, DXSpot *dxs, LatLong *ll);
 extern bool onADIFList (const DXSpot &spot, bool chk_dxcc, bool chk_grid, bool chk_pref, bool chk_band);
+extern uint32_t getADIFGeneration (void);
 
 
 
@@ -1244,7 +1252,9 @@ extern bool onADIFList (const DXSpot &spot, bool chk_dxcc, bool chk_grid, bool c
  *
  */
 
-extern int readADIFFile (GenReader &gr, DXSpot *&spots, bool use_wl, int &n_bad);
+extern int readADIFFile (GenReader &gr, DXSpot *&spots, bool use_wl, int &n_bad, long *eor_os = NULL);
+extern int parseADIFFile (GenReader &gr, DXSpot *&spots, int &n_bad, long *eor_os);
+extern int qualifyADIFSpots (DXSpot *spots, int n_spots, bool use_wl);
 
 
 
@@ -1335,6 +1345,78 @@ extern const char *findHamMode (float kHz);
 
 
 
+/*********************************************************************************************
+ *
+ * bgfetch.cpp
+ *
+ */
+
+#define USER_AGENT_LEN  400                     // getUserAgent() buffer size
+
+/* one background retrieval job.
+ * fetch() runs in a worker thread and must touch only what arg refers to and ua, never the display or
+ * main state; done() runs later in the main thread to install the results.
+ */
+typedef struct _BGFetch {
+    const char *name;                           // for logging
+    bool (*fetch)(struct _BGFetch &bgf);        // worker: retrieve and parse, return whether io ok
+    void (*done)(struct _BGFetch &bgf);         // main thread: install results
+    void *arg;                                  // private context for fetch and done
+    bool pending;                               // set while queued or running, main thread only
+    bool ok;                                    // fetch() return value, valid in done()
+    int ms;                                     // fetch() duration, valid in done()
+    char ua[USER_AGENT_LEN];                    // User-Agent for fetch() to pass to httpHCGET(), set when queued
+    struct _BGFetch *next;                      // engine list link
+} BGFetch;
+
+extern bool startBGFetch (BGFetch &bgf);
+extern int checkBGFetch (void);
+extern void waitBGFetch (BGFetch &bgf);
+
+
+
+
+
+/*********************************************************************************************
+ *
+ * scheduler.cpp
+ *
+ */
+
+/* one main loop deadline, typically static in the subsystem that arms it.
+ * all fields except name are managed by the scheduler.
+ */
+typedef struct _SchedTimer {
+    const char *name;                           // for get_timers.txt
+    uint32_t due_ms;                            // millis() when due, valid while armed
+    bool armed;                                 // whether waiting to come due
+    bool fired;                                 // came due since last schedTimerFired()
+    bool registered;                            // whether on the list of all timers
+    int heap_i;                                 // index in the scheduler's heap while armed
+    uint32_t n_fired;                           // n times come due
+    uint32_t late_ms, max_late_ms;              // lateness of the latest and worst firings
+    struct _SchedTimer *next;                   // list of all timers
+} SchedTimer;
+
+typedef struct {
+    uint32_t ms;                                // millis() when counting began
+    uint32_t n_loops;                           // n waits
+    uint32_t n_timer;                           // n ended by a timer
+    uint32_t n_wake;                            // n ended by wakeMainLoop()
+    uint32_t n_poll;                            // n ended by the SCHED_POLL_MS cap
+    uint32_t sleep_ms;                          // total time spent waiting
+} SchedStats;
+
+extern void armSchedTimer (SchedTimer &st, uint32_t ms);
+extern void armSchedTimerSecond (SchedTimer &st);
+extern bool schedTimerFired (SchedTimer &st);
+extern void wakeMainLoop (void);
+extern void waitMainLoop (void);
+extern const SchedTimer *getSchedTimers (SchedStats &ss);
+
+
+
+
 
 
 
@@ -1423,6 +1505,7 @@ extern void doNCDXFBoxTouch (TouchType tt, const SCoord &s);
 #define CACHE_NONE    1                         // remove all files older than 1 second
 
 extern FILE *openCachedFile (const char *fn, const char *url, int max_age, int min_size);
+extern FILE *openCachedFile (const char *fn, const char *url, int max_age, int min_size, const char *user_agent);
 extern bool cleanCache (const char *contains, int max_age);
 
 
@@ -1612,11 +1695,11 @@ extern bool updateDXCluster (const SBox &box, bool fresh);
 extern void checkDXCluster(void);
 extern void closeDXCluster(void);
 extern bool checkDXClusterTouch (const SCoord &s, const SBox &box);
-extern bool getDXClusterSpots (DXSpot **spp, uint8_t *nspotsp);
+extern bool getDXClusterSpots (DXSpot **spp, int *nspotsp);
 extern void drawDXClusterSpotsOnMap (void);
 extern bool isDXClusterConnected(void);
 extern void sendDXClusterDELLGrid(void);
-extern bool getClosestDXCluster (LatLong &ll, DXSpot *sp, LatLong *llp);
+extern bool getClosestDXCluster (LatLong &ll, DXSpot *sp, LatLong *llp, int *n_near);
 extern bool getDXCPaneSpot (const SCoord &ms, DXSpot *dxs, LatLong *ll);
 extern bool connectDXCluster (void);
 extern const DXSpot *findDXCCall (const char *call);
@@ -1764,6 +1847,7 @@ extern SCircle moon_c;
 extern uint8_t flash_crc_ok;
 
 extern void drawMoreEarth (void);
+extern void hurryMapSweep (void);
 extern void eraseDEMarker (void);
 extern void eraseDEAPMarker (void);
 extern void drawDEMarker (bool force);
@@ -1774,6 +1858,12 @@ extern void drawDEInfo (void);
 extern void drawDECalTime (bool center);
 extern void drawDXTime (void);
 extern void initEarthMap (void);
+extern void benchmarkEarthMap (float build_ms[MAPP_N], float draw_ms[MAPP_N]);
+extern void getMapLLTableStats (size_t &bytes, float &build_ms, int &n_builds);
+extern uint32_t getMapProjGen (void);
+extern void getMapPixelStats (uint32_t &per_min, bool &incremental);
+#define MAX_MAP_TILES   64                      // max render worker tiles in one sweep
+extern int getMapTileStats (int &n_workers, float ms[MAX_MAP_TILES]);
 extern void antipode (LatLong &to, const LatLong &from);
 extern void drawMapCoord (const SCoord &s);
 extern void drawMapCoord (uint16_t x, uint16_t y);
@@ -1829,6 +1919,14 @@ typedef struct _sat_now {
 #define SAT_MIN_EL      -0.4F           // min elevation, rough approx for refraction
 #define TLE_LINEL       70              // TLE line length, including EOS
 
+typedef struct {
+    char name[NV_SATNAME_LEN];          // name, spaces are underscores
+    time_t rise, set;                   // UTC, clipped to the prediction span
+    float raz, saz;                     // rise and set az, degs; SAT_NOAZ if clipped
+    float max_el, max_az;               // highest point, degs
+} SatPass;
+#define SATPASS_HOURS   48              // findAllSatPasses() prediction span, hours
+
 extern void updateSatPath(void);
 extern void drawSatPathAndFoot(void);
 extern void updateSatPass(void);
@@ -1845,10 +1943,12 @@ extern bool setSatFromTLE (const char *name, const char *t1, const char *t2);
 extern bool initSat(void);
 extern bool getSatNow (SatNow &satnow);
 extern bool getSatCir (Observer *snow_obs, time_t t0, SatNow &sat_at_t0);
+extern bool predictSatBatch (time_t t0, const long *secs, SatBatch &b);
 extern bool isNewPass(void);
 extern bool isSatMoon(void);
 extern const char **getAllSatNames(void);
 extern int nextSatRSEvents (time_t **rises, float **raz, time_t **sets, float **saz);
+extern int findAllSatPasses (const SatPass **passes, time_t *t0, int *n_sats);
 extern bool isSatDefined(void);
 extern void drawDXSatMenu(const SCoord &s);
 extern bool dx_info_for_sat;
@@ -1977,14 +2077,20 @@ struct kd_node_t {
 };
 
 typedef struct kd_node_t KD3Node;
+typedef bool (*KD3Accept)(const KD3Node *np, void *arg);        // nearestKD3NodeIf() node filter
 
 extern KD3Node* mkKD3NodeTree (KD3Node *t, int len, int idx);
 extern void freeKD3NodeTree (KD3Node *t, int n_t);
 extern void nearestKD3Node (const KD3Node *root, const KD3Node *nd, int level, const KD3Node **best,
     float *best_dist, int *n_visited);
+extern void nearestKD3NodeIf (const KD3Node *root, const KD3Node *nd, int level, KD3Accept accept, void *arg,
+    const KD3Node **best, float *best_dist, int *n_visited);
+extern int findKD3NodesWithin (const KD3Node *root, const KD3Node *nd, int level, float max_d,
+    const KD3Node **found, int max_found);
 extern void ll2KD3Node (const LatLong &ll, KD3Node *kp);
 extern void KD3Node2ll (const KD3Node &n, LatLong *llp);
 extern float nearestKD3Dist2Miles(float d);
+extern float miles2KD3Dist (float miles);
 
 
 
@@ -2016,6 +2122,17 @@ extern int n_roweb, n_rwweb;
 extern void openLiveWebURL (const char *url);
 extern bool isLiveWebTouch (void);
 
+#define N_LIVE_CODECS   2                               // n live update wire formats
+typedef struct {
+    const char *name;                                   // codec name
+    int n_frames;                                       // n frame changes encoded
+    float bytes;                                        // mean bytes per frame change
+    float usecs;                                        // mean encode time per frame change
+    bool lossless;                                      // whether each decoded frame matched
+} LiveCodecBench;
+extern bool captureLiveFrames (int n, Message &ynot);
+extern bool benchmarkLiveCodecs (LiveCodecBench lcb[N_LIVE_CODECS], Message &ynot);
+
 
 
 
@@ -2393,7 +2510,7 @@ extern bool updateOnTheAir (const SBox &box, bool fresh);
 extern bool checkOnTheAirTouch (const SCoord &s, const SBox &box);
 extern bool getOnTheAirSpots (DXSpot **spp, uint8_t *nspotsp);
 extern void drawOnTheAirSpotsOnMap (void);
-extern bool getClosestOnTheAirSpot (LatLong &ll, DXSpot *sp, LatLong *llp);
+extern bool getClosestOnTheAirSpot (LatLong &ll, DXSpot *sp, LatLong *llp, int *n_near);
 extern bool getOnTheAirPaneSpot (const SCoord &ms, DXSpot *dxs, LatLong *ll);
 extern bool isONTARotating (void);
 
@@ -2544,6 +2661,8 @@ extern void restoreNormPANE0(void);
 extern bool ll2Prefix (const LatLong &ll, char prefix[MAX_PREF_LEN]);
 extern bool call2LL (const char *call, LatLong &ll);
 extern bool call2DXCC (const char *call, int &dxcc);
+extern bool readyCty (void);
+extern void releaseCty (void);
 extern void findCallPrefix (const char *call, char prefix[MAX_PREF_LEN]);
 extern void splitCallSign (const char *call, char home_call[NV_CALLSIGN_LEN], char dx_call[NV_CALLSIGN_LEN]);
 
@@ -2603,7 +2722,7 @@ extern int getRawBandPathWidth (float kHz);
 extern int getRawBandSpotRadius (float kHz);
 extern void drawPSKPaths (void);
 extern void getPSKSpots (const DXSpot* &rp, int &n_rep);
-extern bool getClosestPSK (LatLong &ll, DXSpot *sp, LatLong *mark_ll);
+extern bool getClosestPSK (LatLong &ll, DXSpot *sp, LatLong *mark_ll, int *n_near);
 extern bool getMaxDistPSK (const SCoord &ms, DXSpot *sp, LatLong *mark_ll);
 
 
@@ -3289,10 +3408,25 @@ extern void solveSphere (float A, float b, float cc, float sc, float *cap, float
 
 typedef bool (*SpotFilter)(const DXSpot *sp);
 
-extern bool getClosestSpot (DXSpot *list, int n_list, SpotFilter sfp, LabelOnMapEnd which_ends,
-    LatLong &ll, DXSpot *sp, LatLong *llp);
+// kd3tree over the ends of a spot list, rebuilt on demand after its owner calls spotIndexChanged()
+typedef struct {
+    const DXSpot *list;                         // list last indexed
+    int n_list;                                 // n spots in list
+    LabelOnMapEnd ends;                         // which end(s) are indexed
+    bool changed;                               // set by owner whenever list contents change
+    KD3Node *nodes;                             // malloced tree, one or two nodes per spot
+    int n_malloc;                               // n nodes malloced
+    KD3Node *root;                              // tree root somewhere within nodes
+} SpotIndex;
+
+extern void spotIndexChanged (SpotIndex &si);
+extern bool getClosestSpot (SpotIndex &si, DXSpot *list, int n_list, SpotFilter sfp, LabelOnMapEnd which_ends,
+    LatLong &ll, DXSpot *sp, LatLong *llp, int *n_near);
+extern int getSpotsWithin (SpotIndex &si, DXSpot *list, int n_list, SpotFilter sfp, LabelOnMapEnd which_ends,
+    const LatLong &ll, float miles, int *indices, int max_indices);
 extern void drawSpotLabelOnMap (DXSpot &spot, LabelOnMapEnd txrx, LabelOnMapDot dot);
 extern void drawSpotPathOnMap (const DXSpot &spot);
+extern void getSpotPathStats (int &n_paths, int &n_hits, int &n_misses);
 extern void ditherLL (LatLong &ll);
 extern void drawSpotDot (int16_t raw_x, int16_t raw_y, uint16_t radius, LabelOnMapEnd txrx, uint16_t color);
 extern void drawVisibleSpots (WatchListId wl_id, const DXSpot *spots, const ScrollState &ss, const SBox &box,
@@ -3543,9 +3677,19 @@ typedef struct {
 } NTPServer;
 #define NTP_TOO_LONG 5000U                      // too long response time, millis()
 
+/* one response header field wanted from httpSkipHeader().
+ * a line matches when it begins with name, compared without regard to case as HTTP requires; a name
+ * appearing later within a line, such as in another field's value, does not match.
+ */
+typedef struct {
+    const char *name;                           // header field name including ": ", any case
+    char value[200];                            // value if found, else empty
+} HTTPHeaderField;
+
 extern void initSys (void);
 extern void initWiFiRetry(void);
 extern void scheduleNewPlot (PlotChoice ch);
+extern void scheduleRedrawPlot (PlotChoice pc);
 extern void scheduleNewCoreMap (CoreMaps cm);
 extern void updateWiFi(void);
 extern bool checkBCTouch (const SCoord &s, const SBox &b);
@@ -3553,11 +3697,17 @@ extern void setPlotVisible (PlotChoice pc);
 extern bool setPlotChoice (PlotPane new_pp, PlotChoice new_ch);
 extern time_t getNTPUTC (NTPServer *);
 extern void scheduleRSSNow(void);
+extern bool getTCPChar (WiFiClient &client, char *cp);
 extern bool getTCPLine (WiFiClient &client, char line[], uint16_t line_len, uint16_t *ll);
+extern void getUserAgent (char *ua, size_t ua_len);
 extern void sendUserAgent (WiFiClient &client);
 extern void httpHCGET (WiFiClient &client, const char *server, const char *hc_page);
+extern void httpHCGET (WiFiClient &client, const char *server, const char *hc_page, const char *extra_hdrs);
+extern void httpHCGET (WiFiClient &client, const char *server, const char *hc_page, const char *extra_hdrs,
+    const char *user_agent);
 extern bool httpSkipHeader (WiFiClient &client);
 extern bool httpSkipHeader (WiFiClient &client, const char *header, char *value, int value_len);
+extern bool httpSkipHeader (WiFiClient &client, int &status, HTTPHeaderField fields[], int n_fields);
 extern int getNTPServers (const NTPServer **listp);
 extern bool setRSSTitle (const char *title, int &n_titles, int &max_titles);
 extern time_t nextPaneRotation (PlotPane pp);
@@ -425,6 +425,350 @@ Satellite::predict(const DateTime &dt)
     V[2] = VEL[2] ;
 }
 
+//----------------------------------------------------------------------
+//  batch prediction
+//
+// predict() and topo() are spread across SatBatch in structure-of-arrays form and evaluated SB_W
+// lanes at a time using the compiler's generic vector extensions, which map to SSE on x86 and NEON
+// on ARM. the trig functions are Cephes polynomials so they vectorize too, thus results agree with
+// the scalar code to within float rounding rather than exactly.
+//----------------------------------------------------------------------
+
+#define SB_W            4                               // lanes per vector
+#define SB_NARRAYS      24                              // n float arrays in SatBatch
+
+typedef float SBfloat __attribute__ ((vector_size (SB_W*sizeof(float)))) ;
+typedef int32_t SBint __attribute__ ((vector_size (SB_W*sizeof(int32_t)))) ;
+
+SatBatch::SatBatch(int n_lanes)
+{
+    n = n_lanes ;
+    one_sat = false ;
+    mem = new float[SB_NARRAYS * n] ;
+
+    float *m = mem ;
+    for (int j = 0; j < 3; j++) {
+        S[j] = m; m += n ;
+        V[j] = m; m += n ;
+    }
+    alt = m; m += n ;
+    az = m; m += n ;
+    range = m; m += n ;
+    rate = m; m += n ;
+    T = m; m += n ;
+    MA = m; m += n ;
+    MM = m; m += n ;
+    EC = m; m += n ;
+    DC = m; m += n ;
+    A_0 = m; m += n ;
+    B_0 = m; m += n ;
+    N0 = m; m += n ;
+    WP = m; m += n ;
+    WD = m; m += n ;
+    RA = m; m += n ;
+    QD = m; m += n ;
+    IN = m; m += n ;
+    GHAE = m; m += n ;
+}
+
+SatBatch::~SatBatch()
+{
+    delete [] mem ;
+}
+
+// load this satellite's elements into lane i of b at time dt
+void
+Satellite::lane(SatBatch &b, int i, const DateTime &dt)
+{
+    float TEG = DE - fnday(YG, 1, 0) + TE ;
+
+    b.T[i] = (float) (dt.DN - DE) + (dt.TN-TE) ;
+    b.MA[i] = MA ;
+    b.MM[i] = MM ;
+    b.EC[i] = EC ;
+    b.DC[i] = DC ;
+    b.A_0[i] = A_0 ;
+    b.B_0[i] = B_0 ;
+    b.N0[i] = N0 ;
+    b.WP[i] = WP ;
+    b.WD[i] = WD ;
+    b.RA[i] = RA ;
+    b.QD[i] = QD ;
+    b.IN[i] = IN ;
+    b.GHAE[i] = RADIANS(G0) + TEG * WE ;
+}
+
+// predict this satellite at each of b.n times t0 + secs[i] seconds
+void
+Satellite::predict(const DateTime &t0, const long *secs, SatBatch &b)
+{
+    if (b.n < 1)
+        return ;
+
+    // elements are the same for all so they need only be in lane 0
+    DateTime dt(t0) ;
+    dt += secs[0] ;
+    lane (b, 0, dt) ;
+    for (int i = 1; i < b.n; i++) {
+        dt = t0 ;
+        dt += secs[i] ;
+        b.T[i] = (float) (dt.DN - DE) + (dt.TN-TE) ;
+    }
+
+    b.one_sat = true ;
+    b.propagate() ;
+}
+
+// predict each of the b.n satellites in sats[] at time dt
+void
+Satellite::predict(Satellite **sats, const DateTime &dt, SatBatch &b)
+{
+    for (int i = 0; i < b.n; i++)
+        sats[i]->lane (b, i, dt) ;
+
+    b.one_sat = false ;
+    b.propagate() ;
+}
+
+// return lanes i .. i+SB_W-1 of p, beyond n are 0
+static inline SBfloat
+SBload(const float *p, int i, int n)
+{
+    SBfloat v = {0} ;
+    if (n-i >= SB_W)
+        memcpy (&v, p+i, sizeof(v)) ;
+    else
+        for (int j = 0; j < n-i; j++)
+            v[j] = p[i+j] ;
+    return v ;
+}
+
+// return lanes i .. i+SB_W-1 of element array p, or all lane 0 if one_sat
+static inline SBfloat
+SBelem(const float *p, int i, int n, bool one_sat)
+{
+    if (one_sat) {
+        SBfloat v = {0} ;
+        return v + p[0] ;
+    }
+    return SBload (p, i, n) ;
+}
+
+// store v to lanes i .. i+SB_W-1 of p, but none beyond n
+static inline void
+SBstore(float *p, int i, int n, SBfloat v)
+{
+    if (n-i >= SB_W)
+        memcpy (p+i, &v, sizeof(v)) ;
+    else
+        for (int j = 0; j < n-i; j++)
+            p[i+j] = v[j] ;
+}
+
+static inline SBfloat
+SBabs(SBfloat x)
+{
+    return x < 0 ? -x : x ;
+}
+
+// sin and cos of each lane of x.
+// first reduce to +-PI with PI2 in two parts, then Cephes sinf/cosf by octant.
+static inline void
+SBsincos(SBfloat x, SBfloat &s, SBfloat &c)
+{
+    const float PI2A = 6.28125f ;                       // few bits so k*PI2A is exact
+    const float PI2B = 1.9353071795864769e-3f ;         // 2PI - PI2A
+    const float DP1 = 0.78515625f ;                     // PI/4 in three parts
+    const float DP2 = 2.4187564849853515625e-4f ;
+    const float DP3 = 3.77489497744594108e-8f ;
+
+    SBint ik = __builtin_convertvector (x * (1.f/(2.f*M_PIF)) + (x < 0 ? -0.5f : 0.5f), SBint) ;
+    SBfloat k = __builtin_convertvector (ik, SBfloat) ;
+    x = (x - k*PI2A) - k*PI2B ;
+
+    SBint neg_s = x < 0 ;
+    x = SBabs(x) ;
+    SBint j = __builtin_convertvector (x * (4.f/M_PIF), SBint) ;
+    j = (j + 1) & ~1 ;
+    SBfloat y = __builtin_convertvector (j, SBfloat) ;
+    x = ((x - y*DP1) - y*DP2) - y*DP3 ;
+
+    SBfloat z = x * x ;
+    SBfloat yc = ((2.443315711809948e-5f*z - 1.388731625493765e-3f)*z + 4.166664568298827e-2f)*z*z
+                        - 0.5f*z + 1.f ;
+    SBfloat ys = ((-1.9515295891e-4f*z + 8.3321608736e-3f)*z - 1.6666654611e-1f)*z*x + x ;
+
+    SBint poly = (j & 2) == 0 ;
+    SBfloat sv = poly ? ys : yc ;
+    SBfloat cv = poly ? yc : ys ;
+    neg_s ^= (j & 4) != 0 ;
+    SBint neg_c = ((j - 2) & 4) == 0 ;
+    s = neg_s ? -sv : sv ;
+    c = neg_c ? -cv : cv ;
+}
+
+// find S and V in each lane from its elements and T, as Satellite::predict()
+void
+SatBatch::propagate()
+{
+    for (int i = 0; i < n; i += SB_W) {
+
+        SBfloat T_ = SBload (T, i, n) ;
+        SBfloat EC_ = SBelem (EC, i, n, one_sat) ;
+
+        SBfloat DT = SBelem (DC, i, n, one_sat) * T_ / 2.F ;
+        SBfloat KD = 1.F + 4.F * DT ;
+        SBfloat KDP = 1.F - 7.F * DT ;
+
+        SBfloat M = SBelem (MA, i, n, one_sat) + SBelem (MM, i, n, one_sat) * T_ * (1.F - 3.F * DT) ;
+        SBfloat DR = __builtin_convertvector (__builtin_convertvector (M / (2.F * M_PIF), SBint), SBfloat) ;
+        M -= DR * 2.F * M_PIF ;
+
+        // Kepler's equation, holding each lane as it converges
+        SBfloat EA = M ;
+        SBfloat C_EA = {0}, S_EA = {0}, DNOM = {0} ;
+        SBint done = {0} ;
+        for (int iter = 0; iter < 20; iter++) {
+            SBfloat C, S ;
+            SBsincos (EA, S, C) ;
+            SBfloat DN = 1.F - EC_ * C ;
+            SBfloat D = (EA-EC_*S-M)/DN ;
+            SBint now = ~done & (SBabs(D) < 1e-5f) ;
+            C_EA = now ? C : C_EA ;
+            S_EA = now ? S : S_EA ;
+            DNOM = now ? DN : DNOM ;
+            EA = done ? EA : EA - D ;
+            done |= now ;
+            bool all_done = true ;
+            for (int j = 0; j < SB_W; j++)
+                all_done = all_done && done[j] ;
+            if (all_done)
+                break ;
+        }
+
+        SBfloat A = SBelem (A_0, i, n, one_sat) * KD ;
+        SBfloat B = SBelem (B_0, i, n, one_sat) * KD ;
+        SBfloat N0_ = SBelem (N0, i, n, one_sat) ;
+
+        SBfloat Sx = A * (C_EA - EC_) ;
+        SBfloat Sy = B * S_EA ;
+        SBfloat Vx = -A * S_EA / DNOM * N0_ ;
+        SBfloat Vy =  B * C_EA / DNOM * N0_ ;
+
+        SBfloat CW, SW, CQ, SQ ;
+        SBsincos (SBelem (WP, i, n, one_sat) + SBelem (WD, i, n, one_sat) * T_ * KDP, SW, CW) ;
+        SBsincos (SBelem (RA, i, n, one_sat) + SBelem (QD, i, n, one_sat) * T_ * KDP, SQ, CQ) ;
+        SBfloat CI_, SI_ ;
+        SBsincos (SBelem (IN, i, n, one_sat), SI_, CI_) ;
+
+        SBfloat CX0 =  CW * CQ - SW * CI_ * SQ ;
+        SBfloat CX1 = -SW * CQ - CW * CI_ * SQ ;
+        SBfloat CY0 =  CW * SQ + SW * CI_ * CQ ;
+        SBfloat CY1 = -SW * SQ + CW * CI_ * CQ ;
+        SBfloat CZ0 = SW * SI_ ;
+        SBfloat CZ1 = CW * SI_ ;
+
+        SBfloat SAT0 = Sx * CX0 + Sy * CX1 ;
+        SBfloat SAT1 = Sx * CY0 + Sy * CY1 ;
+        SBfloat SAT2 = Sx * CZ0 + Sy * CZ1 ;
+        SBfloat VEL0 = Vx * CX0 + Vy * CX1 ;
+        SBfloat VEL1 = Vx * CY0 + Vy * CY1 ;
+        SBfloat VEL2 = Vx * CZ0 + Vy * CZ1 ;
+
+        SBfloat CG, SG ;
+        SBsincos (-(SBelem (GHAE, i, n, one_sat) + WE * T_), SG, CG) ;
+
+        SBstore (S[0], i, n, SAT0 * CG - SAT1 * SG) ;
+        SBstore (S[1], i, n, SAT0 * SG + SAT1 * CG) ;
+        SBstore (S[2], i, n, SAT2) ;
+        SBstore (V[0], i, n, VEL0 * CG - VEL1 * SG) ;
+        SBstore (V[1], i, n, VEL0 * SG + VEL1 * CG) ;
+        SBstore (V[2], i, n, VEL2) ;
+    }
+}
+
+// arc tangent of each lane of y/x in the full circle, Cephes atanf by range
+static inline SBfloat
+SBatan2(SBfloat y, SBfloat x)
+{
+    SBfloat ay = SBabs(y) ;
+    SBfloat ax = SBabs(x) ;
+    SBint swap = ay > ax ;                              // keep ratio <= 1
+    SBfloat num = swap ? ax : ay ;
+    SBfloat den = swap ? ay : ax ;
+    SBfloat t = num / (den == 0 ? 1.F : den) ;
+    SBint big = t > 0.4142135623730950f ;
+    SBfloat r = big ? (t-1.F)/(t+1.F) : t ;
+    SBfloat z = r * r ;
+    SBfloat a = (((8.05374449538e-2f*z - 1.38776856032e-1f)*z + 1.99777106478e-1f)*z
+                        - 3.33329491539e-1f)*z*r + r ;
+    a = big ? a + M_PIF/4 : a ;
+    a = swap ? M_PIF/2 - a : a ;
+    a = x < 0 ? M_PIF - a : a ;
+    return y < 0 ? -a : a ;
+}
+
+// arc sine of each lane of x, Cephes asinf
+static inline SBfloat
+SBasin(SBfloat x)
+{
+    SBfloat a = SBabs(x) ;
+    a = a > 1 ? 1.F : a ;
+    SBint big = a > 0.5f ;
+    SBfloat z = big ? 0.5f*(1.F-a) : a*a ;
+    SBfloat r = a ;
+    for (int j = 0; j < SB_W; j++)
+        if (big[j])
+            r[j] = sqrtf(z[j]) ;
+    SBfloat p = ((((4.2163199048e-2f*z + 2.4181311049e-2f)*z + 4.5470025998e-2f)*z + 7.4953002686e-2f)*z
+                        + 1.6666752422e-1f)*z*r + r ;
+    p = big ? M_PIF/2 - (p + p) : p ;
+    return x < 0 ? -p : p ;
+}
+
+// find alt, az, range and rate in each lane from obs, as Satellite::topo()
+void
+SatBatch::topo(const Observer *obs)
+{
+    for (int i = 0; i < n; i += SB_W) {
+
+        SBfloat S0 = SBload (S[0], i, n) ;
+        SBfloat S1 = SBload (S[1], i, n) ;
+        SBfloat S2 = SBload (S[2], i, n) ;
+        SBfloat R0 = S0 - obs->O[0] ;
+        SBfloat R1 = S1 - obs->O[1] ;
+        SBfloat R2 = S2 - obs->O[2] ;
+        SBfloat r2 = R0*R0+R1*R1+R2*R2 ;
+        SBfloat r ;
+        for (int j = 0; j < SB_W; j++)
+            r[j] = sqrtf(r2[j]) ;
+        r = r > 0 ? r : 1.F ;                           // only unused lanes
+        R0 /= r ;
+        R1 /= r ;
+        R2 /= r ;
+        SBstore (range, i, n, r) ;
+
+        SBfloat V0 = SBload (V[0], i, n) ;
+        SBfloat V1 = SBload (V[1], i, n) ;
+        SBfloat V2 = SBload (V[2], i, n) ;
+        SBstore (rate, i, n, 1000*((V0-obs->V[0])*R0 + (V1-obs->V[1])*R1 + V2*R2)) ;     // m/s
+
+        SBfloat u = R0 * obs->U[0] + R1 * obs->U[1] + R2 * obs->U[2] ;
+        SBfloat e = R0 * obs->E[0] + R1 * obs->E[1] + R2 * obs->E[2] ;
+        SBfloat nn = R0 * obs->N[0] + R1 * obs->N[1] + R2 * obs->N[2] ;
+
+        SBfloat a = SBatan2 (e, nn) * (180.F/M_PIF) ;
+        SBstore (az, i, n, a < 0 ? a + 360.F : a) ;
+
+        // Saemundson refraction, true to apparent, 10C 1000 mbar (29.5 inch Hg)
+        SBfloat al = SBasin (u) * (180.F/M_PIF) ;
+        SBfloat rs, rc ;
+        SBsincos ((al + 10.3F/(al+5.11F)) * (M_PIF/180.F), rs, rc) ;
+        al += (1000.0F/1010.0F)*(283.0F/(273.0F+10.0F))*1.02F*rc/rs/60.0F ;
+        SBstore (alt, i, n, al) ;
+    }
+}
+
 /* find local apparent circumstances
  */
 void
@@ -645,3 +989,111 @@ int main (int ac, char *av[])
     return (0);
 }
 #endif // _TLE_UNITTEST
+
+#if defined (_BATCH_UNITTEST)
+
+// build with g++ -O2 -o P13-batch-test -D_BATCH_UNITTEST -IArduinoLib P13.cpp
+
+#include <sys/time.h>
+
+static double
+usecs()
+{
+    struct timeval tv ;
+    gettimeofday (&tv, NULL) ;
+    return (tv.tv_sec*1e6 + tv.tv_usec) ;
+}
+
+// compare lane i of b with sat already predicted for the same time, update worst differences.
+static void
+compare (Satellite *sat, const Observer *obs, SatBatch &b, int i, float &max_ds, float &max_del)
+{
+    float el, az, range, rate ;
+    sat->topo (obs, el, az, range, rate) ;
+    float ds = fabsf(sat->S[0]-b.S[0][i]) + fabsf(sat->S[1]-b.S[1][i]) + fabsf(sat->S[2]-b.S[2][i]) ;
+    float del = fabsf(el - b.alt[i]) ;
+    if (ds > max_ds)
+        max_ds = ds ;
+    if (del > max_del && el > -1)
+        max_del = del ;
+}
+
+int main (int ac, char *av[])
+{
+    const int N = ac > 1 ? atoi(av[1]) : 100000 ;
+    const char t1[] = "1 25544U 98067A   24149.51140801  .00018442  00000+0  32372-3 0  9998";
+    const char t2[] = "2 25544  51.6397  52.8338 0005655 239.3246 313.5976 15.50566673455497";
+    Observer obs (32.3565, -111.1327, 1) ;
+    DateTime t0 (2024,05,29,0,0,0) ;
+    SatBatch b (N) ;
+    float max_ds, max_del ;
+    double us0, us1 ;
+
+    // one satellite over N times 10 seconds apart
+    Satellite sat (t1, t2) ;
+    long *secs = new long[N] ;
+    for (int i = 0; i < N; i++)
+        secs[i] = 10L*i ;
+
+    us0 = usecs() ;
+    for (int i = 0; i < N; i++) {
+        DateTime t (t0) ;
+        t += secs[i] ;
+        sat.predict (t) ;
+        float el, az, range, rate ;
+        sat.topo (&obs, el, az, range, rate) ;
+    }
+    us1 = usecs() ;
+    printf ("scalar:          %8.0f predictions/sec\n", N/(us1-us0)*1e6) ;
+
+    us0 = usecs() ;
+    sat.predict (t0, secs, b) ;
+    b.topo (&obs) ;
+    us1 = usecs() ;
+    printf ("1 sat, %d times: %8.0f predictions/sec\n", N, N/(us1-us0)*1e6) ;
+
+    max_ds = max_del = 0 ;
+    for (int i = 0; i < N; i++) {
+        DateTime t (t0) ;
+        t += secs[i] ;
+        sat.predict (t) ;
+        compare (&sat, &obs, b, i, max_ds, max_del) ;
+    }
+    printf ("    worst position %g km, elevation when up %g degs\n", max_ds, max_del) ;
+
+    // N satellites in assorted orbits at one time
+    Satellite **sats = new Satellite*[N] ;
+    for (int i = 0; i < N; i++) {
+        char l2[80] ;
+        snprintf (l2, sizeof(l2), "2 25544 %8.4f %8.4f %07d %8.4f %8.4f %11.8f%05d",
+                (i*7) % 180 + 0.1234, (i*13) % 360 + 0.5678, (i*97) % 200000, (i*31) % 360 + 0.25,
+                (i*53) % 360 + 0.75, 1 + (i % 15) + 0.12345678, 45549) ;
+        sats[i] = new Satellite (t1, l2) ;
+    }
+
+    us0 = usecs() ;
+    for (int i = 0; i < N; i++) {
+        sats[i]->predict (t0) ;
+        float el, az, range, rate ;
+        sats[i]->topo (&obs, el, az, range, rate) ;
+    }
+    us1 = usecs() ;
+    printf ("scalar:          %8.0f predictions/sec\n", N/(us1-us0)*1e6) ;
+
+    us0 = usecs() ;
+    Satellite::predict (sats, t0, b) ;
+    b.topo (&obs) ;
+    us1 = usecs() ;
+    printf ("%d sats, 1 time: %8.0f predictions/sec\n", N, N/(us1-us0)*1e6) ;
+
+    max_ds = max_del = 0 ;
+    for (int i = 0; i < N; i++) {
+        sats[i]->predict (t0) ;
+        compare (sats[i], &obs, b, i, max_ds, max_del) ;
+    }
+    printf ("    worst position %g km, elevation when up %g degs\n", max_ds, max_del) ;
+
+    return (0);
+}
+
+#endif // _BATCH_UNITTEST
@@ -94,6 +94,33 @@ public:
 
 //----------------------------------------------------------------------
 
+// structure-of-arrays workspace for the batch forms of Satellite::predict(), one lane per prediction.
+// results agree with the scalar predict() and topo() to within float rounding.
+
+class SatBatch {
+public:
+    int n ;                             // n lanes
+    float *S[3], *V[3] ;                // geocentric coordinates, as Satellite::S and V
+    float *alt, *az, *range, *rate ;    // topocentric, filled by topo()
+
+    // per-lane time and elements, filled by Satellite::predict()
+    float *T ;                          // days since epoch
+    float *MA, *MM, *EC, *DC, *A_0, *B_0, *N0, *WP, *WD, *RA, *QD, *IN, *GHAE ;
+    bool one_sat ;                      // elements are only in lane 0, same for all
+
+    SatBatch(int n) ;
+    ~SatBatch() ;
+    SatBatch(const SatBatch &) = delete ;              // owns mem
+    SatBatch &operator=(const SatBatch &) = delete ;
+    void propagate(void) ;
+    void topo(const Observer *obs) ;
+
+private:
+    float *mem ;                        // storage for all arrays
+} ;
+
+//----------------------------------------------------------------------
+
 class Satellite { 
   	long N ;
 	long YE ;	
@@ -128,6 +155,8 @@ public:
 	~Satellite() ;
         void tle(const char *l1, const char *l2) ;
         void predict(const DateTime &dt) ;
+        void predict(const DateTime &t0, const long *secs, SatBatch &b) ;
+        static void predict(Satellite **sats, const DateTime &dt, SatBatch &b) ;
 	bool eclipsed(Sun *sp);
 	void topo(const Observer *obs, float &alt, float &az, float &range, float &range_rate);
 	void geo(float &lat, float &lng);
@@ -136,6 +165,9 @@ public:
 	float viewingRadius(float alt);
 	DateTime epoch(void);
 
+private:
+        void lane(SatBatch &b, int i, const DateTime &dt) ;
+
 } ;
 
 #endif // _P13_H
@@ -5,6 +5,8 @@
 
 #include "HamClock.h"
 
+#include "zlib.h"                                       // just for crc32()
+
 
 #define ADIF_COLOR      RGB565 (255,228,225)            // misty rose
 
@@ -85,6 +87,62 @@ static bool showing_set_adif;                           // set when not checking
 static bool newfile_pending;                            // set when find new file while scrolled away
 static FileSignature fsig;                              // used to decide whether to read file again
 static int n_adif_bad;                                  // n bad spots found, global to maintain context
+static uint32_t adif_gen;                               // incremented whenever adif_spots changes
+static SpotIndex adif_si;                               // map location index of adif_spots
+
+// where the local file was last read through, so growth can be read as an append
+static long adif_eor_os;                                // file offset after last record, 0 if unknown
+static uLong adif_crc;                                  // crc32 of file up to adif_eor_os
+static dev_t adif_dev;                                  // file device
+static ino_t adif_ino;                                  // file inode
+
+// sidecar cache of the parsed local file so a restart need not parse it again
+static const char adif_cache_fn[] = "adif-cache.bin";   // in our_dir
+static const char adif_cache_magic[] = "HCADIF1";       // format version
+
+/* adif_cache_fn header, followed by n_spots DXSpots as they were before any watch list check.
+ * the cache is good only if every field matches what we expect for the file now open.
+ */
+typedef struct {
+    char magic[sizeof(adif_cache_magic)];               // adif_cache_magic
+    char version[16];                                   // hc_version that wrote it
+    int spot_size;                                      // sizeof(DXSpot) that wrote it
+    char src_fn[1000];                                  // full source ADIF path
+    int64_t src_dev, src_ino, src_size;                 // source file identity and size
+    int64_t src_mtime;                                  // source file modification time
+    char de_call[NV_CALLSIGN_LEN];                      // spots without MY_ fields assume this RX ..
+    float de_lat, de_lng;                               // .. at this location
+    long eor_os;                                        // file offset after last record
+    int n_bad;                                          // n broken spots
+    int n_spots;                                        // n DXSpots that follow
+} ADIFCacheHeader;
+
+
+/* worked-before index for onADIFList(). an ADIF record matches a spot when all the fields being checked
+ * agree, so there is one hash set of keys for each combination of fields. each set is built from adif_spots
+ * the first time its combination is asked for, then kept current as more spots are appended.
+ */
+#define ADIFK_DXCC      0x1                             // key includes DXCC
+#define ADIFK_GRID      0x2                             // key includes 4-char grid
+#define ADIFK_PREF      0x4                             // key includes prefix
+#define ADIFK_BAND      0x8                             // key includes band
+#define ADIFK_N         16                              // n combinations
+
+typedef struct {
+    int dxcc;                                           // DXCC, else 0
+    char grid[4];                                       // first 4 grid chars upper case, \0 padded
+    char pref[MAX_PREF_LEN];                            // prefix upper case, \0 padded
+    uint8_t band;                                       // HamBandSetting
+    uint8_t used;                                       // set if slot is in use
+} ADIFKey;
+
+typedef struct {
+    ADIFKey *slots;                                     // malloced open addressing table
+    int n_slots;                                        // table size, always a power of 2
+    int n_used;                                         // n slots in use
+    bool built;                                         // set once loaded from adif_spots
+} ADIFKeySet;
+static ADIFKeySet adif_sets[ADIFK_N];                   // one for each combination of ADIFK_ bits
 
 
 /* save sort and file name
@@ -133,11 +191,344 @@ static void scrollADIFDown (const SBox &box)
     }
 }
 
+/* fill k with those fields of spot called for by the ADIFK_ bits in mask.
+ */
+static void mkADIFKey (const DXSpot &spot, int mask, ADIFKey &k)
+{
+    memset (&k, 0, sizeof(k));
+    if (mask & ADIFK_DXCC)
+        k.dxcc = spot.tx_dxcc;
+    if (mask & ADIFK_GRID)
+        for (int i = 0; i < 4 && spot.tx_grid[i] != '\0'; i++)
+            k.grid[i] = toupper (spot.tx_grid[i]);
+    if (mask & ADIFK_PREF) {
+        findCallPrefix (spot.tx_call, k.pref);
+        strtoupper (k.pref);
+    }
+    if (mask & ADIFK_BAND)
+        k.band = findHamBand (spot.kHz);
+    k.used = 1;
+}
+
+/* FNV-1a hash of k
+ */
+static uint32_t hashADIFKey (const ADIFKey &k)
+{
+    const uint8_t *bp = (const uint8_t *) &k;
+    uint32_t h = 2166136261U;
+    for (unsigned i = 0; i < sizeof(k); i++)
+        h = (h ^ bp[i]) * 16777619U;
+    return (h);
+}
+
+/* return the slot in set where k is, or else would be.
+ */
+static ADIFKey *probeADIFKey (const ADIFKeySet &set, const ADIFKey &k)
+{
+    int mask = set.n_slots - 1;
+    for (uint32_t i = hashADIFKey (k); ; i++) {
+        ADIFKey *kp = &set.slots[i & mask];
+        if (!kp->used || memcmp (kp, &k, sizeof(k)) == 0)
+            return (kp);
+    }
+}
+
+/* add k to set if not already present, growing to stay at most half full.
+ */
+static void insertADIFKey (ADIFKeySet &set, const ADIFKey &k)
+{
+    if (2*(set.n_used + 1) > set.n_slots) {
+        ADIFKeySet bigger;
+        bigger.n_slots = set.n_slots ? 2*set.n_slots : 1024;
+        bigger.slots = (ADIFKey *) calloc (bigger.n_slots, sizeof(ADIFKey));
+        if (!bigger.slots)
+            fatalError ("No memory for ADIF index %d", bigger.n_slots);
+        for (int i = 0; i < set.n_slots; i++)
+            if (set.slots[i].used)
+                *probeADIFKey (bigger, set.slots[i]) = set.slots[i];
+        free (set.slots);
+        set.slots = bigger.slots;
+        set.n_slots = bigger.n_slots;
+    }
+
+    ADIFKey *kp = probeADIFKey (set, k);
+    if (!kp->used) {
+        *kp = k;
+        set.n_used++;
+    }
+}
+
+/* add adif_spots[from .. n_data-1] to each set already built.
+ */
+static void addADIFIndex (int from)
+{
+    for (int m = 1; m < ADIFK_N; m++) {
+        if (adif_sets[m].built) {
+            ADIFKey k;
+            for (int i = from; i < adif_ss.n_data; i++) {
+                mkADIFKey (adif_spots[i], m, k);
+                insertADIFKey (adif_sets[m], k);
+            }
+        }
+    }
+}
+
+/* discard all sets
+ */
+static void resetADIFIndex (void)
+{
+    for (int m = 0; m < ADIFK_N; m++) {
+        free (adif_sets[m].slots);
+        memset (&adif_sets[m], 0, sizeof(adif_sets[m]));
+    }
+}
+
 static void resetADIFMem(void)
 {
     free (adif_spots);
     adif_spots = NULL;
     adif_ss.n_data = 0;
+    adif_eor_os = 0;
+    resetADIFIndex();
+    adif_gen++;
+    spotIndexChanged (adif_si);
+}
+
+/* find the crc32 of the first len bytes of fp.
+ * return whether all could be read.
+ * N.B. leaves fp positioned at len
+ */
+static bool crcADIFFile (FILE *fp, long len, uLong &crc)
+{
+    char buf[16384];
+    crc = crc32 (0L, Z_NULL, 0);
+    if (fseek (fp, 0, SEEK_SET) < 0)
+        return (false);
+    while (len > 0) {
+        size_t n = len < (long)sizeof(buf) ? len : sizeof(buf);
+        if (fread (buf, 1, n, fp) != n)
+            return (false);
+        crc = crc32 (crc, (Bytef *) buf, n);
+        len -= n;
+    }
+    return (true);
+}
+
+/* record where fp was read through by loadLocalADIFFile() so appendADIFFile() can tell whether it just grew.
+ */
+static void saveADIFAppendPoint (FILE *fp)
+{
+    struct stat s;
+    if (adif_eor_os <= 0 || fstat (fileno(fp), &s) < 0 || !crcADIFFile (fp, adif_eor_os, adif_crc)) {
+        adif_eor_os = 0;
+        return;
+    }
+    adif_dev = s.st_dev;
+    adif_ino = s.st_ino;
+}
+
+/* if the file open on fp is the same one we last read, only longer, read just its new records.
+ * return false if fp must be read afresh instead.
+ */
+static bool appendADIFFile (FILE *fp, int &n_good, int &n_bad)
+{
+    // same file and at least as long?
+    struct stat s;
+    if (adif_eor_os <= 0 || showing_set_adif || fstat (fileno(fp), &s) < 0 || s.st_dev != adif_dev
+                            || s.st_ino != adif_ino || s.st_size < adif_eor_os)
+        return (false);
+
+    // and still the same up to where we left off? much faster to check than parse
+    uLong crc;
+    if (!crcADIFFile (fp, adif_eor_os, crc) || crc != adif_crc)
+        return (false);
+
+    // read the remainder, fp is now positioned at adif_eor_os
+    DXSpot *new_spots = NULL;
+    long eor_os;
+    {
+        GenReader gr(fp);
+        n_good = readADIFFile (gr, new_spots, true, n_bad, &eor_os);
+    }
+
+    // append and index
+    if (n_good > 0) {
+        adif_spots = (DXSpot *) realloc (adif_spots, (adif_ss.n_data + n_good) * sizeof(DXSpot));
+        if (!adif_spots)
+            fatalError ("No memory for %d ADIF Spots", adif_ss.n_data + n_good);
+        memcpy (&adif_spots[adif_ss.n_data], new_spots, n_good * sizeof(DXSpot));
+        int from = adif_ss.n_data;
+        adif_ss.n_data += n_good;
+        addADIFIndex (from);
+        adif_gen++;
+        spotIndexChanged (adif_si);
+        qsort (adif_spots, adif_ss.n_data, sizeof(DXSpot), adif_pqsf[adif_sort]);
+        adif_ss.scrollToNewest();
+    }
+    free (new_spots);
+    n_adif_bad += n_bad;
+    if (n_good || n_bad)
+        Serial.printf ("ADIF: appended %d qualifying %d busted spots\n", n_good, n_bad);
+
+    // new append point
+    adif_eor_os += eor_os;
+    saveADIFAppendPoint (fp);
+
+    return (true);
+}
+
+/* fill hdr with what an adif_cache_fn header must contain to be used for the ADIF file fn open on fp.
+ * return false if fp can not be checked.
+ */
+static bool initADIFCacheHeader (FILE *fp, const char *fn, ADIFCacheHeader &hdr)
+{
+    struct stat s;
+    if (fstat (fileno(fp), &s) < 0)
+        return (false);
+
+    memset (&hdr, 0, sizeof(hdr));                      // memcmp-able
+    quietStrncpy (hdr.magic, adif_cache_magic, sizeof(hdr.magic));
+    quietStrncpy (hdr.version, hc_version, sizeof(hdr.version));
+    hdr.spot_size = sizeof(DXSpot);
+    quietStrncpy (hdr.src_fn, fn, sizeof(hdr.src_fn));
+    hdr.src_dev = s.st_dev;
+    hdr.src_ino = s.st_ino;
+    hdr.src_size = s.st_size;
+    hdr.src_mtime = s.st_mtime;
+    quietStrncpy (hdr.de_call, getCallsign(), sizeof(hdr.de_call));
+    hdr.de_lat = de_ll.lat_d;
+    hdr.de_lng = de_ll.lng_d;
+    return (true);
+}
+
+/* read the spots parsed from the ADIF file fn open on fp from adif_cache_fn if it is still good for it.
+ * return whether successful, with spots malloced and eor_os set.
+ */
+static bool readADIFCache (FILE *fp, const char *fn, DXSpot *&spots, int &n_spots, int &n_bad, long &eor_os)
+{
+    ADIFCacheHeader want, have;
+    if (!initADIFCacheHeader (fp, fn, want))
+        return (false);
+
+    FILE *cfp = fopenOurs (adif_cache_fn, "r");
+    if (!cfp)
+        return (false);
+
+    // copy the values the source can not tell us then the whole header must match
+    bool ok = fread (&have, sizeof(have), 1, cfp) == 1 && have.n_spots >= 0;
+    if (ok) {
+        want.eor_os = have.eor_os;
+        want.n_bad = have.n_bad;
+        want.n_spots = have.n_spots;
+        ok = memcmp (&want, &have, sizeof(want)) == 0;
+    }
+
+    // then the spots
+    if (ok) {
+        spots = (DXSpot *) malloc (have.n_spots * sizeof(DXSpot) + 1);          // +1 so never NULL
+        if (!spots)
+            fatalError ("No memory for %d ADIF Spots", have.n_spots);
+        ok = fread (spots, sizeof(DXSpot), have.n_spots, cfp) == (size_t)have.n_spots;
+        if (ok) {
+            n_spots = have.n_spots;
+            n_bad = have.n_bad;
+            eor_os = have.eor_os;
+        } else {
+            free (spots);
+            spots = NULL;
+        }
+    }
+
+    fclose (cfp);
+
+    if (ok)
+        Serial.printf ("ADIF: read %d spots for %s from %s\n", n_spots, fn, adif_cache_fn);
+    return (ok);
+}
+
+/* save the spots parsed from the ADIF file fn open on fp in adif_cache_fn for readADIFCache().
+ * written to a temp file first so a partial cache is never seen.
+ */
+static void writeADIFCache (FILE *fp, const char *fn, const DXSpot *spots, int n_spots, int n_bad, long eor_os)
+{
+    ADIFCacheHeader hdr;
+    if (!initADIFCacheHeader (fp, fn, hdr))
+        return;
+    hdr.eor_os = eor_os;
+    hdr.n_bad = n_bad;
+    hdr.n_spots = n_spots;
+
+    char tmp_fn[sizeof(adif_cache_fn) + 2];
+    snprintf (tmp_fn, sizeof(tmp_fn), "x.%s", adif_cache_fn);
+    FILE *cfp = fopenOurs (tmp_fn, "w");
+    if (!cfp) {
+        Serial.printf ("ADIF: %s: %s\n", tmp_fn, strerror(errno));
+        return;
+    }
+    bool ok = fwrite (&hdr, sizeof(hdr), 1, cfp) == 1
+                && fwrite (spots, sizeof(DXSpot), n_spots, cfp) == (size_t)n_spots;
+    ok = fclose (cfp) == 0 && ok;
+
+    std::string tmp_path = our_dir + tmp_fn;
+    std::string cache_path = our_dir + adif_cache_fn;
+    if (!ok || rename (tmp_path.c_str(), cache_path.c_str()) < 0) {
+        Serial.printf ("ADIF: failed to save %s: %s\n", adif_cache_fn, strerror(errno));
+        unlinkOurs (tmp_fn);
+    }
+}
+
+/* replace adif_spots with those of the given candidates that qualify the watch list, then sort.
+ * we take ownership of spots; eor_os is where a file source was read through, else 0.
+ * pass back the number that qualify.
+ */
+static void installADIFSpots (DXSpot *spots, int n_spots, int n_bad, long eor_os, int &n_good)
+{
+    // restart list and insure settings are loaded
+    resetADIFMem();
+    resetDXPedsWorked();
+    loadADIFSettings();
+
+    // keep those that qualify
+    n_good = qualifyADIFSpots (spots, n_spots, true);
+    adif_spots = (DXSpot *) realloc (spots, n_good * sizeof(DXSpot));
+    adif_ss.n_data = n_good;
+    adif_eor_os = eor_os;
+
+    // report
+    n_adif_bad = n_bad;
+    Serial.printf ("ADIF: loaded %d qualifying %d busted spots\n", n_good, n_bad);
+
+    // sort spots and prep for display
+    qsort (adif_spots, adif_ss.n_data, sizeof(DXSpot), adif_pqsf[adif_sort]);
+    adif_ss.scrollToNewest();
+}
+
+/* replace adif_spots with those in the local ADIF file fn open on fp, using adif_cache_fn if still good.
+ * pass back number of qualifying spots and bad spots found.
+ */
+static void loadLocalADIFFile (FILE *fp, const char *fn, int &n_good, int &n_bad)
+{
+    // announce but no waiting, message will remain until this function returns
+    mapMsg (0, "Loading ADIF file");
+
+    // parse only if not already cached
+    DXSpot *spots = NULL;
+    int n_spots;
+    long eor_os = 0;
+    if (!readADIFCache (fp, fn, spots, n_spots, n_bad, eor_os)) {
+        rewind (fp);
+        {
+            GenReader gr(fp);
+            n_spots = parseADIFFile (gr, spots, n_bad, &eor_os);
+        }
+        writeADIFCache (fp, fn, spots, n_spots, n_bad, eor_os);
+    }
+
+    installADIFSpots (spots, n_spots, n_bad, eor_os, n_good);
+    showing_set_adif = false;
+
+    // final message
+    mapMsg (1000, "Loaded ADIF file");
 }
 
 /* draw complete ADIF pane in the given box.
@@ -345,10 +736,12 @@ void freshenADIFFile (void)
         if (!fp)
             fatalError ("ADIF %s: %s", fn_exp, strerror(errno));        // never returns
 
-        // ingest
-        GenReader gr(fp);
-        int n_good;
-        loadADIFFile (gr, n_good, n_adif_bad);
+        // ingest just the new records if the file merely grew, else all of it
+        int n_good, n_bad;
+        if (!appendADIFFile (fp, n_good, n_bad)) {
+            loadLocalADIFFile (fp, fn_exp, n_good, n_bad);
+            saveADIFAppendPoint (fp);
+        }
         fclose (fp);
 
         // update list if showing
@@ -373,21 +766,11 @@ void loadADIFFile (GenReader &gr, int &n_good, int &n_bad)
     // announce but no waiting, message will remain until this function returns
     mapMsg (0, "Loading ADIF file");
 
-    // restart list and insure settings are loaded
-    resetADIFMem();
-    loadADIFSettings();
-
-    // crack file, adds good entries to adif_spots[]
-    adif_ss.n_data = readADIFFile (gr, adif_spots, true, n_bad);
-
-    // report
-    n_good = adif_ss.n_data;
-    n_adif_bad = n_bad;
-    Serial.printf ("ADIF: loaded %d qualifying %d busted spots\n", n_good, n_bad);
-
-    // sort spots and prep for display
-    qsort (adif_spots, adif_ss.n_data, sizeof(DXSpot), adif_pqsf[adif_sort]);
-    adif_ss.scrollToNewest();
+    // crack file then keep the good entries in adif_spots[]
+    DXSpot *spots = NULL;
+    long eor_os;
+    int n_spots = parseADIFFile (gr, spots, n_bad, &eor_os);
+    installADIFSpots (spots, n_spots, n_bad, gr.isFile() ? eor_os : 0, n_good);     // can only append to files
 
     // note new source type ready
     showing_set_adif = gr.isClient();
@@ -502,12 +885,12 @@ bool checkADIFTouch (const SCoord &s, const SBox &box)
     }
 }
 
-/* find closest spot and location on either end to given ll, if any.
+/* find closest spot and location on either end to given ll, if any, and how many spots are near it.
  */
-bool getClosestADIFSpot (LatLong &ll, DXSpot *sp, LatLong *llp)
+bool getClosestADIFSpot (LatLong &ll, DXSpot *sp, LatLong *llp, int *n_near)
 {
     return (adif_spots && findPaneForChoice(PLOT_CH_ADIF) != PANE_NONE
-                && getClosestSpot (adif_spots, adif_ss.n_data, NULL, LOME_BOTH, ll, sp, llp));
+                && getClosestSpot (adif_si, adif_spots, adif_ss.n_data, NULL, LOME_BOTH, ll, sp, llp, n_near));
 }
 
 
@@ -547,6 +930,14 @@ bool getADIFPaneSpot (const SCoord &ms, DXSpot *dxs, LatLong *ll)
     return (false);
 }
 
+/* return a value that changes whenever the set of ADIF spots changes, such as to know when results
+ * of onADIFList() may differ.
+ */
+uint32_t getADIFGeneration (void)
+{
+    return (adif_gen);
+}
+
 /* return whether the given spot matches all the given tests for any ADIF spot.
  * N.B. check is limited to spots on ADIF watchlist if any.
  * N.B. if no tests are specified we always return true.
@@ -554,26 +945,29 @@ bool getADIFPaneSpot (const SCoord &ms, DXSpot *dxs, LatLong *ll)
  */
 bool onADIFList (const DXSpot &spot, bool chk_dxcc, bool chk_grid, bool chk_pref, bool chk_band)
 {
-    // prep spot
-    HamBandSetting spot_band = findHamBand (spot.kHz);
-    char spot_pref[MAX_PREF_LEN];
-    findCallPrefix (spot.tx_call, spot_pref);
-
-    // compare with each 
-    for (int i = 0; i < adif_ss.n_data; i++) {
-        DXSpot &adif_spot = adif_spots[i];
-        bool pref_match = false;
-        if (chk_pref) {
-            char adif_pref[MAX_PREF_LEN];
-            findCallPrefix (adif_spot.tx_call, adif_pref);
-            pref_match = strcasecmp (spot_pref, adif_pref) == 0;
+    // set for this combination of checks, any record at all qualifies if none
+    int m = (chk_dxcc ? ADIFK_DXCC : 0) | (chk_grid ? ADIFK_GRID : 0) | (chk_pref ? ADIFK_PREF : 0)
+                        | (chk_band ? ADIFK_BAND : 0);
+    if (m == 0)
+        return (adif_ss.n_data > 0);
+    ADIFKeySet &set = adif_sets[m];
+
+    // build if first time
+    if (!set.built) {
+        ADIFKey k;
+        for (int i = 0; i < adif_ss.n_data; i++) {
+            mkADIFKey (adif_spots[i], m, k);
+            insertADIFKey (set, k);
         }
-        if (       (!chk_pref || pref_match)
-                && (!chk_dxcc || spot.tx_dxcc == adif_spot.tx_dxcc)
-                && (!chk_band || spot_band == findHamBand (adif_spot.kHz))
-                && (!chk_grid || strncasecmp (spot.tx_grid, adif_spot.tx_grid, 4) == 0))
-            return (true);
+        set.built = true;
+        if (debugLevel (DEBUG_ADIF, 1))
+            Serial.printf ("ADIF: index %d has %d keys from %d spots\n", m, set.n_used, adif_ss.n_data);
     }
 
-    return (false);
+    // probe
+    if (set.n_used == 0)
+        return (false);
+    ADIFKey k;
+    mkADIFKey (spot, m, k);
+    return (probeADIFKey (set, k)->used);
 }
@@ -642,83 +642,265 @@ static bool parseADIF (char c, ADIFParser &adif, DXSpot &spot)
     return (finished);
 }
 
-/* general purpose ADIF parser from a GenReader.
- * add malloced DXSpots to spots, add to prefix table and return count.
- * also:
- *   we pass back count of any broken spots or did not qualify WLID_ADIF if used.
- *   use_wl determines whether spots are checked against WLID_ADIF.
- * N.B. must call with spots = NULL and caller is responsible to free (spots).
- * N.B. caller must close gr
+/* one piece of an ADIF file being parsed, perhaps in its own thread
  */
-int readADIFFile (GenReader &gr, DXSpot *&spots, bool use_wl, int &n_bad)
-{
-    // init counts, timer
-    int n_read = 0;
-    int n_good = 0;
-    int n_malloc = 0;
-    const int malloc_more = 1000;
-    n_bad = 0;
-    struct timeval tv0;
-    gettimeofday (&tv0, NULL);
+typedef struct {
+    const char *start, *end;                            // bytes to parse, if in memory
+    DXSpot *spots;                                      // malloced spots passing spotLooksGood()
+    int n_spots, n_malloc;                              // n spots used, n malloced
+    int n_bad;                                          // n spots failing spotLooksGood()
+    long eor_os;                                        // bytes through end of last record or header
+} ADIFChunk;
+
+#define ADIF_MALLOC_MORE        1000                    // spots to grow ADIFChunk.spots
+#define ADIF_CHUNK_MIN          (256*1024)              // min bytes worth giving its own thread
+#define ADIF_MAX_THREADS        8                       // max parsing threads
 
-    // reset dxpeds worked list
-    resetDXPedsWorked();
+// parsing threads report completion here
+static pthread_mutex_t adif_chunk_lock = PTHREAD_MUTEX_INITIALIZER;
+static int n_adif_chunks_done;
 
-    // crack file
+
+/* parse the next character into ck, which has so far seen n_chars.
+ * return true when a spot has been completed, good or bad.
+ */
+static inline bool parseADIFChunkChar (char c, ADIFChunk &ck, ADIFParser &adif, DXSpot &spot, long n_chars)
+{
+    bool finished = parseADIF (c, adif, spot);
+    if (finished || adif.ps == ADIFPS_STARTSPOT)
+        ck.eor_os = n_chars + 1;                        // just finished a record, good or bad, or the header
+    if (finished) {
+        if (spotLooksGood (adif, spot)) {
+            if (ck.n_spots + 1 > ck.n_malloc) {
+                ck.spots = (DXSpot *) realloc (ck.spots, (ck.n_malloc += ADIF_MALLOC_MORE) * sizeof(DXSpot));
+                if (!ck.spots)
+                    fatalError ("No memory for %d ADIF Spots", ck.n_malloc);
+            }
+            ck.spots[ck.n_spots++] = spot;
+        } else
+            ck.n_bad++;         // count actual broken spots, not ones that just aren't selected by WL
+    }
+    return (finished);
+}
+
+/* parse ck.start .. ck.end into ck.
+ * N.B. may be run in any thread
+ */
+static void parseADIFChunk (ADIFChunk &ck)
+{
     DXSpot spot;
     ADIFParser adif;
     adif.ps = ADIFPS_STARTFILE;
-    char c;
+    for (const char *cp = ck.start; cp < ck.end; cp++)
+        (void) parseADIFChunkChar (*cp, ck, adif, spot, cp - ck.start);
+}
+
+/* thread to parse one ADIFChunk then report done
+ */
+static void *parseADIFChunkThread (void *vp)
+{
+    parseADIFChunk (*(ADIFChunk *)vp);
+
+    pthread_mutex_lock (&adif_chunk_lock);
+    n_adif_chunks_done++;
+    pthread_mutex_unlock (&adif_chunk_lock);
+
+    return (NULL);
+}
+
+/* return pointer just after the first <EOR> at or after cp, else end.
+ */
+static const char *findADIFEOR (const char *cp, const char *end)
+{
+    while ((cp = (const char *) memchr (cp, '<', end - cp)) != NULL) {
+        if (end - cp >= 5 && strncasecmp (cp, "<eor>", 5) == 0)
+            return (cp + 5);
+        cp++;
+    }
+    return (end);
+}
+
+/* parse all of the in-memory ADIF text all .. all+len into ck, using several threads if worthwhile.
+ * records are split between threads at <EOR> so each starts fresh; spots retain file order.
+ */
+static void parseADIFMemory (const char *all, long len, ADIFChunk &ck)
+{
+    // decide how many threads
+    long n_cpu = sysconf (_SC_NPROCESSORS_ONLN);
+    int n_chunks = len / ADIF_CHUNK_MIN;
+    if (n_chunks > n_cpu)
+        n_chunks = n_cpu;
+    if (n_chunks > ADIF_MAX_THREADS)
+        n_chunks = ADIF_MAX_THREADS;
+
+    // simple if just one or cty can not be made ready, lookups in the threads must never load it
+    if (n_chunks <= 1 || !readyCty()) {
+        ck.start = all;
+        ck.end = all + len;
+        parseADIFChunk (ck);
+        return;
+    }
+
+    // split at record boundaries and start a thread for each
+    ADIFChunk chunks[ADIF_MAX_THREADS];
+    pthread_t tids[ADIF_MAX_THREADS];
+    const char *end = all + len;
+    const char *cp = all;
+    int n_started = 0;
+    n_adif_chunks_done = 0;
+    for (int i = 0; i < n_chunks && cp < end; i++) {
+        ADIFChunk &c = chunks[n_started];
+        memset (&c, 0, sizeof(c));
+        c.start = cp;
+        if (i == n_chunks-1)
+            c.end = end;
+        else {
+            const char *nominal = all + (i+1)*(len/n_chunks);
+            c.end = findADIFEOR (nominal > cp ? nominal : cp, end);
+        }
+        int e = pthread_create (&tids[n_started], NULL, parseADIFChunkThread, &c);
+        if (e)
+            fatalError ("ADIF parse thread failed: %s", strerror(e));
+        cp = c.end;
+        n_started++;
+    }
+
+    // wait for all while keeping the clocks alive
+    for (;;) {
+        pthread_mutex_lock (&adif_chunk_lock);
+        bool all_done = n_adif_chunks_done == n_started;
+        pthread_mutex_unlock (&adif_chunk_lock);
+        if (all_done)
+            break;
+        updateClocks(false);
+        wdDelay (10);
+    }
+
+    // merge in order
+    int n_spots = 0;
+    for (int i = 0; i < n_started; i++) {
+        pthread_join (tids[i], NULL);
+        n_spots += chunks[i].n_spots;
+    }
+    releaseCty();
+    ck.n_malloc = n_spots;
+    ck.spots = (DXSpot *) malloc (n_spots * sizeof(DXSpot) + 1);           // +1 so never NULL
+    if (!ck.spots)
+        fatalError ("No memory for %d ADIF Spots", n_spots);
+    for (int i = 0; i < n_started; i++) {
+        ADIFChunk &c = chunks[i];
+        memcpy (&ck.spots[ck.n_spots], c.spots, c.n_spots * sizeof(DXSpot));
+        ck.n_spots += c.n_spots;
+        ck.n_bad += c.n_bad;
+        if (c.eor_os > 0)
+            ck.eor_os = (c.start - all) + c.eor_os;
+        free (c.spots);
+    }
+
     if (debugLevel (DEBUG_ADIF, 1))
-        Serial.printf ("ADIF: WL DE_Call   Grid   DXCC  DX_Call   Grid   DXCC    Lat   Long Mode      kHz\n");
-    while (gr.getChar(&c)) {
-        if (parseADIF (c, adif, spot)) {
-            // spot parsing complete
-            if (spotLooksGood (adif, spot)) {
-                // at this point all spot fields are complete
-                n_read++;
-
-                // add to the DXPeds indices regardless of watch list
-                addDXPedsWorked (spot);
-
-                // add to list if qualifies watch list
-                bool wl_ok = !use_wl || checkWatchListSpot(WLID_ADIF, spot) != WLS_NO;
-                if (wl_ok) {
-                    // add to *spots_p
-                    if (n_good+1 > n_malloc) {
-                        spots = (DXSpot *) realloc (spots, (n_malloc += malloc_more) * sizeof(DXSpot));
-                        if (!spots)
-                            fatalError ("No memory for %d ADIF Spots", n_malloc);
-                    }
-                    spots[n_good++] = spot;
-                }
-                // nice logging if enabled
-                if ((wl_ok && debugLevel (DEBUG_ADIF, 1)) || (!wl_ok && debugLevel (DEBUG_ADIF, 2))) {
-                    Serial.printf("ADIF: %s %-9.9s %-6.6s %4d  %-9.9s %-6.6s %4d  %5.1f %6.1f %4.4s %8.1f\n", 
-                        wl_ok ? "OK" : "NO",
-                        spot.rx_call, spot.rx_grid, spot.rx_dxcc,
-                        spot.tx_call, spot.tx_grid, spot.tx_dxcc,
-                        spot.tx_ll.lat_d, spot.tx_ll.lng_d, spot.mode, spot.kHz);
-                }
-            } else
-                n_bad++;        // count actual broken spots, not ones that just aren't selected by WL
+        Serial.printf ("ADIF: parsed %ld bytes with %d threads\n", len, n_started);
+}
 
+/* parse all records from gr without regard to watch list.
+ * pass back malloced spots that pass spotLooksGood(), count of those that do not, and return count of spots.
+ * if eor_os we pass back the number of bytes read through the end of the last complete record or header.
+ * if the entire source is in memory, such as a mapped file, it is parsed in parallel.
+ * N.B. must call with spots = NULL and caller is responsible to free (spots).
+ * N.B. caller must close gr
+ */
+int parseADIFFile (GenReader &gr, DXSpot *&spots, int &n_bad, long *eor_os)
+{
+    struct timeval tv0;
+    gettimeofday (&tv0, NULL);
+
+    ADIFChunk ck;
+    memset (&ck, 0, sizeof(ck));
+
+    const char *all;
+    long len;
+    if (gr.getAll (all, len)) {
+        parseADIFMemory (all, len, ck);
+    } else {
+        DXSpot spot;
+        ADIFParser adif;
+        adif.ps = ADIFPS_STARTFILE;
+        char c;
+        for (long n_chars = 0; gr.getChar(&c); n_chars++) {
             // look alive
-            if (((n_good + n_bad)%100) == 0)
+            if (parseADIFChunkChar (c, ck, adif, spot, n_chars) && ((ck.n_spots + ck.n_bad)%100) == 0)
                 updateClocks(false);
         }
     }
 
-    // rm excess spots
-    spots = (DXSpot *) realloc (spots, n_good * sizeof(DXSpot));
-
     if (debugLevel (DEBUG_ADIF, 1)) {
         struct timeval tv1;
         gettimeofday (&tv1, NULL);
-        long usec = TVDELUS (tv0, tv1);
-        Serial.printf ("ADIF: file read %d required %ld ms = %ld spots/s\n", n_read, usec/1000,
-                                                                                1000000L*n_read/usec);
+        long usec = TVDELUS (tv0, tv1) + 1;
+        Serial.printf ("ADIF: file parse %d required %ld ms = %ld spots/s\n", ck.n_spots, usec/1000,
+                                                                                1000000L*ck.n_spots/usec);
+    }
+
+    spots = ck.spots;
+    n_bad = ck.n_bad;
+    if (eor_os)
+        *eor_os = ck.eor_os;
+    return (ck.n_spots);
+}
+
+/* add each of n_spots to the DXPeds worked list then, if use_wl, retain only those that pass WLID_ADIF.
+ * return count retained at the front of spots.
+ * N.B. caller must resetDXPedsWorked() if starting over
+ */
+int qualifyADIFSpots (DXSpot *spots, int n_spots, bool use_wl)
+{
+    if (debugLevel (DEBUG_ADIF, 1))
+        Serial.printf ("ADIF: WL DE_Call   Grid   DXCC  DX_Call   Grid   DXCC    Lat   Long Mode      kHz\n");
+
+    int n_good = 0;
+    for (int i = 0; i < n_spots; i++) {
+        DXSpot &spot = spots[i];
+
+        // add to the DXPeds indices regardless of watch list
+        addDXPedsWorked (spot);
+
+        // keep if qualifies watch list
+        bool wl_ok = !use_wl || checkWatchListSpot(WLID_ADIF, spot) != WLS_NO;
+        if (wl_ok && n_good != i)
+            spots[n_good] = spot;
+
+        // nice logging if enabled
+        if ((wl_ok && debugLevel (DEBUG_ADIF, 1)) || (!wl_ok && debugLevel (DEBUG_ADIF, 2))) {
+            Serial.printf("ADIF: %s %-9.9s %-6.6s %4d  %-9.9s %-6.6s %4d  %5.1f %6.1f %4.4s %8.1f\n", 
+                wl_ok ? "OK" : "NO",
+                spot.rx_call, spot.rx_grid, spot.rx_dxcc,
+                spot.tx_call, spot.tx_grid, spot.tx_dxcc,
+                spot.tx_ll.lat_d, spot.tx_ll.lng_d, spot.mode, spot.kHz);
+        }
+
+        if (wl_ok)
+            n_good++;
     }
 
     return (n_good);
 }
+
+/* general purpose ADIF parser from a GenReader.
+ * add malloced DXSpots to spots, add to DXPeds worked list and return count.
+ * also:
+ *   we pass back count of any broken spots, not those that just did not qualify WLID_ADIF.
+ *   use_wl determines whether spots are checked against WLID_ADIF.
+ *   if eor_os we pass back the number of bytes read through the end of the last complete record or header.
+ * N.B. must call with spots = NULL and caller is responsible to free (spots).
+ * N.B. caller must close gr
+ * N.B. caller must resetDXPedsWorked() if starting over
+ */
+int readADIFFile (GenReader &gr, DXSpot *&spots, bool use_wl, int &n_bad, long *eor_os)
+{
+    int n_spots = parseADIFFile (gr, spots, n_bad, eor_os);
+    int n_good = qualifyADIFSpots (spots, n_spots, use_wl);
+
+    // rm excess spots
+    spots = (DXSpot *) realloc (spots, n_good * sizeof(DXSpot));
+
+    return (n_good);
+}
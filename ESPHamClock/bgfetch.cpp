@@ -0,0 +1,148 @@
+/* background fetch engine.
+ *
+ * a small pool of worker threads performs network retrievals and their parsing off the main thread. each
+ * finished job is pushed onto a lock-free list which the main thread drains from its loop to run the job's
+ * done() installer, so the main thread never waits on the network and only ever draws.
+ */
+
+#include <atomic>
+
+#include "HamClock.h"
+
+
+#define BGF_NWORKERS    4                       // n worker threads
+#define BGF_WAIT_MS     20                      // waitBGFetch() polling period
+
+// jobs waiting for a worker, FIFO
+static pthread_mutex_t bgf_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t bgf_go = PTHREAD_COND_INITIALIZER;
+static BGFetch *bgf_head, *bgf_tail;
+
+// jobs completed by any worker, newest first, taken all at once by the main thread
+static std::atomic<BGFetch*> bgf_done;
+
+
+/* thread that runs jobs as they are queued, forever.
+ */
+static void *bgFetchThread (void *unused)
+{
+    (void) unused;
+
+    pthread_mutex_lock (&bgf_lock);
+    for (;;) {
+
+        // wait for a job
+        while (!bgf_head)
+            pthread_cond_wait (&bgf_go, &bgf_lock);
+        BGFetch *bgf = bgf_head;
+        bgf_head = bgf->next;
+        if (!bgf_head)
+            bgf_tail = NULL;
+        pthread_mutex_unlock (&bgf_lock);
+
+        // run it
+        struct timeval tv0, tv1;
+        gettimeofday (&tv0, NULL);
+        bgf->ok = (*bgf->fetch)(*bgf);
+        gettimeofday (&tv1, NULL);
+        bgf->ms = TVDELUS (tv0, tv1) / 1000;
+
+        // push onto done list, release so main sees all results along with the link
+        BGFetch *top = bgf_done.load (std::memory_order_relaxed);
+        do {
+            bgf->next = top;
+        } while (!bgf_done.compare_exchange_weak (top, bgf, std::memory_order_release,
+                                                                std::memory_order_relaxed));
+        wakeMainLoop();
+
+        pthread_mutex_lock (&bgf_lock);
+    }
+
+    return (NULL);
+}
+
+/* queue bgf to be fetched in the background, starting the worker pool if first time.
+ * return false if bgf is already pending.
+ * N.B. call only from the main thread; bgf must persist until its done() has been called.
+ */
+bool startBGFetch (BGFetch &bgf)
+{
+    static bool pool_ok;
+    if (!pool_ok) {
+        for (int i = 0; i < BGF_NWORKERS; i++) {
+            pthread_t tid;
+            int e = pthread_create (&tid, NULL, bgFetchThread, NULL);
+            if (e)
+                fatalError ("fetch worker thread failed: %s", strerror(e));
+            pthread_detach (tid);
+        }
+        Serial.printf ("BGF: started %d fetch workers\n", BGF_NWORKERS);
+        pool_ok = true;
+    }
+
+    if (bgf.pending)
+        return (false);
+    bgf.pending = true;
+    bgf.next = NULL;
+
+    // getUserAgent() reads main thread state so capture it now for fetch() to pass to httpHCGET()
+    getUserAgent (bgf.ua, sizeof(bgf.ua));
+
+    pthread_mutex_lock (&bgf_lock);
+    if (bgf_tail)
+        bgf_tail->next = &bgf;
+    else
+        bgf_head = &bgf;
+    bgf_tail = &bgf;
+    pthread_cond_signal (&bgf_go);
+    pthread_mutex_unlock (&bgf_lock);
+
+    return (true);
+}
+
+/* run done() for each job that has completed since the last call, in order of completion.
+ * return number of jobs installed.
+ * N.B. call only from the main thread.
+ */
+int checkBGFetch (void)
+{
+    // take the whole list at once, acquire to see everything the workers wrote
+    BGFetch *list = bgf_done.exchange (NULL, std::memory_order_acquire);
+    if (!list)
+        return (0);
+
+    // reverse to oldest first
+    BGFetch *fifo = NULL;
+    while (list) {
+        BGFetch *next = list->next;
+        list->next = fifo;
+        fifo = list;
+        list = next;
+    }
+
+    // install each, N.B. done() may well restart the same job so capture next first
+    int n = 0;
+    while (fifo) {
+        BGFetch *bgf = fifo;
+        fifo = bgf->next;
+        bgf->pending = false;
+        Serial.printf ("BGF: %s %s after %d ms\n", bgf->name, bgf->ok ? "ok" : "failed", bgf->ms);
+        (*bgf->done)(*bgf);
+        n++;
+    }
+
+    return (n);
+}
+
+/* wait for the given job to complete and be installed, keeping the clocks and web server alive meanwhile.
+ * N.B. call only from the main thread.
+ */
+void waitBGFetch (BGFetch &bgf)
+{
+    while (bgf.pending) {
+        if (checkBGFetch() == 0) {
+            updateClocks(false);
+            wdDelay (BGF_WAIT_MS);
+        }
+    }
+}
@@ -53,18 +53,127 @@ static bool fileAgeOk (const char *path, int max_age)
 }
 
 
+/* read the validators saved with cached file fn when it was last downloaded.
+ * return whether found either.
+ */
+static bool readCacheMeta (const char *fn, char *etag, char *last_mod, size_t len)
+{
+    etag[0] = last_mod[0] = '\0';
+
+    char meta_path[1000];
+    snprintf (meta_path, sizeof(meta_path), "%s/%s.meta", our_dir.c_str(), fn);
+    FILE *fp = fopen (meta_path, "r");
+    if (!fp)
+        return (false);
+
+    char line[300];
+    while (fgets (line, sizeof(line), fp)) {
+        chompString (line);
+        if (strncmp (line, "ETag: ", 6) == 0)
+            quietStrncpy (etag, line+6, len);
+        else if (strncmp (line, "Last-Modified: ", 15) == 0)
+            quietStrncpy (last_mod, line+15, len);
+    }
+    fclose (fp);
+
+    return (etag[0] || last_mod[0]);
+}
+
+/* save the validators for cached file fn, or remove the record if neither.
+ */
+static void writeCacheMeta (const char *fn, const char *etag, const char *last_mod)
+{
+    char meta_path[1000];
+    snprintf (meta_path, sizeof(meta_path), "%s/%s.meta", our_dir.c_str(), fn);
+
+    if (!etag[0] && !last_mod[0]) {
+        (void) unlink (meta_path);
+        return;
+    }
+
+    FILE *fp = fopen (meta_path, "w");
+    if (!fp) {
+        Serial.printf ("Cache: %s: %s\n", meta_path, strerror(errno));
+        return;
+    }
+    if (fchown (fileno(fp), getuid(), getgid()) < 0)
+        Serial.printf ("Cache: chown(%s,%d,%d) %s\n", meta_path, getuid(), getgid(), strerror(errno));
+    if (etag[0])
+        fprintf (fp, "ETag: %s\n", etag);
+    if (last_mod[0])
+        fprintf (fp, "Last-Modified: %s\n", last_mod);
+    fclose (fp);
+}
+
+/* server says cached file fn is still current so just restart its age, and that of its meta.
+ */
+static void touchCachedFile (const char *fn, const char *fn_path)
+{
+    if (utime (fn_path, NULL) < 0)
+        Serial.printf ("Cache: utime(%s) %s\n", fn_path, strerror(errno));
+
+    char meta_path[1000];
+    snprintf (meta_path, sizeof(meta_path), "%s/%s.meta", our_dir.c_str(), fn);
+    (void) utime (meta_path, NULL);
+
+    Serial.printf ("Cache: %s unchanged\n", fn);
+}
+
+/* rewrite the downloaded file open in fp in place to be just as if it had been copied line by line with
+ * getTCPLine(), as all our readers expect: drop every \r and insure the last line ends with \n.
+ * return whether io ok.
+ */
+static bool normalizeLines (FILE *fp)
+{
+    char buf[16384];
+    long r_pos = 0, w_pos = 0;
+    char last = '\n';                           // so an empty file stays empty
+    size_t n_read;
+
+    while (fseek (fp, r_pos, SEEK_SET) == 0 && (n_read = fread (buf, 1, sizeof(buf), fp)) > 0) {
+        r_pos += n_read;
+        size_t n_keep = 0;
+        for (size_t i = 0; i < n_read; i++)
+            if (buf[i] != '\r')
+                buf[n_keep++] = buf[i];
+        if (n_keep == 0)
+            continue;
+        last = buf[n_keep-1];
+        // N.B. no need to write back until a \r has been dropped
+        if (w_pos + (long)n_read != r_pos || n_keep != n_read) {
+            if (fseek (fp, w_pos, SEEK_SET) < 0 || fwrite (buf, 1, n_keep, fp) != n_keep)
+                return (false);
+        }
+        w_pos += n_keep;
+    }
+    if (ferror (fp))
+        return (false);
+
+    if (last != '\n') {
+        if (fseek (fp, w_pos, SEEK_SET) < 0 || fputc ('\n', fp) == EOF)
+            return (false);
+        w_pos += 1;
+    }
+    return (fflush (fp) == 0 && ftruncate (fileno(fp), w_pos) == 0);
+}
+
 /* open the given local file or download fresh if too old or too small.
  * if download fails retain fn as long as it's large enough, tolerating too old.
+ * downloads are conditional on the validators saved with the previous copy and may be gzip encoded.
+ * N.B. a bgfetch worker must pass the user_agent prepared by startBGFetch(); this also leaves the clocks
+ *   and remote_addr alone because they belong to the main thread.
  */
-FILE *openCachedFile (const char *fn, const char *url, int max_age, int min_size)
+FILE *openCachedFile (const char *fn, const char *url, int max_age, int min_size, const char *user_agent)
 {
     // try local first
     char fn_path[1000];
     snprintf (fn_path, sizeof(fn_path), "%s/%s", our_dir.c_str(), fn);
+    bool have_local = false;
     FILE *fp = fopen (fn_path, "r");
     if (fp) {
         // file exists, now check the age and size
-        if (fileSizeOk (fn_path, min_size) && fileAgeOk (fn_path, max_age)) {
+        have_local = fileSizeOk (fn_path, min_size);
+        if (have_local && fileAgeOk (fn_path, max_age)) {
             // still good!
             return (fp);
         } else {
@@ -75,26 +184,57 @@ FILE *openCachedFile (const char *fn, const char *url, int max_age, int min_size
     } else
         Serial.printf ("Cache: %s not found -- downloading %s\n", fn, url);
 
+    // ask for compression and, if we have a copy worth keeping, only if it has changed
+    char extra_hdrs[800];
+    char etag[200], last_mod[200];
+    int eh_l = snprintf (extra_hdrs, sizeof(extra_hdrs), "Accept-Encoding: gzip\r\n");
+    if (have_local && readCacheMeta (fn, etag, last_mod, sizeof(etag))) {
+        if (etag[0])
+            eh_l += snprintf (extra_hdrs+eh_l, sizeof(extra_hdrs)-eh_l, "If-None-Match: %s\r\n", etag);
+        if (last_mod[0])
+            eh_l += snprintf (extra_hdrs+eh_l, sizeof(extra_hdrs)-eh_l, "If-Modified-Since: %s\r\n", last_mod);
+    }
+
     // download
     WiFiClient cache_client;
     Serial.println (url);
     if (cache_client.connect(backend_host, backend_port)) {
 
-        updateClocks(false);
+        if (!user_agent)
+            updateClocks(false);
 
         // query web page
-        httpHCGET (cache_client, backend_host, url);
+        httpHCGET (cache_client, backend_host, url, extra_hdrs, user_agent);
 
-        // skip header
-        if (!httpSkipHeader (cache_client)) {
+        // skip header but capture what we need
+        enum {HF_REMOTE, HF_ETAG, HF_LASTMOD, HF_ENCODING, HF_N};
+        HTTPHeaderField hdrs[HF_N];
+        hdrs[HF_REMOTE].name = "Remote_Addr: ";
+        hdrs[HF_ETAG].name = "ETag: ";
+        hdrs[HF_LASTMOD].name = "Last-Modified: ";
+        hdrs[HF_ENCODING].name = "Content-Encoding: ";
+        int status;
+        if (!httpSkipHeader (cache_client, status, hdrs, HF_N)) {
             Serial.printf ("Cache: %s head short\n", url);
             goto out;
         }
+        if (!user_agent && hdrs[HF_REMOTE].value[0])
+            quietStrncpy (remote_addr, hdrs[HF_REMOTE].value, sizeof(remote_addr));
+
+        // nothing more to do if ours is still current
+        if (status == 304 && have_local) {
+            touchCachedFile (fn, fn_path);
+            goto out;
+        }
+        if (status != 200) {
+            Serial.printf ("Cache: %s status %d\n", url, status);
+            goto out;
+        }
 
         // start new temp file near first so it can be renamed
         char tmp_path[1000];
         snprintf (tmp_path, sizeof(tmp_path), "%s/x.%s", our_dir.c_str(), fn);
-        fp = fopen (tmp_path, "w");
+        fp = fopen (tmp_path, "w+");
         if (!fp) {
             Serial.printf ("Cache: %s: x.%s\n", fn, strerror(errno));
             goto out;
@@ -104,22 +244,32 @@ FILE *openCachedFile (const char *fn, const char *url, int max_age, int min_size
         if (fchown (fileno(fp), getuid(), getgid()) < 0)
             Serial.printf ("Cache: chown(%s,%d,%d) %s\n", tmp_path, getuid(), getgid(), strerror(errno));
 
-        // download
-        char buf[1024];
+        // download, inflating or in whole blocks as they arrive
         bool io_ok = true;
-        while (io_ok && getTCPLine (cache_client, buf, sizeof(buf), NULL)) {
-            if (fprintf (fp, "%s\n", buf) < 1) {
-                io_ok = false;
-                Serial.printf ("Cache: write(%s) %s\n", tmp_path, strerror(errno));
+        if (strcistr (hdrs[HF_ENCODING].value, "gzip")) {
+            io_ok = zinfWiFiFILE (cache_client, -1, fp);
+        } else {
+            uint8_t buf[16384];
+            int n_read;
+            while (io_ok && (n_read = cache_client.readArray (buf, sizeof(buf))) > 0) {
+                if (fwrite (buf, 1, n_read, fp) != (size_t)n_read) {
+                    io_ok = false;
+                    Serial.printf ("Cache: write(%s) %s\n", tmp_path, strerror(errno));
+                }
             }
         }
+        if (io_ok && !normalizeLines (fp)) {
+            io_ok = false;
+            Serial.printf ("Cache: normalize(%s) %s\n", tmp_path, strerror(errno));
+        }
         fclose (fp);
 
         // tmp replaces fn_path if io and size ok
         if (io_ok && fileSizeOk (tmp_path, min_size)) {
-            if (rename (tmp_path, fn_path) == 0)
+            if (rename (tmp_path, fn_path) == 0) {
                 Serial.printf ("Cache: fresh %s installed\n", fn);
-            else
+                writeCacheMeta (fn, hdrs[HF_ETAG].value, hdrs[HF_LASTMOD].value);
+            } else
                 Serial.printf ("Cache: rename(%s,%s) %s\n", tmp_path, fn_path, strerror(errno));
         }
 
@@ -144,6 +294,13 @@ FILE *openCachedFile (const char *fn, const char *url, int max_age, int min_size
     return (NULL);
 }
 
+/* same but for use only by the main thread.
+ */
+FILE *openCachedFile (const char *fn, const char *url, int max_age, int min_size)
+{
+    return (openCachedFile (fn, url, max_age, min_size, NULL));
+}
+
 /* remove files that contain the given string and older than the given age in seconds
  * return whether any where removed.
  */
@@ -25,6 +25,7 @@ static bool hide_clocks;                        // run but don't display
 static int prev_yr, prev_mo, prev_dy, prev_hr, prev_mn, prev_sc, prev_wd;
 static bool time_running_bw;                    // set if see time running backwards -- yes it can happen!
 static bool time_is_stuck;                      // set if see time not changing -- yes it can happen!
+static SchedTimer clock_timer = {"clocks"};    // next second
 
 // TimeLib's now() stays at real UTC, but user can adjust time offset
 static int utc_offset;                          // nowWO() offset from UTC, secs
@@ -953,6 +954,9 @@ int utcOffset()
  */
 void updateClocks(bool all)
 {
+    // back at the next second even if hidden, other per-second displays count on it
+    armSchedTimerSecond (clock_timer);
+
     // ignore if disabled
     if (hide_clocks)
         return;
@@ -3,8 +3,13 @@
  * support Spider, AR and CC clusters, plus several UDP packet formats.
  *
  * We actually keep two lists:
- *   dxc_spots: the complete raw list, not filtered nor sorted; length in n_dxspots.
+ *   dxc_spots: the complete raw list in order of arrival, not filtered; n live spots in n_dxspots.
  *   dxwl_spots: watchlist-filtered and time-sorted for display; length in dxc_ss.n_data.
+ *
+ * dxc_spots is a sliding ring: new spots are added at dxc_head and expire from dxc_tail, so the live spots
+ * are always the contiguous slots [dxc_tail, dxc_head). When dxc_head reaches the end of the array the live
+ * spots are moved back to the front. A spot that is updated moves to the head, leaving an empty slot behind
+ * with tx_call[0] == '\0'. Spots are also found by tx_call and band in dxc_hash.
  * 
  */
 
@@ -37,9 +42,24 @@ static uint8_t dxc_age;                               // one of above, once set
 #define HBEAT_MS        60000                   // heatbeat interval, millis
 
 // state
-static DXSpot *dxc_spots;                       // malloced list of all spots
-static int n_dxspots;                           // n spots in dxc_spots
+#define DXC_MAXSPOTS    8192                    // max live spots, must be power of 2
+#define DXC_RINGN       (2*DXC_MAXSPOTS)        // n dxc_spots slots
+#define DXC_HASHN       (2*DXC_MAXSPOTS)        // n dxc_hash slots, never more than half full
+typedef struct {
+    int slot;                                   // dxc_spots index, -1 if empty
+    int band;                                   // HamBandSetting of dxc_spots[slot]
+} DXCHashEntry;
+static DXSpot *dxc_spots;                       // malloced ring of DXC_RINGN spots
+static int dxc_tail, dxc_head;                  // live spots are [dxc_tail, dxc_head)
+static int n_dxspots;                           // n live spots, ie, not counting empty slots
+static DXCHashEntry *dxc_hash;                  // malloced index of live spots by tx_call and band
+static SpotIndex dxc_si;                        // map location index of live dxc_spots window
 static DXSpot *dxwl_spots;                      // malloced list, filtered for display, count in dxc_ss.n_data
+static SpotIndex dxwl_si;                       // map location index of dxwl_spots
+static int n_dxwl_malloc;                       // n dxwl_spots malloced
+static int dxwl_next;                           // first dxc_spots slot not yet checked for dxwl_spots
+static bool dxwl_redo;                          // set when dxwl_spots must be rebuilt from scratch
+static uint32_t dxwl_adif_gen;                  // getADIFGeneration() when dxwl_spots last built
 static ScrollState dxc_ss;                      // scrolling info, and count of dxwl_spots
 static bool dxc_showbio;                        // whether click shows bio
 static bool dxc_spots_changed;                  // set to rebuild display because dxc_spots changed
@@ -88,31 +108,194 @@ static void drawClearListBtn (bool draw)
  */
 static bool showingNewSpot(void)
 {
-    return (scrolledaway_tm > 0 && n_dxspots > 0 && dxc_spots[n_dxspots-1].spotted > scrolledaway_tm);
+    return (scrolledaway_tm > 0 && n_dxspots > 0 && dxc_spots[dxc_head-1].spotted > scrolledaway_tm);
+}
+
+/* return dxc_hash index for the given tx_call and band, which will either match or be empty
+ */
+static int findDXCHash (const char *tx_call, int band)
+{
+    // FNV-1a of call and band
+    uint32_t h = 2166136261U;
+    for (const char *cp = tx_call; *cp; cp++)
+        h = (h ^ (uint8_t)*cp) * 16777619U;
+    h = (h ^ (uint8_t)band) * 16777619U;
+
+    for (int i = h & (DXC_HASHN-1); ; i = (i+1) & (DXC_HASHN-1)) {
+        const DXCHashEntry &e = dxc_hash[i];
+        if (e.slot < 0 || (e.band == band && strcmp (dxc_spots[e.slot].tx_call, tx_call) == 0))
+            return (i);
+    }
+}
+
+/* remove dxc_hash[i], shifting back any later entries in its probe chain so all stay reachable
+ */
+static void rmDXCHash (int i)
+{
+    dxc_hash[i].slot = -1;
+    for (int j = (i+1) & (DXC_HASHN-1); dxc_hash[j].slot >= 0; j = (j+1) & (DXC_HASHN-1)) {
+        DXCHashEntry e = dxc_hash[j];
+        dxc_hash[j].slot = -1;
+        dxc_hash[findDXCHash (dxc_spots[e.slot].tx_call, e.band)] = e;
+    }
+}
+
+/* add dxc_spots[slot] with the given band to dxc_hash
+ */
+static void addDXCHash (int slot, int band)
+{
+    DXCHashEntry &e = dxc_hash[findDXCHash (dxc_spots[slot].tx_call, band)];
+    e.slot = slot;
+    e.band = band;
 }
 
-/* rebuild dxwl_spots from dxc_spots
+/* empty dxc_spots[slot], which must be live, and remove from dxc_hash
+ */
+static void rmDXCSpot (int slot)
+{
+    DXSpot &spot = dxc_spots[slot];
+    rmDXCHash (findDXCHash (spot.tx_call, findHamBand (spot.kHz)));
+    spot = {};
+    n_dxspots--;
+    spotIndexChanged (dxc_si);
+}
+
+/* move the live spots to the front of dxc_spots and reindex
+ */
+static void compactDXCSpots (void)
+{
+    int new_next = 0;
+    int n = 0;
+    for (int i = dxc_tail; i < dxc_head; i++) {
+        if (i == dxwl_next)
+            new_next = n;
+        if (dxc_spots[i].tx_call[0] != '\0')
+            dxc_spots[n++] = dxc_spots[i];
+    }
+    dxwl_next = dxwl_next >= dxc_head ? n : new_next;
+    dxc_tail = 0;
+    dxc_head = n;
+
+    for (int i = 0; i < DXC_HASHN; i++)
+        dxc_hash[i].slot = -1;
+    for (int i = 0; i < n; i++)
+        addDXCHash (i, findHamBand (dxc_spots[i].kHz));
+}
+
+/* add spot with the given band to the head of dxc_spots and dxc_hash.
+ */
+static void pushDXCSpot (const DXSpot &spot, int band)
+{
+    // first time
+    if (!dxc_spots) {
+        dxc_spots = (DXSpot *) malloc (DXC_RINGN * sizeof(DXSpot));
+        dxc_hash = (DXCHashEntry *) malloc (DXC_HASHN * sizeof(DXCHashEntry));
+        if (!dxc_spots || !dxc_hash)
+            fatalError ("No memory for %d DX spots", DXC_MAXSPOTS);
+        for (int i = 0; i < DXC_HASHN; i++)
+            dxc_hash[i].slot = -1;
+        dxc_tail = dxc_head = n_dxspots = dxwl_next = 0;
+    }
+
+    // drop oldest if full
+    if (n_dxspots == DXC_MAXSPOTS) {
+        while (dxc_spots[dxc_tail].tx_call[0] == '\0')
+            dxc_tail++;
+        dxcLog ("%s %g: dropped because list is full\n", dxc_spots[dxc_tail].tx_call, dxc_spots[dxc_tail].kHz);
+        rmDXCSpot (dxc_tail++);
+    }
+
+    // slide back if at the end
+    if (dxc_head == DXC_RINGN)
+        compactDXCSpots();
+
+    dxc_spots[dxc_head] = spot;
+    addDXCHash (dxc_head++, band);
+    n_dxspots++;
+    spotIndexChanged (dxc_si);
+}
+
+/* remove spots from the tail of dxc_spots that are older than MAXKEEP_DT.
+ * return whether any were removed.
+ */
+static bool expireDXCSpots (void)
+{
+    time_t ancient = myNow() - MAXKEEP_DT;
+    bool any = false;
+    while (dxc_tail < dxc_head) {
+        DXSpot &spot = dxc_spots[dxc_tail];
+        if (spot.tx_call[0] != '\0') {
+            if (spot.spotted >= ancient)
+                break;
+            dxcLog ("%s %g: aged out\n", spot.tx_call, spot.kHz);
+            rmDXCSpot (dxc_tail);
+            any = true;
+        }
+        dxc_tail++;
+    }
+    return (any);
+}
+
+/* return whether the given dxwl_spots entry is still the live version of its spot
+ */
+static bool dxwlSpotIsLive (const DXSpot &wl_spot)
+{
+    const DXCHashEntry &e = dxc_hash[findDXCHash (wl_spot.tx_call, findHamBand (wl_spot.kHz))];
+    return (e.slot >= 0 && dxc_spots[e.slot].spotted == wl_spot.spotted);
+}
+
+/* bring dxwl_spots up to date with dxc_spots.
+ * spots already listed are kept if still live and young enough, then only spots added since are checked
+ * against the watch list. start over if dxwl_redo is set or ADIF, which the watch list may use, changed.
  */
 static void rebuildDXWatchList(void)
 {
     // update ADIF if in use in case our WL uses it
     freshenADIFFile();
+    if (getADIFGeneration() != dxwl_adif_gen) {
+        dxwl_adif_gen = getADIFGeneration();
+        dxwl_redo = true;
+    }
 
-    // extract qualifying spots
+    // prune or restart existing list
     time_t oldest = myNow() - 60*dxc_age;               // oldest time to display, seconds
-    dxc_ss.n_data = 0;                                  // reset count, don't bother to resize dxwl_spots
-    for (int i = 0; i < n_dxspots; i++) {
+    if (dxwl_redo || !dxc_spots) {
+        dxc_ss.n_data = 0;                              // reset count, don't bother to resize dxwl_spots
+        dxwl_next = dxc_tail;
+        dxwl_redo = false;
+    } else {
+        int n_keep = 0;
+        for (int i = 0; i < dxc_ss.n_data; i++) {
+            const DXSpot &spot = dxwl_spots[i];
+            if (spot.spotted >= oldest && dxwlSpotIsLive (spot))
+                dxwl_spots[n_keep++] = spot;
+        }
+        dxc_ss.n_data = n_keep;
+    }
+
+    // extract qualifying spots added since last time
+    bool in_order = true;
+    if (dxwl_next < dxc_tail)
+        dxwl_next = dxc_tail;
+    for (int i = dxwl_next; i < dxc_head; i++) {
         DXSpot &spot = dxc_spots[i];
-        if (spot.spotted >= oldest && checkWatchListSpot (WLID_DX, spot) != WLS_NO) {
-            dxwl_spots = (DXSpot *) realloc (dxwl_spots, (dxc_ss.n_data+1) * sizeof(DXSpot));
-            if (!dxwl_spots)
-                fatalError ("No mem for %d watch list spots", dxc_ss.n_data+1);
+        if (spot.tx_call[0] != '\0' && spot.spotted >= oldest && checkWatchListSpot (WLID_DX, spot) != WLS_NO) {
+            if (dxc_ss.n_data + 1 > n_dxwl_malloc) {
+                dxwl_spots = (DXSpot *) realloc (dxwl_spots, (n_dxwl_malloc += 100) * sizeof(DXSpot));
+                if (!dxwl_spots)
+                    fatalError ("No mem for %d watch list spots", n_dxwl_malloc);
+            }
+            if (dxc_ss.n_data > 0 && spot.spotted < dxwl_spots[dxc_ss.n_data-1].spotted)
+                in_order = false;
             dxwl_spots[dxc_ss.n_data++] = spot;
         }
     }
+    dxwl_next = dxc_head;
 
-    // resort and scroll to newest
-    qsort (dxwl_spots, dxc_ss.n_data, sizeof(DXSpot), qsDXCSpotted);
+    // resort only if needed, then scroll to newest
+    if (!in_order)
+        qsort (dxwl_spots, dxc_ss.n_data, sizeof(DXSpot), qsDXCSpotted);
+    spotIndexChanged (dxwl_si);
     dxc_ss.scrollToNewest();
 }
 
@@ -208,49 +391,42 @@ static void addDXClusterSpot (DXSpot &new_spot, bool set_dx)
     // handy
     HamBandSetting new_band = findHamBand(new_spot.kHz);
 
-    // check for dup, and remove any ancient spots along the way
-    bool same_spot = false;
-    for (int i = 0; i < n_dxspots; i++) {
-        DXSpot &spot = dxc_spots[i];
-        if (spot.spotted < ancient) {
-            dxcLog ("%s %g: aged out\n", spot.tx_call, spot.kHz);
-            memmove (&dxc_spots[i], &dxc_spots[i+1], (--n_dxspots - i) * sizeof(DXSpot));
-            i -= 1;                                     // examine new [i] again next loop
-            dxc_spots_changed = true;                   // update GUI with updated list
-        } else if (!strcmp (spot.tx_call, new_spot.tx_call) && findHamBand (spot.kHz) == new_band) {
-            // consider dupe if same tx call and band
-            int spt_hr = hour(spot.spotted);
-            int spt_mn = minute(spot.spotted);
-            int new_hr = hour(new_spot.spotted);
-            int new_mn = minute(new_spot.spotted);
-            same_spot = true;
-            if (new_spot.spotted > spot.spotted) {
-                dxcLog ("%s %g: updated %02d%02dZ > %02d%02dZ\n", new_spot.tx_call, new_spot.kHz,
-                                                                new_hr, new_mn, spt_hr, spt_mn);
-                spot = new_spot;                        // update info
-                dxc_spots_changed = true;               // update GUI with new age
-            } else if (new_spot.spotted == spot.spotted) {
-                dxcLog ("%s %g: dup time %02d%02dZ\n", spot.tx_call, spot.kHz, spt_hr, spt_mn);
-            } else {
-                dxcLog ("%s %g: superseded %02d%02dZ < %02d%02dZ\n", spot.tx_call, spot.kHz,
-                                                                new_hr, new_mn, spt_hr, spt_mn);
-            }
+    // remove any ancient spots
+    if (dxc_spots && expireDXCSpots())
+        dxc_spots_changed = true;                       // update GUI with updated list
+
+    // check for dup, ie, same tx call and band
+    int dup_slot = dxc_spots ? dxc_hash[findDXCHash (new_spot.tx_call, new_band)].slot : -1;
+    if (dup_slot >= 0) {
+        DXSpot &spot = dxc_spots[dup_slot];
+        int spt_hr = hour(spot.spotted);
+        int spt_mn = minute(spot.spotted);
+        int new_hr = hour(new_spot.spotted);
+        int new_mn = minute(new_spot.spotted);
+        if (new_spot.spotted > spot.spotted) {
+            dxcLog ("%s %g: updated %02d%02dZ > %02d%02dZ\n", new_spot.tx_call, new_spot.kHz,
+                                                            new_hr, new_mn, spt_hr, spt_mn);
+            // move to head so the ring stays in order of time, leaving old slot empty
+            rmDXCSpot (dup_slot);
+            pushDXCSpot (new_spot, new_band);
+            dxc_spots_changed = true;                   // update GUI with new age
+        } else if (new_spot.spotted == spot.spotted) {
+            dxcLog ("%s %g: dup time %02d%02dZ\n", spot.tx_call, spot.kHz, spt_hr, spt_mn);
+        } else {
+            dxcLog ("%s %g: superseded %02d%02dZ < %02d%02dZ\n", spot.tx_call, spot.kHz,
+                                                            new_hr, new_mn, spt_hr, spt_mn);
         }
-    }
-    
-    // that's it if already in dxc_spots
-    if (same_spot)
+
+        // that's it if already in dxc_spots
         return;
+    }
 
     // tweak map location for unique picking
     ditherLL (new_spot.tx_ll);
     ditherLL (new_spot.rx_ll);
 
     // append to dxc_spots
-    dxc_spots = (DXSpot *) realloc (dxc_spots, (n_dxspots+1) * sizeof(DXSpot));
-    if (!dxc_spots)
-        fatalError ("No memory for %d DX spots", n_dxspots+1);
-    dxc_spots[n_dxspots++] = new_spot;
+    pushDXCSpot (new_spot, new_band);
 
     // set new DX if desired
     if (set_dx) {
@@ -401,15 +577,22 @@ static void resetDXMem()
 {
     if (dxc_spots) {
         free (dxc_spots);
+        free (dxc_hash);
         dxc_spots = NULL;
-        n_dxspots = 0;
+        dxc_hash = NULL;
+        dxc_tail = dxc_head = n_dxspots = 0;
     }
 
     if (dxwl_spots) {
         free (dxwl_spots);
         dxwl_spots = NULL;
         dxc_ss.n_data = 0;
+        n_dxwl_malloc = 0;
     }
+    dxwl_next = 0;
+    dxwl_redo = true;
+    spotIndexChanged (dxc_si);
+    spotIndexChanged (dxwl_si);
 }
 
 /* return whether the given host appears to be a multicast address
@@ -627,6 +810,7 @@ static void runDXClusterMenu (const SBox &box)
         dxcLog ("set WL to %s %s\n", mtext.label, mtext.text);
 
         // rebuild with new options
+        dxwl_redo = true;
         rebuildDXWatchList();
 
         // full update to capture any/all changes
@@ -1008,8 +1192,9 @@ bool updateDXCluster (const SBox &box, bool fresh)
     }
 
     if (dxc_ss.atNewest()) {
-        // rebuild displayed spots list when master list changes or oldest spot ages out
-        if (dxc_spots_changed || (n_dxspots > 0 && dxc_spots[0].spotted < myNow() - MAXKEEP_DT)) {
+        // rebuild displayed spots list when master list changes or oldest spot ages out of either
+        if (dxc_spots_changed || (dxc_spots && expireDXCSpots())
+                        || (dxc_ss.n_data > 0 && dxwl_spots[0].spotted < myNow() - 60*dxc_age)) {
             rebuildDXWatchList();
             dxc_spots_changed = false;
             dxc_ss.drawNewSpotsSymbol (false, false);           // insure off
@@ -1042,8 +1227,10 @@ void checkDXCluster()
     if (!isDXClusterConnected())
         return;
 
-    // not crazy fast
+    // not crazy fast, but come back as soon as allowed
     static uint32_t prev_check;
+    static SchedTimer dxc_timer = {"DX cluster"};
+    armSchedTimer (dxc_timer, BGCHECK_DT);
     if (!timesUp (&prev_check, BGCHECK_DT))
         return;
 
@@ -1142,11 +1329,11 @@ bool checkDXClusterTouch (const SCoord &s, const SBox &box)
  * ok to pass back if not displayed because spot list is still intact.
  * N.B. caller should not modify the list
  */
-bool getDXClusterSpots (DXSpot **spp, uint8_t *nspotsp)
+bool getDXClusterSpots (DXSpot **spp, int *nspotsp)
 {
     if (useDXCluster()) {
-        *spp = dxc_spots;
-        *nspotsp = n_dxspots;
+        *spp = dxc_spots + dxc_tail;
+        *nspotsp = dxc_head - dxc_tail;
         return (true);
     }
 
@@ -1182,8 +1369,8 @@ void drawDXClusterSpotsOnMap ()
     bool just_dxpeds = dxpeds_using && !dxc_using;
 
     // must use full list if not using DXC pane
-    DXSpot *spots          = just_dxpeds ? dxc_spots : dxwl_spots;
-    int n_spots            = just_dxpeds ? n_dxspots : dxc_ss.n_data;
+    DXSpot *spots          = just_dxpeds ? dxc_spots + dxc_tail : dxwl_spots;
+    int n_spots            = just_dxpeds ? dxc_head - dxc_tail : dxc_ss.n_data;
     LabelOnMapDot tx_label = just_dxpeds ? LOMD_JUSTDOT : LOMD_ALL;
 
     // draw paths then overlay labels
@@ -1202,9 +1389,9 @@ void drawDXClusterSpotsOnMap ()
     }
 }
 
-/* find closest spot and location on either end to given ll, if any.
+/* find closest spot and location on either end to given ll, if any, and how many spots are near it.
  */
-bool getClosestDXCluster (LatLong &ll, DXSpot *sp, LatLong *llp)
+bool getClosestDXCluster (LatLong &ll, DXSpot *sp, LatLong *llp, int *n_near)
 {
     // skip if we are not running
     if (!isDXClusterConnected())
@@ -1224,12 +1411,13 @@ bool getClosestDXCluster (LatLong &ll, DXSpot *sp, LatLong *llp)
     bool just_dxpeds = dxpeds_using && !dxc_using;
 
     // must use full list if not using DXC pane, else limit to just peds
-    DXSpot *spots  = just_dxpeds ? dxc_spots : dxwl_spots;
-    int n_spots    = just_dxpeds ? n_dxspots : dxc_ss.n_data;
+    DXSpot *spots  = just_dxpeds ? dxc_spots + dxc_tail : dxwl_spots;
+    int n_spots    = just_dxpeds ? dxc_head - dxc_tail : dxc_ss.n_data;
     SpotFilter sfp = just_dxpeds ? findDXPedsCall : NULL;
+    SpotIndex &si  = just_dxpeds ? dxc_si : dxwl_si;
 
     // find closest spot, if any
-    bool found = getClosestSpot (spots, n_spots, sfp, LOME_BOTH, ll, sp, llp);
+    bool found = getClosestSpot (si, spots, n_spots, sfp, LOME_BOTH, ll, sp, llp, n_near);
     if (!found)
         return (false);
 
@@ -1308,10 +1496,16 @@ void sendDXClusterDELLGrid (void)
 const DXSpot *findDXCCall (const char *call)
 {
     // only if dxpeds wants it and we are actually running
-    if (dxpedsWatchingCluster() && isDXClusterConnected()) {
-        for (int i = 0; i < n_dxspots; i++)
-            if (strcasecmp (dxc_spots[i].tx_call, call) == 0)
-                return (&dxc_spots[i]);
+    if (dxpedsWatchingCluster() && isDXClusterConnected() && dxc_spots) {
+        // spots are stored in upper case, check each band
+        char up_call[MAX_SPOTCALL_LEN];
+        quietStrncpy (up_call, call, sizeof(up_call));
+        strtoupper (up_call);
+        for (int b = 0; b <= HAMBAND_NONE; b++) {
+            int slot = dxc_hash[findDXCHash (up_call, b)].slot;
+            if (slot >= 0)
+                return (&dxc_spots[slot]);
+        }
     }
 
     return (NULL);
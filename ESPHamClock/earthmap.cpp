@@ -40,6 +40,86 @@ uint8_t show_lp;                                // display long path, else short
 #define GRAYLINE_POW    (0.75F)                 // cos power exponent, sqrt is too severe, 1 is too gradual
 static SCoord moremap_s;                        // drawMoreEarth() scanning location 
 
+// drawMoreEarth() works a whole row at a time, keeping the lat/lng of the current and next rows.
+// rows include one extra column for the right neighbor of the last pixel and are padded for fractDayRow().
+#define MAPROW_N    ((EARTH_W+1+3)/4*4)         // n columns in each row buffer, multiple of 4
+typedef struct {
+    float lat[MAPROW_N], lng[MAPROW_N];         // degrees, lat is NAN if not over map
+    int y;                                      // screen row, -1 if unknown
+} MapRowLL;
+typedef struct {
+    MapRowLL rows[2];                           // current and next row, in either order
+    float fday[MAPROW_N];                       // fract_day for each column of current row
+} MapRowCtx;                                    // one for main thread and each render worker
+static MapRowCtx map_ctx;                       // used by main thread
+static void resetMapRows(void);
+
+// lat/lng of every map pixel depends only on the following so it is computed once into a table.
+// rows are MAPROW_N wide like MapRowLL and there is one extra row for the neighbors below the last.
+typedef struct {
+    float de_lat, de_lng;                       // DE, rads
+    uint8_t proj;                               // MapProjection
+    PanZoom pz;                                 // pan and zoom
+    SBox b;                                     // map_b
+    int16_t center_lng;                         // getCenterLng() unless CM_USER
+} MapLLKey;
+static MapLLKey mapll_key;                      // conditions of current table
+static float *mapll_lat, *mapll_lng;            // [(EARTH_H+1)*MAPROW_N] degrees, lat NAN if not on globe
+static float mapll_build_ms;                    // time to build most recent table
+static int mapll_n_builds;                      // n times table has been built
+static MapLLKey proj_gen_key;                   // conditions when proj_gen last changed
+static uint32_t proj_gen;                       // changes whenever ll2s() results may change
+static bool s2llGlobe (const SCoord &s, LatLong &ll);
+
+// after one full sweep, each row only redraws the blocks of pixels that may be near the terminator, the rest
+// are restored from the earth layer kept by tft just to erase whatever was drawn on top during the last sweep.
+#define MAPBLK_W        32                      // columns in each block, multiple of 4
+#define MAPBLK_N        ((EARTH_W+MAPBLK_W-1)/MAPBLK_W) // blocks in each row
+#define MAP_FULL_MS     600000                  // full sweep at least this often just to be safe, millis
+#define MAP_REST_MS     500                     // pause between sweeps so the main loop may sleep, millis
+typedef struct {
+    float cmin, cmax;                           // range of cos of angle from subsolar point of each pixel
+    float sun_lat, sun_lng;                     // subsolar point when range was found, rads
+} MapBlk;
+static MapBlk map_blks[EARTH_H][MAPBLK_N];      // each block of each row
+static int16_t map_day_w[EARTH_H][EARTH_W];     // day weight 0..256 of each pixel last drawn, -1 if none
+static bool map_full_pending = true;            // whether next sweep must draw everything
+static bool map_sweep_full;                     // whether current sweep is drawing everything
+static uint32_t map_full_ms;                    // millis() of last full sweep
+static int map_full_builds;                     // mapll_n_builds at last full sweep
+static uint32_t map_pix_count;                  // earth pixels drawn since map_pix_ms
+static uint32_t map_pix_ms;                     // millis() when map_pix_count was last reset
+static uint32_t map_pix_per_min;                // earth pixels drawn during previous minute
+static bool map_resting;                        // whether waiting for map_timer to start the next sweep
+static SCoord ib_ms;                            // cursor when drawInfoBox() last ran, if ib_ms_ok
+static bool ib_ms_ok;                           // whether cursor was over the app then
+static SchedTimer map_timer = {"map sweep"};    // when to continue drawing the map
+
+// optional pool of threads that render the whole map in horizontal tiles while the main loop carries on.
+// the overlays are drawn by the main thread once all tiles are complete.
+int map_workers;                                // n render threads, 0 to draw one row per loop
+const int map_workers_max = 32;                 // largest map_workers
+typedef struct {
+    uint16_t y0, y1;                            // screen rows [y0,y1)
+    float ms;                                   // time to render
+    uint32_t n_pix;                             // earth pixels drawn
+} MapTile;
+static MapTile map_tiles[MAX_MAP_TILES];        // tiles of current sweep
+static int map_n_tiles;                         // n tiles in map_tiles[]
+static int map_next_tile;                       // index of next tile for a worker to claim
+static int map_tiles_done;                      // n tiles complete
+static int map_tiles_busy;                      // n tiles being rendered now
+static volatile bool map_tiles_abort;           // tell workers to abandon their tile
+static bool map_tiles_running;                  // whether a tiled sweep is in progress, main thread only
+static float map_tile_ms[MAX_MAP_TILES];        // tile times of last complete sweep
+static SBox map_overlays[MAX_MAP_OVERLAYS];     // boxes drawn over the map when the sweep started
+static int map_n_overlays;                      // n in map_overlays[]
+static int map_n_tile_ms;                       // n in map_tile_ms[]
+static pthread_mutex_t map_tile_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t map_tile_go = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t map_tile_done = PTHREAD_COND_INITIALIZER;
+static void mapPRNotify (int x, int y, int w, int h);
+
 // cached grid colors
 uint16_t EARTH_GRIDC, EARTH_GRIDC00;            // main and highlighted
 
@@ -915,7 +995,6 @@ static void drawMapMenu()
  */
 void initEarthMap()
 {
-
     // completely erase map
     fillSBox (map_b, RA8875_BLACK);
 
@@ -957,67 +1036,684 @@ void initEarthMap()
     // init scan line in map_b
     moremap_s.x = 0;                    // avoid updateCircumstances() first call to drawMoreEarth()
     moremap_s.y = map_b.y;
+    resetMapRows();
+    map_full_pending = true;
+    hurryMapSweep();
+
+    // anything projected before may have moved
+    proj_gen++;
 
     // now main loop can resume with drawMoreEarth()
 }
 
-/* display another earth map row at mmoremap_s.
+/* capture the current conditions on which the lat/lng table depends
  */
-void drawMoreEarth()
+static void getMapLLKey (MapLLKey &k)
 {
+    memset (&k, 0, sizeof(k));                  // for memcmp
+    k.de_lat = de_ll.lat;
+    k.de_lng = de_ll.lng;
+    k.proj = map_proj;
+    k.pz.zoom = pan_zoom.zoom;                  // fields separately to avoid padding
+    k.pz.pan_x = pan_zoom.pan_x;
+    k.pz.pan_y = pan_zoom.pan_y;
+    k.b = map_b;
+    k.center_lng = core_map != CM_USER ? getCenterLng() : 0;
+}
 
-    uint16_t last_x = map_b.x + EARTH_W - 1;
+/* (re)build the lat/lng table if any of its conditions have changed.
+ */
+static void checkMapLLTable()
+{
+    MapLLKey k;
+    getMapLLKey (k);
+    if (mapll_lat && memcmp (&k, &mapll_key, sizeof(k)) == 0)
+        return;
 
-    // draw next row
-    for (moremap_s.x = map_b.x; moremap_s.x <= last_x; moremap_s.x++)
-        drawMapCoord (moremap_s);               // does not draw grid
+    struct timeval tv0, tv1;
+    gettimeofday (&tv0, NULL);
 
-    // advance row, wrap and reset and finish up at the end
-    if ((moremap_s.y += 1) >= map_b.y + EARTH_H) {
+    const size_t n_ll = (EARTH_H+1) * MAPROW_N;
+    if (!mapll_lat) {
+        mapll_lat = (float *) malloc (n_ll * sizeof(float));
+        mapll_lng = (float *) malloc (n_ll * sizeof(float));
+        if (!mapll_lat || !mapll_lng)
+            fatalError ("No memory for map table: %lu", (unsigned long)(2*n_ll*sizeof(float)));
+    }
 
-        // draw goodies unless showing CM_USER
-        if (core_map != CM_USER) {
-            drawMapGrid();
-            drawSatPathAndFoot();
-            if (waiting4DXPath())
-                drawDXPath();
-            drawPSKPaths ();
-            drawAllSymbols();
-            drawSatName();
-            drawInfoBox();
+    for (int r = 0; r <= EARTH_H; r++) {
+        float *lat = &mapll_lat[r*MAPROW_N];
+        float *lng = &mapll_lng[r*MAPROW_N];
+        for (int c = 0; c < MAPROW_N; c++) {
+            LatLong ll;
+            SCoord s = {(uint16_t)(map_b.x + c), (uint16_t)(map_b.y + r)};
+            if (c <= EARTH_W && s2llGlobe (s, ll)) {
+                lat[c] = ll.lat_d;
+                lng[c] = ll.lng_d;
+            } else {
+                lat[c] = lng[c] = NAN;
+            }
         }
+    }
 
-        // draw now
-        tft.drawPR();
+    mapll_key = k;
+    mapll_n_builds++;
+
+    gettimeofday (&tv1, NULL);
+    mapll_build_ms = TVDELUS (tv0, tv1) / 1000.0F;
+    Serial.printf ("MAPLL: %s table %lu bytes built in %.1f ms\n", map_projnames[map_proj],
+                                (unsigned long)(2*n_ll*sizeof(float)), mapll_build_ms);
+}
+
+/* return a value that changes whenever the projection, DE, pan/zoom or map box changes, ie, whenever
+ * screen coords found by ll2s() and ll2sRaw() may differ. useful to know when to discard saved coords.
+ */
+uint32_t getMapProjGen (void)
+{
+    MapLLKey k;
+    getMapLLKey (k);
+    if (memcmp (&k, &proj_gen_key, sizeof(k)) != 0) {
+        proj_gen_key = k;
+        proj_gen++;
+    }
+    return (proj_gen);
+}
+
+/* report size of lat/lng table and time of most recent build
+ */
+void getMapLLTableStats (size_t &bytes, float &build_ms, int &n_builds)
+{
+    bytes = mapll_lat ? 2*(EARTH_H+1)*MAPROW_N*sizeof(float) : 0;
+    build_ms = mapll_build_ms;
+    n_builds = mapll_n_builds;
+}
+
+/* forget any rows saved in the given context by getMapRowLL()
+ */
+static void resetMapRowCtx (MapRowCtx &ctx)
+{
+    ctx.rows[0].y = ctx.rows[1].y = -1;
+}
+
+/* forget any rows saved by the main thread, and insure table is current.
+ */
+static void resetMapRows()
+{
+    resetMapRowCtx (map_ctx);
+    checkMapLLTable();
+}
+
+/* capture the boxes now drawn over the map for getMapRowLL() to use throughout the coming sweep.
+ * N.B. main thread only, never while the render workers are busy.
+ */
+static void snapMapOverlays()
+{
+    map_n_overlays = getMapOverlays (map_overlays);
+}
 
-        // check pending events
-        if (mapmenu_pending) {
-            drawMapMenu();
-            mapmenu_pending = false;
+/* return lat/lng of each column in screen row y, copying it into ctx only if not already saved.
+ * keep is a row that must not be overwritten, if any.
+ * N.B. called from the render workers so must use only the sweep snapshots, never main thread state.
+ */
+static const MapRowLL *getMapRowLL (MapRowCtx &ctx, uint16_t y, const MapRowLL *keep)
+{
+    for (int i = 0; i < 2; i++)
+        if (ctx.rows[i].y == y)
+            return (&ctx.rows[i]);
+
+    MapRowLL &r = ctx.rows[keep == &ctx.rows[0] ? 1 : 0];
+    int tr = y - map_b.y;
+    if (tr >= 0 && tr <= EARTH_H) {
+        memcpy (r.lat, &mapll_lat[tr*MAPROW_N], sizeof(r.lat));
+        memcpy (r.lng, &mapll_lng[tr*MAPROW_N], sizeof(r.lng));
+        // remove whatever was drawn over the map when the sweep started
+        for (int i = 0; i < map_n_overlays; i++) {
+            const SBox &b = map_overlays[i];
+            if (y < b.y || y >= b.y + b.h)
+                continue;
+            int c0 = b.x > map_b.x ? b.x - map_b.x : 0;
+            int c1 = b.x + b.w - map_b.x <= EARTH_W ? b.x + b.w - map_b.x : EARTH_W + 1;
+            for (int c = c0; c < c1; c++)
+                r.lat[c] = r.lng[c] = NAN;
         }
-        if (map_popup.pending) {
-            drawMapPopup();
-            map_popup.pending = false;
+    } else {
+        for (int c = 0; c < MAPROW_N; c++)
+            r.lat[c] = r.lng[c] = NAN;
+    }
+    r.y = y;
+
+    return (&r);
+}
+
+/* given cosine of angle from subsolar point return fraction of daylight
+ */
+static float fractDay (float cos_t)
+{
+    if (!night_on || cos_t > 0) {
+        // < 90 deg: sunlit
+        return (1);
+    } else if (cos_t > GRAYLINE_COS) {
+        // blend from day to night
+        return (1 - powf(cos_t/GRAYLINE_COS, GRAYLINE_POW));
+    } else {
+        // night side
+        return (0);
+    }
+}
+
+#if defined(__GNUC__)
+
+/* vector of 4 floats and matching comparison result, compiles to SSE2 or NEON where available.
+ * N.B. GCC and clang both broadcast a scalar operand as needed.
+ */
+typedef float v4sf __attribute__ ((vector_size (16)));
+typedef int32_t v4si __attribute__ ((vector_size (16)));
+
+/* return each a where m else b
+ */
+static inline v4sf v4select (v4si m, v4sf a, v4sf b)
+{
+    return ((v4sf)(((v4si)a & m) | ((v4si)b & ~m)));
+}
+
+/* return sin(x) for x in [-3pi,3pi], good to a few parts per million which is plenty for shading.
+ */
+static inline v4sf v4sin (v4sf x)
+{
+    // wrap to [-pi,pi] then fold to [-pi/2,pi/2]
+    x = v4select (x > M_PIF, x - 2*M_PIF, x);
+    x = v4select (x < -M_PIF, x + 2*M_PIF, x);
+    x = v4select (x > M_PI_2F, M_PIF - x, x);
+    x = v4select (x < -M_PI_2F, -M_PIF - x, x);
+
+    // taylor to x^9
+    v4sf x2 = x*x;
+    return (x * (1.0F + x2*(-1.0F/6 + x2*(1.0F/120 + x2*(-1.0F/5040 + x2*(1.0F/362880))))));
+}
+
+#endif // __GNUC__
+
+/* set cos_t[] to the cosine of the angle from the subsolar point for the first n locations in lat_d[] and
+ * lng_d[], degrees. this is done 4 at a time if possible so n is rounded up to a multiple of 4;
+ * N.B. caller's arrays must allow for this.
+ */
+static void sunCosRow (const float *lat_d, const float *lng_d, float *cos_t, int n)
+{
+#if defined(__GNUC__)
+
+    for (int i = 0; i < n; i += 4) {
+        v4sf lat, lng;
+        memcpy (&lat, &lat_d[i], sizeof(lat));
+        memcpy (&lng, &lng_d[i], sizeof(lng));
+        lat = lat * (M_PIF/180);
+        lng = lng * (M_PIF/180);
+
+        v4sf c = ssslat*v4sin(lat) + csslat*v4sin(M_PI_2F-lat)*v4sin(M_PI_2F-(sun_ss_ll.lng-lng));
+        memcpy (&cos_t[i], &c, sizeof(c));
+    }
+
+#else
+
+    for (int i = 0; i < n; i++) {
+        float lat = deg2rad(lat_d[i]);
+        float lng = deg2rad(lng_d[i]);
+        cos_t[i] = ssslat*sinf(lat) + csslat*cosf(lat)*cosf(sun_ss_ll.lng-lng);
+    }
+
+#endif // !__GNUC__
+}
+
+/* return whether no pixel in the given block can have changed its day weight since it was last drawn.
+ * the angle of any location from the subsolar point changes by no more than the subsolar point itself has
+ * moved, so a block that was all day or all night stays that way until the sun has moved far enough.
+ */
+static bool mapBlkQuiet (const MapBlk &bk)
+{
+    // all day regardless
+    if (!night_on)
+        return (true);
+
+    // cos and sin of how far the sun has moved since the block was drawn, with a little margin for
+    // float error. N.B. sin loses meaning beyond 90 degrees but we give up long before then.
+    float cos_d = sinf(bk.sun_lat)*ssslat + cosf(bk.sun_lat)*csslat*cosf(sun_ss_ll.lng - bk.sun_lng);
+    if (cos_d < 0.9F)
+        return (false);
+    float sin_d = (cos_d < 1 ? sqrtf (1 - cos_d*cos_d) : 0) + 1e-3F;
+
+    // still all day if no pixel has moved within 90 degrees of the terminator
+    if (bk.cmin >= sin_d)
+        return (true);
+
+    // still all night if no pixel has moved to within the twilight band
+    const float sin_g = sqrtf (1 - GRAYLINE_COS*GRAYLINE_COS);
+    if (bk.cmax <= GRAYLINE_COS*cos_d - sin_g*sin_d)
+        return (true);
+
+    return (false);
+}
+
+/* draw the given screen row of the earth map using the given working space, return n earth pixels drawn.
+ * if full, this is the same as calling drawMapCoord() for each pixel but shares all the neighbor conversions.
+ * otherwise only pixels whose day weight has changed are drawn, the rest are restored from the earth layer.
+ * N.B. may be called from render workers so only touch this row.
+ */
+static uint32_t drawMapRow (MapRowCtx &ctx, uint16_t y, bool full)
+{
+    const MapRowLL *r0 = getMapRowLL (ctx, y, NULL);
+    const MapRowLL *r1 = getMapRowLL (ctx, y+1, r0);
+    int row = y - map_b.y;
+    uint32_t n_pix = 0;
+
+    // restore each run of pixels over the map to erase whatever was drawn over them.
+    // also force any block with pixels that were not drawn last time, such as when an overlay moves.
+    bool blk_force[MAPBLK_N];
+    memset (blk_force, 0, sizeof(blk_force));
+    if (!full) {
+        for (int c0 = 0; c0 < EARTH_W; ) {
+            if (isnan (r0->lat[c0])) {
+                map_day_w[row][c0++] = -1;
+                continue;
+            }
+            int c1 = c0;
+            while (c1 < EARTH_W && !isnan (r0->lat[c1])) {
+                if (map_day_w[row][c1] < 0)
+                    blk_force[c1/MAPBLK_W] = true;
+                c1++;
+            }
+            tft.restoreEarthRow (map_b.x + c0, y, c1 - c0);
+            c0 = c1;
+        }
+    }
+
+    // check each block
+    for (int b = 0; b < MAPBLK_N; b++) {
+
+        // skip if nothing can have changed
+        MapBlk &bk = map_blks[row][b];
+        if (!full && !blk_force[b] && mapBlkQuiet (bk))
+            continue;
+
+        // find cos from sun of each pixel in block
+        int b0 = b*MAPBLK_W;
+        int b1 = b0 + MAPBLK_W < EARTH_W ? b0 + MAPBLK_W : EARTH_W;
+        sunCosRow (&r0->lat[b0], &r0->lng[b0], &ctx.fday[b0], b1-b0);
+
+        // convert to day fraction, noting range of cos and which day weights changed
+        bool changed[MAPBLK_W];
+        bk.cmin = 2;
+        bk.cmax = -2;
+        bk.sun_lat = sun_ss_ll.lat;
+        bk.sun_lng = sun_ss_ll.lng;
+        for (int c = b0; c < b1; c++) {
+            int16_t &day_w = map_day_w[row][c];
+            if (isnan (r0->lat[c])) {
+                changed[c-b0] = false;
+                day_w = -1;
+                continue;
+            }
+            float cos_t = ctx.fday[c];
+            if (cos_t < bk.cmin)
+                bk.cmin = cos_t;
+            if (cos_t > bk.cmax)
+                bk.cmax = cos_t;
+            ctx.fday[c] = fractDay (cos_t);
+            int16_t new_w = ctx.fday[c]*256;                    // same as plotEarthPixel()
+            changed[c-b0] = full || new_w != day_w;
+            day_w = new_w;
+        }
+
+        // draw each run of changed pixels
+        for (int c0 = b0; c0 < b1; ) {
+            if (!changed[c0-b0]) {
+                c0++;
+                continue;
+            }
+            int c1 = c0 + 1;
+            while (c1 < b1 && changed[c1-b0])
+                c1++;
+            tft.plotEarthRow (map_b.x + c0, y, c1 - c0, &r0->lat[c0], &r0->lng[c0], &r1->lat[c0],
+                                &r1->lng[c0], &ctx.fday[c0]);
+            n_pix += c1 - c0;
+            c0 = c1;
+        }
+    }
+
+    return (n_pix);
+}
+
+/* report number of earth pixels drawn during the previous minute and whether the sweep is incremental
+ */
+void getMapPixelStats (uint32_t &per_min, bool &incremental)
+{
+    per_min = map_pix_per_min;
+    incremental = !map_sweep_full;
+}
+
+/* thread that renders map tiles as they become available, forever.
+ */
+static void *mapTileThread (void *unused)
+{
+    (void) unused;
+
+    // private working space
+    MapRowCtx *ctx = (MapRowCtx *) malloc (sizeof(MapRowCtx));
+    if (!ctx)
+        fatalError ("No memory for map worker");
+
+    pthread_mutex_lock (&map_tile_lock);
+    for (;;) {
+
+        // wait for a tile
+        while (map_next_tile >= map_n_tiles)
+            pthread_cond_wait (&map_tile_go, &map_tile_lock);
+        MapTile &t = map_tiles[map_next_tile++];
+        bool full = map_sweep_full;
+        map_tiles_busy++;
+        pthread_mutex_unlock (&map_tile_lock);
+
+        // render each row unless told to stop
+        struct timeval tv0, tv1;
+        gettimeofday (&tv0, NULL);
+        resetMapRowCtx (*ctx);
+        t.n_pix = 0;
+        for (uint16_t y = t.y0; y < t.y1 && !map_tiles_abort; y++)
+            t.n_pix += drawMapRow (*ctx, y, full);
+        gettimeofday (&tv1, NULL);
+        t.ms = TVDELUS (tv0, tv1) / 1000.0F;
+
+        // report
+        pthread_mutex_lock (&map_tile_lock);
+        map_tiles_busy--;
+        map_tiles_done++;
+        pthread_cond_broadcast (&map_tile_done);
+        if (map_tiles_done == map_n_tiles)
+            wakeMainLoop();
+    }
+
+    return (NULL);
+}
+
+/* start rendering all of map_b in tiles using the worker pool, starting the pool if first time.
+ */
+static void startMapTiles()
+{
+    static bool pool_ok;
+    if (!pool_ok) {
+        for (int i = 0; i < map_workers; i++) {
+            pthread_t tid;
+            int e = pthread_create (&tid, NULL, mapTileThread, NULL);
+            if (e)
+                fatalError ("map worker thread failed: %s", strerror(e));
+            pthread_detach (tid);
         }
+        Serial.printf ("MAP: started %d render workers\n", map_workers);
+        tft.setPRNotify (mapPRNotify);
+        pool_ok = true;
+    }
+
+    // several tiles per worker to balance incremental sweeps where only some rows have work
+    int n_tiles = 4*map_workers < MAX_MAP_TILES ? 4*map_workers : MAX_MAP_TILES;
+
+    snapMapOverlays();
+
+    pthread_mutex_lock (&map_tile_lock);
+    for (int i = 0; i < n_tiles; i++) {
+        map_tiles[i].y0 = map_b.y + i*EARTH_H/n_tiles;
+        map_tiles[i].y1 = map_b.y + (i+1)*EARTH_H/n_tiles;
+    }
+    map_n_tiles = n_tiles;
+    map_next_tile = 0;
+    map_tiles_done = 0;
+    map_tiles_abort = false;
+    pthread_cond_broadcast (&map_tile_go);
+    pthread_mutex_unlock (&map_tile_lock);
+
+    map_tiles_running = true;
+}
+
+/* return whether all tiles of the current sweep are complete.
+ * if wait then block until they are.
+ */
+static bool mapTilesDone (bool wait)
+{
+    pthread_mutex_lock (&map_tile_lock);
+    while (wait && map_tiles_done < map_n_tiles)
+        pthread_cond_wait (&map_tile_done, &map_tile_lock);
+    bool done = map_tiles_done >= map_n_tiles;
+    pthread_mutex_unlock (&map_tile_lock);
+    return (done);
+}
+
+/* abandon any tiled sweep in progress and wait for the workers to let go.
+ * the workers stay idle until the main loop next calls drawMoreEarth(), so there is no need to resume them.
+ */
+static void stopMapTiles()
+{
+    if (!map_tiles_running)
+        return;
+
+    pthread_mutex_lock (&map_tile_lock);
+    map_tiles_abort = true;
+    map_next_tile = map_n_tiles;
+    while (map_tiles_busy > 0)
+        pthread_cond_wait (&map_tile_done, &map_tile_lock);
+    pthread_mutex_unlock (&map_tile_lock);
+
+    // an abandoned full sweep must be done over in full
+    if (map_sweep_full)
+        map_full_pending = true;
+
+    map_tiles_running = false;
+}
+
+/* tft calls this before the main thread draws the given rectangle within map_b, its protected region.
+ * the workers never draw within the overlays noted when the sweep started so those may be redrawn at any time,
+ * anything else must stop them first.
+ */
+static void mapPRNotify (int x, int y, int w, int h)
+{
+    if (!map_tiles_running)
+        return;
 
-        // rotate?
-        checkBGMap();
+    for (int i = 0; i < map_n_overlays; i++) {
+        const SBox &b = map_overlays[i];
+        if (x >= b.x && y >= b.y && x + w <= b.x + b.w && y + h <= b.y + b.h)
+            return;
+    }
 
-        // prep for next
-        updateCircumstances();
-        moremap_s.y = map_b.y;
+    stopMapTiles();
+}
 
-    // #define TIME_MAP_DRAW                             // RBF
-    #if defined(TIME_MAP_DRAW)
-        static struct timeval tv0;
-        struct timeval tv1;
+/* collect the results from each tile of a completed sweep
+ */
+static void collectMapTiles()
+{
+    map_n_tile_ms = map_n_tiles;
+    for (int i = 0; i < map_n_tiles; i++) {
+        map_pix_count += map_tiles[i].n_pix;
+        map_tile_ms[i] = map_tiles[i].ms;
+        if (debugLevel (DEBUG_MAP, 2))
+            Serial.printf ("MAP: tile %2d rows %3d-%3d %7u pixels %7.1f ms\n", i, map_tiles[i].y0,
+                            map_tiles[i].y1-1, map_tiles[i].n_pix, map_tiles[i].ms);
+    }
+    map_tiles_running = false;
+}
+
+/* report n render workers and the time of each tile in the last tiled sweep.
+ * return n tiles in ms[], 0 if not using workers.
+ */
+int getMapTileStats (int &n_workers, float ms[MAX_MAP_TILES])
+{
+    n_workers = map_workers;
+    memcpy (ms, map_tile_ms, map_n_tile_ms * sizeof(float));
+    return (map_n_tile_ms);
+}
+
+/* render one complete earth map in each projection without displaying it and report the time to
+ * build its lat/lng table and then to draw it. then restore the current projection and restart the normal map sweep.
+ */
+void benchmarkEarthMap (float build_ms[MAPP_N], float draw_ms[MAPP_N])
+{
+    uint8_t save_proj = map_proj;
+
+    stopMapTiles();
+
+    for (int i = 0; i < MAPP_N; i++) {
+        map_proj = i;
+        resetMapRows();
+        build_ms[i] = mapll_build_ms;
+
+        struct timeval tv0, tv1;
+        gettimeofday (&tv0, NULL);
+        map_sweep_full = true;
+        if (map_workers > 0) {
+            startMapTiles();
+            (void) mapTilesDone (true);
+            collectMapTiles();
+        } else {
+            snapMapOverlays();
+            for (uint16_t y = map_b.y; y < map_b.y + EARTH_H; y++)
+                map_pix_count += drawMapRow (map_ctx, y, true);
+        }
         gettimeofday (&tv1, NULL);
-        if (tv0.tv_sec != 0)
-            Serial.printf ("****** map %ld us\n", TVDELUS (tv0, tv1));
-        tv0 = tv1;
-    #endif // TIME_MAP_DRAW
 
+        draw_ms[i] = TVDELUS (tv0, tv1) / 1000.0F;
+        Serial.printf ("MAPBENCH: %-10s build %8.1f draw %8.1f ms\n", map_projnames[i], build_ms[i], draw_ms[i]);
     }
+
+    map_proj = save_proj;
+    initEarthMap();
+}
+
+/* decide whether the sweep now starting must draw everything
+ */
+static void startMapSweep()
+{
+    map_sweep_full = map_full_pending || mapll_n_builds != map_full_builds || timesUp (&map_full_ms, MAP_FULL_MS);
+    if (map_sweep_full) {
+        map_full_pending = false;
+        map_full_builds = mapll_n_builds;
+        map_full_ms = millis();
+    }
+}
+
+/* draw the overlays on the completed map, show it and get ready for the next sweep
+ */
+static void finishMapSweep()
+{
+    // note cursor first so any motion while drawing still counts as new
+    ib_ms_ok = tft.getMouse (&ib_ms.x, &ib_ms.y);
+
+    // draw goodies unless showing CM_USER
+    if (core_map != CM_USER) {
+        drawMapGrid();
+        drawSatPathAndFoot();
+        if (waiting4DXPath())
+            drawDXPath();
+        drawPSKPaths ();
+        drawAllSymbols();
+        drawSatName();
+        drawInfoBox();
+    }
+
+    // draw now
+    tft.drawPR();
+
+    // check pending events
+    if (mapmenu_pending) {
+        drawMapMenu();
+        mapmenu_pending = false;
+    }
+    if (map_popup.pending) {
+        drawMapPopup();
+        map_popup.pending = false;
+    }
+
+    // rotate?
+    checkBGMap();
+
+    // prep for next, after a rest
+    updateCircumstances();
+    moremap_s.y = map_b.y;
+    resetMapRows();
+    map_resting = true;
+    armSchedTimer (map_timer, MAP_REST_MS);
+
+// #define TIME_MAP_DRAW                             // RBF
+#if defined(TIME_MAP_DRAW)
+    static struct timeval tv0;
+    struct timeval tv1;
+    gettimeofday (&tv1, NULL);
+    if (tv0.tv_sec != 0)
+        Serial.printf ("****** map %ld us\n", TVDELUS (tv0, tv1));
+    tv0 = tv1;
+#endif // TIME_MAP_DRAW
+}
+
+/* return whether the cursor has moved, or come or gone, since drawInfoBox() last ran.
+ */
+static bool cursorMoved()
+{
+    SCoord ms;
+    bool ms_ok = tft.getMouse (&ms.x, &ms.y);
+    return (ms_ok != ib_ms_ok || (ms_ok && (ms.x != ib_ms.x || ms.y != ib_ms.y)));
+}
+
+/* display another earth map row at mmoremap_s, or check on the render workers if using them.
+ */
+void drawMoreEarth()
+{
+    // wait for rest to end, but the info box and spot highlight must follow the cursor without delay
+    if (map_resting) {
+        if (cursorMoved())
+            hurryMapSweep();
+        if (!schedTimerFired (map_timer))
+            return;
+        map_resting = false;
+    }
+
+    if (map_workers > 0) {
+
+        // start a new sweep or finish when all tiles are complete
+        if (!map_tiles_running) {
+            startMapSweep();
+            startMapTiles();
+        } else if (mapTilesDone (false)) {
+            collectMapTiles();
+            finishMapSweep();
+        }
+
+    } else {
+
+        // draw next row
+        if (moremap_s.y == map_b.y) {
+            startMapSweep();
+            snapMapOverlays();
+        }
+        map_pix_count += drawMapRow (map_ctx, moremap_s.y, map_sweep_full);       // does not draw grid
+
+        // advance row, finish up at the end else come right back for the next
+        if ((moremap_s.y += 1) >= map_b.y + EARTH_H)
+            finishMapSweep();
+        else
+            armSchedTimer (map_timer, 0);
+    }
+
+    // update pixel rate
+    if (timesUp (&map_pix_ms, 60000)) {
+        map_pix_per_min = map_pix_count;
+        map_pix_count = 0;
+        if (debugLevel (DEBUG_MAP, 1))
+            Serial.printf ("MAP: %u pixels drawn in past minute\n", map_pix_per_min);
+    }
+}
+
+/* start the next map sweep now if resting between sweeps, such as when something has changed on the map.
+ */
+void hurryMapSweep()
+{
+    if (map_resting)
+        armSchedTimer (map_timer, 0);
 }
 
 /* convert lat and long in radians to scaled screen coords.
@@ -1162,6 +1858,13 @@ bool s2ll (const SCoord &s, LatLong &ll)
     if (!overMap(s))
         return (false);
 
+    return (s2llGlobe (s, ll));
+}
+
+/* same as s2ll() but without regard to anything drawn over the map.
+ */
+static bool s2llGlobe (const SCoord &s, LatLong &ll)
+{
     switch ((MapProjection)map_proj) {
 
     case MAPP_AZIMUTHAL: {
@@ -1214,6 +1917,10 @@ bool s2ll (const SCoord &s, LatLong &ll)
 
     case MAPP_MERCATOR: {
 
+        // full map_b
+        if (!inBox (s, map_b))
+            return (false);
+
         // straight rectangular mercator projection
         ll.lat_d = 180.0F*((map_b.y + map_b.h/2 - s.y)/(float)pan_zoom.zoom + pan_zoom.pan_y)/map_b.h;
         ll.lng_d = 360.0F*((s.x - map_b.x - map_b.w/2)/(float)pan_zoom.zoom + pan_zoom.pan_x)/map_b.w;
@@ -1290,17 +1997,7 @@ void drawMapCoord (const SCoord &s)
     float cos_t = ssslat*slat + csslat*clat*cosf(sun_ss_ll.lng-lls.lng);
 
     // decide day, night or twilight
-    float fract_day;
-    if (!night_on || cos_t > 0) {
-        // < 90 deg: sunlit
-        fract_day = 1;
-    } else if (cos_t > GRAYLINE_COS) {
-        // blend from day to night
-        fract_day = 1 - powf(cos_t/GRAYLINE_COS, GRAYLINE_POW);
-    } else {
-        // night side
-        fract_day = 0;
-    }
+    float fract_day = fractDay (cos_t);
 
     // draw the full res map point
     tft.plotEarth (s.x, s.y, lls.lat_d, lls.lng_d, llr.lat_d - lls.lat_d, llr.lng_d - lls.lng_d,
@@ -7,6 +7,8 @@
  */
 
 
+#include <sys/stat.h>
+
 #include "HamClock.h"
 
 #define MAX_ACTIVE_SATS 2               // increasing this works here but requires more colors
@@ -71,12 +73,34 @@ static const char esat_sfn[] = "esats.txt";             // local cached file fro
 static const char esat_url[] = "/esats/esats.txt";      // server file URL
 #define MAX_CACHE_AGE   10000                           // max cache age, seconds
 
-// used by readNextSat()
-typedef enum {
-    RNS_INIT = 0,                                       // check user's list
-    RNS_SERVER,                                         // check backend list
-    RNS_DONE                                            // checked both
-} RNS_t;
+// one TLE catalog entry
+typedef struct {
+    char name[NV_SATNAME_LEN];                          // name, spaces are underscores
+    char t1[TLE_LINEL], t2[TLE_LINEL];                  // TLE as read
+    long norad;                                         // catalog number from t2
+    Satellite *sat;                                     // elements, NULL unless both checksums are good
+    bool epoch_ok;                                      // whether epoch is good as of sat_cat_t
+    int next_name, next_norad;                          // next entry in same hash chain, -1 at end
+} SatCatEntry;
+
+// identifies one version of a catalog source file
+typedef struct {
+    ino_t ino;                                          // inode, new when openCachedFile() installs a file
+    off_t size;                                         // size
+    time_t mtime;                                       // modification time, if user file
+} SatCatFile;
+
+// the TLE catalog: user's file then server's, each parsed once and indexed by name and NORAD number.
+#define SATCAT_NHASH    256                             // n hash chains, must be power of 2
+#define SATCAT_RECHECK  3600                            // recheck epochs if older than this, seconds
+static SatCatEntry *sat_cat;                            // malloced, user's entries first
+static int n_sat_cat;                                   // n sat_cat
+static int sat_cat_name_hash[SATCAT_NHASH];             // first sat_cat index for each name hash
+static int sat_cat_norad_hash[SATCAT_NHASH];            // first sat_cat index for each NORAD hash
+static SatCatFile sat_cat_ufile, sat_cat_sfile;         // source files when sat_cat was built
+static bool sat_cat_ok;                                 // whether sat_cat has been built
+static time_t sat_cat_t;                                // when epoch_ok was last set
+static int sat_cat_max_age;                             // maxTLEAgeDays() when epoch_ok was last set
 
 // foot configuration
 static const uint16_t max_foot[N_FOOT] = {FOOT_ALT0, FOOT_ALT30, FOOT_ALT60};   // max dots on each altitude 
@@ -732,9 +756,9 @@ static void fatalSatError (const char *fmt, ...)
 }
 
 
-/* return whether sat epoch is known to be good at the given time.
+/* return whether sat epoch is within the allowed age at the given time, quietly.
  */
-static bool satEpochOk (Satellite *sat, const char *name, time_t t)
+static bool satEpochInRange (Satellite *sat, const char *name, time_t t)
 {
     if (!sat)
         return (false);
@@ -745,9 +769,22 @@ static bool satEpochOk (Satellite *sat, const char *name, time_t t)
     // N.B. can not use isSatMoon because sat_name is not set
     float max_age = strcasecmp(name,"Moon") == 0 ? 1.5F : maxTLEAgeDays();
 
-    bool ok = t_sat + max_age > t_now && t_now + max_age > t_sat;
+    return (t_sat + max_age > t_now && t_now + max_age > t_sat);
+}
+
+/* return whether sat epoch is known to be good at the given time.
+ */
+static bool satEpochOk (Satellite *sat, const char *name, time_t t)
+{
+    if (!sat)
+        return (false);
+
+    bool ok = satEpochInRange (sat, name, t);
 
     if (!ok) {
+        DateTime t_now = userDateTime(t);
+        DateTime t_sat = sat->epoch();
+        float max_age = strcasecmp(name,"Moon") == 0 ? 1.5F : maxTLEAgeDays();
         int year;
         uint8_t mon, day, h, m, s;
         Serial.printf ("SAT: %s age %g > %g days:\n", name, t_now - t_sat, max_age);
@@ -761,113 +798,179 @@ static bool satEpochOk (Satellite *sat, const char *name, time_t t)
 
 }
 
-/* each call returns the next TLE from user's file then seamlessly from the backend server.
- * first time: call with fp = NULL and state = RNS_INIT then leave them alone for us to manage.
- * we return true if another TLE was found from either source, else false with fp closed.
- * N.B. if caller wants to stop calling us before we return false, they must fclose(fp) if it's != NULL.
- * N.B. name[] will be in the internal '_' format
+/* return hash of the given sat name, ignoring case.
  */
-static bool readNextSat (FILE *&fp, RNS_t &state,
-char name[NV_SATNAME_LEN], char t1[TLE_LINEL], char t2[TLE_LINEL])
+static unsigned satNameHash (const char *name)
 {
-    // prep for user, then server, then done.
-  next:
-
-    if (state == RNS_INIT) {
-        if (!fp) {
-            fp = fopenOurs (esat_ufn, "r");
-            if (!fp) {
-                if (debugLevel (DEBUG_ESATS, 1))
-                    Serial.printf ("SAT: %s: %s\n", esat_ufn, strerror (errno));
-                state = RNS_SERVER;
-            }
-        }
-    }
-
-    if (state == RNS_SERVER) {
-        if (!fp) {
-            fp = openCachedFile (esat_sfn, esat_url, MAX_CACHE_AGE, 0);     // ok if empty
-            if (!fp) {
-                Serial.printf ("SAT: no server sats file\n");
-                state = RNS_DONE;
-            }
-        }
-    }
-
-    if (state == RNS_DONE)
-        return (false);
-
-
+    unsigned h = 2166136261U;
+    while (*name)
+        h = (h ^ (unsigned char)tolower(*name++)) * 16777619U;
+    return (h);
+}
 
-    // find next 3 lines other than comments or blank
-    int n_found;
-    for (n_found = 0; n_found < 3; ) {
+/* append each TLE in fp to sat_cat, skipping comments and blank lines.
+ */
+static void readSatCatFile (FILE *fp, const char *source)
+{
+    char name[NV_SATNAME_LEN] = "";
+    char t1[TLE_LINEL] = "";
+    int n_found = 0;
+    int n0 = n_sat_cat;
 
-        // read next useful line
-        char line[TLE_LINEL+10];
-        if (fgets (line, sizeof(line), fp) == NULL)
-            break;
+    char line[TLE_LINEL+10];
+    while (fgets (line, sizeof(line), fp)) {
         chompString(line);
         if (line[0] == '#' || line[0] == '\0')
             continue;
 
-        // assign
-        switch (n_found) {
+        switch (n_found++) {
         case 0:
             line[NV_SATNAME_LEN-1] = '\0';
             strTrimAll(line);
             strncpySubChar (name, line, '_', ' ', NV_SATNAME_LEN);      // internal name form
-            n_found++;
             break;
         case 1:
             strTrimEnds(line);
             quietStrncpy (t1, line, TLE_LINEL);
-            n_found++;
             break;
         case 2:
             strTrimEnds(line);
-            quietStrncpy (t2, line, TLE_LINEL);
-            n_found++;
+            sat_cat = (SatCatEntry *) realloc (sat_cat, (n_sat_cat+1) * sizeof(SatCatEntry));
+            if (!sat_cat)
+                fatalError ("No memory for %d sats", n_sat_cat+1);
+            SatCatEntry &e = sat_cat[n_sat_cat++];
+            memset (&e, 0, sizeof(e));
+            strcpy (e.name, name);
+            strcpy (e.t1, t1);
+            quietStrncpy (e.t2, line, TLE_LINEL);
+            e.norad = atol (e.t2 + 2);
+            if (tleHasValidChecksum (e.t1) && tleHasValidChecksum (e.t2))
+                e.sat = new Satellite (e.t1, e.t2);
+            if (debugLevel (DEBUG_ESATS, 1)) {
+                Serial.printf ("SAT: found TLE from %s:\n", source);
+                Serial.printf ("   '%s'\n", e.name);
+                Serial.printf ("   '%s'\n", e.t1);
+                Serial.printf ("   '%s'\n", e.t2);
+            }
+            n_found = 0;
             break;
         }
     }
 
-    if (n_found == 3) {
+    Serial.printf ("SAT: %d TLE from %s\n", n_sat_cat - n0, source);
+}
 
-        if (debugLevel (DEBUG_ESATS, 1)) {
-            Serial.printf ("SAT: found TLE from %s:\n", state == RNS_INIT ? "user" : "server");
-            Serial.printf ("   '%s'\n", name);
-            Serial.printf ("   '%s'\n", t1);
-            Serial.printf ("   '%s'\n", t2);
-        }
+/* return whether fp, if any, is still the same as the version in sf, and save its current version in sf.
+ */
+static bool satCatFileSame (FILE *fp, SatCatFile &sf, bool check_mtime)
+{
+    SatCatFile now;
+    memset (&now, 0, sizeof(now));
+    struct stat st;
+    if (fp && fstat (fileno(fp), &st) == 0) {
+        now.ino = st.st_ino;
+        now.size = st.st_size;
+        if (check_mtime)
+            now.mtime = st.st_mtime;
+    }
 
-    } else {
+    bool same = now.ino == sf.ino && now.size == sf.size && now.mtime == sf.mtime;
+    sf = now;
+    return (same);
+}
 
-        // no more from this file
-        if (debugLevel (DEBUG_ESATS, 1))
-            Serial.printf ("SAT: no more TLE from %s\n", state == RNS_INIT ? "user" : "server");
+/* make sure sat_cat reflects the current user and server files, rebuilding only if either is new.
+ * also reevaluate epoch_ok if it was set long enough ago or max TLE age has changed.
+ * N.B. the server file is not checked for being out of date more often than openCachedFile() allows.
+ */
+static void loadSatCatalog (void)
+{
+    // open both sources
+    FILE *ufp = fopenOurs (esat_ufn, "r");
+    if (!ufp && debugLevel (DEBUG_ESATS, 1))
+        Serial.printf ("SAT: %s: %s\n", esat_ufn, strerror (errno));
+    FILE *sfp = openCachedFile (esat_sfn, esat_url, MAX_CACHE_AGE, 0);     // ok if empty
+    if (!sfp)
+        Serial.printf ("SAT: no server sats file\n");
+
+    // rebuild if either is new, N.B. check both to save each version
+    bool u_same = satCatFileSame (ufp, sat_cat_ufile, true);
+    bool s_same = satCatFileSame (sfp, sat_cat_sfile, false);
+    bool rebuild = !sat_cat_ok || !u_same || !s_same;
+    if (rebuild) {
+
+        // discard previous
+        for (int i = 0; i < n_sat_cat; i++)
+            delete sat_cat[i].sat;
+        free (sat_cat);
+        sat_cat = NULL;
+        n_sat_cat = 0;
+
+        // user's first so they take priority
+        if (ufp)
+            readSatCatFile (ufp, "user");
+        if (sfp)
+            readSatCatFile (sfp, "server");
+
+        // index each name and number, but only the first of any duplicates
+        for (int i = 0; i < SATCAT_NHASH; i++)
+            sat_cat_name_hash[i] = sat_cat_norad_hash[i] = -1;
+        for (int i = n_sat_cat; --i >= 0; ) {
+            SatCatEntry &e = sat_cat[i];
+            int *hp = &sat_cat_name_hash[satNameHash(e.name) & (SATCAT_NHASH-1)];
+            e.next_name = *hp;
+            *hp = i;
+            hp = &sat_cat_norad_hash[e.norad & (SATCAT_NHASH-1)];
+            e.next_norad = *hp;
+            *hp = i;
+        }
 
-        // close fp
-        fclose (fp);
-        fp = NULL;
+        sat_cat_ok = true;
+    }
 
-        // advance to next state
-        switch (state) {
-        case RNS_INIT:   state = RNS_SERVER; break;
-        case RNS_SERVER: state = RNS_DONE; break;
-        case RNS_DONE:   break;
-        }
+    if (ufp)
+        fclose (ufp);
+    if (sfp)
+        fclose (sfp);
 
-        // resume
-        goto next;
+    // update epoch_ok
+    time_t now = nowWO();
+    if (rebuild || labs (now - sat_cat_t) > SATCAT_RECHECK || sat_cat_max_age != maxTLEAgeDays()) {
+        int n_ok = 0;
+        for (int i = 0; i < n_sat_cat; i++) {
+            SatCatEntry &e = sat_cat[i];
+            e.epoch_ok = satEpochInRange (e.sat, e.name, now);
+            if (e.epoch_ok)
+                n_ok++;
+        }
+        sat_cat_t = now;
+        sat_cat_max_age = maxTLEAgeDays();
+        Serial.printf ("SAT: %d of %d catalog sats are current\n", n_ok, n_sat_cat);
     }
+}
 
-    // if get here one or the other was a success
-    return (true);
+/* return the first catalog entry with the given name, ignoring case, else NULL.
+ */
+static const SatCatEntry *findSatCatName (const char *name)
+{
+    for (int i = sat_cat_name_hash[satNameHash(name) & (SATCAT_NHASH-1)]; i >= 0; i = sat_cat[i].next_name)
+        if (strcasecmp (sat_cat[i].name, name) == 0)
+            return (&sat_cat[i]);
+    return (NULL);
 }
 
-/* look up name. if found set up sat, else inform user and remove sat altogether.
- * return whether found it.
+/* return the first catalog entry with the given NORAD catalog number, else NULL.
+ */
+static const SatCatEntry *findSatCatNorad (long norad)
+{
+    for (int i = sat_cat_norad_hash[norad & (SATCAT_NHASH-1)]; i >= 0; i = sat_cat[i].next_norad)
+        if (sat_cat[i].norad == norad)
+            return (&sat_cat[i]);
+    return (NULL);
+}
+
+/* look up name, or NORAD number if it is all digits. if found set up sat, else inform user and remove sat
+ * altogether. return whether found it.
  */
 static bool satLookup (SatState &s)
 {
@@ -883,43 +986,28 @@ static bool satLookup (SatState &s)
         s.sat = NULL;
     }
 
-    // prepare for readNextSat()
-    FILE *rns_fp = NULL;
-    RNS_t rns_state = RNS_INIT;
-
-    // read and check each name
-    char name[NV_SATNAME_LEN];
-    char t1[TLE_LINEL];
-    char t2[TLE_LINEL];
-    bool ok = false;
-    char err_msg[100] = "";                     // user default err msg if this stays ""
-    while (!ok && readNextSat (rns_fp, rns_state, name, t1, t2)) {
-        if (strcasecmp (name, s.name) == 0) {
-            if (!tleHasValidChecksum (t1))
-                snprintf (err_msg, sizeof(err_msg), "Bad checksum for %s TLE line 1", name);
-            else if (!tleHasValidChecksum (t2))
-                snprintf (err_msg, sizeof(err_msg), "Bad checksum for %s TLE line 2", name);
-            else
-                ok = true;
+    // find by name else number
+    loadSatCatalog();
+    const SatCatEntry *e = findSatCatName (s.name);
+    if (!e && strspn (s.name, "0123456789") == strlen (s.name)) {
+        e = findSatCatNorad (atol (s.name));
+        if (e) {
+            Serial.printf ("SAT: NORAD %s is %s\n", s.name, e->name);
+            strcpy (s.name, e->name);
         }
     }
 
-    // finished with fp regardless
-    if (rns_fp)
-        fclose(rns_fp);
-
     // final check
-    if (ok) {
-        // TLE looks good: define new sat
-        s.sat = new Satellite (t1, t2);
-    } else {
-        if (err_msg[0])
-            fatalSatError ("%s", err_msg);
-        else
-            fatalSatError ("%s disappeared", s.name);
-    }
+    if (!e)
+        fatalSatError ("%s disappeared", s.name);
+    else if (!tleHasValidChecksum (e->t1))
+        fatalSatError ("Bad checksum for %s TLE line 1", e->name);
+    else if (!tleHasValidChecksum (e->t2))
+        fatalSatError ("Bad checksum for %s TLE line 2", e->name);
+    else
+        s.sat = new Satellite (*e->sat);                // TLE looks good: copy for our own use
 
-    return (ok);
+    return (s.sat != NULL);
 }
 
 /* show table selection box marked or not
@@ -1012,9 +1100,8 @@ static int askSat (char selections[MAX_ACTIVE_SATS][NV_SATNAME_LEN])
     char sat_table[MAX_NSAT][NV_SATNAME_LEN];
     int n_sat_table;
 
-    // prepare for readNextSat()
-    FILE *rns_fp = NULL;
-    RNS_t rns_state = RNS_INIT;
+    // get current catalog
+    loadSatCatalog();
 
 
     //*******************************************************************************************
@@ -1028,11 +1115,11 @@ static int askSat (char selections[MAX_ACTIVE_SATS][NV_SATNAME_LEN])
         // handy
         char *tbl_name = sat_table[n_sat_table];
 
-        // read user's file until it's empty, then read from server
-        char t1[TLE_LINEL];
-        char t2[TLE_LINEL];
-        if (!readNextSat (rns_fp, rns_state, tbl_name, t1, t2))
+        // user's entries first, then server's
+        if (n_sat_table >= n_sat_cat)
             break;
+        const SatCatEntry &e = sat_cat[n_sat_table];
+        strcpy (tbl_name, e.name);
 
         // row and column, col-major order
         int r = n_sat_table % N_ROWS;
@@ -1062,12 +1149,12 @@ static int askSat (char selections[MAX_ACTIVE_SATS][NV_SATNAME_LEN])
             showSelectionBox (r, c, false);
 
         // display next rise time of this sat
-        Satellite *sat = new Satellite (t1, t2);
         tft.setTextColor (RA8875_WHITE);
         tft.setCursor (cell_s.x + CB_SIZE + 8, cell_s.y + FONT_H);
-        if (satEpochOk(sat, tbl_name, now)) {
+        if (e.epoch_ok) {
             SatRiseSet rs;
-            findNextPass (sat, tbl_name, now, rs);
+            Satellite sat (*e.sat);                     // findNextPass() changes sat
+            findNextPass (&sat, tbl_name, now, rs);
             if (rs.rise_ok) {
                 DateTime t_now = userDateTime(now);
                 if (rs.rise_time < rs.set_time) {
@@ -1103,9 +1190,6 @@ static int askSat (char selections[MAX_ACTIVE_SATS][NV_SATNAME_LEN])
             tft.print ("Age ");
         }
 
-        // recycle sat
-        delete sat;
-
         // followed by scrubbed name
         char user_name[NV_SATNAME_LEN];
         strncpySubChar (user_name, tbl_name, ' ', '_', NV_SATNAME_LEN);
@@ -1178,10 +1262,6 @@ static int askSat (char selections[MAX_ACTIVE_SATS][NV_SATNAME_LEN])
 
   out:
 
-    // one final fclose in case we didn't read all
-    if (rns_fp)
-        fclose (rns_fp);
-
     if (n_sat_table == 0) {
         fatalSatError ("%s", "No satellites found");
         return (false);
@@ -1395,6 +1475,19 @@ bool setNewSatCircumstance (void)
     return (n_ok > 0);
 }
 
+/* if a satellite is currently in play, predict it at each of b.n times t0 + secs[i] into b and return true.
+ * caller then calls b.topo() for each observer of interest.
+ */
+bool predictSatBatch (time_t t0, const long *secs, SatBatch &b)
+{
+    int cs = currentSat();
+    if (cs == NO_CUR_SAT)
+        return (false);
+
+    sat_state[cs].sat->predict (userDateTime(t0), secs, b);
+    return (true);
+}
+
 /* handy getSatCir() for right now
  */
 bool getSatNow (SatNow &satnow)
@@ -1937,19 +2030,14 @@ const char **getAllSatNames()
     const char **all_names = NULL;
     int n_names = 0;
 
-    // prep for readNextSat
-    FILE *rns_fp = NULL;
-    RNS_t rns_state = RNS_INIT;
-
-    // read and add each to all_names.
-    char name[NV_SATNAME_LEN];
-    char t1[TLE_LINEL];
-    char t2[TLE_LINEL];
-    while (readNextSat (rns_fp, rns_state, name, t1, t2)) {
+    // add each catalog entry to all_names.
+    loadSatCatalog();
+    for (int i = 0; i < n_sat_cat; i++) {
+        const SatCatEntry &e = sat_cat[i];
         all_names = (const char **) realloc (all_names, (n_names+3)*sizeof(const char*));
-        all_names[n_names++] = strdup (name);
-        all_names[n_names++] = strdup (t1);
-        all_names[n_names++] = strdup (t2);
+        all_names[n_names++] = strdup (e.name);
+        all_names[n_names++] = strdup (e.t1);
+        all_names[n_names++] = strdup (e.t2);
     }
 
     Serial.printf ("SAT: found %d satellites\n", n_names/3);
@@ -2038,6 +2126,310 @@ int nextSatRSEvents (time_t **rises, float **raz, time_t **sets, float **saz)
     return nextSatRSEvents (sat_state[cs], rises, raz, sets, saz);
 }
 
+/* return elevation and optionally az of sat from op at dt seconds after t0.
+ * N.B. thread safe as long as no other thread is using the same sat.
+ */
+static float satPassEl (Satellite *sat, const Observer *op, const DateTime &t0, long dt, float *azp)
+{
+    DateTime t(t0);
+    t += dt;
+    sat->predict (t);
+    float el, az, range, rate;
+    sat->topo (op, el, az, range, rate);
+    if (azp)
+        *azp = az;
+    return (el);
+}
+
+/* given sat is up at exactly one of seconds lo and hi after t0, narrow by bisection to the two adjacent
+ * seconds where it changes and return the one where it is up.
+ */
+static long refineSatPassEdge (Satellite *sat, const Observer *op, const DateTime &t0, long lo, long hi)
+{
+    bool hi_up = satPassEl (sat, op, t0, hi, NULL) >= SAT_MIN_EL;
+    while (hi - lo > 1) {
+        long mid = (lo + hi)/2;
+        if ((satPassEl (sat, op, t0, mid, NULL) >= SAT_MIN_EL) == hi_up)
+            hi = mid;
+        else
+            lo = mid;
+    }
+    return (hi_up ? hi : lo);
+}
+
+/* fill in the elevation and direction of the highest point of sp, which lies within seconds r and s after t0,
+ * by golden section search. return its time.
+ */
+static long findSatPassPeak (Satellite *sat, const Observer *op, const DateTime &t0, long r, long s, SatPass &sp)
+{
+    const float g = 0.618034F;
+    float a = r, b = s;
+    float c = b - g*(b-a), d = a + g*(b-a);
+    float el_c = satPassEl (sat, op, t0, (long)c, NULL);
+    float el_d = satPassEl (sat, op, t0, (long)d, NULL);
+    while (b - a > 1) {
+        if (el_c > el_d) {
+            b = d; d = c; el_d = el_c;
+            c = b - g*(b-a);
+            el_c = satPassEl (sat, op, t0, (long)c, NULL);
+        } else {
+            a = c; c = d; el_c = el_d;
+            d = a + g*(b-a);
+            el_d = satPassEl (sat, op, t0, (long)d, NULL);
+        }
+    }
+    long peak = (long)((a+b)/2);
+    sp.max_el = satPassEl (sat, op, t0, peak, &sp.max_az);
+    return (peak);
+}
+
+// one satellite for findAllSatPasses() to predict
+typedef struct {
+    char name[NV_SATNAME_LEN];                          // name, spaces are underscores
+    Satellite *sat;                                     // elements, private to whichever thread takes this job
+    SatPass *passes;                                    // malloced passes found
+    int n_passes;                                       // n passes
+} SatPassJob;
+
+// work shared by the findAllSatPasses() threads
+typedef struct {
+    SatPassJob *jobs;                                   // all sats
+    int n_jobs;                                         // n jobs
+    int next_job;                                       // index of next job to start
+    int n_done;                                         // n jobs finished
+    const Observer *op;                                 // DE
+    DateTime t0;                                        // start time
+} SatPassWork;
+static pthread_mutex_t sp_lock = PTHREAD_MUTEX_INITIALIZER;     // guards next_job and n_done
+
+// the sorted pass index
+static SatPass *sp_passes;                              // malloced, sorted by rise
+static int n_sp_passes;                                 // n sp_passes
+static int n_sp_sats;                                   // n sats predicted
+static time_t sp_t0;                                    // start of sp_passes span, 0 if never built
+static LatLong sp_ll;                                   // DE when sp_passes was built
+#define SATPASS_STEP    60                              // coarse search step, seconds
+#define SATPASS_REDO    (10*60)                         // rebuild sp_passes if older, seconds
+#define SATPASS_THREADS 8                               // max worker threads
+
+/* append sp to the passes of job
+ */
+static void addSatJobPass (SatPassJob &job, const SatPass &sp)
+{
+    job.passes = (SatPass *) realloc (job.passes, (job.n_passes+1) * sizeof(SatPass));
+    if (!job.passes)
+        fatalError ("No memory for %d %s passes", job.n_passes+1, job.name);
+    job.passes[job.n_passes++] = sp;
+}
+
+/* find each pass of job over the span of w, stepping SATPASS_STEP then refining each rise and set.
+ * passes in progress at either end of the span are clipped to it.
+ */
+static void findSatJobPasses (SatPassWork &w, SatPassJob &job)
+{
+    Satellite *sat = job.sat;
+    const long span = SATPASS_HOURS*3600L;
+
+    SatPass sp;
+    memset (&sp, 0, sizeof(sp));
+    strcpy (sp.name, job.name);
+    long rise = 0;
+
+    // el at the previous two steps
+    float el0 = satPassEl (sat, w.op, w.t0, 0, NULL);
+    float el_prev = el0;
+    bool was_up = el0 >= SAT_MIN_EL;
+    if (was_up)
+        sp.raz = SAT_NOAZ;
+
+    for (long t0 = 0, t1 = SATPASS_STEP; t0 < span; t0 = t1, t1 = t1 + SATPASS_STEP > span ? span : t1 + SATPASS_STEP){
+
+        float el1 = satPassEl (sat, w.op, w.t0, t1, NULL);
+        bool is_up = el1 >= SAT_MIN_EL;
+
+        if (is_up == was_up) {
+            // a pass that just grazes the horizon can rise and set between steps so check each peak while down
+            if (!is_up && t0 > 0 && el0 > el_prev && el0 >= el1) {
+                long t_prev = t0 - SATPASS_STEP;
+                long peak = findSatPassPeak (sat, w.op, w.t0, t_prev, t1, sp);
+                if (sp.max_el >= SAT_MIN_EL) {
+                    sp.rise = refineSatPassEdge (sat, w.op, w.t0, t_prev, peak);
+                    sp.set = refineSatPassEdge (sat, w.op, w.t0, peak, t1);
+                    satPassEl (sat, w.op, w.t0, sp.rise, &sp.raz);
+                    satPassEl (sat, w.op, w.t0, sp.set, &sp.saz);
+                    addSatJobPass (job, sp);
+                }
+            }
+        } else {
+            long edge = refineSatPassEdge (sat, w.op, w.t0, t0, t1);
+            if (is_up) {
+                rise = edge;
+                satPassEl (sat, w.op, w.t0, rise, &sp.raz);
+            } else {
+                satPassEl (sat, w.op, w.t0, edge, &sp.saz);
+                findSatPassPeak (sat, w.op, w.t0, rise, edge, sp);
+                sp.rise = rise;
+                sp.set = edge;
+                addSatJobPass (job, sp);
+            }
+            was_up = is_up;
+        }
+
+        el_prev = el0;
+        el0 = el1;
+    }
+
+    // clip a pass still in progress
+    if (was_up) {
+        sp.saz = SAT_NOAZ;
+        findSatPassPeak (sat, w.op, w.t0, rise, span, sp);
+        sp.rise = rise;
+        sp.set = span;
+        addSatJobPass (job, sp);
+    }
+}
+
+/* thread that predicts the next unclaimed job in the given SatPassWork until none remain
+ */
+static void *satPassThread (void *vp)
+{
+    SatPassWork &w = *(SatPassWork *)vp;
+
+    for (;;) {
+        pthread_mutex_lock (&sp_lock);
+        int i = w.next_job < w.n_jobs ? w.next_job++ : -1;
+        pthread_mutex_unlock (&sp_lock);
+        if (i < 0)
+            break;
+
+        findSatJobPasses (w, w.jobs[i]);
+
+        pthread_mutex_lock (&sp_lock);
+        w.n_done++;
+        pthread_mutex_unlock (&sp_lock);
+    }
+
+    return (NULL);
+}
+
+/* qsort-style compare two SatPass by rise time then name
+ */
+static int qsSatPassRise (const void *v1, const void *v2)
+{
+    const SatPass *p1 = (const SatPass *)v1;
+    const SatPass *p2 = (const SatPass *)v2;
+    if (p1->rise != p2->rise)
+        return (p1->rise < p2->rise ? -1 : 1);
+    return (strcmp (p1->name, p2->name));
+}
+
+/* rebuild sp_passes with all passes of all satellites in the catalog over the next SATPASS_HOURS
+ * starting at t0, using several threads while keeping the clocks alive.
+ */
+static void buildAllSatPasses (time_t t0)
+{
+    struct timeval tv0, tv1;
+    gettimeofday (&tv0, NULL);
+
+    // collect each sat in the catalog whose elements are good now
+    SatPassWork w;
+    w.jobs = NULL;
+    w.n_jobs = w.next_job = w.n_done = 0;
+    w.t0 = userDateTime (t0);
+    Observer de_obs (de_ll.lat_d, de_ll.lng_d, 0);
+    w.op = &de_obs;
+    loadSatCatalog();
+    for (int i = 0; i < n_sat_cat; i++) {
+        const SatCatEntry &e = sat_cat[i];
+        if (!e.epoch_ok || findSatCatName (e.name) != &e)
+            continue;
+        w.jobs = (SatPassJob *) realloc (w.jobs, (w.n_jobs+1) * sizeof(SatPassJob));
+        if (!w.jobs)
+            fatalError ("No memory for %d sat pass jobs", w.n_jobs+1);
+        SatPassJob &job = w.jobs[w.n_jobs++];
+        memset (&job, 0, sizeof(job));
+        quietStrncpy (job.name, e.name, NV_SATNAME_LEN);
+        job.sat = new Satellite (*e.sat);               // each thread changes its own
+    }
+
+    // start threads, no more than there are cpus or jobs
+    int n_threads = sysconf (_SC_NPROCESSORS_ONLN);
+    if (n_threads > SATPASS_THREADS)
+        n_threads = SATPASS_THREADS;
+    if (n_threads > w.n_jobs)
+        n_threads = w.n_jobs;
+    pthread_t tids[SATPASS_THREADS];
+    for (int i = 0; i < n_threads; i++) {
+        int e = pthread_create (&tids[i], NULL, satPassThread, &w);
+        if (e)
+            fatalError ("sat pass thread failed: %s", strerror(e));
+    }
+
+    // wait for all while keeping the clocks alive
+    for (;;) {
+        pthread_mutex_lock (&sp_lock);
+        bool all_done = w.n_done == w.n_jobs;
+        pthread_mutex_unlock (&sp_lock);
+        if (all_done)
+            break;
+        updateClocks(false);
+        wdDelay (10);
+    }
+    for (int i = 0; i < n_threads; i++)
+        pthread_join (tids[i], NULL);
+
+    // replace sp_passes with all passes, converting times from span offsets to UTC
+    free (sp_passes);
+    sp_passes = NULL;
+    n_sp_passes = 0;
+    for (int i = 0; i < w.n_jobs; i++)
+        n_sp_passes += w.jobs[i].n_passes;
+    sp_passes = (SatPass *) malloc (n_sp_passes * sizeof(SatPass) + 1);        // +1 so never NULL
+    if (!sp_passes)
+        fatalError ("No memory for %d sat passes", n_sp_passes);
+    SatPass *sp = sp_passes;
+    for (int i = 0; i < w.n_jobs; i++) {
+        SatPassJob &job = w.jobs[i];
+        for (int j = 0; j < job.n_passes; j++) {
+            *sp = job.passes[j];
+            sp->rise += t0;
+            sp->set += t0;
+            sp++;
+        }
+        free (job.passes);
+        delete job.sat;
+    }
+    qsort (sp_passes, n_sp_passes, sizeof(SatPass), qsSatPassRise);
+    n_sp_sats = w.n_jobs;
+    free (w.jobs);
+
+    sp_t0 = t0;
+    sp_ll = de_ll;
+
+    gettimeofday (&tv1, NULL);
+    Serial.printf ("SAT: found %d passes of %d sats over %d hrs using %d threads in %ld ms\n",
+                n_sp_passes, n_sp_sats, SATPASS_HOURS, n_threads, TVDELUS(tv0,tv1)/1000);
+}
+
+/* pass back all passes of all satellites in the catalog over the next SATPASS_HOURS sorted by rise time,
+ * the start of the span and the number of satellites predicted, and return the number of passes.
+ * the list is rebuilt first if it is older than SATPASS_REDO or DE has moved.
+ * N.B. list remains valid only until the next call.
+ * N.B. call only from the main thread.
+ */
+int findAllSatPasses (const SatPass **passes, time_t *t0, int *n_sats)
+{
+    time_t now = nowWO();
+    if (!sp_t0 || now < sp_t0 || now - sp_t0 > SATPASS_REDO
+                        || sp_ll.lat_d != de_ll.lat_d || sp_ll.lng_d != de_ll.lng_d)
+        buildAllSatPasses (now);
+
+    *passes = sp_passes;
+    *t0 = sp_t0;
+    *n_sats = n_sp_sats;
+    return (n_sp_passes);
+}
+
 /* display table of several local DE rise/set events for the given sat using whole screen.
  * return after user has clicked ok or time out.
  * N.B. caller should call initScreen() after return.
@@ -2192,6 +2584,143 @@ static void showNextSatEvents (SatState &s)
     drawStringInBox (button_name, ok_b, true, RA8875_GREEN);
 }
 
+/* display table of upcoming DE passes of all satellites in the catalog, in order of rise, using whole screen.
+ * return after user has clicked ok or time out.
+ * N.B. caller should call initScreen() after return.
+ */
+static void showAllSatPasses (void)
+{
+    // clean
+    hideClocks();
+    eraseScreen();
+
+    // setup layout
+    #define _SAP_LR_B     10                    // left-right border
+    #define _SAP_TOP_B    10                    // top border
+    #define _SAP_DAY_W    45                    // width of day column
+    #define _SAP_HHMM_W   65                    // width of rise and set columns
+    #define _SAP_EL_W     45                    // width of max el column
+    #define _SAP_ROWH     30                    // row height
+    #define _SAP_TIMEOUT  60000                 // ms
+    #define _SAP_OKY      12                    // Ok box y
+
+    // init scan coords
+    uint16_t x = _SAP_LR_B;
+    uint16_t y = _SAP_ROWH + _SAP_TOP_B;
+
+    // draw ok button box
+    SBox ok_b;
+    ok_b.w = 100;
+    ok_b.x = tft.width() - ok_b.w - _SAP_LR_B;
+    ok_b.y = _SAP_OKY;
+    ok_b.h = _SAP_ROWH;
+    static const char button_name[] = "Ok";
+    drawStringInBox (button_name, ok_b, false, RA8875_GREEN);
+
+    // this can take a while the first time
+    selectFontStyle (LIGHT_FONT, SMALL_FONT);
+    tft.setTextColor (RA8875_WHITE);
+    tft.setCursor (x, y);
+    tft.print ("Computing...");
+    tft.drawPR();
+
+    const SatPass *passes;
+    time_t t0;
+    int n_sats;
+    int n_passes = findAllSatPasses (&passes, &t0, &n_sats);
+    tft.fillRect (x, y-24, 250, 30, RA8875_BLACK);      // font y - font height
+
+    // draw header
+    char buf[80];
+    tft.setTextColor (DE_COLOR);
+    tft.setCursor (x, y);
+    snprintf (buf, sizeof(buf), "Passes of %d satellites, DE local time, next %d hours", n_sats, SATPASS_HOURS);
+    tft.print (buf);
+    y += _SAP_ROWH;
+    for (int col = 0; col < 2; col++) {
+        uint16_t cx = x + col*tft.width()/2;
+        tft.setCursor (cx, y); tft.print ("Day");
+        tft.setCursor (cx+_SAP_DAY_W, y); tft.print ("Rise");
+        tft.setCursor (cx+_SAP_DAY_W+_SAP_HHMM_W, y); tft.print ("Set");
+        tft.setCursor (cx+_SAP_DAY_W+2*_SAP_HHMM_W, y); tft.print ("El");
+        tft.setCursor (cx+_SAP_DAY_W+2*_SAP_HHMM_W+_SAP_EL_W, y); tft.print ("Name");
+    }
+
+    // advance to first data row
+    y += _SAP_ROWH;
+    const uint16_t y0 = y;
+
+    // show each pass not yet over, as many as fit
+    time_t now = nowWO();
+    int n_shown = 0;
+    tft.setTextColor (RA8875_WHITE);
+    for (int i = 0; i < n_passes; i++) {
+
+        const SatPass &sp = passes[i];
+        if (sp.set < now)
+            continue;
+
+        // convert to DE local time
+        time_t rt = sp.rise + getTZ (de_tz);
+        time_t st = sp.set + getTZ (de_tz);
+
+        // show rise day
+        snprintf (buf, sizeof(buf), "%.3s", dayShortStr(weekday(rt)));
+        tft.setCursor (x, y);
+        tft.print (buf);
+
+        // show rise and set times, marking those clipped to the prediction span
+        snprintf (buf, sizeof(buf), "%02dh%02d%s", hour(rt), minute(rt), sp.raz == SAT_NOAZ ? "<" : "");
+        tft.setCursor (x+_SAP_DAY_W, y);
+        tft.print (buf);
+        snprintf (buf, sizeof(buf), "%02dh%02d%s", hour(st), minute(st), sp.saz == SAT_NOAZ ? ">" : "");
+        tft.setCursor (x+_SAP_DAY_W+_SAP_HHMM_W, y);
+        tft.print (buf);
+
+        // show max elevation
+        snprintf (buf, sizeof(buf), "%.0f", sp.max_el);
+        tft.setCursor (x+_SAP_DAY_W+2*_SAP_HHMM_W, y);
+        tft.print (buf);
+
+        // show name, as much as fits
+        char user_name[NV_SATNAME_LEN];
+        strncpySubChar (user_name, sp.name, ' ', '_', NV_SATNAME_LEN);
+        (void) maxStringW (user_name, tft.width()/2 - (_SAP_DAY_W+2*_SAP_HHMM_W+_SAP_EL_W) - _SAP_LR_B);
+        tft.setCursor (x+_SAP_DAY_W+2*_SAP_HHMM_W+_SAP_EL_W, y);
+        tft.print (user_name);
+        n_shown++;
+
+        // next row with wrap
+        if ((y += _SAP_ROWH) > tft.height()) {
+            if ((x += tft.width()/2) > tft.width())
+                break;                                  // no more room
+            y = y0;
+        }
+    }
+    if (n_shown == 0) {
+        tft.setCursor (x, y);
+        tft.print ("No passes");
+    }
+
+    // wait for user to ack
+    UserInput ui = {
+        ok_b,
+        UI_UFuncNone,
+        UF_UNUSED,
+        _SAP_TIMEOUT,
+        UF_NOCLOCKS,
+        {0, 0}, TT_NONE, '\0', false, false
+    };
+
+    do {
+        waitForUser (ui);
+    } while (! (ui.kb_char == CHAR_CR || ui.kb_char == CHAR_NL || ui.kb_char == CHAR_ESC
+                        || inBox (ui.tap, ok_b)) );
+
+    // ack
+    drawStringInBox (button_name, ok_b, true, RA8875_GREEN);
+}
+
 /* called when tap within dx_info_b while showing a sat to show menu of choices.
  * s is known to be within dx_info_b.
  */
@@ -2201,6 +2730,7 @@ void drawDXSatMenu (const SCoord &s)
     // N.B. must be in same order as mitems[] !!
     enum {
         _SMI_CHOOSE,
+        _SMI_ALL,
         _SMI_INFO,
         _SMI_NAME1,
         _SMI_PATH1, _SMI_PASS1, _SMI_TABLE1, _SMI_PLAN1,
@@ -2238,6 +2768,7 @@ void drawDXSatMenu (const SCoord &s)
     #define _DXS_INDENT2 10
     MenuItem mitems[_SMI_N] = {
         {MENU_1OFN,   false, 1, _DXS_INDENT1,  "Choose satellites", NULL},
+        {MENU_1OFN,   false, 1, _DXS_INDENT1,  "Show all passes", NULL},
         {MENU_1OFN,   false, 1, _DXS_INDENT1,  "Show DX Info here", NULL},
 
         {menu_name1,  false, 1, _DXS_INDENT1,  name1, NULL},
@@ -2285,6 +2816,11 @@ void drawDXSatMenu (const SCoord &s)
                     dx_info_for_sat = querySatSelection();
                     initScreen();
                     break;
+                case _SMI_ALL:
+                    // show table of upcoming passes of all sats
+                    showAllSatPasses();
+                    initScreen();
+                    break;
                 case _SMI_INFO:
                     // return to normal DX info but leave sats functional
                     dx_info_for_sat = false;
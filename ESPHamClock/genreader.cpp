@@ -0,0 +1,502 @@
+/* GenReader: read bytes or lines from an array, FILE or WiFiClient through whole spans of memory.
+ *
+ * arrays are their own span. regular files are mapped into memory whole, others are read in large blocks.
+ * clients lend out their read-ahead buffer directly with readSpan() and are told only at refill or
+ * destruction how much was used with skip(). so getChar() never calls into stdio or the socket for each
+ * byte and getLine() finds line ends with memchr() and usually returns them in place without copying.
+ *
+ * to build and run a stand-alone benchmark of old and new paths over any large PSK or ADIF capture file,
+ * or over a synthetic ADIF file if none given:
+ *    g++ -Wall -O2 -IArduinoLib -D_UNIT_TEST -o x.genreader genreader.cpp && ./x.genreader [file]
+ */
+
+#include <sys/mman.h>
+
+#include "HamClock.h"
+
+
+#define GR_BUFSZ        65536                   // read size if can not map file
+#define GR_LINEMORE     1024                    // getLine() copy growth increment
+
+
+/* common initialization, all empty.
+ */
+void GenReader::init()
+{
+    my_fp = NULL;
+    my_client = NULL;
+    my_clen = 0;
+    my_has_clen = false;
+    my_span = my_next = my_end = NULL;
+    my_map = NULL;
+    my_map_len = 0;
+    my_buf = NULL;
+    my_buf_os = 0;
+    my_line = NULL;
+    my_line_mem = 0;
+}
+
+/* start reading client, at most content_length bytes if > 0
+ */
+GenReader::GenReader (WiFiClient &client, long content_length)
+{
+    init();
+    my_type = GR_CLIENT;
+    my_client = &client;
+    my_clen = content_length;
+    my_has_clen = content_length > 0;
+}
+
+/* start reading fp from its current position.
+ */
+GenReader::GenReader (FILE *fp)
+{
+    init();
+    my_type = GR_FILE;
+    my_fp = fp;
+
+    // map the remainder if regular file, offset must be page aligned so map it all and start part way in
+    struct stat s;
+    long os = ftell (fp);
+    if (os >= 0 && fstat (fileno(fp), &s) == 0 && S_ISREG(s.st_mode) && s.st_size > os) {
+        void *map = mmap (NULL, s.st_size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+        if (map != MAP_FAILED) {
+            (void) madvise (map, s.st_size, MADV_SEQUENTIAL);
+            my_map = (char *) map;
+            my_map_len = s.st_size;
+            my_span = my_next = my_map + os;
+            my_end = my_map + my_map_len;
+            return;
+        }
+    }
+
+    // resort to reading blocks
+    my_buf = (char *) malloc (GR_BUFSZ);
+    if (!my_buf)
+        fatalError ("GenReader: no memory for %d byte file buffer", GR_BUFSZ);
+    my_buf_os = os;
+    my_span = my_next = my_end = my_buf;
+}
+
+/* read from array a of n_a bytes.
+ */
+GenReader::GenReader (const char *a, int n_a)
+{
+    init();
+    my_type = GR_ARRAY;
+    my_span = my_next = a;
+    my_end = a + n_a;
+}
+
+GenReader::~GenReader()
+{
+    release();
+}
+
+/* leave file or client positioned just after the last byte we returned and free any resources.
+ */
+void GenReader::release()
+{
+    switch (my_type) {
+    case GR_FILE:
+        if (my_map) {
+            (void) fseek (my_fp, my_next - my_map, SEEK_SET);
+            munmap (my_map, my_map_len);
+            my_map = NULL;
+        } else if (my_buf) {
+            if (my_buf_os >= 0)
+                (void) fseek (my_fp, my_buf_os + (my_next - my_span), SEEK_SET);
+            free (my_buf);
+            my_buf = NULL;
+        }
+        break;
+    case GR_CLIENT:
+        my_client->skip (my_next - my_span);
+        break;
+    case GR_ARRAY:
+        break;
+    }
+
+    free (my_line);
+    my_line = NULL;
+    my_line_mem = 0;
+    my_span = my_next = my_end = NULL;
+}
+
+/* current span is used up, start another.
+ * return whether there is more.
+ */
+bool GenReader::refill()
+{
+    switch (my_type) {
+
+    case GR_ARRAY:
+        return (false);
+
+    case GR_FILE: {
+        if (my_map)
+            return (false);
+        if (my_buf_os >= 0)
+            my_buf_os += my_end - my_span;
+        size_t nr = fread (my_buf, 1, GR_BUFSZ, my_fp);
+        my_span = my_next = my_buf;
+        my_end = my_buf + nr;
+        return (nr > 0);
+        }
+
+    case GR_CLIENT: {
+        my_client->skip (my_end - my_span);
+        my_span = my_next = my_end = NULL;
+        if (my_has_clen && my_clen <= 0)
+            return (false);
+        int n;
+        const char *span = (const char *) my_client->readSpan (n);
+        if (!span || n <= 0)
+            return (false);
+        if (my_has_clen) {
+            if (n > my_clen)
+                n = my_clen;
+            my_clen -= n;
+        }
+        my_span = my_next = span;
+        my_end = span + n;
+        return (true);
+        }
+    }
+
+    return (false);
+}
+
+/* return next line without its \n or any \r just before it, and whether there was one.
+ * a final line without \n is still returned. line is not NUL-terminated and remains valid only until the next
+ * call to any method; it points directly into the source unless the line spanned more than one refill.
+ */
+bool GenReader::getLine (const char *&line, int &len)
+{
+    if (my_next == my_end && !refill())
+        return (false);
+
+    // typical case: all in current span
+    const char *nl = (const char *) memchr (my_next, '\n', my_end - my_next);
+    if (nl) {
+        line = my_next;
+        len = nl - my_next;
+        my_next = nl + 1;
+    } else {
+
+        // assemble in my_line until find \n or run out
+        len = 0;
+        do {
+            nl = (const char *) memchr (my_next, '\n', my_end - my_next);
+            int n_more = (nl ? nl : my_end) - my_next;
+            if (len + n_more > my_line_mem) {
+                my_line_mem = len + n_more + GR_LINEMORE;
+                my_line = (char *) realloc (my_line, my_line_mem);
+                if (!my_line)
+                    fatalError ("GenReader: no memory for %d byte line", my_line_mem);
+            }
+            memcpy (my_line + len, my_next, n_more);
+            len += n_more;
+            my_next += n_more;
+            if (nl) {
+                my_next++;
+                break;
+            }
+        } while (refill());
+        line = my_line;
+    }
+
+    if (len > 0 && line[len-1] == '\r')
+        len -= 1;
+
+    return (true);
+}
+
+/* return all that remains of the current span, starting another if necessary, and whether there was any.
+ * span remains valid only until the next call to any method.
+ */
+bool GenReader::getSpan (const char *&span, int &len)
+{
+    if (my_next == my_end && !refill())
+        return (false);
+
+    span = my_next;
+    len = my_end - my_next;
+    my_next = my_end;
+    return (true);
+}
+
+
+/* if the whole remainder of the source is in memory, as for arrays and mapped files, return it all and
+ * consume it. else return false and consume nothing.
+ * all remains valid until this GenReader is destroyed.
+ */
+bool GenReader::getAll (const char *&all, long &len)
+{
+    if (my_type == GR_ARRAY || (my_type == GR_FILE && my_map)) {
+        all = my_next;
+        len = my_end - my_next;
+        my_next = my_end;
+        return (true);
+    }
+
+    return (false);
+}
+
+
+
+#if defined(_UNIT_TEST)
+
+/* stand-alone correctness check and benchmark
+ */
+
+void fatalError (const char *fmt, ...)
+{
+    char msg[2000];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf (msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+
+    printf ("Fatal: %s\n", msg);
+    exit(1);
+}
+
+// not used here, just to link
+const uint8_t *WiFiClient::readSpan (int &n)
+{
+    n = 0;
+    return (NULL);
+}
+void WiFiClient::skip (int n)
+{
+    (void) n;
+}
+
+// what each path reports so they can be compared
+typedef struct {
+    long n_bytes;                               // bytes seen
+    long n_lines;                               // \n seen
+    long n_eor;                                 // ADIF <EOR> seen, any case
+    unsigned long sum;                          // sum of all bytes except \r and \n
+    long us;                                    // elapsed time
+} BenchResult;
+
+// count <eor> one char at a time, as the ADIF parser sees them
+static void scanEOR (char c, int &state, long &n_eor)
+{
+    static const char eor[] = "<eor>";
+    if (tolower(c) == eor[state]) {
+        if (++state == 5) {
+            n_eor++;
+            state = 0;
+        }
+    } else
+        state = c == '<';
+}
+
+// count <eor> within a whole line
+static long lineEOR (const char *line, int len)
+{
+    long n = 0;
+    for (const char *lt = line; (lt = (const char *) memchr (lt, '<', line + len - lt)) != NULL; lt++)
+        if (line + len - lt >= 5 && strncasecmp (lt, "<eor>", 5) == 0)
+            n++;
+    return (n);
+}
+
+// the original GenReader FILE path: one fgetc per byte
+static bool oldGetChar (FILE *fp, char *bp)
+{
+    int i = fgetc(fp);
+    if (i == EOF || feof(fp) || ferror(fp))
+        return (false);
+    *bp = (char)i;
+    return (true);
+}
+
+// the original getTCPLine(): assemble line one byte at a time
+static bool oldGetLine (FILE *fp, char line[], int line_len, int *ll)
+{
+    line_len -= 1;
+    int i = 0;
+    while (true) {
+        char c;
+        if (!oldGetChar (fp, &c))
+            return (false);
+        if (c == '\r')
+            continue;
+        if (c == '\n') {
+            line[i] = '\0';
+            *ll = i;
+            return (true);
+        } else if (i < line_len)
+            line[i++] = c;
+    }
+}
+
+static void startBench (BenchResult &r, struct timeval &tv0)
+{
+    memset (&r, 0, sizeof(r));
+    gettimeofday (&tv0, NULL);
+}
+
+static void stopBench (const char *name, BenchResult &r, struct timeval &tv0)
+{
+    struct timeval tv1;
+    gettimeofday (&tv1, NULL);
+    r.us = TVDELUS (tv0, tv1);
+    printf ("%-16s %10ld bytes %8ld lines %8ld EOR sum %12lu %8.1f ms %8.1f MB/s\n", name, r.n_bytes, r.n_lines,
+                r.n_eor, r.sum, r.us/1000.0, r.n_bytes/(r.us ? (float)r.us : 1.0F));
+}
+
+static void benchOldChar (const char *fn, BenchResult &r)
+{
+    struct timeval tv0;
+    startBench (r, tv0);
+    FILE *fp = fopen (fn, "r");
+    int state = 0;
+    char c;
+    while (oldGetChar (fp, &c)) {
+        r.n_bytes++;
+        if (c == '\n')
+            r.n_lines++;
+        else if (c != '\r')
+            r.sum += (unsigned char)c;
+        scanEOR (c, state, r.n_eor);
+    }
+    fclose (fp);
+    stopBench ("old getChar", r, tv0);
+}
+
+static void benchNewChar (const char *fn, BenchResult &r)
+{
+    struct timeval tv0;
+    startBench (r, tv0);
+    FILE *fp = fopen (fn, "r");
+    {
+        GenReader gr(fp);
+        int state = 0;
+        char c;
+        while (gr.getChar (&c)) {
+            r.n_bytes++;
+            if (c == '\n')
+                r.n_lines++;
+            else if (c != '\r')
+                r.sum += (unsigned char)c;
+            scanEOR (c, state, r.n_eor);
+        }
+    }
+    fclose (fp);
+    stopBench ("new getChar", r, tv0);
+}
+
+static void benchOldLine (const char *fn, BenchResult &r)
+{
+    struct timeval tv0;
+    startBench (r, tv0);
+    FILE *fp = fopen (fn, "r");
+    static char line[1<<20];
+    int ll;
+    while (oldGetLine (fp, line, sizeof(line), &ll)) {
+        r.n_lines++;
+        r.n_bytes += ll;
+        for (int i = 0; i < ll; i++)
+            r.sum += (unsigned char)line[i];
+        r.n_eor += lineEOR (line, ll);
+    }
+    fclose (fp);
+    stopBench ("old getTCPLine", r, tv0);
+}
+
+static void benchNewLine (const char *fn, BenchResult &r)
+{
+    struct timeval tv0;
+    startBench (r, tv0);
+    FILE *fp = fopen (fn, "r");
+    {
+        GenReader gr(fp);
+        const char *line;
+        int ll;
+        while (gr.getLine (line, ll)) {
+            r.n_lines++;
+            r.n_bytes += ll;
+            for (int i = 0; i < ll; i++)
+                r.sum += (unsigned char)line[i];
+            r.n_eor += lineEOR (line, ll);
+        }
+    }
+    fclose (fp);
+    stopBench ("new getLine", r, tv0);
+}
+
+// write a synthetic ADIF capture of n records to fn
+static void mkADIF (const char *fn, int n)
+{
+    FILE *fp = fopen (fn, "w");
+    if (!fp)
+        fatalError ("%s: %s", fn, strerror(errno));
+    fprintf (fp, "synthetic GenReader benchmark\r\n<adif_ver:5>3.1.4 <programid:8>HamClock <EOH>\r\n");
+    for (int i = 0; i < n; i++)
+        fprintf (fp, "<call:6>K%dABC <gridsquare:4>DM%02d <mode:3>FT8 <band:3>20m <freq:9>14.07%04d "
+                     "<qso_date:8>2024%02d%02d <time_on:6>%06d <station_callsign:5>WB0OE <my_gridsquare:6>DM42jj "
+                     "<eor>\r\n", i%10, i%100, i%10000, 1+i%12, 1+i%28, i%240000);
+    fclose (fp);
+}
+
+// compare two results, return whether same
+static bool sameResult (const char *what, const BenchResult &a, const BenchResult &b, bool lines)
+{
+    bool ok = a.n_lines == b.n_lines && a.n_eor == b.n_eor && a.sum == b.sum && (lines || a.n_bytes == b.n_bytes);
+    printf ("%-16s %s\n", what, ok ? "agree" : "DISAGREE");
+    return (ok);
+}
+
+// check getLine() edge cases on an array
+static bool checkArray (void)
+{
+    const char txt[] = "one\r\ntwo\n\nthree";
+    const char *want[] = {"one", "two", "", "three"};
+    GenReader gr (txt, strlen(txt));
+    const char *line;
+    int ll, n = 0;
+    bool ok = true;
+    while (gr.getLine (line, ll)) {
+        if (n >= 4 || (int)strlen(want[n]) != ll || strncmp (line, want[n], ll) != 0)
+            ok = false;
+        n++;
+    }
+    ok = ok && n == 4;
+    printf ("%-16s %s\n", "array lines", ok ? "agree" : "DISAGREE");
+    return (ok);
+}
+
+int main (int ac, char *av[])
+{
+    const char *fn;
+    char tmp_fn[] = "/tmp/x.genreader.adi";
+    if (ac > 1)
+        fn = av[1];
+    else {
+        mkADIF (tmp_fn, 500000);
+        fn = tmp_fn;
+    }
+
+    BenchResult oc, nc, ol, nl;
+    benchOldChar (fn, oc);
+    benchNewChar (fn, nc);
+    benchOldLine (fn, ol);
+    benchNewLine (fn, nl);
+
+    bool ok = checkArray();
+    ok = sameResult ("getChar paths", oc, nc, false) && ok;
+    ok = sameResult ("getLine paths", ol, nl, true) && ok;
+    printf ("getChar speedup %.1fx, getLine speedup %.1fx\n", oc.us/(float)nc.us, ol.us/(float)nl.us);
+
+    if (fn == tmp_fn)
+        unlink (tmp_fn);
+
+    return (ok ? 0 : 1);
+}
+
+#endif // _UNIT_TEST
@@ -114,6 +114,17 @@ static void drawIB_Freq (long hz, uint16_t tx, int dy, uint16_t &ty)
         tft.printf ("f %7.0f", hz * 1e-3);
 }
 
+/* drawMouseLoc() helper to show how many other spots are near the one shown, if any.
+ * update ty by dy for each row used.
+ */
+static void drawIB_Near (int n_near, uint16_t tx, int dy, uint16_t &ty)
+{
+    if (n_near > 1) {
+        tft.setCursor (tx, ty += dy);
+        tft.printf ("+%d near", n_near - 1);
+    }
+}
+
 /* drawMouseLoc() helper to show mode, if known.
  * update ty by dy for each row used.
  */
@@ -209,7 +220,7 @@ static void drawIB_MapMarker (const LatLong &ll, const SBox &minfo_b, bool ignor
 
 /* draw info for PSK, WSPR or RBN spot
  */
-static void drawIB_PSK (const SBox &minfo_b, const DXSpot &dx_s, const LatLong &dxc_ll)
+static void drawIB_PSK (const SBox &minfo_b, const DXSpot &dx_s, const LatLong &dxc_ll, int n_near)
 {
     char buf[IB_MAXCHARS+1];
     uint16_t tx = minfo_b.x;
@@ -255,6 +266,9 @@ static void drawIB_PSK (const SBox &minfo_b, const DXSpot &dx_s, const LatLong &
     // show distance and bearing
     drawIB_DB (dxc_ll, tx+IB_INDENT, IB_LINEDY, ty);
 
+    // show other spots nearby
+    drawIB_Near (n_near, tx+IB_INDENT, IB_LINEDY, ty);
+
     // show weather
     drawIB_WX (dxc_ll, tx+IB_INDENT, IB_LINEDY, minfo_b.y+minfo_b.h-IB_LINEDY, ty);
 
@@ -365,7 +379,7 @@ static void drawIB_DXPed (const SBox &minfo_b, const DXPedEntry *dxp, const SCoo
 
 /* draw info for DX Cluster or POTA/SOTA or ADIF spot
  */
-static void drawIB_DX (const SBox &minfo_b, const DXSpot &dx_s, const LatLong &dxc_ll)
+static void drawIB_DX (const SBox &minfo_b, const DXSpot &dx_s, const LatLong &dxc_ll, int n_near)
 {
     char buf[IB_MAXCHARS+1];
     uint16_t tx = minfo_b.x;
@@ -408,6 +422,9 @@ static void drawIB_DX (const SBox &minfo_b, const DXSpot &dx_s, const LatLong &d
     // show distance and bearing
     drawIB_DB (dxc_ll, tx+IB_INDENT, IB_LINEDY, ty);
 
+    // show other spots nearby
+    drawIB_Near (n_near, tx+IB_INDENT, IB_LINEDY, ty);
+
     // show weather
     drawIB_WX (dxc_ll, tx+IB_INDENT, IB_LINEDY, minfo_b.y+minfo_b.h-IB_LINEDY, ty);
 
@@ -497,17 +514,18 @@ void drawInfoBox()
     LatLong ll;                                         // ll at ms
     DXSpot dx_s;                                        // spot info
     LatLong dxc_ll;                                     // ll to mark
+    int n_near = 0;                                     // n map spots near dxc_ll, including dx_s
     DXPedEntry *dxp = NULL;                             // set if over
     PlotPane pp;                                        // set if over SDO or Moon pane
 
     bool over_app = tft.getMouse (&ms.x, &ms.y);
     bool over_map = over_app && s2ll (ms, ll);
-    bool over_psk = over_map && getClosestPSK (ll, &dx_s, &dxc_ll);             // only one that sets snr
+    bool over_psk = over_map && getClosestPSK (ll, &dx_s, &dxc_ll, &n_near);    // only one that sets snr
     bool over_dxped = (over_map && getClosestDXPed (ll, dxp)) || (!over_map && getPaneDXPed (ms, dxp));
     bool over_spot = over_map && !over_psk && !over_dxped &&
-                                (getClosestDXCluster (ll, &dx_s, &dxc_ll)
-                                    || getClosestOnTheAirSpot (ll, &dx_s, &dxc_ll)
-                                    || getClosestADIFSpot (ll, &dx_s, &dxc_ll)
+                                (getClosestDXCluster (ll, &dx_s, &dxc_ll, &n_near)
+                                    || getClosestOnTheAirSpot (ll, &dx_s, &dxc_ll, &n_near)
+                                    || getClosestADIFSpot (ll, &dx_s, &dxc_ll, &n_near)
                                 );
     bool over_pane = over_app && !over_map && !over_dxped &&
                                 (getDXCPaneSpot (ms, &dx_s, &dxc_ll)
@@ -567,13 +585,13 @@ void drawInfoBox()
 
     // draw, depending on type
     if (over_psk)
-        drawIB_PSK (minfo_b, dx_s, dxc_ll);
+        drawIB_PSK (minfo_b, dx_s, dxc_ll, n_near);
 
     else if (dxp)
         drawIB_DXPed (minfo_b, dxp, ms);
 
     else if (over_spot || over_pane)
-        drawIB_DX (minfo_b, dx_s, dxc_ll);
+        drawIB_DX (minfo_b, dx_s, dxc_ll, n_near);
 
     else if (over_map) {
 
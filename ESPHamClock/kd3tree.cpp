@@ -2,13 +2,17 @@
  *
  * inspired by https://rosettacode.org/wiki/K-d_tree
  *
- * usage: call mkKD3NodeTree() once then nearestKD3Node() for each lookup; see unit test for usage.
+ * usage: call mkKD3NodeTree() once then nearestKD3Node() for each lookup, or nearestKD3NodeIf() to skip some
+ *   nodes or findKD3NodesWithin() to collect all nodes near a point; see unit test for usage.
  *
  * to build and run a stand-alone main test:
  *    g++ -Wall -O2 -D_UNIT_TEST -o x.kd3tree kd3tree.cpp && ./x.kd3tree 
  */
 
 
+#include <algorithm>
+
+
 /* use HamClock.h but if unit test then define here what we need from it
  */
 
@@ -46,6 +50,7 @@ struct kd_node_t {
 };
  
 typedef struct kd_node_t KD3Node;
+typedef bool (*KD3Accept)(const KD3Node *np, void *arg);
 
 
 #else // !_UNIT_TEST
@@ -73,42 +78,18 @@ static float kd3dist (const KD3Node *a, const KD3Node *b)
     return (d2);
 }
 
-static void kd3swap(KD3Node *x, KD3Node *y)
-{
-    KD3Node tmp = *x;
-    *x = *y;
-    *y = tmp;
-}
-
+/* partially sort [start,end) about its median on the given axis and return it.
+ * N.B. unlike a simple partition this keeps all smaller-or-equal values left and larger-or-equal right even
+ *   when many nodes share the median value, such as spots with a common end.
+ */
 static KD3Node* find_median(KD3Node *start, KD3Node *end, int level)
 {
     if (end <= start) return NULL;
-    if (end == start + 1)
-        return start;
-
-    KD3Node *p, *store, *md = start + (end - start) / 2;
 
-    float pivot;
-    while (1) {
-        pivot = md->s[level];
- 
-        kd3swap(md, end - 1);
-        for (store = p = start; p < end; p++) {
-            if (p->s[level] < pivot) {
-                if (p != store)
-                    kd3swap(p, store);
-                store++;
-            }
-        }
-        kd3swap(store, end - 1);
- 
-        /* median has duplicate values */
-        if (store->s[level] == md->s[level])
-            return md;
- 
-        if (store > md) end = store;
-        else          start = store;
-    }
+    KD3Node *md = start + (end - start) / 2;
+    std::nth_element (start, md, end,
+                [level](const KD3Node &a, const KD3Node &b) { return (a.s[level] < b.s[level]); });
+    return md;
 }
  
 /* transform and array of KD3Node into a proper kd3tree in place.
@@ -167,6 +148,62 @@ void nearestKD3Node (const KD3Node *root, const KD3Node *nd, int level, const KD
     nearestKD3Node(dx > 0 ? root->right : root->left, nd, level, best, best_dist, n_visited);
 }
 
+/* like nearestKD3Node() but only consider nodes for which accept(node,arg) returns true, if accept is set.
+ * ties go to the node with the lower data address so the result does not depend on the tree shape.
+ * best must be NULL on the initial call; it remains NULL if no node is accepted.
+ */
+void nearestKD3NodeIf (const KD3Node *root, const KD3Node *nd, int level, KD3Accept accept, void *arg,
+    const KD3Node **best, float *best_dist, int *n_visited)
+{
+    if (!root) return;
+    float d = kd3dist (root, nd);
+    float dx = root->s[level] - nd->s[level];
+
+    (*n_visited)++;
+
+    if ((!*best || d < *best_dist || (d == *best_dist && root->data < (*best)->data))
+                                                        && (!accept || (*accept)(root, arg))) {
+        *best_dist = d;
+        *best = root;
+    }
+
+    level = (level + 1) % 3;
+
+    // N.B. only prune if strictly farther so equal ties are still seen
+    nearestKD3NodeIf (dx > 0 ? root->left : root->right, nd, level, accept, arg, best, best_dist, n_visited);
+    if (*best && dx*dx > *best_dist) return;
+    nearestKD3NodeIf (dx > 0 ? root->right : root->left, nd, level, accept, arg, best, best_dist, n_visited);
+}
+
+/* find all nodes within distance metric max_d of nd, storing up to max_found of them in found[].
+ * initial call with level 0.
+ * return total count within max_d, which may be more than max_found.
+ */
+int findKD3NodesWithin (const KD3Node *root, const KD3Node *nd, int level, float max_d,
+    const KD3Node **found, int max_found)
+{
+    if (!root) return (0);
+    float dx = root->s[level] - nd->s[level];
+
+    int n = 0;
+    if (kd3dist (root, nd) <= max_d) {
+        if (max_found > 0)
+            found[0] = root;
+        n = 1;
+    }
+
+    level = (level + 1) % 3;
+
+    // near side always, far side only if the splitting plane is within range
+    const KD3Node *near = dx > 0 ? root->left : root->right;
+    const KD3Node *far  = dx > 0 ? root->right : root->left;
+    n += findKD3NodesWithin (near, nd, level, max_d, found + n, max_found > n ? max_found - n : 0);
+    if (dx*dx <= max_d)
+        n += findKD3NodesWithin (far, nd, level, max_d, found + n, max_found > n ? max_found - n : 0);
+
+    return (n);
+}
+
 /* handy convert ll.lat/lng to KD3Node
  */
 void ll2KD3Node (const LatLong &ll, KD3Node *kp)
@@ -196,6 +233,13 @@ float nearestKD3Dist2Miles(float d)
     return (ERAD_M*sqrtf(d));
 }
 
+/* inverse of nearestKD3Dist2Miles(), ie, convert earth distance in miles to a kd3 distance metric.
+ */
+float miles2KD3Dist (float miles)
+{
+    return (sqr(miles/ERAD_M));
+}
+
 #endif // _IS_UNIX
 
  
@@ -219,11 +263,20 @@ void rand_pt (KD3Node *kp)
 }
 
 
+// sample KD3Accept that accepts about half the nodes depending on their data address
+static bool acceptHalf (const KD3Node *np, void *arg)
+{
+    (void) arg;
+    return (((long)np->data & 0x10) == 0);
+}
+
+
 int main(int ac, char *av[])
 {
     int i;
     KD3Node testNode;
-    KD3Node *root, *found, *million;
+    KD3Node *root, *million;
+    const KD3Node *found;
     float best_dist;
     int visited;
  
@@ -273,6 +326,46 @@ int main(int ac, char *av[])
             "worst dist %g\n",
             test_runs, seen, test_runs, seen/(float)test_runs, sqrtf(worst_dist));
     printf ("time %ld us\n", (tv1.tv_sec-tv0.tv_sec)*1000000 + (tv1.tv_usec-tv0.tv_usec));
+
+    /* check filtered nearest and radius searches against brute force, accepting about half the nodes
+     * and counting all within 50 miles. move every third node to one location to exercise duplicates.
+     */
+
+    for (i = 0; i < N; i += 3)
+        memcpy (million[i].s, million[N-1].s, sizeof(million[i].s));
+    root = mkKD3NodeTree(million, N, 0);
+
+    int n_bad = 0, brute_runs = 100;
+    float max_d = miles2KD3Dist (50);
+    const KD3Node **within = (const KD3Node **) malloc (N * sizeof(const KD3Node *));
+    for (i = 0; i < brute_runs; i++) {
+        if (i % 10)
+            rand_pt(&testNode);
+        else
+            testNode = million[N-1];
+        const KD3Node *bf_best = NULL;
+        float bf_dist = 0;
+        int bf_n = 0;
+        for (int j = 0; j < N; j++) {
+            float d = kd3dist (&million[j], &testNode);
+            if (d <= max_d)
+                bf_n++;
+            if (acceptHalf (&million[j], NULL) && (!bf_best || d < bf_dist
+                                        || (d == bf_dist && million[j].data < bf_best->data))) {
+                bf_best = &million[j];
+                bf_dist = d;
+            }
+        }
+        const KD3Node *kd_best = NULL;
+        float kd_dist = 0;
+        visited = 0;
+        nearestKD3NodeIf (root, &testNode, 0, acceptHalf, NULL, &kd_best, &kd_dist, &visited);
+        int kd_n = findKD3NodesWithin (root, &testNode, 0, max_d, within, N);
+        if (kd_best != bf_best || kd_n != bf_n)
+            n_bad++;
+    }
+    printf (">> Filtered nearest and 50 mile radius vs brute force %d times: %d mismatches\n", brute_runs, n_bad);
+    free (within);
  
     free(million);
  
@@ -54,6 +54,7 @@ char live_html[] =  R"_raw_html_(
         var want_fs, tried_fs;          // whether user wants full screen and has succeeded once
         var wsclose_reload = 1;         // whether to reload if lose ws connection
         var cvs, ctx;                   // handy
+        var draw_chain = Promise.resolve(); // images are drawn in the order they arrive
 
         // define functions, onLoad follows near the bottom
 
@@ -120,7 +121,8 @@ char live_html[] =  R"_raw_html_(
         function drawFullImage (png8) {
 
             var pngbl = new Blob ([png8], {type:"image/png"});
-            createImageBitmap (pngbl)
+            draw_chain = draw_chain
+            .then(function() { return createImageBitmap (pngbl); })
             .then(function(ibm) {
                 if (drawing_verbose)
                     console.log ("drawFullImage size " + ibm.width + " x " + ibm.height);
@@ -132,7 +134,7 @@ char live_html[] =  R"_raw_html_(
             });
         }
 
-        // update given header and png sprites image -- see liveweb.cpp::updateExistingClient()
+        // update given header and png sprites image -- see liveweb.cpp::encodeBlocks()
         function drawUpdate (hdr8, png8) {
 
             // extract 4-byte header preamble
@@ -161,7 +163,8 @@ char live_html[] =  R"_raw_html_(
             if (n_regn > 0) {
                 // png8 is one image blok_h hi of n_regns contiguous regions each variable width
                 let pngbl = new Blob ([png8], {type:"image/png"});
-                createImageBitmap (pngbl)
+                draw_chain = draw_chain
+                .then(function() { return createImageBitmap (pngbl); })
                 .then(function(ibm) {
                     // render each region.
                     let regn_x = 0;                         // walk region x along img
@@ -200,6 +203,97 @@ char live_html[] =  R"_raw_html_(
 
         }
 
+        // update from one lwq message -- see liveweb.cpp::encodeLWQ()
+        function drawLWQ (msg8) {
+
+            // extract 9-byte header preamble
+            const blok_w = msg8[3];                         // block width, pixels
+            const blok_h = msg8[4];                         // block height, pixels
+            const n_copy = (msg8[5] << 8) | msg8[6];        // n copy ops, MSB LSB
+            const n_pix = (msg8[7] << 8) | msg8[8];         // n pixel ops, MSB LSB
+
+            draw_chain = draw_chain
+            .then(function() {
+
+                // copies all come from the canvas as it was before this message
+                let op = 9;
+                if (n_copy > 0) {
+                    let snap = document.createElement ("canvas");
+                    snap.width = cvs.width;
+                    snap.height = cvs.height;
+                    snap.getContext("2d").drawImage (cvs, 0, 0);
+                    for (let i = 0; i < n_copy; i++, op += 7) {
+                        const cvs_x = msg8[op] * blok_w;
+                        const cvs_y = msg8[op+1] * blok_h;
+                        const cvs_w = msg8[op+2] * blok_w;
+                        const src_x = (msg8[op+3] << 8) | msg8[op+4];
+                        const src_y = (msg8[op+5] << 8) | msg8[op+6];
+                        ctx.drawImage (snap, src_x, src_y, cvs_w, blok_h, cvs_x, cvs_y, cvs_w, blok_h);
+                    }
+                }
+
+                // then each pixel op from one qoi-style stream
+                let qi = op + 3*n_pix;                      // stream index
+                let index = new Uint8Array(64*3);           // recently seen pixels by hash
+                let r = 0, g = 0, b = 0;                    // previous pixel
+                let run = 0;                                // n repeats of previous pending
+                for (let i = 0; i < n_pix; i++, op += 3) {
+                    const cvs_x = msg8[op] * blok_w;
+                    const cvs_y = msg8[op+1] * blok_h;
+                    const cvs_w = msg8[op+2] * blok_w;
+                    let imgd = ctx.createImageData (cvs_w, blok_h);
+                    let px = imgd.data;
+                    for (let p = 0; p < px.length; p += 4) {
+                        if (run > 0) {
+                            run--;
+                        } else {
+                            const c = msg8[qi++];
+                            if (c == 0xfe) {                    // RGB
+                                r = msg8[qi++];
+                                g = msg8[qi++];
+                                b = msg8[qi++];
+                            } else if ((c & 0xc0) == 0x00) {    // INDEX
+                                r = index[3*c];
+                                g = index[3*c+1];
+                                b = index[3*c+2];
+                            } else if ((c & 0xc0) == 0x40) {    // DIFF
+                                r = (r + ((c >> 4) & 3) - 2) & 0xff;
+                                g = (g + ((c >> 2) & 3) - 2) & 0xff;
+                                b = (b + (c & 3) - 2) & 0xff;
+                            } else if ((c & 0xc0) == 0x80) {    // LUMA
+                                const dg = (c & 0x3f) - 32;
+                                const c2 = msg8[qi++];
+                                r = (r + dg + ((c2 >> 4) & 0xf) - 8) & 0xff;
+                                g = (g + dg) & 0xff;
+                                b = (b + dg + (c2 & 0xf) - 8) & 0xff;
+                            } else {                            // RUN
+                                run = c & 0x3f;
+                            }
+                            if (c == 0xfe || (c & 0xc0) != 0xc0) {
+                                const h = 3*((r*3 + g*5 + b*7 + 255*11) % 64);
+                                index[h] = r;
+                                index[h+1] = g;
+                                index[h+2] = b;
+                            }
+                        }
+                        px[p] = r;
+                        px[p+1] = g;
+                        px[p+2] = b;
+                        px[p+3] = 255;
+                    }
+                    ctx.putImageData (imgd, cvs_x, cvs_y);
+                }
+
+                if (drawing_verbose)
+                    console.log ("  drawLWQ " + msg8.byteLength + "B " + n_copy + " copies " +
+                                    n_pix + " pixel runs of " + blok_w + " x " + blok_h);
+            })
+            .catch(function(err) {
+                console.log("lwq promise err: ", err);
+                runSoon (getFullImage);
+            });
+        }
+
         // schedule func() soon
         var upd_tid = 0;                            // update pacing timer id
         function runSoon (func) {
@@ -371,6 +465,8 @@ char live_html[] =  R"_raw_html_(
             ws.binaryType = "arraybuffer";
             ws.onopen = function () {
                 console.log('WS connection established.');
+                // prefer lwq updates, server stays with png if it does not know it
+                sendWSMsg ("set_codec?c=lwq");
             };
             ws.onclose = function () {
                 console.log('WS connection closed.');
@@ -393,7 +489,11 @@ char live_html[] =  R"_raw_html_(
                     // received whole or update image
 
                     var data8 = new Uint8Array (e.data);
-                    if (data8[0] == 137 && data8[1] == 80 && data8[2] == 78 && data8[3] == 71) {
+                    if (data8[0] == 76 && data8[1] == 87 && data8[2] == 81) {
+                        // this is a complete lwq update
+                        drawLWQ (data8);
+                        runSoon (getUpdate);
+                    } else if (data8[0] == 137 && data8[1] == 80 && data8[2] == 78 && data8[3] == 71) {
                         // this is a PNG image -- show whole if alone else assume its part of an update
                         if (ws_abdata) {
                             drawUpdate (new Uint8Array(ws_abdata), data8);
@@ -3,7 +3,7 @@
  * we listen to liveweb_rw_port and liveweb_ro_port for live.html or web socket upgrades.
  *
  * Browser displays entire HamClock frame buffer. Complete frame is sent initially then only the
- * pixels that change.
+ * pixels that change. The changes are encoded once per screen change and shared by all clients.
  *
  * N.B. this server-side code must work in concert with client-side code in liveweb-html.cpp.
  */
@@ -49,15 +49,88 @@ static char *liveweb_openurl;                           // malloced url to attem
 static pthread_mutex_t lw_url_lock = PTHREAD_MUTEX_INITIALIZER; // thread-safe access for liveweb_openurl
 
 
-// complete scene on browser for each web socket
+// what each web socket client is displaying
 typedef struct {
     ws_cli_conn_t *client;                              // pointer unique to each connection, else NULL
-    uint8_t *pixels;                                    // this client's current display image
+    uint32_t gen;                                       // frame generation client has, 0 if none yet
+    uint32_t ctr;                                       // connection counter client has, see clientCounter()
+    uint8_t codec;                                      // LiveCodec client wants for updates
 } SessionInfo;
 static SessionInfo *si_list;                            // malloced list
 static int si_n;                                        // n malloced
 static pthread_mutex_t si_lock = PTHREAD_MUTEX_INITIALIZER;     // atomic updates
 
+
+// the screen is converted and diffed once per change for all clients into a shared frame. each change starts
+// a new frame generation and the header and png that update the previous generation to it are cached.
+// clients are sent the cached deltas since the generation they last received, or a cached keyframe if they are
+// too far behind, so the work does not grow with the number of clients.
+#define BLOK_W      (BUILD_W>1600?16:8)                 // pixels wide
+#define BLOK_H      8                                   // pixels high
+#define BLOK_NCOLS  (BUILD_W/BLOK_W)                    // blocks in each row over entire image
+#define BLOK_NROWS  (BUILD_H/BLOK_H)                    // blocks in each col over entire image
+#define BLOK_NPIX   (BLOK_W*BLOK_H)                     // size of 1 block, pixels
+#define BLOK_NBYTES (BLOK_NPIX*LIVE_BYPPIX)             // size of 1 block, bytes
+#define BLOK_WBYTES (BLOK_W*LIVE_BYPPIX)                // width of 1 block, bytes
+#define MAX_REGNS   (BLOK_NCOLS*BLOK_NROWS)             // worse case number of regions
+#if BLOK_NCOLS > 255                                    // insure fits into uint8_t
+    #error too many block columns
+#endif
+#if BLOK_NROWS > 255                                    // insure fits into uint8_t
+    #error too many block rows
+#endif
+#if MAX_REGNS > 65535                                   // insure fits into uint16_t
+    #error too many live regions
+#endif
+#define LIVE_NDELTAS 32                                 // n consecutive deltas kept
+
+typedef struct {
+    uint8_t *hdr;                                       // malloced region header, NULL for a keyframe
+    int hdr_l;                                          // bytes in hdr
+    uint8_t *body;                                      // malloced png image or lwq message
+    int body_l;                                         // bytes in body
+} LiveMsg;
+
+// wire formats for updates. a client starts with png and may ask for another with set_codec.
+// keyframes are always png.
+typedef enum {
+    LIVE_CODEC_PNG,                                     // header then png of changed block sprites
+    LIVE_CODEC_LWQ,                                     // one message of block copies then qoi-style pixels
+} LiveCodec;
+static const char *live_codec_names[N_LIVE_CODECS] = {"png", "lwq"};
+
+typedef struct {
+    uint32_t gen;                                       // frame generation this delta updates to from gen-1
+    LiveMsg msg[N_LIVE_CODECS];                         // encoded update, body NULL if codec was not in use
+    bool ctr;                                           // whether update overwrites the connection counter
+} LiveDelta;
+
+static uint8_t *frame_img;                              // malloced shared RGB image of frame_gen
+static uint8_t *frame_prev;                             // malloced shared RGB image of frame_gen-1
+static uint32_t frame_gen;                              // increments with each change to frame_img
+static uint32_t frame_tft_gen;                          // tft generation of frame_img
+static LiveDelta frame_deltas[LIVE_NDELTAS];            // deltas to most recent gens, indexed by gen % N
+static LiveMsg frame_key;                               // cached keyframe png
+static uint32_t frame_key_gen;                          // frame_gen of frame_key
+static pthread_mutex_t frame_lock = PTHREAD_MUTEX_INITIALIZER;  // atomic frame updates
+static FILE *capture_fp;                                // capture each new frame here for benchmarkLiveCodecs()
+static int capture_n;                                   // n more frames to capture
+
+// lwq copy ops may take source blocks from this far above or below in the previous frame
+#define LWQ_MAXDY   (16*tft.SCALESZ)
+#define LWQ_MAXSRCH (MAX_REGNS/4)                       // don't look for copies if more blocks changed
+
+// connection counter is drawn only in what is sent to each client, not in frame_img
+#define CTR_RAWW    (3*tft.SCALESZ)                     // digit width
+#define CTR_RAWH    (5*tft.SCALESZ)                     // digit height
+#define CTR_RAWX    (tft.SCALESZ*(lkscrn_b.x-4))        // left edge
+#define CTR_RAWY    (tft.SCALESZ*(lkscrn_b.y+lkscrn_b.h+3)) // top edge
+#define CTR_MAXW    (10*CTR_RAWW)                       // widest, ie, 3 digits then R and O or W
+#define CTR_BR0     (CTR_RAWY/BLOK_H)                   // first block row
+#define CTR_BR1     ((CTR_RAWY+CTR_RAWH+BLOK_H-1)/BLOK_H) // last block row + 1
+#define CTR_BC0     (CTR_RAWX/BLOK_W)                   // first block column
+#define CTR_BC1     ((CTR_RAWX+CTR_MAXW+BLOK_W-1)/BLOK_W) // last block column + 1
+
 #if defined(__GNUC__)
 static void bye (const char *fmt, ...) __attribute__ ((format (__printf__, 1, 2)));
 #else
@@ -119,17 +192,16 @@ static unsigned char * myZDeflate(unsigned char *data, int data_len, int *out_le
     return (out_mem);
 }
 
-/* stbi_write_png_to_func helper to write the given array to the given ws_cli_conn_t in context.
+/* send the given binary message to client.
  */
-static void wifiSTBWrite_helper (void *context, void *data, int size)
+static void sendClientBin (ws_cli_conn_t *client, const uint8_t *data, int size)
 {
-    ws_cli_conn_t *client = (ws_cli_conn_t *)context;
     int n_sent = ws_sendframe_bin (client, (const char *) data, size);
     if (n_sent != size)
-        Serial.printf ("LIVE: client %s: wrong png write len: %d != %d\n", ws_getaddress(client), n_sent, size);
+        Serial.printf ("LIVE: client %s: wrong write len: %d != %d\n", ws_getaddress(client), n_sent, size);
     if (debugLevel (DEBUG_WEB, 2)) {
-        Serial.printf ("LIVE: sent image %d bytes\n", size);
-        if (debugLevel (DEBUG_WEB, 3)) {
+        Serial.printf ("LIVE: sent %d bytes\n", size);
+        if (debugLevel (DEBUG_WEB, 3) && size > 4 && data[1] == 'P' && data[2] == 'N' && data[3] == 'G') {
             FILE *fp = fopen ("/tmp/live.png", "w");
             fwrite (data, size, 1, fp);
             fclose(fp);
@@ -137,160 +209,81 @@ static void wifiSTBWrite_helper (void *context, void *data, int size)
     }
 }
 
-/* return the pixels pointer for the existing client, else NULL.
- * pixels pointer is safe to use outside si_lock and even if si_list is later realloced (and hence moves).
+/* find client in si_list and pass back a copy of its SessionInfo.
+ * return whether found.
  */
-static uint8_t *getSIPixels (ws_cli_conn_t *client)
+static bool getSI (ws_cli_conn_t *client, SessionInfo &si)
 {
     // protect list while manipulating -- N.B. unlock before returning!
     pthread_mutex_lock (&si_lock);
 
     // scan si_list for client
-    SessionInfo *found_sip = NULL;
+    bool found = false;
     for (int i = 0; i < si_n; i++) {
         if (si_list[i].client == client) {
-            found_sip = &si_list[i];
+            si = si_list[i];
+            found = true;
             break;
         }
     }
-
-    // capture pixels address before unlocking
-    uint8_t *pixels = NULL;
-    if (found_sip)
-        pixels = found_sip->pixels;
-    else
-        Serial.printf ("LIVE: client %s: missing pixels\n", ws_getaddress(client));
+    if (!found)
+        Serial.printf ("LIVE: client %s: missing session\n", ws_getaddress(client));
 
     // unlock
     pthread_mutex_unlock (&si_lock);
 
     // return result
-    return (pixels);
+    return (found);
 }
 
-/* send difference between client's last known screen image and the current image,
- * then store current image back in client's SessionInfo.
+/* record the frame generation and connection counter now displayed by the given client.
  */
-static void updateExistingClient (ws_cli_conn_t *client)
+static void setSI (ws_cli_conn_t *client, uint32_t gen, uint32_t ctr)
 {
-    // curious how long these steps take
-    struct timeval tv0;
-    gettimeofday (&tv0, NULL);
-
-    // find client's current pixels
-    uint8_t *pixels = getSIPixels(client);
-    if (!pixels)
-        return;
-
-    // make a copy of client's last known image
-    uint8_t *img_client = (uint8_t *) malloc (LIVE_NBYTES);
-    if (!img_client)
-        bye ("No memory for LIVE update\n");
-    memcpy (img_client, pixels, LIVE_NBYTES);
-
-    // replace clients's pixels with current screen contents
-    if (!tft.getRawPix (pixels, LIVE_NPIX))
-        bye ("getRawPix for update failed\n");
-    uint8_t *img_now = pixels;                      // better name
-
-    if (debugLevel (DEBUG_WEB, 2)) {
-        struct timeval tv1;
-        gettimeofday (&tv1, NULL);
-        Serial.printf ("LIVE: client %s: copying img and reading new pixels took %ld usec\n",
-                                ws_getaddress(client), TVDELUS (tv0,tv1));
+    pthread_mutex_lock (&si_lock);
+    for (int i = 0; i < si_n; i++) {
+        if (si_list[i].client == client) {
+            si_list[i].gen = gen;
+            si_list[i].ctr = ctr;
+            break;
+        }
     }
+    pthread_mutex_unlock (&si_lock);
+}
 
-    // draw connection counter on main page
-    if (mainpage_up) {
-        #define CTR_RAWW (3*tft.SCALESZ)
-        #define CTR_RAWH (5*tft.SCALESZ)
-        #define CTR_RAWX (tft.SCALESZ*(lkscrn_b.x-4))
-        #define CTR_RAWY (tft.SCALESZ*(lkscrn_b.y+lkscrn_b.h+3))
-        SBox digit_b = {(uint16_t)CTR_RAWX, (uint16_t)CTR_RAWY, (uint16_t)CTR_RAWW, (uint16_t)CTR_RAWH};
-        if (client->port == liveweb_ro_port) {
-            static const uint8_t txt_clr[LIVE_BYPPIX] = {255U,50U,50U};
-            // n_roweb = 1234567890;       // RBF
-            if (n_roweb < 10)
-                digit_b.x += CTR_RAWW;
-            drawImgNumber (n_roweb, img_now, digit_b, txt_clr);
-            digit_b.x += 2*digit_b.w/3;
-            drawImgR (img_now, digit_b, txt_clr);
-            digit_b.x += 3*digit_b.w/2;
-            drawImgO (img_now, digit_b, txt_clr);
-        } else {
-            static const uint8_t txt_clr[LIVE_BYPPIX] = {255U,255U,255U};
-            // n_rwweb = 1234567890;       // RBF
-            if (n_rwweb < 10)
-                digit_b.x += CTR_RAWW;
-            drawImgNumber (n_rwweb, img_now, digit_b, txt_clr);
-            digit_b.x += 2*digit_b.w/3;
-            drawImgR (img_now, digit_b, txt_clr);
-            digit_b.x += 3*digit_b.w/2;
-            drawImgW (img_now, digit_b, txt_clr);
-        }
-    }
-
-    // we only send small regions that have changed since previous, ie changes from img_client to img_now.
-    // image is divided into fixed sized blocks and those which have changed are coalesced into regions
-    // of height one block but variable length. these are collected and sent as one image of height one
-    // block preceded by a header defining the location and size of each region. the coordinates and
-    // length of a region are in units of blocks, not pixels, to reduce each value's size to one byte
-    // each in the header. smaller regions are more efficient but the coords must fit in 8 bit header value.
-    #define BLOK_W      (BUILD_W>1600?16:8)             // pixels wide
-    #define BLOK_H      8                               // pixels high
-    #define BLOK_NCOLS  (BUILD_W/BLOK_W)                // blocks in each row over entire image
-    #define BLOK_NROWS  (BUILD_H/BLOK_H)                // blocks in each col over entire image
-    #define BLOK_NPIX   (BLOK_W*BLOK_H)                 // size of 1 block, pixels
-    #define BLOK_NBYTES (BLOK_NPIX*LIVE_BYPPIX)         // size of 1 block, bytes
-    #define BLOK_WBYTES (BLOK_W*LIVE_BYPPIX)            // width of 1 block, bytes
-    #define MAX_REGNS   (BLOK_NCOLS*BLOK_NROWS)         // worse case number of regions
-    #if BLOK_NCOLS > 255                                // insure fits into uint8_t
-        #error too many block columns
-    #endif
-    #if BLOK_NROWS > 255                                // insure fits into uint8_t
-        #error too many block rows
-    #endif
-    #if MAX_REGNS > 65535                               // insure fits into uint16_t
-        #error too many live regions
-    #endif
-
+/* build the header and png image that update the given blocks from img. img starts at block row img_br0
+ * and is always BUILD_W wide. only blocks in rows [br0,br1) are checked.
+ * we send small regions that have changed since previous: the image is divided into fixed sized blocks and
+ * those which have changed are coalesced into regions of height one block but variable length. these are
+ * collected into one image of height one block preceded by a header defining the location and size of each
+ * region. the coordinates and length of a region are in units of blocks, not pixels, to reduce each value's
+ * size to one byte each in the header. smaller regions are more efficient but the coords must fit in 8 bit
+ * header value. N.B. coordinate with liveweb-html
+ */
+static void encodeBlocks (const uint8_t *img, int img_br0, const uint8_t *blk_changed, int br0, int br1,
+LiveMsg &msg)
+{
     // time block creation
+    struct timeval tv0;
     gettimeofday (&tv0, NULL);
 
     // set header to location and length of each changed region.
     typedef struct {
         uint8_t x, y, l;                                // region location and length in units of blocks
     } RegnLoc;
-    RegnLoc locs[MAX_REGNS];                            // room for max number of header region entries
+    StackMalloc locs_mem(MAX_REGNS*sizeof(RegnLoc));    // room for max number of header region entries
+    RegnLoc *locs = (RegnLoc *) locs_mem.getMem();
     uint16_t n_regns = 0;                               // n regions defined so far
     int n_bloks = 0;                                    // n blocks within all regions so far
 
-    // build locs by checking each region for change across then down
-    for (int ry = 0; ry < BLOK_NROWS; ry++) {
+    // build locs by coalescing changed blocks across then down
+    for (int ry = br0; ry < br1; ry++) {
 
-        // pre-check an image band all the way across BLOK_COLS hi, skip entirely if no change anywhere
-        int band_start = ry*LIVE_BYPPIX*BLOK_H*BUILD_W;
-        if (memcmp (&img_now[band_start], &img_client[band_start], LIVE_BYPPIX*BLOK_H*BUILD_W) == 0)
-            continue;
-
-        // something changed, scan across this band checking each block
         locs[n_regns].l = 0;                            // init n contiguous blocks that start here
         for (int rx = 0; rx < BLOK_NCOLS; rx++) {
-            int blok_start = band_start + rx*BLOK_WBYTES;
-            uint8_t *now0 = &img_now[blok_start];       // first pixel in this block of current image
-            uint8_t *pre0 = &img_client[blok_start];    // first pixel in this block of image in client
-
-            // check each row of this block for any change, start or add to region 
-            bool blok_changed = false;                  // set if any changed pixels in this block
-            for (int rr = 0; rr < BLOK_H; rr++) {
-                if (memcmp (now0+rr*LIVE_BYPPIX*BUILD_W, pre0+rr*LIVE_BYPPIX*BUILD_W, BLOK_WBYTES) != 0) {
-                    blok_changed = true;
-                    break;
-                }
-            }
 
             // add to or start new region
-            if (blok_changed) {
+            if (blk_changed[ry*BLOK_NCOLS + rx]) {
                 if (locs[n_regns].l == 0) {
                     locs[n_regns].x = rx;
                     locs[n_regns].y = ry;
@@ -313,35 +306,27 @@ static void updateExistingClient (ws_cli_conn_t *client)
 
     // now create one wide image containing each region as a separate sprite.
     // remember each region must work as a separate image of size lx1 blocks.
-    uint8_t *chg_regns = (uint8_t*) malloc (n_bloks * BLOK_NBYTES);
+    uint8_t *chg_regns = (uint8_t*) malloc (n_bloks * BLOK_NBYTES + 1);
     if (!chg_regns)
         bye ("No memory for sprites %d\n", n_bloks);
     uint8_t *chg0 = chg_regns;
     for (int ry = 0; ry < BLOK_H; ry++) {
         for (int i = 0; i < n_regns; i++) {
             RegnLoc *rp = &locs[i];
-            uint8_t *now0 = &img_now[BUILD_W*LIVE_BYPPIX*(ry+BLOK_H*rp->y) + BLOK_WBYTES*rp->x];
-            memcpy (chg0, now0, BLOK_WBYTES*rp->l);
+            const uint8_t *img0 = &img[LIVE_RBYTES*(ry+BLOK_H*(rp->y-img_br0)) + BLOK_WBYTES*rp->x];
+            memcpy (chg0, img0, BLOK_WBYTES*rp->l);
             chg0 += BLOK_WBYTES*rp->l;
         }
     }
     if (n_bloks != (chg0-chg_regns)/BLOK_NBYTES)        // assert
         bye ("live regions %d != %d\n", n_bloks, (int)((chg0-chg_regns)/BLOK_NBYTES));
 
-    if (debugLevel (DEBUG_WEB, 2)) {
-        struct timeval tv1;
-        gettimeofday (&tv1, NULL);
-        Serial.printf ("LIVE: client %s: built %d regions from %d blocks in %ld usec\n",
-                        ws_getaddress(client), n_regns, n_bloks, TVDELUS (tv0, tv1));
-    }
-
-    // time header creation and png write
-    gettimeofday (&tv0, NULL);
-
     // build 4-byte header followed by x,y,l of each of n regions in units of blocks.
-    unsigned hdr_l = 4+3*n_regns;
-    StackMalloc hdr_mem(hdr_l);
-    uint8_t *hdr = (uint8_t *) hdr_mem.getMem();
+    msg.hdr_l = 4+3*n_regns;
+    msg.hdr = (uint8_t *) malloc (msg.hdr_l);
+    if (!msg.hdr)
+        bye ("No memory for live header %d\n", msg.hdr_l);
+    uint8_t *hdr = msg.hdr;
     hdr[0] = BLOK_W;                            // block width, pixels
     hdr[1] = BLOK_H;                            // block height, pixels
     hdr[2] = n_regns >> 8;                      // n regions, MSB
@@ -354,50 +339,637 @@ static void updateExistingClient (ws_cli_conn_t *client)
             Serial.printf ("   %d,%d %dx%d\n", locs[i].x*BLOK_W, locs[i].y*BLOK_H, locs[i].l*BLOK_W, BLOK_H);
     }
 
-    // always send header
-    unsigned n_hdrsent = ws_sendframe_bin (client, (const char *) hdr, hdr_l);
-    if (n_hdrsent != hdr_l)
-        Serial.printf ("LIVE: client %s: wrong header write %u != %d\n", ws_getaddress(client), n_hdrsent, hdr_l);
-
     // followed by one image containing one column BLOK_W wide of all changed regions
-    stbi_write_png_to_func (wifiSTBWrite_helper, client, BLOK_W*n_bloks, BLOK_H,
-                            COMP_RGB, chg_regns, BLOK_WBYTES*n_bloks);
+    msg.body = stbi_write_png_to_mem (chg_regns, BLOK_WBYTES*n_bloks, BLOK_W*n_bloks, BLOK_H, COMP_RGB,
+                            &msg.body_l);
+    if (!msg.body)
+        bye ("live update png failed\n");
+    free (chg_regns);
 
     if (debugLevel (DEBUG_WEB, 2)) {
         struct timeval tv1;
         gettimeofday (&tv1, NULL);
-        Serial.printf ("LIVE: client %s: write hdr %d bytes and update took %ld usec\n",
-                        ws_getaddress(client), hdr_l, TVDELUS (tv0,tv1));
+        Serial.printf ("LIVE: encoded %d regions from %d blocks into %d bytes in %ld usec\n",
+                        n_regns, n_bloks, msg.hdr_l + msg.body_l, TVDELUS (tv0, tv1));
     }
+}
 
-    if (debugLevel (DEBUG_WEB, 2))
-        Serial.printf ("LIVE: client %s: sent update with %d regions %d blocks\n",
-                        ws_getaddress(client), n_regns, n_bloks);
+/* free the memory in the given message and reset.
+ */
+static void freeLiveMsg (LiveMsg &msg)
+{
+    free (msg.hdr);
+    free (msg.body);
+    memset (&msg, 0, sizeof(msg));
+}
 
-    // finished with temps
-    free (chg_regns);
-    free (img_client);
+/* pass back a malloced copy of the given message.
+ */
+static void copyLiveMsg (const LiveMsg &from, LiveMsg &to)
+{
+    to = from;
+    to.hdr = NULL;
+    if (from.hdr_l > 0) {
+        to.hdr = (uint8_t *) malloc (from.hdr_l);
+        if (!to.hdr)
+            bye ("No memory for live header copy %d\n", from.hdr_l);
+        memcpy (to.hdr, from.hdr, from.hdr_l);
+    }
+    to.body = (uint8_t *) malloc (from.body_l);
+    if (!to.body)
+        bye ("No memory for live png copy %d\n", from.body_l);
+    memcpy (to.body, from.body, from.body_l);
 }
 
-/* capture fresh screen image for client and send.
+/* send the given message to client: the header, if any, followed by its png.
  */
-static void sendClientPNG (ws_cli_conn_t *client)
+static void sendLiveMsg (ws_cli_conn_t *client, const LiveMsg &msg)
+{
+    if (msg.hdr_l > 0)
+        sendClientBin (client, msg.hdr, msg.hdr_l);
+    sendClientBin (client, msg.body, msg.body_l);
+}
+
+/* qoi-style pixel stream state, shared by encodeLWQ() and decodeLWQ().
+ * see https://qoiformat.org, we omit alpha.
+ */
+typedef struct {
+    uint8_t index[64][LIVE_BYPPIX];                     // recently seen pixels by hash
+    uint8_t prev[LIVE_BYPPIX];                          // previous pixel
+    int run;                                            // n repeats of prev pending
+} QOIState;
+#define QOI_OP_INDEX    0x00                            // 00xxxxxx
+#define QOI_OP_DIFF     0x40                            // 01xxxxxx
+#define QOI_OP_LUMA     0x80                            // 10xxxxxx
+#define QOI_OP_RUN      0xc0                            // 11xxxxxx
+#define QOI_OP_RGB      0xfe                            // 11111110
+#define QOI_MASK        0xc0                            // 11000000
+#define QOI_HASH(p)     (((p)[0]*3 + (p)[1]*5 + (p)[2]*7 + 255*11) % 64)
+
+/* append n pixels at px to the qoi stream at out, return new end of stream.
+ */
+static uint8_t *encodeQOIPixels (QOIState &qs, const uint8_t *px, int n, uint8_t *out)
+{
+    for (int i = 0; i < n; i++, px += LIVE_BYPPIX) {
+
+        if (px[0] == qs.prev[0] && px[1] == qs.prev[1] && px[2] == qs.prev[2]) {
+            if (++qs.run == 62) {
+                *out++ = QOI_OP_RUN | (qs.run - 1);
+                qs.run = 0;
+            }
+            continue;
+        }
+        if (qs.run > 0) {
+            *out++ = QOI_OP_RUN | (qs.run - 1);
+            qs.run = 0;
+        }
+
+        uint8_t *ip = qs.index[QOI_HASH(px)];
+        if (ip[0] == px[0] && ip[1] == px[1] && ip[2] == px[2]) {
+            *out++ = QOI_OP_INDEX | QOI_HASH(px);
+        } else {
+            memcpy (ip, px, LIVE_BYPPIX);
+            int8_t dr = (int8_t)(px[0] - qs.prev[0]);
+            int8_t dg = (int8_t)(px[1] - qs.prev[1]);
+            int8_t db = (int8_t)(px[2] - qs.prev[2]);
+            int8_t dr_dg = dr - dg;
+            int8_t db_dg = db - dg;
+            if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                *out++ = QOI_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2);
+            } else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7) {
+                *out++ = QOI_OP_LUMA | (dg + 32);
+                *out++ = (dr_dg + 8) << 4 | (db_dg + 8);
+            } else {
+                *out++ = QOI_OP_RGB;
+                *out++ = px[0];
+                *out++ = px[1];
+                *out++ = px[2];
+            }
+        }
+        memcpy (qs.prev, px, LIVE_BYPPIX);
+    }
+
+    return (out);
+}
+
+/* decode n pixels from the qoi stream at in into px, return new stream position or NULL if stream ends early.
+ */
+static const uint8_t *decodeQOIPixels (QOIState &qs, const uint8_t *in, const uint8_t *in_end, uint8_t *px,
+int n)
+{
+    for (int i = 0; i < n; i++, px += LIVE_BYPPIX) {
+        if (qs.run > 0) {
+            qs.run--;
+        } else {
+            if (in >= in_end)
+                return (NULL);
+            uint8_t op = *in++;
+            if (op == QOI_OP_RGB) {
+                if (in + 3 > in_end)
+                    return (NULL);
+                memcpy (qs.prev, in, LIVE_BYPPIX);
+                in += 3;
+            } else if ((op & QOI_MASK) == QOI_OP_INDEX) {
+                memcpy (qs.prev, qs.index[op], LIVE_BYPPIX);
+            } else if ((op & QOI_MASK) == QOI_OP_DIFF) {
+                qs.prev[0] += ((op >> 4) & 3) - 2;
+                qs.prev[1] += ((op >> 2) & 3) - 2;
+                qs.prev[2] += (op & 3) - 2;
+            } else if ((op & QOI_MASK) == QOI_OP_LUMA) {
+                if (in >= in_end)
+                    return (NULL);
+                int dg = (op & 0x3f) - 32;
+                uint8_t b2 = *in++;
+                qs.prev[0] += dg + ((b2 >> 4) & 0xf) - 8;
+                qs.prev[1] += dg;
+                qs.prev[2] += dg + (b2 & 0xf) - 8;
+            } else {
+                qs.run = op & 0x3f;
+            }
+            if (op == QOI_OP_RGB || (op & QOI_MASK) != QOI_OP_RUN)
+                memcpy (qs.index[QOI_HASH(qs.prev)], qs.prev, LIVE_BYPPIX);
+        }
+        memcpy (px, qs.prev, LIVE_BYPPIX);
+    }
+    return (in);
+}
+
+/* return whether the block at bx,by of img equals the block of prev dy pixels lower.
+ * img starts at block row img_br0, prev is a complete image.
+ */
+static bool lwqBlockMoved (const uint8_t *img, int img_br0, const uint8_t *prev, int bx, int by, int dy)
+{
+    int src_y = by*BLOK_H + dy;
+    if (src_y < 0 || src_y + BLOK_H > BUILD_H)
+        return (false);
+
+    // the client draws the connection counter over its copy of the frame so avoid copying from there
+    if (bx >= CTR_BC0 && bx < CTR_BC1 && src_y < CTR_BR1*BLOK_H && src_y + BLOK_H > CTR_BR0*BLOK_H)
+        return (false);
+
+    const uint8_t *img0 = &img[LIVE_RBYTES*BLOK_H*(by-img_br0) + BLOK_WBYTES*bx];
+    const uint8_t *prev0 = &prev[LIVE_RBYTES*src_y + BLOK_WBYTES*bx];
+    for (int r = 0; r < BLOK_H; r++)
+        if (memcmp (img0 + r*LIVE_RBYTES, prev0 + r*LIVE_RBYTES, BLOK_WBYTES) != 0)
+            return (false);
+    return (true);
+}
+
+/* build one lwq message that updates the given blocks from img. img starts at block row img_br0 and is always
+ * BUILD_W wide. only blocks in rows [br0,br1) are checked. if prev is not NULL it is the complete frame the
+ * client has now and we look for changed blocks that just moved vertically, eg, scrolling panes, and send them
+ * as copies. message format, all values are bytes, coordinates and lengths in units of blocks unless noted:
+ *   'L' 'W' 'Q' blok_w blok_h n_copy(MSB LSB) n_pix(MSB LSB)
+ *   n_copy copy ops: dst_x dst_y len src_x(MSB LSB pixels) src_y(MSB LSB pixels)
+ *   n_pix pixel ops: dst_x dst_y len
+ *   one qoi-style stream of the pixels of each pixel op in turn, each row by row.
+ * copies all take their source from the client's image before this message, then pixels are drawn.
+ * N.B. coordinate with liveweb-html
+ */
+static void encodeLWQ (const uint8_t *img, int img_br0, const uint8_t *blk_changed, int br0, int br1,
+const uint8_t *prev, LiveMsg &msg)
+{
+    // time creation
+    struct timeval tv0;
+    gettimeofday (&tv0, NULL);
+
+    // how each changed block will be sent
+    #define LWQ_PIX     0x7fff                          // send pixels, else dy of copy source
+    StackMalloc how_mem(BLOK_NROWS*BLOK_NCOLS*sizeof(int16_t));
+    int16_t *how = (int16_t *) how_mem.getMem();
+    int n_bloks = 0;
+    for (int ry = br0; ry < br1; ry++)
+        for (int rx = 0; rx < BLOK_NCOLS; rx++)
+            if (blk_changed[ry*BLOK_NCOLS + rx])
+                n_bloks++;
+
+    // look for moved blocks, starting with the offset of the last one found
+    int16_t last_dy = 0;
+    for (int ry = br0; ry < br1; ry++) {
+        for (int rx = 0; rx < BLOK_NCOLS; rx++) {
+            int bi = ry*BLOK_NCOLS + rx;
+            if (!blk_changed[bi])
+                continue;
+            how[bi] = LWQ_PIX;
+            if (!prev || n_bloks > LWQ_MAXSRCH)
+                continue;
+            if (last_dy && lwqBlockMoved (img, img_br0, prev, rx, ry, last_dy)) {
+                how[bi] = last_dy;
+                continue;
+            }
+            for (int16_t dy = 1; dy <= LWQ_MAXDY; dy++) {
+                if (lwqBlockMoved (img, img_br0, prev, rx, ry, dy)) {
+                    how[bi] = last_dy = dy;
+                    break;
+                }
+                if (lwqBlockMoved (img, img_br0, prev, rx, ry, -dy)) {
+                    how[bi] = last_dy = -dy;
+                    break;
+                }
+            }
+        }
+    }
+
+    // worst case is every pixel as QOI_OP_RGB
+    int max_l = 9 + 7*n_bloks + 3*n_bloks + n_bloks*BLOK_NPIX*(LIVE_BYPPIX+1) + 1;
+    uint8_t *out0 = (uint8_t *) malloc (max_l);
+    if (!out0)
+        bye ("No memory for lwq message %d\n", max_l);
+
+    // coalesce runs of like blocks along each row into copy or pixel ops. two passes to put copies first.
+    uint8_t *out = out0 + 9;
+    int n_ops[2] = {0, 0};
+    for (int pass = 0; pass < 2; pass++) {
+        bool want_pix = pass == 1;
+        for (int ry = br0; ry < br1; ry++) {
+            for (int rx = 0; rx < BLOK_NCOLS; ) {
+                int bi = ry*BLOK_NCOLS + rx;
+                if (!blk_changed[bi] || (how[bi] == LWQ_PIX) != want_pix) {
+                    rx++;
+                    continue;
+                }
+                int len = 1;
+                while (rx + len < BLOK_NCOLS && blk_changed[bi+len] && how[bi+len] == how[bi])
+                    len++;
+                *out++ = rx;
+                *out++ = ry;
+                *out++ = len;
+                if (!want_pix) {
+                    int src_x = rx*BLOK_W;
+                    int src_y = ry*BLOK_H + how[bi];
+                    *out++ = src_x >> 8;
+                    *out++ = src_x & 0xff;
+                    *out++ = src_y >> 8;
+                    *out++ = src_y & 0xff;
+                }
+                n_ops[pass]++;
+                rx += len;
+            }
+        }
+    }
+
+    // then the pixels of each pixel op in the same order
+    QOIState qs;
+    memset (&qs, 0, sizeof(qs));
+    const uint8_t *op = out0 + 9 + 7*n_ops[0];
+    for (int i = 0; i < n_ops[1]; i++, op += 3) {
+        int rx = op[0], ry = op[1], len = op[2];
+        for (int r = 0; r < BLOK_H; r++) {
+            const uint8_t *row = &img[LIVE_RBYTES*(BLOK_H*(ry-img_br0) + r) + BLOK_WBYTES*rx];
+            out = encodeQOIPixels (qs, row, len*BLOK_W, out);
+        }
+    }
+    if (qs.run > 0)
+        *out++ = QOI_OP_RUN | (qs.run - 1);
+
+    // header
+    out0[0] = 'L';
+    out0[1] = 'W';
+    out0[2] = 'Q';
+    out0[3] = BLOK_W;
+    out0[4] = BLOK_H;
+    out0[5] = n_ops[0] >> 8;
+    out0[6] = n_ops[0] & 0xff;
+    out0[7] = n_ops[1] >> 8;
+    out0[8] = n_ops[1] & 0xff;
+
+    msg.hdr = NULL;
+    msg.hdr_l = 0;
+    msg.body_l = out - out0;
+    msg.body = (uint8_t *) realloc (out0, msg.body_l);
+
+    if (debugLevel (DEBUG_WEB, 2)) {
+        struct timeval tv1;
+        gettimeofday (&tv1, NULL);
+        Serial.printf ("LIVE: encoded %d copies and %d pixel runs from %d blocks into %d bytes in %ld usec\n",
+                        n_ops[0], n_ops[1], n_bloks, msg.body_l, TVDELUS (tv0, tv1));
+    }
+}
+
+/* apply the given lwq message to the complete image img, just as liveweb-html does.
+ * return whether message was well formed.
+ */
+static bool decodeLWQ (const uint8_t *msg, int msg_l, uint8_t *img)
+{
+    if (msg_l < 9 || msg[0] != 'L' || msg[1] != 'W' || msg[2] != 'Q' || msg[3] != BLOK_W || msg[4] != BLOK_H)
+        return (false);
+    int n_copy = (msg[5] << 8) | msg[6];
+    int n_pix = (msg[7] << 8) | msg[8];
+    const uint8_t *op = msg + 9;
+    const uint8_t *in = op + 7*n_copy + 3*n_pix;
+    const uint8_t *in_end = msg + msg_l;
+    if (in > in_end)
+        return (false);
+
+    // copies come from the image as it was before this message
+    if (n_copy > 0) {
+        uint8_t *snap = (uint8_t *) malloc (LIVE_NBYTES);
+        if (!snap)
+            bye ("No memory for lwq decode\n");
+        memcpy (snap, img, LIVE_NBYTES);
+        for (int i = 0; i < n_copy; i++, op += 7) {
+            int dst_x = op[0]*BLOK_W, dst_y = op[1]*BLOK_H, w = op[2]*BLOK_W;
+            int src_x = (op[3] << 8) | op[4], src_y = (op[5] << 8) | op[6];
+            if (dst_x + w > BUILD_W || src_x + w > BUILD_W || src_y + BLOK_H > BUILD_H) {
+                free (snap);
+                return (false);
+            }
+            for (int r = 0; r < BLOK_H; r++)
+                memcpy (&img[LIVE_RBYTES*(dst_y+r) + LIVE_BYPPIX*dst_x],
+                        &snap[LIVE_RBYTES*(src_y+r) + LIVE_BYPPIX*src_x], w*LIVE_BYPPIX);
+        }
+        free (snap);
+    }
+
+    // then pixels
+    QOIState qs;
+    memset (&qs, 0, sizeof(qs));
+    for (int i = 0; i < n_pix; i++, op += 3) {
+        int dst_x = op[0]*BLOK_W, dst_y = op[1]*BLOK_H, w = op[2]*BLOK_W;
+        if (dst_x + w > BUILD_W || dst_y + BLOK_H > BUILD_H)
+            return (false);
+        for (int r = 0; r < BLOK_H && in; r++)
+            in = decodeQOIPixels (qs, in, in_end, &img[LIVE_RBYTES*(dst_y+r) + LIVE_BYPPIX*dst_x], w);
+        if (!in)
+            return (false);
+    }
+
+    return (true);
+}
+
+/* encode the given blocks of img with the given codec, see encodeBlocks() and encodeLWQ() for details.
+ */
+static void encodeDelta (LiveCodec codec, const uint8_t *img, int img_br0, const uint8_t *blk_changed,
+int br0, int br1, const uint8_t *prev, LiveMsg &msg)
+{
+    switch (codec) {
+    case LIVE_CODEC_LWQ:
+        encodeLWQ (img, img_br0, blk_changed, br0, br1, prev, msg);
+        break;
+    default:
+        encodeBlocks (img, img_br0, blk_changed, br0, br1, msg);
+        break;
+    }
+}
+
+/* return mask of 1 << LiveCodec of each codec wanted by any client.
+ */
+static unsigned liveCodecsInUse(void)
 {
-    // get this client's current pixels array
-    uint8_t *pixels = getSIPixels(client);
-    if (!pixels)
+    unsigned mask = 0;
+    pthread_mutex_lock (&si_lock);
+    for (int i = 0; i < si_n; i++)
+        if (si_list[i].client)
+            mask |= 1 << si_list[i].codec;
+    pthread_mutex_unlock (&si_lock);
+    return (mask);
+}
+
+/* save frame_img if capturing for benchmarkLiveCodecs().
+ * N.B. we assume frame_lock is held
+ */
+static void captureFrame()
+{
+    if (!capture_fp)
+        return;
+    if (fwrite (frame_img, LIVE_NBYTES, 1, capture_fp) != 1 || --capture_n <= 0) {
+        Serial.printf ("LIVE: frame capture %s\n", capture_n > 0 ? strerror(errno) : "complete");
+        fclose (capture_fp);
+        capture_fp = NULL;
+    }
+}
+
+/* bring the shared frame up to date with the screen. if anything changed, start a new frame generation
+ * and cache the delta that updates the previous generation to it.
+ * N.B. we assume frame_lock is held
+ */
+static void freshenFrame()
+{
+    // first time just capture
+    if (!frame_img) {
+        frame_img = (uint8_t *) malloc (LIVE_NBYTES);
+        frame_prev = (uint8_t *) malloc (LIVE_NBYTES);
+        if (!frame_img || !frame_prev)
+            bye ("No memory for live frame\n");
+        if (!tft.getRawPix (frame_img, LIVE_NPIX, frame_tft_gen))
+            bye ("getRawPix for frame failed\n");
+        memcpy (frame_prev, frame_img, LIVE_NBYTES);
+        frame_gen = 1;
+        captureFrame();
+        return;
+    }
+
+    // just the portions of the screen that changed since frame_tft_gen, noting each block that really changed
+    struct timeval tv0;
+    gettimeofday (&tv0, NULL);
+    StackMalloc blk_mem(BLOK_NROWS*BLOK_NCOLS);
+    uint8_t *blk_changed = (uint8_t *) blk_mem.getMem();
+    memset (blk_changed, 0, BLOK_NROWS*BLOK_NCOLS);
+    if (!tft.getRawPixChanges (frame_img, LIVE_NPIX, frame_tft_gen, blk_changed, BLOK_W, BLOK_H))
+        bye ("getRawPixChanges for frame failed\n");
+    if (!memchr (blk_changed, 1, BLOK_NROWS*BLOK_NCOLS))
+        return;
+
+    if (debugLevel (DEBUG_WEB, 2)) {
+        struct timeval tv1;
+        gettimeofday (&tv1, NULL);
+        Serial.printf ("LIVE: reading frame %u changes took %ld usec\n", frame_gen+1, TVDELUS (tv0,tv1));
+    }
+
+    // new generation, reuse oldest delta slot for each codec any client is using
+    LiveDelta &ld = frame_deltas[++frame_gen % LIVE_NDELTAS];
+    unsigned codecs = liveCodecsInUse();
+    for (int c = 0; c < N_LIVE_CODECS; c++) {
+        freeLiveMsg (ld.msg[c]);
+        if (codecs & (1 << c))
+            encodeDelta ((LiveCodec)c, frame_img, 0, blk_changed, 0, BLOK_NROWS, frame_prev, ld.msg[c]);
+    }
+    ld.gen = frame_gen;
+
+    // note whether this delta touches the connection counter
+    ld.ctr = false;
+    for (int ry = CTR_BR0; !ld.ctr && ry < CTR_BR1; ry++)
+        for (int rx = CTR_BC0; !ld.ctr && rx < CTR_BC1; rx++)
+            ld.ctr = blk_changed[ry*BLOK_NCOLS + rx] != 0;
+
+    // previous frame catches up
+    for (int ry = 0; ry < BLOK_NROWS; ry++) {
+        for (int rx = 0; rx < BLOK_NCOLS; rx++) {
+            if (blk_changed[ry*BLOK_NCOLS + rx]) {
+                int blok_start = ry*BLOK_H*LIVE_RBYTES + rx*BLOK_WBYTES;
+                for (int r = 0; r < BLOK_H; r++)
+                    memcpy (&frame_prev[blok_start + r*LIVE_RBYTES], &frame_img[blok_start + r*LIVE_RBYTES],
+                                BLOK_WBYTES);
+            }
+        }
+    }
+
+    captureFrame();
+}
+
+/* pass back a copy of the keyframe for the current frame generation, creating it if necessary.
+ * N.B. we assume frame_lock is held
+ */
+static void getKeyFrame (LiveMsg &msg)
+{
+    if (frame_key_gen != frame_gen || !frame_key.body) {
+        freeLiveMsg (frame_key);
+        stbi_write_png_compression_level = 2;       // faster with hardly any increase in size
+        frame_key.body = stbi_write_png_to_mem (frame_img, LIVE_RBYTES, BUILD_W, BUILD_H, COMP_RGB,
+                                &frame_key.body_l);
+        if (!frame_key.body)
+            bye ("live keyframe png failed\n");
+        frame_key_gen = frame_gen;
+    }
+    copyLiveMsg (frame_key, msg);
+}
+
+/* return the connection counter the given client should now see: 0 for none else a unique code.
+ */
+static uint32_t clientCounter (ws_cli_conn_t *client)
+{
+    if (!mainpage_up)
+        return (0);
+    if (client->port == liveweb_ro_port)
+        return (0x80000000U | (n_roweb + 1));
+    return (n_rwweb + 1);
+}
+
+/* pass back a message in the given codec that draws the connection counter ctr from clientCounter() over
+ * the current frame.
+ * N.B. we assume frame_lock is held
+ */
+static void encodeCounter (uint32_t ctr, LiveCodec codec, LiveMsg &msg)
+{
+    // copy the band of frame containing the counter
+    const int band_nbytes = (CTR_BR1-CTR_BR0)*BLOK_H*LIVE_RBYTES;
+    StackMalloc band_mem(band_nbytes);
+    uint8_t *band = (uint8_t *) band_mem.getMem();
+    memcpy (band, &frame_img[CTR_BR0*BLOK_H*LIVE_RBYTES], band_nbytes);
+
+    // draw counter, y is relative to band
+    if (ctr) {
+        SBox digit_b = {(uint16_t)CTR_RAWX, (uint16_t)(CTR_RAWY - CTR_BR0*BLOK_H),
+                        (uint16_t)CTR_RAWW, (uint16_t)CTR_RAWH};
+        unsigned n = (ctr & 0x7fffffffU) - 1;
+        if (n < 10)
+            digit_b.x += CTR_RAWW;
+        if (ctr & 0x80000000U) {
+            static const uint8_t txt_clr[LIVE_BYPPIX] = {255U,50U,50U};
+            drawImgNumber (n, band, digit_b, txt_clr);
+            digit_b.x += 2*digit_b.w/3;
+            drawImgR (band, digit_b, txt_clr);
+            digit_b.x += 3*digit_b.w/2;
+            drawImgO (band, digit_b, txt_clr);
+        } else {
+            static const uint8_t txt_clr[LIVE_BYPPIX] = {255U,255U,255U};
+            drawImgNumber (n, band, digit_b, txt_clr);
+            digit_b.x += 2*digit_b.w/3;
+            drawImgR (band, digit_b, txt_clr);
+            digit_b.x += 3*digit_b.w/2;
+            drawImgW (band, digit_b, txt_clr);
+        }
+    }
+
+    // send all counter blocks
+    StackMalloc blk_mem(BLOK_NROWS*BLOK_NCOLS);
+    uint8_t *blk_changed = (uint8_t *) blk_mem.getMem();
+    memset (blk_changed, 0, BLOK_NROWS*BLOK_NCOLS);
+    for (int ry = CTR_BR0; ry < CTR_BR1; ry++)
+        memset (&blk_changed[ry*BLOK_NCOLS + CTR_BC0], 1, CTR_BC1 - CTR_BC0);
+    encodeDelta (codec, band, CTR_BR0, blk_changed, CTR_BR0, CTR_BR1, NULL, msg);
+}
+
+/* bring client up to date with the current frame by sending the cached deltas since the generation it last
+ * received, or the keyframe if it is too far behind. then draw the connection counter if it changed or
+ * might have been overwritten. always send at least one message so the client keeps asking.
+ */
+static void updateExistingClient (ws_cli_conn_t *client)
+{
+    // curious how long these steps take
+    struct timeval tv0;
+    gettimeofday (&tv0, NULL);
+
+    // find what client has now
+    SessionInfo si;
+    if (!getSI (client, si))
         return;
 
-    // fresh capture
-    if (!tft.getRawPix (pixels, LIVE_NPIX))
-        bye ("getRawPix for png failed\n");
+    // collect copies of what client needs so we can send without holding frame_lock
+    LiveMsg msgs[LIVE_NDELTAS+1];
+    int n_msgs = 0;
+    bool key = false;
+    bool ctr_covered = false;
+    uint32_t ctr = clientCounter (client);
 
-    // convert image to and send as png
-    stbi_write_png_compression_level = 2;       // faster with hardly any increase in size
-    stbi_write_png_to_func (wifiSTBWrite_helper, client, BUILD_W, BUILD_H, COMP_RGB, pixels, LIVE_RBYTES);
+    pthread_mutex_lock (&frame_lock);
+
+        freshenFrame();
+
+        // keyframe if client is new, too far behind or changed codec since the deltas were encoded
+        LiveCodec codec = (LiveCodec) si.codec;
+        key = si.gen == 0 || frame_gen - si.gen >= LIVE_NDELTAS;
+        for (uint32_t g = si.gen + 1; !key && g <= frame_gen; g++) {
+            const LiveDelta &ld = frame_deltas[g % LIVE_NDELTAS];
+            key = ld.gen != g || !ld.msg[codec].body;
+        }
+
+        if (key) {
+            getKeyFrame (msgs[n_msgs++]);
+            ctr_covered = true;
+        } else {
+            for (uint32_t g = si.gen + 1; g <= frame_gen; g++) {
+                const LiveDelta &ld = frame_deltas[g % LIVE_NDELTAS];
+                copyLiveMsg (ld.msg[codec], msgs[n_msgs++]);
+                if (ld.ctr)
+                    ctr_covered = true;
+            }
+        }
+
+        // counter is sent if it changed or any of the above drew over it, or just to keep client going
+        if (ctr != si.ctr || (ctr_covered && ctr) || n_msgs == 0)
+            encodeCounter (ctr, codec, msgs[n_msgs++]);
+
+        si.gen = frame_gen;
+
+    pthread_mutex_unlock (&frame_lock);
+
+    // send in order then record what client has now
+    for (int i = 0; i < n_msgs; i++) {
+        sendLiveMsg (client, msgs[i]);
+        freeLiveMsg (msgs[i]);
+    }
+    setSI (client, si.gen, ctr);
+
+    if (debugLevel (DEBUG_WEB, 2)) {
+        struct timeval tv1;
+        gettimeofday (&tv1, NULL);
+        Serial.printf ("LIVE: client %s: sent %d %s through gen %u in %ld usec\n", ws_getaddress(client),
+                        n_msgs, key ? "incl keyframe" : "deltas", si.gen, TVDELUS (tv0,tv1));
+    }
+}
+
+/* send client the keyframe of the current frame.
+ */
+static void sendClientPNG (ws_cli_conn_t *client)
+{
+    LiveMsg msg;
+    memset (&msg, 0, sizeof(msg));
+
+    pthread_mutex_lock (&frame_lock);
+        freshenFrame();
+        getKeyFrame (msg);
+        uint32_t gen = frame_gen;
+    pthread_mutex_unlock (&frame_lock);
+
+    sendLiveMsg (client, msg);
+    freeLiveMsg (msg);
+
+    // counter will be drawn with the next update
+    setSI (client, gen, 0);
 
     if (debugLevel (DEBUG_WEB, 1))
-        Serial.printf ("LIVE: client %s: sent full PNG\n", ws_getaddress(client));
+        Serial.printf ("LIVE: client %s: sent full PNG gen %u\n", ws_getaddress(client), gen);
 }
 
 /* send message that user wants full screen.
@@ -480,6 +1052,49 @@ static void getLiveUpdate (ws_cli_conn_t *client, char args[], size_t args_len)
     updateExistingClient (client);
 }
 
+/* client running liveweb-html.cpp asking for updates in the given codec.
+ * unknown codecs are ignored so the client continues to receive png.
+ */
+static void setLiveCodec (ws_cli_conn_t *client, char args[], size_t args_len)
+{
+    WebArgs wa;
+    wa.nargs = 0;
+    wa.name[wa.nargs++] = "c";
+
+    // parse
+    if (!parseWebCommand (wa, args, args_len) || !wa.found[0]) {
+        Serial.printf ("LIVE: set_codec garbled: %s\n", args);
+        return;
+    }
+
+    // find
+    int codec = -1;
+    for (int i = 0; i < N_LIVE_CODECS; i++) {
+        if (strcmp (wa.value[0], live_codec_names[i]) == 0) {
+            codec = i;
+            break;
+        }
+    }
+    if (codec < 0) {
+        Serial.printf ("LIVE: client %s: unknown codec %s, staying with %s\n", ws_getaddress(client),
+                                wa.value[0], live_codec_names[LIVE_CODEC_PNG]);
+        return;
+    }
+
+    // set
+    pthread_mutex_lock (&si_lock);
+    for (int i = 0; i < si_n; i++) {
+        if (si_list[i].client == client) {
+            si_list[i].codec = codec;
+            break;
+        }
+    }
+    pthread_mutex_unlock (&si_lock);
+
+    if (debugLevel (DEBUG_WEB, 1))
+        Serial.printf ("LIVE: client %s: using codec %s\n", ws_getaddress(client), wa.value[0]);
+}
+
 /* client running liveweb-html.cpp sending us a character to act on as if typed locally.
  */
 static void setLiveChar (ws_cli_conn_t *client, char args[], size_t args_len)
@@ -610,6 +1225,7 @@ static void setLiveTouch (ws_cli_conn_t *client, char args[], size_t args_len)
             wifi_tt_s.x = x;
             wifi_tt_s.y = y;
             wifi_tt = button ? TT_TAP_BX : TT_TAP;              // 0 means button 1 -- go figure
+            wakeMainLoop();
 
             // record this client as the latest to do a touch
             lastest_ws_touch_client = client;
@@ -650,6 +1266,7 @@ static void setLiveMouse (ws_cli_conn_t *client, char args[], size_t args_len)
         int x = atoi(wa.value[0]);
         int y = atoi(wa.value[1]);
         tft.setMouse (x, y);
+        wakeMainLoop();                                 // so the info box follows
         if (debugLevel (DEBUG_WEB, 1))
             Serial.printf ("LIVE: set_mouse %d %d\n", x, y);
             
@@ -689,7 +1306,7 @@ static void sendLiveFavicon (FILE *sockfp)
 }
 
 /* callback when browser asks for a new websocket connection.
- * assign a fresh si_list for keeping track its pixels.
+ * assign a fresh si_list entry for keeping track of what it displays.
  */
 static void ws_onopen(ws_cli_conn_t *client)
 {
@@ -704,11 +1321,6 @@ static void ws_onopen(ws_cli_conn_t *client)
         SessionInfo *sip = &si_list[i];
         if (!sip->client) {
             new_sip = sip;
-            // insure no stale pixels
-            if (new_sip->pixels) {
-                free (new_sip->pixels);
-                new_sip->pixels = NULL;
-            }
             break;
         }
     }
@@ -728,12 +1340,12 @@ static void ws_onopen(ws_cli_conn_t *client)
         }
     }
 
-    // init including memory for pixels but don't capture until client asks for them
+    // init but don't capture until client asks
     if (new_sip) {
         new_sip->client = client;
-        new_sip->pixels = (uint8_t *) malloc (LIVE_NBYTES);
-        if (!new_sip->pixels)
-            bye ("No memory for new live session pixels\n");
+        new_sip->gen = 0;
+        new_sip->ctr = 0;
+        new_sip->codec = LIVE_CODEC_PNG;
 
         // increment appropriate counter
         if (client->port == liveweb_ro_port) {
@@ -762,12 +1374,6 @@ static void ws_onclose (ws_cli_conn_t *client)
         if (sip->client == client) {
             sip->client = NULL;
 
-            // recycle pixel memory
-            if (sip->pixels) {
-                free (sip->pixels);
-                sip->pixels = NULL;
-            }
-
             // decrement appropriate counter
             if (client->port == liveweb_ro_port) {
                 n_roweb -= 1;
@@ -803,6 +1409,7 @@ static void ws_onmessage (ws_cli_conn_t *client, const unsigned char *msg, uint6
         {"set_touch?",    setLiveTouch},
         {"set_char?",     setLiveChar},
         {"get_live.png?", getLivePNG},
+        {"set_codec?",    setLiveCodec},
     };
 
     // msg as null-terminated string cmd
@@ -948,3 +1555,126 @@ bool isLiveWebTouch (void)
 {
     return (lastest_ws_touch_client != NULL);
 }
+
+/* return name of file used to capture frames for benchmarkLiveCodecs()
+ */
+static std::string liveCaptureName(void)
+{
+    return (our_dir + "live-frames.rgb");
+}
+
+/* start saving the next n distinct frames seen by live web clients for benchmarkLiveCodecs().
+ * N.B. frames are only produced while at least one live client is connected.
+ */
+bool captureLiveFrames (int n, Message &ynot)
+{
+    if (n < 2) {
+        ynot.set ("capture requires at least 2 frames");
+        return (false);
+    }
+
+    std::string fn = liveCaptureName();
+    pthread_mutex_lock (&frame_lock);
+        if (capture_fp)
+            fclose (capture_fp);
+        capture_fp = fopen (fn.c_str(), "w");
+        capture_n = n;
+    pthread_mutex_unlock (&frame_lock);
+
+    if (!capture_fp) {
+        ynot.printf ("%s: %s", fn.c_str(), strerror(errno));
+        return (false);
+    }
+    Serial.printf ("LIVE: capturing %d frames to %s\n", n, fn.c_str());
+    return (true);
+}
+
+/* replay the frames saved by captureLiveFrames() through each codec and report the mean size and encode
+ * time of each frame change. lwq messages are also decoded to confirm they reproduce each frame exactly.
+ */
+bool benchmarkLiveCodecs (LiveCodecBench lcb[N_LIVE_CODECS], Message &ynot)
+{
+    std::string fn = liveCaptureName();
+    FILE *fp = fopen (fn.c_str(), "r");
+    if (!fp) {
+        ynot.printf ("%s: %s", fn.c_str(), strerror(errno));
+        return (false);
+    }
+
+    uint8_t *prev = (uint8_t *) malloc (LIVE_NBYTES);
+    uint8_t *now = (uint8_t *) malloc (LIVE_NBYTES);
+    uint8_t *check = (uint8_t *) malloc (LIVE_NBYTES);
+    uint8_t *blk_changed = (uint8_t *) malloc (BLOK_NROWS*BLOK_NCOLS);
+    if (!prev || !now || !check || !blk_changed)
+        bye ("No memory for live codec benchmark\n");
+
+    for (int c = 0; c < N_LIVE_CODECS; c++) {
+        lcb[c].name = live_codec_names[c];
+        lcb[c].n_frames = 0;
+        lcb[c].bytes = 0;
+        lcb[c].usecs = 0;
+        lcb[c].lossless = true;
+    }
+
+    bool ok = fread (prev, LIVE_NBYTES, 1, fp) == 1;
+    if (!ok)
+        ynot.printf ("%s: no frames", fn.c_str());
+    while (ok && fread (now, LIVE_NBYTES, 1, fp) == 1) {
+
+        // find changed blocks
+        memset (blk_changed, 0, BLOK_NROWS*BLOK_NCOLS);
+        for (int ry = 0; ry < BLOK_NROWS; ry++) {
+            for (int rx = 0; rx < BLOK_NCOLS; rx++) {
+                int blok_start = ry*BLOK_H*LIVE_RBYTES + rx*BLOK_WBYTES;
+                for (int r = 0; r < BLOK_H; r++) {
+                    if (memcmp (&now[blok_start + r*LIVE_RBYTES], &prev[blok_start + r*LIVE_RBYTES],
+                                                BLOK_WBYTES) != 0) {
+                        blk_changed[ry*BLOK_NCOLS + rx] = 1;
+                        break;
+                    }
+                }
+            }
+        }
+
+        // encode with each codec
+        for (int c = 0; c < N_LIVE_CODECS; c++) {
+            LiveMsg msg;
+            memset (&msg, 0, sizeof(msg));
+            struct timeval tv0, tv1;
+            gettimeofday (&tv0, NULL);
+            encodeDelta ((LiveCodec)c, now, 0, blk_changed, 0, BLOK_NROWS, prev, msg);
+            gettimeofday (&tv1, NULL);
+            lcb[c].n_frames++;
+            lcb[c].bytes += msg.hdr_l + msg.body_l;
+            lcb[c].usecs += TVDELUS (tv0, tv1);
+            if (c == LIVE_CODEC_LWQ) {
+                memcpy (check, prev, LIVE_NBYTES);
+                if (!decodeLWQ (msg.body, msg.body_l, check) || memcmp (check, now, LIVE_NBYTES) != 0)
+                    lcb[c].lossless = false;
+            }
+            freeLiveMsg (msg);
+        }
+
+        // next
+        uint8_t *tmp = prev;
+        prev = now;
+        now = tmp;
+    }
+    fclose (fp);
+
+    for (int c = 0; c < N_LIVE_CODECS; c++) {
+        if (lcb[c].n_frames > 0) {
+            lcb[c].bytes /= lcb[c].n_frames;
+            lcb[c].usecs /= lcb[c].n_frames;
+        }
+        Serial.printf ("LIVEBENCH: %-4s %5d frames %10.0f bytes %10.0f usec %s\n", lcb[c].name,
+                lcb[c].n_frames, lcb[c].bytes, lcb[c].usecs, lcb[c].lossless ? "lossless" : "LOSSY");
+    }
+
+    free (prev);
+    free (now);
+    free (check);
+    free (blk_changed);
+
+    return (ok);
+}
@@ -1152,7 +1152,8 @@ void rotateNextMap()
 }
 
 
-/* Decompress in_n bytes from client to out_fp until stream ends or EOF.
+/* Decompress in_n bytes, or until EOF if in_n < 0, of zlib or gzip format from client to out_fp until
+ * stream ends or EOF.
  * return whether successful.
  * modeled after zpipe.
  */
@@ -1173,7 +1174,7 @@ bool zinfWiFiFILE (WiFiClient &client, int in_n, FILE *out_fp)
     strm.opaque = Z_NULL;
     strm.avail_in = 0;
     strm.next_in = Z_NULL;
-    ret = inflateInit(&strm);
+    ret = inflateInit2(&strm, 15+32);           // max window, detect zlib or gzip header
     if (ret != Z_OK) {
         Serial.printf ("inflateInit failed: %s\n", strm.msg);
         return (false);
@@ -1182,7 +1183,7 @@ bool zinfWiFiFILE (WiFiClient &client, int in_n, FILE *out_fp)
     // decompress until deflate stream ends, read in_n bytes or end of file
     do {
         // fill in[]
-        int n_read = in_n - in_read;
+        int n_read = in_n < 0 ? CHUNK : in_n - in_read;
         if (n_read > CHUNK)
             n_read = CHUNK;
         strm.avail_in = client.readArray (in, n_read);
@@ -1221,8 +1222,8 @@ bool zinfWiFiFILE (WiFiClient &client, int in_n, FILE *out_fp)
     (void)inflateEnd(&strm);
     if (ret == Z_STREAM_END) {
         // N.B. an empty file will return Z_STREAM_END!
-        if (out_n > in_n) {
-            Serial.printf ("inflated %d -> %d\n", in_n, out_n);
+        if (in_n < 0 || out_n > in_n) {
+            Serial.printf ("inflated %d -> %d\n", in_read, out_n);
             return (true);
         }
         Serial.printf ("inflate did not expand: %d -> %d\n", in_n, out_n);
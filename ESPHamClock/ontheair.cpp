@@ -55,6 +55,7 @@ static uint8_t onta_age;                                // one of above, once se
 static DXSpot *onta_spots;                              // malloced list, complete
 static int n_ontaspots;                                 // n spots in onta_spots
 static DXSpot *ontawl_spots;                            // filtered malloced list, count in onta_ss.n_data
+static SpotIndex ontawl_si;                             // map location index of ontawl_spots
 static ScrollState onta_ss;                             // scrolling state
 static uint8_t onta_sortby;                             // one of ONTASort
 static bool onta_showbio;                               // whether click shows bio
@@ -405,6 +406,7 @@ static void rebuildONTAWatchList(void)
 
     // sort as desired and scroll to newest with new n_data
     qsort (ontawl_spots, onta_ss.n_data, sizeof(DXSpot), onta_sorts[onta_sortby].qsf);
+    spotIndexChanged (ontawl_si);
     onta_ss.scrollToNewest();
 }
 
@@ -549,6 +551,7 @@ static void resetONTAStorage (const SBox &box)
     n_ontaspots = 0;
     free (ontawl_spots);
     ontawl_spots = NULL;
+    spotIndexChanged (ontawl_si);
     onta_ss.init ((box.h - LISTING_Y0)/LISTING_DY, 0, 0, onta_ss.DIR_FROMSETUP);
     onta_ss.scrollToNewest();
     onta_ss.initNewSpotsSymbol (box, ONTA_COLOR);
@@ -782,12 +785,14 @@ void drawOnTheAirSpotsOnMap (void)
     }
 }
 
-/* find closest ontawl_spot and location on tx end to given ll (we don't use rx_ll), if any.
+/* find closest ontawl_spot and location on tx end to given ll (we don't use rx_ll), if any,
+ * and how many spots are near it.
  */
-bool getClosestOnTheAirSpot (LatLong &ll, DXSpot *onta_closest, LatLong *ll_closest)
+bool getClosestOnTheAirSpot (LatLong &ll, DXSpot *onta_closest, LatLong *ll_closest, int *n_near)
 {
     return (ontawl_spots && findPaneForChoice (PLOT_CH_ONTA) != PANE_NONE && getSpotLabelType() != LBL_NONE
-            && getClosestSpot (ontawl_spots, onta_ss.n_data, NULL, LOME_TXEND, ll, onta_closest, ll_closest));
+            && getClosestSpot (ontawl_si, ontawl_spots, onta_ss.n_data, NULL, LOME_TXEND, ll, onta_closest,
+                                        ll_closest, n_near));
 }
 
 /* return spot in our pane if under ms 
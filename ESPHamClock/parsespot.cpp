@@ -398,6 +398,7 @@ bool crackADIFSpot (const char string[], DXSpot &spot)
     GenReader gr(string, strlen (string));
     DXSpot *spots = NULL;
     int n_bad;
+    resetDXPedsWorked();
     int n_good = readADIFFile (gr, spots, false, n_bad);
     bool ok = false;
     if (n_good > 0) {
@@ -7,24 +7,36 @@
 #include "HamClock.h"
 
 
-/* prefixes are cached with fast radix access
+/* prefixes are cached in a trie for fast longest-match access
  */
 
 static char cty_page[] = "/cty/cty_wt_mod-ll-dxcc.txt";         // web page to download
 static char cty_fn[] = "cty-ll-dxcc.txt";                       // local cache copy name
 
 typedef struct {
-    char call[MAX_SPOTCALL_LEN];                // mostly prefixes, a few calls; sorted ala strcmp
+    char call[MAX_SPOTCALL_LEN];                // mostly prefixes, a few calls; any leading = removed
     float lat_d, lng_d;                         // +N +E degrees
-    int call_len;                               // handy strlen(call)
     int dxcc;                                   // DXCC number
+    bool exact;                                 // call was marked =, matches only itself
 } CtyLoc;
 static CtyLoc *cty_list;                        // malloced list
 static int n_cty, n_malloc;                     // n entries used, n malloced
-#define _N_RADIX ('Z' - '0' + 1)                // radix range, 
-static int cty_radix[_N_RADIX];                 // table of cty_list index from first character
-static char prev_radix;                         // used to detect change in radis index
+
+/* each node is reached from its parent by one more call character. all children of a node are contiguous
+ * and sorted by c once the trie is compacted, so a lookup costs one short scan per call character.
+ */
+typedef struct {
+    int child;                                  // index of first child, else 0; next sibling while building
+    int prefix;                                 // cty_list index of prefix ending here, else -1
+    int exact;                                  // cty_list index of exact call ending here, else -1
+    uint8_t n_child;                            // n contiguous children starting at child
+    char c;                                     // character leading here from parent
+} CtyNode;
+static CtyNode *cty_trie;                       // malloced trie, root is [0]
+static int n_trie, n_trie_malloc;               // n nodes used, n malloced
 static time_t next_refresh;                     // time of next download
+static pthread_mutex_t cty_lock = PTHREAD_MUTEX_INITIALIZER;   // lookups may come from ADIF parsing threads
+static int cty_holds;                           // n readyCty() not yet released, no (re)loading while > 0
 #define MAX_CTY_AGE     (1*24*3600)             // normally update city file this often, secs
 #define MIN_CTY_SIZ     800000                  // min believable file size
 #define RETRY_DT        60                      // retry interval if trouble, secs
@@ -674,30 +686,128 @@ static const SmallPrefix small_prefs[] = {
 #define N_SMALLPREFS NARRAY(small_prefs)
 
 
+/* small_prefs is also bucketed by location on a coarse grid so ll2Prefix() need only check nearby cells.
+ * each cell lists its small_prefs indices in ascending order, contiguous in spref_cells.
+ */
+#define SPREF_CELL      4                       // grid cell size, degrees
+#define SPREF_ROWS      (180/SPREF_CELL)        // n cells in latitude
+#define SPREF_COLS      (360/SPREF_CELL)        // n cells in longitude
+#define SPREF_SLACK     0.01F                   // extra cell bound allowance for rounding, degrees
+static uint16_t spref_start[SPREF_ROWS*SPREF_COLS+1]; // spref_cells index of first entry in each cell
+static uint16_t spref_cells[N_SMALLPREFS];      // small_prefs indices grouped by cell
+static bool spref_ready;                        // set once spref_start and spref_cells are built
+
+/* return grid row and column containing the given location
+ */
+static void smallPrefCell (float lat_d, float lng_d, int &row, int &col)
+{
+    row = (int) floorf ((lat_d + 90) / SPREF_CELL);
+    row = row < 0 ? 0 : (row >= SPREF_ROWS ? SPREF_ROWS-1 : row);
+    col = ((int) floorf ((lng_d + 180) / SPREF_CELL) % SPREF_COLS + SPREF_COLS) % SPREF_COLS;
+}
+
+/* bucket small_prefs into spref_start and spref_cells
+ */
+static void buildSmallPrefCells (void)
+{
+    // count per cell, offset by one
+    memset (spref_start, 0, sizeof(spref_start));
+    for (int i = 0; i < N_SMALLPREFS; i++) {
+        int row, col;
+        smallPrefCell (0.01F * small_prefs[i].lat, 0.01F * small_prefs[i].lng, row, col);
+        spref_start[row*SPREF_COLS + col + 1]++;
+    }
+
+    // convert to starting positions
+    for (int c = 0; c < SPREF_ROWS*SPREF_COLS; c++)
+        spref_start[c+1] += spref_start[c];
+
+    // fill in ascending order
+    uint16_t fill[SPREF_ROWS*SPREF_COLS];
+    memcpy (fill, spref_start, sizeof(fill));
+    for (int i = 0; i < N_SMALLPREFS; i++) {
+        int row, col;
+        smallPrefCell (0.01F * small_prefs[i].lat, 0.01F * small_prefs[i].lng, row, col);
+        spref_cells[fill[row*SPREF_COLS + col]++] = i;
+    }
+
+    spref_ready = true;
+}
+
+/* return the ll2Prefix() separation of ll from small_prefs[i], given coslat = cosf(ll.lat).
+ * N.B. this is a simple linear approximation and, because lngDiff() is not symmetric, favors entries
+ *   at or west of ll.
+ */
+static float smallPrefDist (const LatLong &ll, float coslat, int i)
+{
+    float dlat = fabsf (ll.lat_d - 0.01F * small_prefs[i].lat);
+    float dlng = coslat * fabsf (lngDiff (ll.lng_d - 0.01F * small_prefs[i].lng));
+    return (dlat + dlng);
+}
+
 /* find nearest small_prefs to the given LL, if within allowed max
  * N.B. tried cty but it has way too many weird ones, eg it finds AX? instead of VK? and lots of
  *   parochial US calls. Don't try it!
  */
 bool ll2Prefix (const LatLong &ll, char prefix[MAX_PREF_LEN])
 {
-    // scan for closest location -- use simple linear approx
-    float mind = 1e10;                                  // min linear degree separation so far
+    if (!spref_ready)
+        buildSmallPrefCells();
+
+    // our cell and how far we are east of its west edge
+    int row_ll, col_ll;
+    smallPrefCell (ll.lat_d, ll.lng_d, row_ll, col_ll);
+    float east_of = lngDiff (ll.lng_d - (col_ll * SPREF_CELL - 180));
     float coslat = cosf(ll.lat);                        // handy
-    uint16_t closest_smpref = 0;                        // small_prefs index of closest entry
-    for (int i = 0; i < N_SMALLPREFS; i++) {
-        float dlat = fabsf (ll.lat_d - 0.01F * small_prefs[i].lat);
-        if (dlat < mind) {                              // dont bother adding dlng if already > mind
-            float dlng = coslat * fabsf (lngDiff (ll.lng_d - 0.01F * small_prefs[i].lng));
-            float d = dlat + dlng;
-            if (d < mind) {
-                mind = d;
-                closest_smpref = i;
+    float coslat_lb = fmaxf (coslat, 0);                // in case rounding near the poles
+
+    // check each entry in each cell that could be closer than the best so far, starting with our row
+    // and working outwards in latitude, and with our cell and working westwards in longitude.
+    // ties go to the lowest index to match a linear scan.
+    float mind = 1e10;                                  // min linear degree separation so far
+    int closest_smpref = -1;                            // small_prefs index of closest entry
+    for (int dr = 0; dr < SPREF_ROWS; dr++) {
+
+        // next row each side, done when both too far for either the best so far or MAX_DIST
+        bool any_row = false;
+        for (int side = 0; side < (dr ? 2 : 1); side++) {
+            int row = side ? row_ll + dr : row_ll - dr;
+            if (row < 0 || row >= SPREF_ROWS)
+                continue;
+
+            // lower bound of dlat for any entry in this row
+            float row_lat = row * SPREF_CELL - 90;
+            float lat_lb = ll.lat_d < row_lat ? row_lat - ll.lat_d
+                            : (ll.lat_d > row_lat + SPREF_CELL ? ll.lat_d - (row_lat + SPREF_CELL) : 0);
+            if (lat_lb - SPREF_SLACK > mind || lat_lb - SPREF_SLACK > MAX_DIST)
+                continue;
+            any_row = true;
+
+            for (int k = 0; k < SPREF_COLS; k++) {
+
+                // lower bound of dlng for any entry in this cell, 0 if ours else from its east edge
+                float lng_lb = k == 0 ? 0 : east_of + (k-1)*SPREF_CELL;
+                float lb = lat_lb + coslat_lb * lng_lb - SPREF_SLACK;
+                if (lb > mind || lb > MAX_DIST)
+                    break;
+
+                int cell = row*SPREF_COLS + (col_ll - k + SPREF_COLS) % SPREF_COLS;
+                for (int j = spref_start[cell]; j < spref_start[cell+1]; j++) {
+                    int i = spref_cells[j];
+                    float d = smallPrefDist (ll, coslat, i);
+                    if (d < mind || (d == mind && i < closest_smpref)) {
+                        mind = d;
+                        closest_smpref = i;
+                    }
+                }
             }
         }
+        if (!any_row)
+            break;
     }
 
     // fail if too far away
-    if (mind > MAX_DIST)
+    if (closest_smpref < 0 || mind > MAX_DIST)
         return (false);
 
     // save in prefix[] as legitimate string
@@ -819,6 +929,103 @@ static void initCty(void)
     cty_list = NULL;
     n_cty = 0;
     n_malloc = 0;
+
+    if (cty_trie)
+        free (cty_trie);
+    cty_trie = NULL;
+    n_trie = 0;
+    n_trie_malloc = 0;
+}
+
+/* add a new empty trie node reached via c and return its index.
+ * N.B. may move cty_trie
+ */
+static int newCtyNode (char c)
+{
+    if (n_trie + 1 > n_trie_malloc) {
+        cty_trie = (CtyNode *) realloc (cty_trie, (n_trie_malloc += 4096) * sizeof(CtyNode));
+        if (!cty_trie)
+            fatalError ("No memory for cty trie %d\n", n_trie_malloc);
+    }
+    CtyNode &n = cty_trie[n_trie];
+    n.child = 0;
+    n.prefix = n.exact = -1;
+    n.n_child = 0;
+    n.c = c;
+    return (n_trie++);
+}
+
+/* add cty_list[cl_i] to the trie, still in its building form with child and sibling lists.
+ * the first of any duplicates is retained.
+ */
+static void addCtyTrie (int cl_i, int *sibling)
+{
+    int node = 0;
+    for (const char *cp = cty_list[cl_i].call; *cp != '\0'; cp++) {
+
+        // find c among children sorted by c else insert it
+        int prev = 0;
+        int ch = cty_trie[node].child;
+        while (ch && cty_trie[ch].c < *cp) {
+            prev = ch;
+            ch = sibling[ch];
+        }
+        if (!ch || cty_trie[ch].c != *cp) {
+            int new_ch = newCtyNode (*cp);
+            sibling[new_ch] = ch;
+            if (prev)
+                sibling[prev] = new_ch;
+            else
+                cty_trie[node].child = new_ch;
+            cty_trie[node].n_child++;
+            ch = new_ch;
+        }
+        node = ch;
+    }
+
+    int &slot = cty_list[cl_i].exact ? cty_trie[node].exact : cty_trie[node].prefix;
+    if (slot < 0)
+        slot = cl_i;
+}
+
+/* build cty_trie from cty_list.
+ * nodes are inserted using temporary sibling links then copied breadth first so each set of children is
+ * contiguous.
+ */
+static void buildCtyTrie (void)
+{
+    // plenty of sibling links, nodes can not exceed the total of all call lengths
+    int max_nodes = 1;
+    for (int i = 0; i < n_cty; i++)
+        max_nodes += strlen (cty_list[i].call);
+    StackMalloc sib_mem(max_nodes * sizeof(int));
+    int *sibling = (int *) sib_mem.getMem();
+
+    (void) newCtyNode ('\0');
+    for (int i = 0; i < n_cty; i++)
+        addCtyTrie (i, sibling);
+
+    // compact by copying breadth first, each node's children are appended together in sorted order
+    CtyNode *bfs = (CtyNode *) malloc (n_trie * sizeof(CtyNode));
+    if (!bfs)
+        fatalError ("No memory for cty trie %d\n", n_trie);
+    StackMalloc old_mem(n_trie * sizeof(int));
+    int *old_i = (int *) old_mem.getMem();      // old index of each bfs node
+    bfs[0] = cty_trie[0];
+    old_i[0] = 0;
+    int n_bfs = 1;
+    for (int i = 0; i < n_bfs; i++) {
+        int ch = cty_trie[old_i[i]].child;
+        bfs[i].child = ch ? n_bfs : 0;
+        for (; ch; ch = sibling[ch]) {
+            bfs[n_bfs] = cty_trie[ch];
+            old_i[n_bfs++] = ch;
+        }
+    }
+
+    free (cty_trie);
+    cty_trie = bfs;
+    n_trie_malloc = n_trie;
 }
 
 /* crack and add another line to cty_list
@@ -826,37 +1033,33 @@ static void initCty(void)
 static void addCtyLine (char *line)
 {
     // skip blank and comment lines
-    if (line[0] == '\n' || line[0] == '#')
+    if (line[0] == '\0' || line[0] == '#')
         return;
 
     // crack
     CtyLoc cl;
-    if (sscanf (line, "%10s %f %f %d", cl.call, &cl.lat_d, &cl.lng_d, &cl.dxcc) != 4) {
+    if (sscanf (line, "%11s %f %f %d", cl.call, &cl.lat_d, &cl.lng_d, &cl.dxcc) != 4) {
         Serial.printf ("CTY: %s bad format: %s\n", cty_page, line);
         return;
     }
 
+    // = marks an exact call as in cty.dat
+    cl.exact = cl.call[0] == '=';
+    if (cl.exact)
+        memmove (cl.call, cl.call+1, strlen(cl.call));
+    if (cl.call[0] == '\0')
+        return;
+
     // add to list, expanding as needed
     if (n_cty + 1 > n_malloc) {
         cty_list = (CtyLoc *) realloc (cty_list, (n_malloc += 1000) * sizeof(CtyLoc));
         if (!cty_list)
             fatalError ("No memory for cty location list %d\n", n_malloc);
     }
-    cl.call_len = strlen(cl.call);
     cty_list[n_cty++] = cl;
-
-    // update radix index when first char changes
-    if (cl.call[0] != prev_radix) {
-        int radix_index = cl.call[0] - '0';
-        if (radix_index < 0 || radix_index >= _N_RADIX)
-            fatalError ("cty radix out of range %d %d", radix_index, _N_RADIX);
-        cty_radix[radix_index] = n_cty - 1;
-        prev_radix = cl.call[0];
-        // printf ("********* radix %c %5d %5d\n",cl.call[0], radix_index, radix[radix_index]);
-    }
 }
 
-/* insure cty_lst and its supporting radix index are ready to use, even if stale if no other way.
+/* insure cty_lst and its supporting trie are ready to use, even if stale if no other way.
  * use local file but if absent or too old try to download.
  * return whether cty_list is ready.
  */
@@ -873,61 +1076,69 @@ static bool loadCtyFile(void)
         return (false);
     }
 
-    // (re)build cty_list
+    // (re)build cty_list and its trie
     initCty();
     char line[100];
     while (fgets (line, sizeof(line), fp)) {
         chompString (line);
         addCtyLine (line);
     }
+    buildCtyTrie();
 
     // done
     fclose (fp);
     next_refresh = myNow() + MAX_CTY_AGE;
-    Serial.printf ("CTY: loaded %d locations from %s\n", n_cty, cty_fn);
+    Serial.printf ("CTY: loaded %d locations from %s in %d trie nodes\n", n_cty, cty_fn, n_trie);
 
     // real question is whether cty_list exists
     return (cty_list != NULL);
 }
 
-/* search for best CtyLoc for the given prefix.
+/* search for best CtyLoc for the given call: an exact call entry if any, else the longest prefix entry.
  * return pointer else NULL
  */
-static const CtyLoc *searchCty (const char *prefix)
+static const CtyLoc *searchCty (const char *call)
 {
-    // start at radix then find longest cty_list call entry that starts with prefix.
+    if (!cty_trie)
+        return (NULL);
+
+    // walk down the trie as far as call allows, noting each prefix passed along the way
     const CtyLoc *candidate = NULL;
-    int radix_index = prefix[0] - '0';
-    if (radix_index >= 0 && radix_index < _N_RADIX) {
-        int start = cty_radix[radix_index];
-        int len_match = 0;                              // find longest match
-        for (int i = start; i < n_cty; i++) {           // start at this radix, go to end or next radix
-            const CtyLoc *cp = &cty_list[i];
-            if (cp->call[0] != prefix[0])
-                break;                                  // end of this radix
-            if (strncmp (cp->call, prefix, cp->call_len) == 0) {
-                int cc_len = strlen(cp->call);
-                if (cc_len > len_match) {
-                    len_match = cc_len;
-                    candidate = cp;
-                    if (debugLevel (DEBUG_CTY, 1))
-                        Serial.printf ("CTY: match for %s now %s length %d\n", prefix, cp->call, len_match);
-                }
-            }
+    const CtyNode *np = &cty_trie[0];
+    const char *cp;
+    for (cp = call; *cp != '\0'; cp++) {
+        const CtyNode *ch = &cty_trie[np->child];
+        const CtyNode *ch_end = ch + np->n_child;
+        while (ch < ch_end && ch->c < *cp)
+            ch++;
+        if (ch == ch_end || ch->c != *cp)
+            break;
+        np = ch;
+        if (np->prefix >= 0) {
+            candidate = &cty_list[np->prefix];
+            if (debugLevel (DEBUG_CTY, 1))
+                Serial.printf ("CTY: match for %s now %s length %d\n", call, candidate->call, (int)(cp-call+1));
         }
     }
 
+    // exact call overrides any prefix
+    if (*cp == '\0' && np->exact >= 0) {
+        candidate = &cty_list[np->exact];
+        if (debugLevel (DEBUG_CTY, 1))
+            Serial.printf ("CTY: exact match for %s\n", call);
+    }
+
     return (candidate);
 }
 
 
-/* given a call sign or prefix find its lat/long by querying the cty table.
- * return whether successful.
+/* call2LL() while holding cty_lock.
+ * N.B. this never loads cty_list, it just reports not found if it is not ready.
  */
-bool call2LL (const char *call, LatLong &ll)
+static bool call2LLLocked (const char *call, LatLong &ll)
 {
     // check cty_list
-    if (!loadCtyFile())
+    if (!cty_trie)
         return (false);
 
     // use the dx end of a portable call
@@ -958,13 +1169,13 @@ bool call2LL (const char *call, LatLong &ll)
     }
 }
 
-/* given a call sign or prefix find its DXCC number by querying the cty table.
- * return whether successful.
+/* call2DXCC() while holding cty_lock.
+ * N.B. this never loads cty_list, it just reports not found if it is not ready.
  */
-bool call2DXCC (const char *call, int &dxcc)
+static bool call2DXCCLocked (const char *call, int &dxcc)
 {
     // check cty_list
-    if (!loadCtyFile())
+    if (!cty_trie)
         return (false);
 
     // use the dx end of a portable call
@@ -986,3 +1197,338 @@ bool call2DXCC (const char *call, int &dxcc)
         return (false);
     }
 }
+
+
+/* given a call sign or prefix find its lat/long by querying the cty table.
+ * the table is loaded or refreshed first if necessary unless it is being held by readyCty().
+ * return whether successful.
+ * N.B. may be called from any thread but only the main thread, or another while the table is being held,
+ *   since loading may download and draw.
+ */
+bool call2LL (const char *call, LatLong &ll)
+{
+    pthread_mutex_lock (&cty_lock);
+    if (cty_holds == 0)
+        (void) loadCtyFile();
+    bool ok = call2LLLocked (call, ll);
+    pthread_mutex_unlock (&cty_lock);
+    return (ok);
+}
+
+/* given a call sign or prefix find its DXCC number by querying the cty table.
+ * the table is loaded or refreshed first if necessary unless it is being held by readyCty().
+ * return whether successful.
+ * N.B. same thread rules as call2LL()
+ */
+bool call2DXCC (const char *call, int &dxcc)
+{
+    pthread_mutex_lock (&cty_lock);
+    if (cty_holds == 0)
+        (void) loadCtyFile();
+    bool ok = call2DXCCLocked (call, dxcc);
+    pthread_mutex_unlock (&cty_lock);
+    return (ok);
+}
+
+/* insure the cty table is loaded, downloading if necessary, and return whether it is ready.
+ * if so the table is held as is, so call2LL() and call2DXCC() never load, until releaseCty().
+ * N.B. call from the main thread before other threads use call2LL() or call2DXCC(), and do not start
+ *   them at all if this fails.
+ */
+bool readyCty (void)
+{
+    pthread_mutex_lock (&cty_lock);
+    bool ok = cty_holds > 0 ? cty_trie != NULL : loadCtyFile();
+    if (ok)
+        cty_holds++;
+    pthread_mutex_unlock (&cty_lock);
+    return (ok);
+}
+
+/* release the hold on the cty table from a successful readyCty().
+ * N.B. call from the main thread once the other threads are done with it.
+ */
+void releaseCty (void)
+{
+    pthread_mutex_lock (&cty_lock);
+    if (cty_holds > 0)
+        cty_holds--;
+    pthread_mutex_unlock (&cty_lock);
+}
+
+
+
+#if defined(_UNIT_TEST)
+
+/* stand-alone check and benchmark of ll2Prefix() against a linear scan over a lat/lng grid, then of cty
+ * lookups against the former radix scan if given a cty file:
+ *    g++ -Wall -O2 -IArduinoLib -D_UNIT_TEST -o x.prefixes prefixes.cpp ArduinoLib/Serial.cpp
+ *    ./x.prefixes [cty-ll-dxcc.txt [calls.txt]]
+ * calls.txt has one call per line, such as cut from a spot or ADIF capture, else calls are made up from cty.
+ */
+
+static const char *test_cty_fn;
+
+uint32_t millis(void) { return (0); }
+time_t myNow() { return (0); }
+bool debugLevel (DebugSubsys s, int level) { (void)s; (void)level; return (false); }
+float lngDiff (float dlng) { return (fmodf (dlng + 720, 360)); }
+
+void fatalError (const char *fmt, ...)
+{
+    char msg[2000];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf (msg, sizeof(msg), fmt, ap);
+    va_end(ap);
+
+    printf ("Fatal: %s\n", msg);
+    exit(1);
+}
+
+bool strHasDigit (const char *s)
+{
+    return (strcspn (s, "0123456789") < strlen(s));
+}
+
+void quietStrncpy (char *to, const char *from, int len)
+{
+    snprintf (to, len, "%.*s", len-1, from);
+}
+
+void chompString (char *str)
+{
+    str[strcspn (str, "\r\n")] = '\0';
+}
+
+FILE *openCachedFile (const char *fn, const char *url, int max_age, int min_size)
+{
+    (void) fn; (void) url; (void) max_age; (void) min_size;
+    return (fopen (test_cty_fn, "r"));
+}
+
+/* the former search: cty_list sorted by call, linear scan from the radix of the first character.
+ */
+#define _N_RADIX ('Z' - '0' + 1)
+static CtyLoc *old_list;
+static int old_radix[_N_RADIX];
+
+static int oldCtyQSF (const void *v1, const void *v2)
+{
+    const CtyLoc *c1 = (const CtyLoc *)v1;
+    const CtyLoc *c2 = (const CtyLoc *)v2;
+    int d = strcmp (c1->call, c2->call);
+    return (d ? d : c1->dxcc - c2->dxcc);
+}
+
+static void oldCtyBuild (void)
+{
+    // sort a copy, breaking ties by original order so duplicates resolve the same way
+    StackMalloc sort_mem(n_cty * sizeof(CtyLoc));
+    CtyLoc *sort_list = (CtyLoc *) sort_mem.getMem();
+    memcpy (sort_list, cty_list, n_cty * sizeof(CtyLoc));
+    for (int i = 0; i < n_cty; i++)
+        sort_list[i].dxcc = i;                  // borrow to remember original position
+    qsort (sort_list, n_cty, sizeof(CtyLoc), oldCtyQSF);
+
+    old_list = (CtyLoc *) malloc (n_cty * sizeof(CtyLoc));
+    char prev_radix = 0;
+    for (int i = 0; i < n_cty; i++) {
+        old_list[i] = cty_list[sort_list[i].dxcc];
+        int radix_index = old_list[i].call[0] - '0';
+        if (old_list[i].call[0] != prev_radix && radix_index >= 0 && radix_index < _N_RADIX) {
+            old_radix[radix_index] = i;
+            prev_radix = old_list[i].call[0];
+        }
+    }
+}
+
+static const CtyLoc *oldSearchCty (const char *call)
+{
+    const CtyLoc *candidate = NULL;
+    int radix_index = call[0] - '0';
+    if (radix_index >= 0 && radix_index < _N_RADIX) {
+        int len_match = 0;
+        for (int i = old_radix[radix_index]; i < n_cty; i++) {
+            const CtyLoc *cp = &old_list[i];
+            if (cp->call[0] != call[0])
+                break;
+            int cc_len = strlen(cp->call);
+            if (cp->exact) {
+                if (strcmp (cp->call, call) == 0)
+                    return (cp);
+            } else if (strncmp (cp->call, call, cc_len) == 0 && cc_len > len_match) {
+                len_match = cc_len;
+                candidate = cp;
+            }
+        }
+    }
+    return (candidate);
+}
+
+/* the former ll2Prefix() search: linear scan of all small_prefs
+ */
+static bool oldLL2Prefix (const LatLong &ll, char prefix[MAX_PREF_LEN])
+{
+    float mind = 1e10;
+    float coslat = cosf(ll.lat);
+    uint16_t closest_smpref = 0;
+    for (int i = 0; i < N_SMALLPREFS; i++) {
+        float dlat = fabsf (ll.lat_d - 0.01F * small_prefs[i].lat);
+        if (dlat < mind) {
+            float d = smallPrefDist (ll, coslat, i);
+            if (d < mind) {
+                mind = d;
+                closest_smpref = i;
+            }
+        }
+    }
+    if (mind > MAX_DIST)
+        return (false);
+    memset (prefix, 0, MAX_PREF_LEN);
+    memcpy (prefix, small_prefs[closest_smpref].pref, SMALL_PREF_LEN);
+    return (true);
+}
+
+/* compare ll2Prefix() with oldLL2Prefix() at every point of a 0.2 degree grid, including the poles and
+ * both sides of the dateline, then time each over the same grid. return number that differ.
+ */
+static int checkLL2Prefix (void)
+{
+    // grid
+    const int n_ll = 901*1801;
+    LatLong *grid = (LatLong *) malloc (n_ll * sizeof(LatLong));
+    for (int lat10 = -900, n = 0; lat10 <= 900; lat10 += 2) {
+        for (int lng10 = -1800; lng10 <= 1800; lng10 += 2, n++) {
+            LatLong &ll = grid[n];
+            ll.lat_d = 0.1F * lat10;
+            ll.lng_d = 0.1F * lng10;
+            ll.lat = deg2rad (ll.lat_d);
+            ll.lng = deg2rad (ll.lng_d);
+        }
+    }
+
+    // compare
+    int n_found = 0, n_differ = 0;
+    for (int i = 0; i < n_ll; i++) {
+        char p_new[MAX_PREF_LEN], p_old[MAX_PREF_LEN];
+        bool ok_new = ll2Prefix (grid[i], p_new);
+        bool ok_old = oldLL2Prefix (grid[i], p_old);
+        if (ok_new)
+            n_found++;
+        if (ok_new != ok_old || (ok_new && strcmp (p_new, p_old))) {
+            if (n_differ++ < 10)
+                printf ("%7.1f %7.1f grid %s linear %s\n", grid[i].lat_d, grid[i].lng_d,
+                                        ok_new ? p_new : "-", ok_old ? p_old : "-");
+        }
+    }
+    printf ("ll2Prefix: %d locations, %d found, %d differ\n", n_ll, n_found, n_differ);
+
+    // time each
+    struct timeval tv0, tv1;
+    char prefix[MAX_PREF_LEN];
+    int sum = 0;
+    gettimeofday (&tv0, NULL);
+    for (int i = 0; i < n_ll; i++)
+        sum += oldLL2Prefix (grid[i], prefix);
+    gettimeofday (&tv1, NULL);
+    double old_us = TVDELUS(tv0,tv1);
+    gettimeofday (&tv0, NULL);
+    for (int i = 0; i < n_ll; i++)
+        sum -= ll2Prefix (grid[i], prefix);
+    gettimeofday (&tv1, NULL);
+    double new_us = TVDELUS(tv0,tv1);
+    printf ("linear scan %10.0f lookups/sec\n", n_ll/old_us*1e6);
+    printf ("grid cells  %10.0f lookups/sec, %.1fx %s\n", n_ll/new_us*1e6, old_us/new_us, sum ? "SUM BAD" : "");
+
+    free (grid);
+    return (n_differ + (sum != 0));
+}
+
+int main (int ac, char *av[])
+{
+    int n_differ = checkLL2Prefix();
+    if (ac < 2)
+        return (n_differ ? 1 : 0);
+    test_cty_fn = av[1];
+
+    struct timeval tv0, tv1;
+    gettimeofday (&tv0, NULL);
+    if (!loadCtyFile()) {
+        fprintf (stderr, "%s: can not load\n", av[1]);
+        return (1);
+    }
+    gettimeofday (&tv1, NULL);
+    printf ("built trie of %d nodes, %ld KB, in %.1f ms\n", n_trie, (long)(n_trie*sizeof(CtyNode)/1024),
+                                TVDELUS(tv0,tv1)/1000.0);
+    oldCtyBuild();
+
+    // collect calls
+    const int max_calls = 1000000;
+    char (*calls)[NV_CALLSIGN_LEN] = (char (*)[NV_CALLSIGN_LEN]) malloc (max_calls * NV_CALLSIGN_LEN);
+    int n_calls = 0;
+    if (ac > 2) {
+        FILE *fp = fopen (av[2], "r");
+        if (!fp) {
+            fprintf (stderr, "%s: %s\n", av[2], strerror(errno));
+            return (1);
+        }
+        char line[100];
+        while (n_calls < max_calls && fgets (line, sizeof(line), fp)) {
+            char call[NV_CALLSIGN_LEN], home[NV_CALLSIGN_LEN];
+            chompString (line);
+            splitCallSign (line, home, call);
+            if (call[0])
+                strcpy (calls[n_calls++], call);
+        }
+        fclose (fp);
+    } else {
+        srand (1);
+        while (n_calls < max_calls) {
+            const CtyLoc *cp = &cty_list[rand() % n_cty];
+            if (cp->exact)
+                strcpy (calls[n_calls++], cp->call);
+            else
+                snprintf (calls[n_calls++], NV_CALLSIGN_LEN, "%.5s%d%c%c", cp->call, rand()%10,
+                                        'A' + rand()%26, 'A' + rand()%26);
+        }
+    }
+
+    // compare
+    int n_found = 0;
+    for (int i = 0; i < n_calls; i++) {
+        const CtyLoc *c_new = searchCty (calls[i]);
+        const CtyLoc *c_old = oldSearchCty (calls[i]);
+        if (c_new)
+            n_found++;
+        if (!c_new != !c_old || (c_new && (strcmp (c_new->call, c_old->call) || c_new->dxcc != c_old->dxcc))) {
+            if (n_differ++ < 10)
+                printf ("%-12s trie %s old %s\n", calls[i], c_new ? c_new->call : "-", c_old ? c_old->call : "-");
+        }
+    }
+    printf ("%d calls, %d found, %d differ\n", n_calls, n_found, n_differ);
+
+    // time each
+    long sum = 0;
+    gettimeofday (&tv0, NULL);
+    for (int i = 0; i < n_calls; i++) {
+        const CtyLoc *cp = oldSearchCty (calls[i]);
+        sum += cp ? cp->dxcc : 0;
+    }
+    gettimeofday (&tv1, NULL);
+    double old_us = TVDELUS(tv0,tv1);
+    gettimeofday (&tv0, NULL);
+    for (int i = 0; i < n_calls; i++) {
+        const CtyLoc *cp = searchCty (calls[i]);
+        sum -= cp ? cp->dxcc : 0;
+    }
+    gettimeofday (&tv1, NULL);
+    double new_us = TVDELUS(tv0,tv1);
+
+    printf ("radix scan %10.0f lookups/sec\n", n_calls/old_us*1e6);
+    printf ("trie       %10.0f lookups/sec, %.1fx %s\n", n_calls/new_us*1e6, old_us/new_us, sum ? "SUM BAD" : "");
+
+    return (n_differ || sum ? 1 : 0);
+}
+
+#endif // _UNIT_TEST
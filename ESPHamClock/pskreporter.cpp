@@ -24,9 +24,20 @@ static const char rbn_page[] PROGMEM = "/fetchRBN.pl";
 static DXSpot *reports;                         // malloced list of all reports, not just TST_PSKBAND
 static int n_reports;                           // count of reports used in psk_bands, might be < n_malloced
 static int n_malloced;                          // total n malloced in reports[]
+static SpotIndex reports_si;                    // map location index of reports[]
 static int spot_maxrpt[HAMBAND_N];              // indices into reports[] for the farthest spot per band
 static PSKBandStats bstats[HAMBAND_N];          // band stats
 
+// background retrieval, the worker only collects the reply which installPSK() parses on the main thread
+static BGFetch psk_bgf;                         // background job
+static char psk_query[100];                     // query being fetched, built by main before starting
+static uint8_t psk_fetch_mask;                  // psk_mask used to build psk_query
+static char *psk_reply;                         // worker's malloced reply lines, each ending with \n
+static bool psk_io_ok;                          // whether the most recent fetch io was ok
+static bool psk_again;                          // settings changed while pending so fetch again when done
+static int psk_n_installed;                     // n fetches installed, 0 until first arrives
+static time_t psk_next_update;                  // don't update faster than PSK_INTERVAL
+
 // layout
 #define SUBHEAD_DYUP 15                         // distance up from bottom to subheading
 #define TBLHGAP (PLOTBOX123_W/20)               // table horizontal gap
@@ -218,19 +229,68 @@ static void drawPSKPane (const SBox &box)
     tft.print (label);
 }
 
-/* retrieve spots into reports[] according to current settings.
+/* bgfetch worker to read the reply to psk_query into psk_reply, one line per \n.
  * return whether io ok.
  */
-static bool retrievePSK (void)
+static bool fetchPSK (BGFetch &bgf)
 {
-    // get fresh
     WiFiClient psk_client;
     bool ok = false;
+    size_t n_reply = 0;
+
+    // start empty
+    free (psk_reply);
+    psk_reply = NULL;
+
+    if (psk_client.connect(backend_host, backend_port)) {
+
+        // query web page, N.B. with the User-Agent prepared by startBGFetch()
+        httpHCGET (psk_client, backend_host, psk_query, NULL, bgf.ua);
+
+        // skip header, N.B. not the remote_addr flavor, that belongs to the main thread
+        if (!httpSkipHeader (psk_client, NULL, NULL, 0)) {
+            Serial.print ("PSK: no header\n");
+            goto out;
+        }
+
+        // consider io ok
+        ok = true;
+
+        // collect lines, installPSK() does the parsing
+        char line[100];
+        uint16_t ll;
+        while (getTCPLine (psk_client, line, sizeof(line), &ll)) {
+            char *new_reply = (char *) realloc (psk_reply, n_reply + ll + 2);
+            if (!new_reply) {
+                Serial.printf ("PSK: no mem %u\n", (unsigned) n_reply);
+                ok = false;
+                goto out;
+            }
+            psk_reply = new_reply;
+            memcpy (psk_reply + n_reply, line, ll);
+            n_reply += ll;
+            psk_reply[n_reply++] = '\n';
+            psk_reply[n_reply] = '\0';
+        }
+
+    } else
+        Serial.print ("PSK: Spots connection failed\n");
+
+out:
+    psk_client.stop();
+    return (ok);
+}
+
+static void installPSK (BGFetch &bgf);
 
+/* start a background retrieval of spots according to current settings.
+ * N.B. caller must insure psk_bgf is not already pending.
+ */
+static void startPSKFetch (void)
+{
     // query type
     bool ispsk = (psk_mask & PSKMB_SRCMASK) == PSKMB_PSK;
     bool iswspr = (psk_mask & PSKMB_SRCMASK) == PSKMB_WSPR;
-    bool isrbn = (psk_mask & PSKMB_SRCMASK) == PSKMB_RBN;
     bool use_call = (psk_mask & PSKMB_CALL) != 0;
     bool of_de = (psk_mask & PSKMB_OFDE) != 0;
 
@@ -240,146 +300,165 @@ static bool retrievePSK (void)
     de_maid[4] = '\0';
 
     // build query
-    char query[100];
     if (ispsk)
-        strcpy_P (query, psk_page);
+        strcpy_P (psk_query, psk_page);
     else if (iswspr)
-        strcpy_P (query, wspr_page);
+        strcpy_P (psk_query, wspr_page);
     else
-        strcpy_P (query, rbn_page);
-    int qlen = strlen (query);
-    snprintf (query+qlen, sizeof(query)-qlen, "?%s%s=%s&maxage=%d",
+        strcpy_P (psk_query, rbn_page);
+    int qlen = strlen (psk_query);
+    snprintf (psk_query+qlen, sizeof(psk_query)-qlen, "?%s%s=%s&maxage=%d",
                                         of_de ? "of" : "by",
                                         use_call ? "call" : "grid",
                                         use_call ? getCallsign() : de_maid,
                                         psk_maxage_mins*60 /* wants seconds */);
-    Serial.printf ("PSK: query: %s\n", query);
+    Serial.printf ("PSK: query: %s\n", psk_query);
+    psk_fetch_mask = psk_mask;
 
-    // fetch and fill reports[]
-    resetWatchdog();
-    if (psk_client.connect(backend_host, backend_port)) {
-        updateClocks(false);
-        resetWatchdog();
+    psk_bgf.name = "PSK";
+    psk_bgf.fetch = fetchPSK;
+    psk_bgf.done = installPSK;
+    (void) startBGFetch (psk_bgf);
+}
 
-        // query web page
-        httpHCGET (psk_client, backend_host, query);
+/* main thread bgfetch completion: parse psk_reply into reports[] then show them.
+ */
+static void installPSK (BGFetch &bgf)
+{
+    // these are already stale if the settings changed meanwhile
+    if (psk_again) {
+        psk_again = false;
+        startPSKFetch();
+        return;
+    }
 
-        // skip header
-        if (!httpSkipHeader (psk_client)) {
-            Serial.print ("PSK: no header\n");
-            goto out;
-        }
+    bool ok = bgf.ok;
 
-        // consider io ok
-        ok = true;
+    // query type
+    bool ispsk = (psk_fetch_mask & PSKMB_SRCMASK) == PSKMB_PSK;
+    bool iswspr = (psk_fetch_mask & PSKMB_SRCMASK) == PSKMB_WSPR;
+    bool isrbn = (psk_fetch_mask & PSKMB_SRCMASK) == PSKMB_RBN;
+    bool use_call = (psk_fetch_mask & PSKMB_CALL) != 0;
+    bool of_de = (psk_fetch_mask & PSKMB_OFDE) != 0;
 
-        // reset lists
-        n_reports = 0;
-        for (int i = 0; i < HAMBAND_N; i++)
-            bstats[i] = {};
+    // handy 4x DE maid if needed
+    char de_maid[MAID_CHARLEN];
+    getNVMaidenhead (NV_DE_GRID, de_maid);
+    de_maid[4] = '\0';
 
-        // read lines -- anything unexpected is considered an error message
-        char line[100];
-        while (getTCPLine (psk_client, line, sizeof(line), NULL)) {
-
-            // Serial.printf ("PSK: fetched %s\n", line);
-
-            // parse.
-            // N.B. match sscanf sizes with array sizes
-            // N.B. first grid/call pair is always TX, second always RX; which is DE depends on PSKMB_OFDE
-            DXSpot new_sp = {};
-            long posting_temp;
-            long Hz_temp;
-            if (sscanf (line, "%ld,%6[^,],%11[^,],%6[^,],%11[^,],%7[^,],%ld,%f", &posting_temp,
-                            new_sp.tx_grid, new_sp.tx_call, new_sp.rx_grid, new_sp.rx_call,
-                            new_sp.mode, &Hz_temp, &new_sp.snr) != 8) {
-                Serial.printf ("PSK: %s\n", line);
-                goto out;
-            }
-            new_sp.spotted = posting_temp;
-            new_sp.kHz = Hz_temp * 1e-3F;
+    // reset lists
+    n_reports = 0;
+    for (int i = 0; i < HAMBAND_N; i++)
+        bstats[i] = {};
+
+    // parse each line -- anything unexpected is considered an error message
+    char *next_line = psk_reply;
+    while (ok && next_line && *next_line) {
+
+        char *line = next_line;
+        char *nl = strchr (line, '\n');
+        *nl = '\0';
+        next_line = nl + 1;
+
+        // Serial.printf ("PSK: fetched %s\n", line);
+
+        // parse.
+        // N.B. match sscanf sizes with array sizes
+        // N.B. first grid/call pair is always TX, second always RX; which is DE depends on PSKMB_OFDE
+        DXSpot new_sp = {};
+        long posting_temp;
+        long Hz_temp;
+        if (sscanf (line, "%ld,%6[^,],%11[^,],%6[^,],%11[^,],%7[^,],%ld,%f", &posting_temp,
+                        new_sp.tx_grid, new_sp.tx_call, new_sp.rx_grid, new_sp.rx_call,
+                        new_sp.mode, &Hz_temp, &new_sp.snr) != 8) {
+            Serial.printf ("PSK: %s\n", line);
+            ok = false;
+            break;
+        }
+        new_sp.spotted = posting_temp;
+        new_sp.kHz = Hz_temp * 1e-3F;
 
-            // RBN does not provide tx_grid but it must be us. N.B. this will be blank from rbndaemon
-            if (isrbn)
-                strcpy (new_sp.tx_grid, de_maid);
+        // RBN does not provide tx_grid but it must be us. N.B. this will be blank from rbndaemon
+        if (isrbn)
+            strcpy (new_sp.tx_grid, de_maid);
 
-            // convert grids to ll
-            if (!maidenhead2ll (new_sp.tx_ll, new_sp.tx_grid)) {
-                Serial.printf ("PSK: RX grid? %s\n", line);
-                continue;
-            }
-            if (!maidenhead2ll (new_sp.rx_ll, new_sp.rx_grid)) {
-                Serial.printf ("PSK: RX grid? %s\n", line);
-                continue;
-            }
+        // convert grids to ll
+        if (!maidenhead2ll (new_sp.tx_ll, new_sp.tx_grid)) {
+            Serial.printf ("PSK: RX grid? %s\n", line);
+            continue;
+        }
+        if (!maidenhead2ll (new_sp.rx_ll, new_sp.rx_grid)) {
+            Serial.printf ("PSK: RX grid? %s\n", line);
+            continue;
+        }
 
-            // check for unknown or unsupported band
-            const HamBandSetting band = findHamBand (new_sp.kHz);
-            if (band == HAMBAND_NONE) {
-                Serial.printf ("PSK: band? %s\n", line);
-                continue;
-            }
+        // check for unknown or unsupported band
+        const HamBandSetting band = findHamBand (new_sp.kHz);
+        if (band == HAMBAND_NONE) {
+            Serial.printf ("PSK: band? %s\n", line);
+            continue;
+        }
 
-            // DXCC
-            if (!call2DXCC (new_sp.tx_call, new_sp.tx_dxcc)) {
-                Serial.printf ("PSK: no DXCC for %s\n", new_sp.tx_call);
-                continue;
-            }
-            if (!call2DXCC (new_sp.rx_call, new_sp.rx_dxcc)) {
-                Serial.printf ("PSK: no DXCC for %s\n", new_sp.rx_call);
-                continue;
-            }
+        // DXCC
+        if (!call2DXCC (new_sp.tx_call, new_sp.tx_dxcc)) {
+            Serial.printf ("PSK: no DXCC for %s\n", new_sp.tx_call);
+            continue;
+        }
+        if (!call2DXCC (new_sp.rx_call, new_sp.rx_dxcc)) {
+            Serial.printf ("PSK: no DXCC for %s\n", new_sp.rx_call);
+            continue;
+        }
 
-            // update stats for this band
-            PSKBandStats &pbs = bstats[band];
+        // update stats for this band
+        PSKBandStats &pbs = bstats[band];
 
-            // update count of this band
-            pbs.count++;
+        // update count of this band
+        pbs.count++;
 
-            // dither ll for unique selection
-            ditherLL (new_sp.tx_ll);
-            ditherLL (new_sp.rx_ll);
+        // dither ll for unique selection
+        ditherLL (new_sp.tx_ll);
+        ditherLL (new_sp.rx_ll);
 
-            // finally! save new report, grow array if out of room
-            if ( !(n_reports < n_malloced) ) {
-                reports = (DXSpot *) realloc (reports, (n_malloced += 100) * sizeof(DXSpot));
-                if (!reports)
-                    fatalError ("Live Spots: no mem %d", n_malloced);
-            }
-            reports[n_reports] = new_sp;         // N.B. do not inc yet, used last
-
-            // check each end for farthest from DE
-            float tx_dist, rx_dist, bearing;        
-            propDEPath (false, new_sp.tx_ll, &tx_dist, &bearing);
-            propDEPath (false, new_sp.rx_ll, &rx_dist, &bearing);
-            tx_dist *= KM_PER_MI * ERAD_M;                         // convert core angle to surface km
-            rx_dist *= KM_PER_MI * ERAD_M;                         // convert core angle to surface km
-            bool tx_gt_rx = (tx_dist > rx_dist);
-            float max_dist = tx_gt_rx ? tx_dist : rx_dist;
-            if (max_dist > pbs.maxkm) {
-
-                // update pbs for this band with farther spot
-                LatLong max_ll = tx_gt_rx ? new_sp.tx_ll : new_sp.rx_ll;
-                const char *call = tx_gt_rx ? new_sp.tx_call : new_sp.rx_call;
-                pbs.maxkm = max_dist;
-                pbs.maxll = max_ll;
-                if (getSpotLabelType() == LBL_PREFIX)
-                    findCallPrefix (call, pbs.maxcall);
-                else
-                    strcpy (pbs.maxcall, call);
-
-                // newest spot is now farthest for this band
-                spot_maxrpt[band] = n_reports;
-            }
+        // finally! save new report, grow array if out of room
+        if ( !(n_reports < n_malloced) ) {
+            reports = (DXSpot *) realloc (reports, (n_malloced += 100) * sizeof(DXSpot));
+            if (!reports)
+                fatalError ("Live Spots: no mem %d", n_malloced);
+        }
+        reports[n_reports] = new_sp;         // N.B. do not inc yet, used last
+
+        // check each end for farthest from DE
+        float tx_dist, rx_dist, bearing;        
+        propDEPath (false, new_sp.tx_ll, &tx_dist, &bearing);
+        propDEPath (false, new_sp.rx_ll, &rx_dist, &bearing);
+        tx_dist *= KM_PER_MI * ERAD_M;                         // convert core angle to surface km
+        rx_dist *= KM_PER_MI * ERAD_M;                         // convert core angle to surface km
+        bool tx_gt_rx = (tx_dist > rx_dist);
+        float max_dist = tx_gt_rx ? tx_dist : rx_dist;
+        if (max_dist > pbs.maxkm) {
+
+            // update pbs for this band with farther spot
+            LatLong max_ll = tx_gt_rx ? new_sp.tx_ll : new_sp.rx_ll;
+            const char *call = tx_gt_rx ? new_sp.tx_call : new_sp.rx_call;
+            pbs.maxkm = max_dist;
+            pbs.maxll = max_ll;
+            if (getSpotLabelType() == LBL_PREFIX)
+                findCallPrefix (call, pbs.maxcall);
+            else
+                strcpy (pbs.maxcall, call);
 
-            // ok, another report
-            n_reports++;
+            // newest spot is now farthest for this band
+            spot_maxrpt[band] = n_reports;
         }
 
-    } else
-        Serial.print ("PSK: Spots connection failed\n");
+        // ok, another report
+        n_reports++;
+    }
+
+    // finished with reply
+    free (psk_reply);
+    psk_reply = NULL;
 
-out:
     // reset counts if trouble
     if (!ok) {
         n_reports = 0;
@@ -388,52 +467,57 @@ out:
             bstats[i].maxkm = -1;
         }
     }
+    spotIndexChanged (reports_si);
 
-    // finish up
-    psk_client.stop();
     Serial.printf ("PSK: found %d %s reports %s %s\n",
                         n_reports,
                         (ispsk ? "PSK" : (iswspr ? "WSPR" : "RBN")),
                         of_de ? "of" : "by",
                         use_call ? getCallsign() : de_maid);
 
-    // already logged any problems
-    return (ok);
+    // record, schedule next and show
+    psk_io_ok = ok;
+    psk_next_update = ok ? myNow() + PSK_INTERVAL : nextWiFiRetry (PLOT_CH_PSK);
+    psk_n_installed++;
+    scheduleRedrawPlot (PLOT_CH_PSK);
 }
 
-/* query PSK reporter etc for new reports, draw results and return whether all ok
+/* draw the current reports, starting a fresh background query of PSK reporter etc if needed or requested.
+ * only the very first time do we wait for the query; after that, new reports arrive later via installPSK()
+ * which causes the pane to redraw.
+ * return whether the most recent io was ok.
  */
 bool updatePSKReporter (const SBox &box, bool force)
 {
     // save last retrieval settings to know whether reports[] can be reused
-    static time_t next_update;                          // don't update faster than PSK_INTERVAL
     static uint8_t my_psk_mask;                         // setting used for reports[]
     static uint32_t my_psk_bands;                       // setting used for reports[]
     static uint16_t my_psk_maxage_mins;                 // setting used for reports[]
-    static bool last_ok;                                // used to force retry
-
-    // just use cache if settings all match and not too old
-    if (!force && last_ok && reports && n_malloced > 0 && myNow() < next_update
-                            && my_psk_mask == psk_mask && my_psk_maxage_mins == psk_maxage_mins
-                            && my_psk_bands == psk_bands) {
-        drawPSKPane (box);
-        return (true);
-    }
-
-    // save settings
-    my_psk_mask = psk_mask;
-    my_psk_maxage_mins = psk_maxage_mins;
-    my_psk_bands = psk_bands;
-    next_update = myNow() + PSK_INTERVAL;;
 
-    // get fresh
-    last_ok = retrievePSK();
+    // get fresh unless settings all match and not too old
+    if (force || psk_n_installed == 0 || myNow() >= psk_next_update
+                            || my_psk_mask != psk_mask || my_psk_maxage_mins != psk_maxage_mins
+                            || my_psk_bands != psk_bands) {
+
+        // save settings
+        my_psk_mask = psk_mask;
+        my_psk_maxage_mins = psk_maxage_mins;
+        my_psk_bands = psk_bands;
+
+        // start fresh, or another after the one underway if that is already out of date
+        if (!psk_bgf.pending)
+            startPSKFetch();
+        else if (force)
+            psk_again = true;
+        if (psk_n_installed == 0)
+            waitBGFetch (psk_bgf);
+    }
 
-    // display whatever we got regardless
+    // display whatever we have regardless
     drawPSKPane (box);
 
     // reply
-    return (last_ok);
+    return (psk_io_ok);
 }
 
 /* check for tap at s known to be within a PLOT_CH_PSK box.
@@ -677,9 +761,16 @@ void drawPSKPaths ()
     }
 }
 
-/* report spot closest to ll and which end to mark on map, if any within MAX_CSR_DIST.
+/* SpotFilter that accepts spots in displayed ham_bands
+ */
+static bool pskBandSpot (const DXSpot *sp)
+{
+    return (TST_PSKBAND(findHamBand(sp->kHz)));
+}
+
+/* report spot closest to ll and which end to mark on map, if any within MAX_CSR_DIST, and how many spots are near.
  */
-bool getClosestPSK (LatLong &ll, DXSpot *sp, LatLong *mark_ll)
+bool getClosestPSK (LatLong &ll, DXSpot *sp, LatLong *mark_ll, int *n_near)
 {
     // ignore if not in any rotation set
     if (findPaneForChoice(PLOT_CH_PSK) == PANE_NONE)
@@ -707,34 +798,15 @@ bool getClosestPSK (LatLong &ll, DXSpot *sp, LatLong *mark_ll)
         if (min_i >= 0 && min_d*ERAD_M < MAX_CSR_DIST) {
             *sp = reports[spot_maxrpt[min_i]];
             *mark_ll = of_de ? sp->rx_ll : sp->tx_ll;
+            *n_near = 1;                                // only the farthest are shown
             return (true);
         }
     
     } else {
 
-        // check all spots in displayed ham_bands.
-        // N.B. can't use getClosestSpot() because of TST_PSKBAND
+        // check all spots in displayed ham_bands
 
-        float min_d = 0;
-        int min_i = -1;
-        for (int i = 0; i < n_reports; i++) {
-            DXSpot &s = reports[i];
-            if (TST_PSKBAND(findHamBand(s.kHz))) {
-                float d = ll.GSD(s.rx_ll);
-                if (min_i < 0 || d < min_d) {
-                    min_d = d;
-                    min_i = i;
-                }
-                d = ll.GSD(s.tx_ll);
-                if (min_i < 0 || d < min_d) {
-                    min_d = d;
-                    min_i = i;
-                }
-            }
-        }
-
-        if (min_i >= 0 && min_d*ERAD_M < MAX_CSR_DIST) {
-            *sp = reports[min_i];
+        if (getClosestSpot (reports_si, reports, n_reports, pskBandSpot, LOME_BOTH, ll, sp, mark_ll, n_near)) {
             *mark_ll = of_de ? sp->rx_ll : sp->tx_ll;
             return (true);
         }
@@ -47,6 +47,23 @@ static void getObsCir (Observer *de_obsp, Observer *dx_obsp, time_t t0, SatAzEl
     dx_azel.el = deg2rad(snow.el);
 }
 
+/* fill de_el[] and dx_el[] with the sat elevation, rads, at each of n times t0 + secs[i].
+ * same as getObsCir() at each time but all predicted at once.
+ */
+static void getObsEls (Observer *de_obsp, Observer *dx_obsp, time_t t0, const long secs[], int n,
+float de_el[], float dx_el[])
+{
+    SatBatch b(n);
+    if (!predictSatBatch (t0, secs, b))
+        fatalError ("SatTool failed to get sat info");
+    b.topo (de_obsp);
+    for (int i = 0; i < n; i++)
+        de_el[i] = deg2rad(b.alt[i]);
+    b.topo (dx_obsp);
+    for (int i = 0; i < n; i++)
+        dx_el[i] = deg2rad(b.alt[i]);
+}
+
 /* draw everything in the plot except the elevation plots, Resume button and the "Next Up" table.
  * t0 is nowWO()
  */
@@ -191,18 +208,25 @@ static void drawSTElPlot (time_t t0, time_t &t_start, time_t &t_end)
         const uint16_t x_step = ST_T2X(ST_DT) - ST_T2X(0);    // time step x change
         const uint16_t elm90y = ST_E2Y(deg2rad(-90));         // y of -90 el
 
+        // find elevations at each step all at once
+        #define ST_NDT (ST_DUR/ST_DT + 1)
+        long secs[ST_NDT];
+        float de_els[ST_NDT], dx_els[ST_NDT];
+        for (int i = 0; i < ST_NDT; i++)
+            secs[i] = i * ST_DT;
+        getObsEls (&de_obs, &dx_obs, t0, secs, ST_NDT, de_els, dx_els);
+
         // work across plot
-        for (time_t t = t0; t <= t0 + ST_DUR; t += ST_DT) {
+        for (int i = 0; i < ST_NDT; i++) {
 
-            // find each circumstance at time t
-            SatAzEl de_azel, dx_azel;
-            getObsCir (&de_obs, &dx_obs, t, de_azel, dx_azel);
-            uint16_t de_y = ST_E2Y(de_azel.el);
-            uint16_t dx_y = ST_E2Y(dx_azel.el);
+            // circumstance at time t
+            time_t t = t0 + secs[i];
+            uint16_t de_y = ST_E2Y(de_els[i]);
+            uint16_t dx_y = ST_E2Y(dx_els[i]);
             uint16_t x = ST_T2X(t);
 
             // check both_up_now
-            bool both_up_now = de_azel.el > 0 && dx_azel.el > 0;
+            bool both_up_now = de_els[i] > 0 && dx_els[i] > 0;
 
             // emphasize when both up
             if (!prev_both_up && both_up_now) {
@@ -263,31 +287,38 @@ static void drawSTBothUpTable (time_t t0, time_t t_start, time_t t_end)
         bool finite_both_up = !always_both_up && !never_both_up;
         char buf[50];
 
-        // search around times in finer steps to refine to nearest ST_US
+        // search back from each rough time in finer steps to refine to nearest ST_US.
+        // the step before each rough time differed so ST_NUS steps back always reach a change.
         time_t better_start = 0, better_end = 0;
         if (finite_both_up) {
 
-            // find better start unless now
+            // find elevations back from both rough times all at once, start then end
+            #define ST_NUS (ST_DT/ST_US + 1)
+            long secs[2*ST_NUS];
+            float de_els[2*ST_NUS], dx_els[2*ST_NUS];
+            for (int k = 0; k < ST_NUS; k++) {
+                secs[k] = t_start - t0 - (k+1)*ST_US;
+                secs[ST_NUS+k] = t_end - t0 - (k+1)*ST_US;
+            }
+            getObsEls (&de_obs, &dx_obs, t0, secs, 2*ST_NUS, de_els, dx_els);
+
+            // find better start unless now: last both up going back
             if (t_start > t0) {
-                bool both_up_now = true;
-                for (better_start = t_start - ST_US; both_up_now; better_start -= ST_US) {
-                    SatAzEl de_azel, dx_azel;
-                    getObsCir (&de_obs, &dx_obs, better_start, de_azel, dx_azel);
-                    both_up_now = de_azel.el > 0 && dx_azel.el > 0;
-                }
-                better_start += 2*ST_US;            // return to last known both_up_now
+                int k;
+                for (k = 0; k < ST_NUS; k++)
+                    if (!(de_els[k] > 0 && dx_els[k] > 0))
+                        break;
+                better_start = t_start - k*ST_US;
             } else {
                 better_start = t0;
             }
 
-            // find better end
-            bool both_up_now = false;
-            for (better_end = t_end - ST_US; !both_up_now; better_end -= ST_US) {
-                SatAzEl de_azel, dx_azel;
-                getObsCir (&de_obs, &dx_obs, better_end, de_azel, dx_azel);
-                both_up_now = de_azel.el > 0 && dx_azel.el > 0;
-            }
-            better_end += 2*ST_US;              // return to last known !both_up_now
+            // find better end: first not both up after the last both up going back
+            int k;
+            for (k = 0; k < ST_NUS; k++)
+                if (de_els[ST_NUS+k] > 0 && dx_els[ST_NUS+k] > 0)
+                    break;
+            better_end = t_end - k*ST_US;
 
             Serial.printf ("SatTool:: better start %02d:%02d end %02d:%02d\n",
                                 hour(better_start), minute(better_start),
@@ -0,0 +1,213 @@
+/* main loop scheduler.
+ *
+ * rather than spinning through loop() continuously, each subsystem arms a SchedTimer for when it next has work
+ * and the main thread sleeps in poll() at the end of each loop() until the earliest timer comes due or another
+ * thread calls wakeMainLoop(). all network and input io is done by other threads, so they call wakeMainLoop()
+ * when they have something for the main thread. armed timers are kept in a binary heap ordered by due time.
+ * subsystems not yet driven by their own timer still poll for themselves with timesUp() so we never sleep
+ * longer than SCHED_POLL_MS.
+ */
+
+#include "HamClock.h"
+
+
+#define SCHED_MAXTIMERS 32                      // max armed timers
+#define SCHED_POLL_MS   250                     // longest sleep, for subsystems that still poll
+
+// armed timers, heap ordered by due_ms, main thread only
+static SchedTimer *sched_heap[SCHED_MAXTIMERS];
+static int sched_n_heap;
+
+// every timer ever armed, for getSchedTimers()
+static SchedTimer *sched_all;
+
+// pipe written by wakeMainLoop() from any thread
+static int sched_wake[2] = {-1, -1};
+
+// wakeup statistics
+static SchedStats sched_stats;
+
+
+/* return whether timer a is due before timer b, allowing for millis() roll over
+ */
+static bool schedBefore (const SchedTimer *a, const SchedTimer *b)
+{
+    return ((int32_t)(a->due_ms - b->due_ms) < 0);
+}
+
+/* place st at heap index i then move it up or down until the heap is in order again
+ */
+static void schedSift (SchedTimer *st, int i)
+{
+    // up
+    while (i > 0) {
+        int parent = (i-1)/2;
+        if (!schedBefore (st, sched_heap[parent]))
+            break;
+        sched_heap[i] = sched_heap[parent];
+        sched_heap[i]->heap_i = i;
+        i = parent;
+    }
+
+    // down
+    for (;;) {
+        int child = 2*i + 1;
+        if (child >= sched_n_heap)
+            break;
+        if (child+1 < sched_n_heap && schedBefore (sched_heap[child+1], sched_heap[child]))
+            child++;
+        if (!schedBefore (sched_heap[child], st))
+            break;
+        sched_heap[i] = sched_heap[child];
+        sched_heap[i]->heap_i = i;
+        i = child;
+    }
+
+    sched_heap[i] = st;
+    st->heap_i = i;
+}
+
+/* remove st from the heap and record that it fired at time now.
+ */
+static void schedFire (SchedTimer *st, uint32_t now)
+{
+    SchedTimer *last = sched_heap[--sched_n_heap];
+    if (last != st)
+        schedSift (last, st->heap_i);
+
+    st->armed = false;
+    st->fired = true;
+    st->n_fired++;
+    st->late_ms = now - st->due_ms;
+    if (st->late_ms > st->max_late_ms)
+        st->max_late_ms = st->late_ms;
+}
+
+/* arm st to come due ms from now, or leave it alone if it is already armed to come due sooner.
+ * N.B. main thread only
+ */
+void armSchedTimer (SchedTimer &st, uint32_t ms)
+{
+    // add to list of all the first time
+    if (!st.registered) {
+        st.next = sched_all;
+        sched_all = &st;
+        st.registered = true;
+    }
+
+    uint32_t due = millis() + ms;
+
+    if (st.armed) {
+        if ((int32_t)(due - st.due_ms) >= 0)
+            return;
+        st.due_ms = due;
+        schedSift (&st, st.heap_i);
+    } else {
+        if (sched_n_heap == SCHED_MAXTIMERS)
+            fatalError ("too many timers arming %s", st.name);
+        st.due_ms = due;
+        st.armed = true;
+        schedSift (&st, sched_n_heap++);
+    }
+}
+
+/* arm st to come due at the next whole second of real time, such as for redrawing a clock.
+ * N.B. main thread only
+ */
+void armSchedTimerSecond (SchedTimer &st)
+{
+    struct timeval tv;
+    gettimeofday (&tv, NULL);
+    armSchedTimer (st, 1000 - tv.tv_usec/1000);
+}
+
+/* return whether st has come due since it was last armed, then forget that it did.
+ * N.B. main thread only
+ */
+bool schedTimerFired (SchedTimer &st)
+{
+    // might be due without our having waited, such as while a menu has been up
+    if (st.armed) {
+        uint32_t now = millis();
+        if ((int32_t)(now - st.due_ms) >= 0)
+            schedFire (&st, now);
+    }
+
+    bool fired = st.fired;
+    st.fired = false;
+    return (fired);
+}
+
+/* cause the main thread to return from waitMainLoop() as soon as possible.
+ * N.B. this may be called from any thread
+ */
+void wakeMainLoop (void)
+{
+    // nothing to do if not started yet; pipe is nonblocking so a full pipe just means a wakeup is pending
+    if (sched_wake[1] >= 0 && write (sched_wake[1], "", 1) < 0 && errno != EAGAIN)
+        Serial.printf ("SCHED: wake: %s\n", strerror(errno));
+}
+
+/* sleep until the earliest armed timer comes due, wakeMainLoop() is called, or SCHED_POLL_MS, whichever
+ * is first.
+ * N.B. main thread only
+ */
+void waitMainLoop (void)
+{
+    // create wake pipe first time
+    if (sched_wake[0] < 0) {
+        if (pipe (sched_wake) < 0)
+            fatalError ("scheduler pipe: %s", strerror(errno));
+        for (int i = 0; i < 2; i++)
+            fcntl (sched_wake[i], F_SETFL, fcntl (sched_wake[i], F_GETFL) | O_NONBLOCK);
+        sched_stats.ms = millis();
+    }
+
+    // how long until the earliest timer
+    uint32_t t0 = millis();
+    int timeout = SCHED_POLL_MS;
+    if (sched_n_heap > 0) {
+        int32_t dt = sched_heap[0]->due_ms - t0;
+        if (dt < timeout)
+            timeout = dt > 0 ? dt : 0;
+    }
+
+    // watch the wake pipe
+    struct pollfd pfd;
+    pfd.fd = sched_wake[0];
+    pfd.events = POLLIN;
+    int n_ready = timeout > 0 ? poll (&pfd, 1, timeout) : 0;
+    if (n_ready < 0 && errno != EINTR)
+        fatalError ("scheduler poll: %s", strerror(errno));
+
+    uint32_t t1 = millis();
+    sched_stats.sleep_ms += t1 - t0;
+    sched_stats.n_loops++;
+
+    // drain the wake pipe
+    if (n_ready > 0 && pfd.revents) {
+        char buf[64];
+        while (read (sched_wake[0], buf, sizeof(buf)) > 0)
+            continue;
+        sched_stats.n_wake++;
+    }
+
+    // fire each timer now due
+    bool any_timer = false;
+    while (sched_n_heap > 0 && (int32_t)(t1 - sched_heap[0]->due_ms) >= 0) {
+        schedFire (sched_heap[0], t1);
+        any_timer = true;
+    }
+    if (any_timer)
+        sched_stats.n_timer++;
+    else if (n_ready == 0 && timeout > 0)
+        sched_stats.n_poll++;
+}
+
+/* pass back the wakeup statistics and return list of all timers ever armed, linked by next.
+ */
+const SchedTimer *getSchedTimers (SchedStats &ss)
+{
+    ss = sched_stats;
+    return (sched_all);
+}
@@ -177,12 +177,13 @@ static bool drawSDOImage (const SBox &box)
             plotMessage (box, SDO_COLOR, "local SDO file is missing");
             ok = false;
         } else {
-            GenReader gr(fp);
             Message ynot;
-            if (!installBMPBox (gr, box, FIT_CROP, ynot)) {
-                plotMessage (box, SDO_COLOR, ynot.get());
-                ok = false;
+            {
+                GenReader gr(fp);
+                ok = installBMPBox (gr, box, FIT_CROP, ynot);
             }
+            if (!ok)
+                plotMessage (box, SDO_COLOR, ynot.get());
             fclose (fp);
         }
     }
@@ -26,10 +26,23 @@ static SolarFluxData sf_cache;
 static DRAPData drap_cache;
 static XRayData xray_cache;
 static KpData kp_cache;
+static const char noaasw_cats[N_NOAASW_C] = {'R', 'S', 'G'};
 static NOAASpaceWxData noaasw_cache = {0, false, {'R', 'S', 'G'}, {}};
 static AuroraData aurora_cache;
 static DSTData dst_cache;
 
+// private copies being filled by the background fetches, see spcwx_fetch[]
+static BzBtData bzbt_fresh;
+static SolarWindData sw_fresh;
+static SunSpotData ssn_fresh;
+static SolarFluxData sf_fresh;
+static DRAPData drap_fresh;
+static XRayData xray_fresh;
+static KpData kp_fresh;
+static NOAASpaceWxData noaasw_fresh;
+static AuroraData aurora_fresh;
+static DSTData dst_fresh;
+
 #define X(a,b,c,d,e,f,g,h,i) {a,b,c,d,e,f,g,h,i},     // expands SPCWX_DATA to each array initialization in {}
 SpaceWeather_t space_wx[SPCWX_N] = {
     SPCWX_DATA
@@ -345,1101 +358,732 @@ time_t nextRetrieval (PlotChoice pc, int interval)
 }
 
 
-/* retrieve sun spot and SPCWX_SSN if it's time, else use cache.
- * return whether transaction was ok (even if data was not)
+/* parse sun spot reply into SunSpotData, return whether complete and if so pass back latest for SPCWX_SSN.
+ * N.B. runs in a bgfetch worker.
  */
-bool retrieveSunSpots (SunSpotData &ssn)
+static bool parseSunSpots (WiFiClient &client, void *data, float &value)
 {
-    // check cache first
-    if (myNow() < ssn_cache.next_update) {
-        ssn = ssn_cache;
-        return (true);
-    }
-
-    // get fresh
+    SunSpotData &ssn = *(SunSpotData *)data;
     char line[100];
-    WiFiClient ss_client;
-    bool ok = false;
-
-    // mark value as bad until proven otherwise
-    space_wx[SPCWX_SSN].value_ok = false;
-    ssn.data_ok = ssn_cache.data_ok = false;
 
-    Serial.println(ssn_page);
-    if (ss_client.connect(backend_host, backend_port)) {
-        updateClocks(false);
-
-        // query web page
-        httpHCGET (ss_client, backend_host, ssn_page);
-
-        // skip response header
-        if (!httpSkipHeader (ss_client)) {
-            Serial.print ("SSN: header fail\n");
-            goto out;
-        }
-
-        // transaction successful
-        ok = true;
-
-        // read lines into ssn array and build corresponding time value
-        int8_t ssn_i;
-        for (ssn_i = 0; ssn_i < SSN_NV && getTCPLine (ss_client, line, sizeof(line), NULL); ssn_i++) {
-            ssn_cache.x[ssn_i] = 1-SSN_NV + ssn_i;
-            ssn_cache.ssn[ssn_i] = atof(line+11);
-        }
-
-        updateClocks(false);
-
-        // ok if all received
-        if (ssn_i == SSN_NV) {
-
-            // capture latest
-            space_wx[SPCWX_SSN].value = ssn_cache.ssn[SSN_NV-1];
-            space_wx[SPCWX_SSN].value_ok = true;
-            ssn_cache.data_ok = true;
-            ssn = ssn_cache;
-
-        } else {
-
-            Serial.printf ("SSN: data short %d / %d\n", ssn_i, SSN_NV);
-        }
-
-    } else {
-
-        Serial.print ("SSN: connection failed\n");
+    // read lines into ssn array and build corresponding time value
+    int8_t ssn_i;
+    for (ssn_i = 0; ssn_i < SSN_NV && getTCPLine (client, line, sizeof(line), NULL); ssn_i++) {
+        ssn.x[ssn_i] = 1-SSN_NV + ssn_i;
+        ssn.ssn[ssn_i] = atof(line+11);
     }
 
-out:
-
-    // set next update
-    ssn_cache.next_update = ok ? nextRetrieval (PLOT_CH_SSN, SSN_INTERVAL) : nextWiFiRetry(PLOT_CH_SSN);
-
-    // clean up
-    updateClocks(false);
-    ss_client.stop();
-    return (ok);
-}
-
-
-/* return whether new SPCWX_SSN data are ready, even if bad.
- */
-static bool checkForNewSunSpots (void)
-{
-    if (myNow() < ssn_cache.next_update)
+    // ok if all received
+    if (ssn_i < SSN_NV) {
+        Serial.printf ("SSN: data short %d / %d\n", ssn_i, SSN_NV);
         return (false);
+    }
 
-    SunSpotData ssn;
-    return (retrieveSunSpots (ssn));
+    // capture latest
+    value = ssn.ssn[SSN_NV-1];
+    return (true);
 }
 
-/* retrieve solar flux and SPCWX_FLUX if it's time, else use cache.
- * return whether transaction was ok (even if data was not)
+/* parse solar flux reply into SolarFluxData, return whether complete and if so pass back current SPCWX_FLUX.
+ * N.B. runs in a bgfetch worker.
  */
-bool retrieveSolarFlux (SolarFluxData &sf)
+static bool parseSolarFlux (WiFiClient &client, void *data, float &value)
 {
-    // check cache first
-    if (myNow() < sf_cache.next_update) {
-        sf = sf_cache;
-        return (true);
-    }
-
-    // get fresh
+    SolarFluxData &sf = *(SolarFluxData *)data;
     char line[120];
-    WiFiClient sf_client;
-    bool ok = false;
-
-    // mark value as bad until proven otherwise
-    space_wx[SPCWX_FLUX].value_ok = false;
-    sf.data_ok = sf_cache.data_ok = false;
-
-    Serial.println (sf_page);
-    if (sf_client.connect(backend_host, backend_port)) {
-        updateClocks(false);
-
-        // query web page
-        httpHCGET (sf_client, backend_host, sf_page);
-
-        // skip response header
-        if (!httpSkipHeader (sf_client)) {
-            Serial.print ("SFlux: header fail\n");
-            goto out;
-        }
-
-        // transaction successful
-        ok = true;
 
-        // read lines into flux array and build corresponding time value
-        int8_t sf_i;
-        for (sf_i = 0; sf_i < SFLUX_NV && getTCPLine (sf_client, line, sizeof(line), NULL); sf_i++) {
-            sf_cache.x[sf_i] = (sf_i - (SFLUX_NV-9-1))/3.0F; // 3x(30 days history + 3 days predictions)
-            sf_cache.sflux[sf_i] = atof(line);
-        }
-
-        updateClocks(false);
-
-        // ok if found all
-        if (sf_i == SFLUX_NV) {
-
-            // capture current value (not predictions)
-            space_wx[SPCWX_FLUX].value = sf_cache.sflux[SFLUX_NV-10];
-            space_wx[SPCWX_FLUX].value_ok = true;
-            sf_cache.data_ok = true;
-            sf = sf_cache;
-
-        } else {
-
-            Serial.printf ("SFlux: data short: %d / %d\n", sf_i, SFLUX_NV);
-        }
-
-    } else {
-
-        Serial.print ("SFlux: connection failed\n");
+    // read lines into flux array and build corresponding time value
+    int8_t sf_i;
+    for (sf_i = 0; sf_i < SFLUX_NV && getTCPLine (client, line, sizeof(line), NULL); sf_i++) {
+        sf.x[sf_i] = (sf_i - (SFLUX_NV-9-1))/3.0F;     // 3x(30 days history + 3 days predictions)
+        sf.sflux[sf_i] = atof(line);
     }
 
-out:
-
-    // set next update
-    sf_cache.next_update = ok ? nextRetrieval (PLOT_CH_FLUX, SFLUX_INTERVAL) : nextWiFiRetry (PLOT_CH_FLUX);
-
-    // clean up
-    updateClocks(false);
-    sf_client.stop();
-    return (ok);
-}
-
-/* return whether fresh SPCWX_FLUX data are ready, even if bad.
- */
-static bool checkForNewSolarFlux (void)
-{
-    if (myNow() < sf_cache.next_update)
+    // ok if found all
+    if (sf_i < SFLUX_NV) {
+        Serial.printf ("SFlux: data short: %d / %d\n", sf_i, SFLUX_NV);
         return (false);
+    }
 
-    SolarFluxData sf;
-    return (retrieveSolarFlux (sf));
+    // capture current value (not predictions)
+    value = sf.sflux[SFLUX_NV-10];
+    return (true);
 }
 
-
-/* retrieve DRAP and SPCWX_DRAP if it's time, else use cache.
- * return whether transaction was ok (even if data was not)
+/* parse DRAP reply into DRAPData, return whether good and if so pass back current SPCWX_DRAP.
+ * N.B. runs in a bgfetch worker.
  */
-bool retrieveDRAP (DRAPData &drap)
+static bool parseDRAP (WiFiClient &client, void *data, float &value)
 {
-    // check cache first
-    if (myNow() < drap_cache.next_update) {
-        drap = drap_cache;
-        return (true);
-    }
-
-    // get fresh
-
     #define _DRAPDATA_MAXMI     (DRAPDATA_NPTS/10)                      // max allowed missing intervals
     #define _DRAP_MINGOODI      (DRAPDATA_NPTS-3600/DRAPDATA_INTERVAL)  // min index with good data
 
+    DRAPData &drap = *(DRAPData *)data;
     char line[100];                                                     // text line
-    WiFiClient drap_client;                                             // wifi client connection
-    bool ok = false;                                                    // set iff all ok
-
-    // want to find any holes in data so init x values to all 0
-    memset (drap_cache.x, 0, DRAPDATA_NPTS*sizeof(float));
 
-    // want max in each interval so init y values to all 0
-    memset (drap_cache.y, 0, DRAPDATA_NPTS*sizeof(float));
+    // N.B. x and y arrive all 0 so we can find any holes in the data and the max in each interval
 
-    // mark data as bad until proven otherwise
-    space_wx[SPCWX_DRAP].value_ok = false;
-    drap.data_ok = drap_cache.data_ok = false;
+    // init state
+    time_t t_now = myNow();
 
-    Serial.println (drap_page);
-    if (drap_client.connect(backend_host, backend_port)) {
-        updateClocks(false);
+    // read lines, oldest first
+    int n_lines = 0;
+    while (getTCPLine (client, line, sizeof(line), NULL)) {
+        n_lines++;
 
-        // query web page
-        httpHCGET (drap_client, backend_host, drap_page);
-
-        // skip response header
-        if (!httpSkipHeader (drap_client)) {
-            Serial.print ("DRAP: header short\n");
-            goto out;
+        // crack
+        long utime;
+        float min, max, mean;
+        if (sscanf (line, "%ld : %f %f %f", &utime, &min, &max, &mean) != 4) {
+            Serial.printf ("DRAP: garbled: %s\n", line);
+            return (false);
         }
-
-        // transaction itself is successful
-        ok = true;
-
-        // init state
-        time_t t_now = myNow();
-
-        // read lines, oldest first
-        int n_lines = 0;
-        while (getTCPLine (drap_client, line, sizeof(line), NULL)) {
-            n_lines++;
-
-            // crack
-            long utime;
-            float min, max, mean;
-            if (sscanf (line, "%ld : %f %f %f", &utime, &min, &max, &mean) != 4) {
-                Serial.printf ("DRAP: garbled: %s\n", line);
-                goto out;
-            }
-            // Serial.printf ("DRAP: %ld %g %g %g\n", utime, min, max, mean;
-
-            // find age for this datum, skip if crazy new or too old
-            int age = t_now - utime;
-            int xi = DRAPDATA_NPTS*(DRAPDATA_PERIOD - age)/DRAPDATA_PERIOD;
-            if (xi < 0 || xi >= DRAPDATA_NPTS) {
-                // Serial.printf ("DRAP: skipping age %g hrs\n", age/3600.0F);
-                continue;
-            }
-            drap_cache.x[xi] = age/(-3600.0F);                             // seconds to hours ago
-
-            // set in array if larger
-            if (max > drap_cache.y[xi]) {
-                // if (y[xi] > 0)
-                    // Serial.printf ("DRAP: saw xi %d utime %ld age %d again\n", xi, utime, age);
-                drap_cache.y[xi] = max;
-            }
-
-            // Serial.printf ("DRAP: %3d %6d: %g %g\n", xi, age, x[xi], y[xi]);
+        // Serial.printf ("DRAP: %ld %g %g %g\n", utime, min, max, mean;
+
+        // find age for this datum, skip if crazy new or too old
+        int age = t_now - utime;
+        int xi = DRAPDATA_NPTS*(DRAPDATA_PERIOD - age)/DRAPDATA_PERIOD;
+        if (xi < 0 || xi >= DRAPDATA_NPTS) {
+            // Serial.printf ("DRAP: skipping age %g hrs\n", age/3600.0F);
+            continue;
         }
-        Serial.printf ("DRAP: read %d lines\n", n_lines);
-
-        // look alive
-        updateClocks(false);
+        drap.x[xi] = age/(-3600.0F);                                    // seconds to hours ago
 
-        // check for missing data
-        int n_missing = 0;
-        int maxi_good = 0;
-        for (int i = 0; i < DRAPDATA_NPTS; i++) {
-            if (drap_cache.x[i] == 0) {
-                drap_cache.x[i] = (DRAPDATA_PERIOD - i*DRAPDATA_PERIOD/DRAPDATA_NPTS)/-3600.0F;
-                if (i > 0)
-                    drap_cache.y[i] = drap_cache.y[i-1];                      // fill with previous
-                // Serial.printf ("DRAP: filling missing interval %d at age %g hrs to %g\n", i, drap_cache.x[i], drap_cache.y[i]);
-                n_missing++;
-            } else {
-                maxi_good = i;
-            }
+        // set in array if larger
+        if (max > drap.y[xi]) {
+            // if (y[xi] > 0)
+                // Serial.printf ("DRAP: saw xi %d utime %ld age %d again\n", xi, utime, age);
+            drap.y[xi] = max;
         }
 
-        // check for too much missing or newest too old
-        if (n_missing > _DRAPDATA_MAXMI) {
-            Serial.print ("DRAP: data too sparse\n");
-            goto out;
-        }
-        if (maxi_good < _DRAP_MINGOODI) {
-            Serial.print ("DRAP: data too old\n");
-            goto out;
+        // Serial.printf ("DRAP: %3d %6d: %g %g\n", xi, age, x[xi], y[xi]);
+    }
+    Serial.printf ("DRAP: read %d lines\n", n_lines);
+
+    // check for missing data
+    int n_missing = 0;
+    int maxi_good = 0;
+    for (int i = 0; i < DRAPDATA_NPTS; i++) {
+        if (drap.x[i] == 0) {
+            drap.x[i] = (DRAPDATA_PERIOD - i*DRAPDATA_PERIOD/DRAPDATA_NPTS)/-3600.0F;
+            if (i > 0)
+                drap.y[i] = drap.y[i-1];                                // fill with previous
+            // Serial.printf ("DRAP: filling missing interval %d at age %g hrs to %g\n", i, drap.x[i], drap.y[i]);
+            n_missing++;
+        } else {
+            maxi_good = i;
         }
-
-        // ok! capture current value
-        space_wx[SPCWX_DRAP].value = drap_cache.y[DRAPDATA_NPTS-1];
-        space_wx[SPCWX_DRAP].value_ok = true;
-        drap_cache.data_ok = true;
-        drap = drap_cache;
-
-    } else {
-
-        Serial.print ("DRAP: connection failed\n");
     }
 
-out:
-
-    // set next update
-    drap_cache.next_update = ok ? nextRetrieval (PLOT_CH_DRAP, DRAPPLOT_INTERVAL)
-                                : nextWiFiRetry (PLOT_CH_DRAP);
+    // check for too much missing or newest too old
+    if (n_missing > _DRAPDATA_MAXMI) {
+        Serial.print ("DRAP: data too sparse\n");
+        return (false);
+    }
+    if (maxi_good < _DRAP_MINGOODI) {
+        Serial.print ("DRAP: data too old\n");
+        return (false);
+    }
 
-    // clean up
-    updateClocks(false);
-    drap_client.stop();
-    return (ok);
+    // ok! capture current value
+    value = drap.y[DRAPDATA_NPTS-1];
+    return (true);
 }
 
-/* return whether fresh SPCWX_DRAP data are ready, even if bad.
+/* parse Kp reply into KpData, return whether complete and if so pass back current SPCWX_KP.
+ * N.B. runs in a bgfetch worker.
  */
-bool checkForNewDRAP ()
+static bool parseKp (WiFiClient &client, void *data, float &value)
 {
-    if (myNow() < drap_cache.next_update)
+    KpData &kp = *(KpData *)data;
+    char line[100];                                     // text line
+
+    // read lines into kp array and build x
+    const int now_i = KP_NHD*KP_VPD-1;                  // last historic is now
+    int kp_i;
+    for (kp_i = 0; kp_i < KP_NV && getTCPLine (client, line, sizeof(line), NULL); kp_i++) {
+        kp.x[kp_i] = (kp_i-now_i)/(float)KP_VPD;
+        kp.p[kp_i] = atof(line);
+    }
+
+    if (kp_i < KP_NV) {
+        Serial.printf ("Kp: data short: %d of %d\n", kp_i, KP_NV);
         return (false);
+    }
 
-    DRAPData drap;
-    return (retrieveDRAP (drap));
+    // save current (not last!) value
+    value = kp.p[now_i];
+    return (true);
 }
 
-/* retrieve Kp and SPCWX_KP if it's time, else use cache.
- * return whether transaction was ok (even if data was not)
+/* parse DST reply into DSTData, return whether complete and if so pass back latest SPCWX_DST.
+ * N.B. runs in a bgfetch worker.
  */
-bool retrieveKp (KpData &kp)
+static bool parseDST (WiFiClient &client, void *data, float &value)
 {
-    // check cache first
-    if (myNow() < kp_cache.next_update) {
-        kp = kp_cache;
-        return (true);
-    }
-
-    // get fresh
-    WiFiClient kp_client;                               // wifi client connection
-    int kp_i = 0;                                       // next kp index to use
+    DSTData &dst = *(DSTData *)data;
     char line[100];                                     // text line
-    bool ok = false;                                    // set if no network errors
 
-    // mark value as bad until proven otherwise
-    space_wx[SPCWX_KP].value_ok = false;
-    kp.data_ok = kp_cache.data_ok = false;
+    // handy now for finding age
+    time_t now = myNow();
 
-    Serial.println(kp_page);
-    if (kp_client.connect(backend_host, backend_port)) {
-        updateClocks(false);
-
-        // query web page
-        httpHCGET (kp_client, backend_host, kp_page);
+    // read lines into DST array
+    // 2025-04-15T00:00:00 -25
+    int dst_i = 0;
+    for (dst_i = 0; dst_i < DST_NV && getTCPLine (client, line, sizeof(line), NULL); dst_i++) {
 
-        // skip response header
-        if (!httpSkipHeader (kp_client)) {
-            Serial.print ("Kp: header short\n");
-            goto out;
+        // determine age as hours ago
+        time_t val_time = crackISO8601 (line);
+        if (val_time == 0) {
+            Serial.printf ("DST: bogus line: %s\n", line);
+            break;
         }
-
-        // transaction successful even if data is not
-        ok = true;
-
-        // read lines into kp array and build x
-        const int now_i = KP_NHD*KP_VPD-1;              // last historic is now
-        for (kp_i = 0; kp_i < KP_NV && getTCPLine (kp_client, line, sizeof(line), NULL); kp_i++) {
-            kp_cache.x[kp_i] = (kp_i-now_i)/(float)KP_VPD;
-            kp_cache.p[kp_i] = atof(line);
+        float age_hrs = (val_time - now)/3600.0F;
+        if (age_hrs > DST_MAXAGE) {
+            Serial.printf ("DST: too old: %s\n", line);
+            break;
         }
 
-        // record sw
-        if (kp_i == KP_NV) {
-
-            // save current (not last!) value
-            space_wx[SPCWX_KP].value = kp_cache.p[now_i];
-            space_wx[SPCWX_KP].value_ok = true;
-            kp_cache.data_ok = true;
-            kp = kp_cache;
-
-        } else {
-
-            Serial.printf ("Kp: data short: %d of %d\n", kp_i, KP_NV);
-        }
-
-    } else {
-
-        Serial.print ("Kp: connection failed\n");
+        dst.age_hrs[dst_i] = age_hrs;
+        dst.values[dst_i] = atof(line + 19);
     }
 
-out:
-
-    // set next update
-    kp_cache.next_update = ok ? nextRetrieval (PLOT_CH_KP, KP_INTERVAL) : nextWiFiRetry(PLOT_CH_KP);
-
-    // clean up
-    updateClocks(false);
-    kp_client.stop();
-    return (ok);
-}
-
-/* return whether fresh SPCWX_KP data are ready, even if bad.
- */
-static bool checkForNewKp (void)
-{
-    if (myNow() < kp_cache.next_update)
+    if (dst_i < DST_NV) {
+        Serial.printf ("DST: data short: %d of %d\n", dst_i, DST_NV);
         return (false);
+    }
 
-    KpData kp;
-    return (retrieveKp (kp));
+    // save latest value
+    value = dst.values[DST_NV-1];
+    return (true);
 }
 
-/* retrieve DST and SPCWX_DST if it's time, else use cache.
- * return whether transaction was ok (even if data was not)
+/* parse XRay reply into XRayData, return whether complete and if so pass back current raw long SPCWX_XRAY.
+ * N.B. runs in a bgfetch worker.
  */
-bool retrieveDST (DSTData &dst)
+static bool parseXRay (WiFiClient &client, void *data, float &value)
 {
-    // check cache first
-    if (myNow() < dst_cache.next_update) {
-        dst = dst_cache;
-        return (true);
-    }
-
-    // get fresh
-    WiFiClient dst_client;                              // wifi client connection
-    char line[100];                                     // text line
-    bool ok = false;                                    // set if no network errors
-
-    // mark value as bad until proven otherwise
-    space_wx[SPCWX_DST].value_ok = false;
-    dst.data_ok = dst_cache.data_ok = false;
-
-    Serial.println(dst_page);
-    if (dst_client.connect(backend_host, backend_port)) {
-        updateClocks(false);
-
-        // query web page
-        httpHCGET (dst_client, backend_host, dst_page);
-
-        // skip response header
-        if (!httpSkipHeader (dst_client)) {
-            Serial.print ("DST: header short\n");
-            goto out;
-        }
-
-        // transaction successful even if data is not
-        ok = true;
-
-        // handy now for finding age
-        time_t now = myNow();
+    XRayData &xray = *(XRayData *)data;
+    char line[100];
+    uint16_t ll;
 
-        // read lines into DST array and build cache
-        // 2025-04-15T00:00:00 -25
-        int dst_i = 0;
-        for (dst_i = 0; dst_i < DST_NV && getTCPLine (dst_client, line, sizeof(line), NULL); dst_i++) {
+    // collect content lines and extract both wavelength intensities
+    int xray_i = 0;
+    float raw_lxray = 0;
+    while (xray_i < XRAY_NV && getTCPLine (client, line, sizeof(line), &ll)) {
 
-            // determine age as hours ago
-            time_t val_time = crackISO8601 (line);
-            if (val_time == 0) {
-                Serial.printf ("DST: bogus line: %s\n", line);
-                break;
-            }
-            float age_hrs = (val_time - now)/3600.0F;
-            if (age_hrs > DST_MAXAGE) {
-                Serial.printf ("DST: too old: %s\n", line);
-                break;
-            }
+        if (line[0] == '2' && ll >= 56) {
 
-            dst_cache.age_hrs[dst_i] = age_hrs;
-            dst_cache.values[dst_i] = atof(line + 19);
-        }
+            // short
+            float s = atof(line+35);
+            if (s <= 0)                                 // missing values are set to -1.00e+05, also guard 0
+                s = 1e-9;
+            xray.s[xray_i] = log10f(s);
 
-        // record sw
-        if (dst_i == DST_NV) {
+            // long
+            float l = atof(line+47);
+            if (l <= 0)                                 // missing values are set to -1.00e+05, also guard 0
+                l = 1e-9;
+            xray.l[xray_i] = log10f(l);
+            raw_lxray = l;                              // last one will be current
 
-            // save current (not last!) value
-            space_wx[SPCWX_DST].value = dst_cache.values[DST_NV-1];
-            space_wx[SPCWX_DST].value_ok = true;
-            dst_cache.data_ok = true;
-            dst = dst_cache;
+            // time in hours back from 0
+            xray.x[xray_i] = (xray_i-XRAY_NV)/6.0;     // 6 entries per hour
 
-        } else {
-
-            Serial.printf ("DST: data short: %d of %d\n", dst_i, DST_NV);
+            // good
+            xray_i++;
         }
-
-    } else {
-
-        Serial.print ("DST: connection failed\n");
     }
 
-out:
-
-    // set next update
-    dst_cache.next_update = ok ? nextRetrieval (PLOT_CH_DST, DST_INTERVAL) : nextWiFiRetry(PLOT_CH_DST);
-
-    // clean up
-    updateClocks(false);
-    dst_client.stop();
-    return (ok);
-}
-
-/* return whether fresh SPCWX_DST data are ready, even if bad.
- */
-static bool checkForNewDST (void)
-{
-    if (myNow() < dst_cache.next_update)
+    // capture iff we found all
+    if (xray_i < XRAY_NV) {
+        Serial.printf ("XRay: data short %d of %d\n", xray_i, XRAY_NV);
         return (false);
+    }
 
-    DSTData dst;
-    return (retrieveDST (dst));
+    value = raw_lxray;
+    return (true);
 }
 
-/* retrieve XRay and SPCWX_XRAY if it's time, else use cache.
- * return whether transaction was ok (even if data was not)
+/* parse BzBt reply into BzBtData, return whether complete and current and if so pass back latest SPCWX_BZ.
+ * N.B. runs in a bgfetch worker.
  */
-bool retrieveXRay (XRayData &xray)
+static bool parseBzBt (WiFiClient &client, void *data, float &value)
 {
-    // check cache first
-    if (myNow() < xray_cache.next_update) {
-        xray = xray_cache;
-        return (true);
-    }
-
-    // get fresh
-    WiFiClient xray_client;
+    BzBtData &bzbt = *(BzBtData *)data;
     char line[100];
-    uint16_t ll;
-    bool ok = false;
-
-    // mark value as bad until proven otherwise
-    space_wx[SPCWX_XRAY].value_ok = false;
-    xray.data_ok = xray_cache.data_ok = false;
-
-    Serial.println(xray_page);
-    if (xray_client.connect(backend_host, backend_port)) {
-        updateClocks(false);
-
-        // query web page
-        httpHCGET (xray_client, backend_host, xray_page);
+    time_t t0 = myNow();
 
-        // soak up remaining header
-        if (!httpSkipHeader (xray_client)) {
-            Serial.print ("XRay: header short\n");
-            goto out;
+    // collect content lines and extract both magnetic values, oldest first (newest last :-)
+    // # UNIX        Bx     By     Bz     Bt
+    // 1684087500    1.0   -2.7   -3.2    4.3
+    int bzbt_i = 0;
+    while (bzbt_i < BZBT_NV && getTCPLine (client, line, sizeof(line), NULL)) {
+
+        // crack
+        // Serial.printf("BZBT: %d %s\n", bzbt_i, line);
+        long unix;
+        float this_bz, this_bt;
+        if (sscanf (line, "%ld %*f %*f %f %f", &unix, &this_bz, &this_bt) != 3) {
+            // Serial.printf ("BZBT: rejecting %s\n", line);
+            continue;
         }
 
-        // transaction successful
-        ok = true;
+        // store at bzbt_i
+        bzbt.bz[bzbt_i] = this_bz;
+        bzbt.bt[bzbt_i] = this_bt;
 
-        // collect content lines and extract both wavelength intensities
-        int xray_i = 0;
-        float raw_lxray = 0;
-        while (xray_i < XRAY_NV && getTCPLine (xray_client, line, sizeof(line), &ll)) {
+        // time in hours back from now but clamp at 0 in case we are slightly late
+        bzbt.x[bzbt_i] = unix < t0 ? (unix - t0)/3600.0 : 0;
 
-            if (line[0] == '2' && ll >= 56) {
+        // n read
+        bzbt_i++;
+    }
 
-                // short
-                float s = atof(line+35);
-                if (s <= 0)                             // missing values are set to -1.00e+05, also guard 0
-                    s = 1e-9;
-                xray_cache.s[xray_i] = log10f(s);
+    // proceed iff we found all and current
+    if (bzbt_i < BZBT_NV) {
+        Serial.printf ("BZBT: data short %d of %d\n", bzbt_i, BZBT_NV);
+        return (false);
+    }
+    if (bzbt.x[BZBT_NV-1] <= -0.25F) {
+        Serial.printf ("BZBT: data %g hrs old\n", -bzbt.x[BZBT_NV-1]);
+        return (false);
+    }
 
-                // long
-                float l = atof(line+47);
-                if (l <= 0)                             // missing values are set to -1.00e+05, also guard 0
-                    l = 1e-9;
-                xray_cache.l[xray_i] = log10f(l);
-                raw_lxray = l;                          // last one will be current
+    // capture latest
+    value = bzbt.bz[BZBT_NV-1];
+    return (true);
+}
 
-                // time in hours back from 0
-                xray_cache.x[xray_i] = (xray_i-XRAY_NV)/6.0;       // 6 entries per hour
+/* parse solar wind reply into SolarWindData, return whether enough and if so pass back latest SPCWX_SOLWIND.
+ * N.B. runs in a bgfetch worker.
+ */
+static bool parseSolarWind (WiFiClient &client, void *data, float &value)
+{
+    SolarWindData &sw = *(SolarWindData *)data;
+    char line[80];
 
-                // good
-                xray_i++;
-            }
+    // read lines into wind array and build corresponding x/y values
+    time_t t0 = myNow();
+    time_t start_t = t0 - SWIND_PER;
+    time_t prev_unixs = 0;
+    float max_y = 0;
+    for (sw.n_values = 0; sw.n_values < SWIND_MAXN && getTCPLine (client, line, sizeof(line), NULL); ) {
+        // Serial.printf ("SolWind: %3d: %s\n", nsw, line);
+        long unixs;         // unix seconds
+        float density;      // /cm^2
+        float speed;        // km/s
+        if (sscanf (line, "%ld %f %f", &unixs, &density, &speed) != 3) {
+            Serial.println ("SolWind: data garbled");
+            return (false);
         }
 
-        // capture iff we found all
-        if (xray_i == XRAY_NV) {
+        // want y axis to be 10^12 /s /m^2
+        float this_y = density * speed * 1e-3;
 
-            // capture
-            space_wx[SPCWX_XRAY].value = raw_lxray;
-            space_wx[SPCWX_XRAY].value_ok = true;
-            xray_cache.data_ok = true;
-            xray = xray_cache;
+        // capture largest value in this period
+        if (this_y > max_y)
+            max_y = this_y;
 
+        // skip until find within period and new interval or always included last
+        if ((unixs < start_t || unixs - prev_unixs < SWIND_DT) && sw.n_values != SWIND_MAXN-1)
+            continue;
+        prev_unixs = unixs;
 
-        } else {
-
-            Serial.printf ("XRay: data short %d of %d\n", xray_i, XRAY_NV);
-        }
+        // want x axis to be hours back from now
+        sw.x[sw.n_values] = (t0 - unixs)/(-3600.0F);
+        sw.y[sw.n_values] = max_y;
+        // Serial.printf ("SolWind: %3d %5.2f %5.2f\n", nsw, x[nsw], y[nsw]);
 
-    } else {
-
-        Serial.print ("XRay: connection failed\n");
+        // good one
+        max_y = 0;
+        sw.n_values++;
     }
 
-out:
-
-    // set next update
-    xray_cache.next_update = ok ? nextRetrieval (PLOT_CH_XRAY, XRAY_INTERVAL) : nextWiFiRetry(PLOT_CH_XRAY);
-
-    // clean up
-    updateClocks(false);
-    xray_client.stop();
-    return (ok);
-}
-
-/* return whether fresh SPCWX_XRAY data are ready, even if bad.
- */
-static bool checkForNewXRay (void)
-{
-    if (myNow() < xray_cache.next_update)
+    // good iff found enough
+    if (sw.n_values < SWIND_MINN) {
+        Serial.println ("SolWind:: data error");
         return (false);
+    }
 
-    XRayData xray;
-    return (retrieveXRay (xray));
+    // capture latest
+    value = sw.y[sw.n_values-1];
+    return (true);
 }
 
-/* retrieve BzBt data and SPCWX_BZBT if it's time, else use cache.
- * return whether transaction was ok (even if data was not)
+/* parse NOAA space weather reply into NOAASpaceWxData, return whether good and if so pass back the max
+ * as SPCWX_NOAASPW.
+ * N.B. runs in a bgfetch worker.
  */
-bool retrieveBzBt (BzBtData &bzbt)
+static bool parseNOAASWx (WiFiClient &client, void *data, float &value)
 {
-    // check cache first
-    if (myNow() < bzbt_cache.next_update) {
-        bzbt = bzbt_cache;
-        return (true);
-    }
+    // expecting 3 reply lines of the following form, anything else is an error message
+    //  R  0 0 0 0
+    //  S  0 0 0 0
+    //  G  0 0 0 0
 
-    // get fresh
-    int bzbt_i;                                     // next index to use
-    WiFiClient bzbt_client;
+    NOAASpaceWxData &noaasw = *(NOAASpaceWxData *)data;
     char line[100];
-    bool ok = false;
-    time_t t0 = myNow();
 
-    // mark data as bad until proven otherwise
-    space_wx[SPCWX_BZ].value_ok = false;
-    bzbt.data_ok = bzbt_cache.data_ok = false;
+    // find max
+    int noaasw_max = 0;
 
-    Serial.println(bzbt_page);
-    if (bzbt_client.connect(backend_host, backend_port)) {
-        updateClocks(false);
+    // for each of N_NOAASW_C categories
+    memcpy (noaasw.cat, noaasw_cats, sizeof(noaasw.cat));
+    for (int i = 0; i < N_NOAASW_C; i++) {
 
-        // query web page
-        httpHCGET (bzbt_client, backend_host, bzbt_page);
+        // read next line
+        if (!getTCPLine (client, line, sizeof(line), NULL)) {
+            Serial.println ("NOAASW: missing data");
+            return (false);
+        }
+        // Serial.printf ("NOAA: %d %s\n", i, line);
 
-        // skip over remaining header
-        if (!httpSkipHeader (bzbt_client)) {
-            Serial.print ("BZBT: header short\n");
-            goto out;
+        // category in first char must match
+        if (noaasw.cat[i] != line[0]) {
+            Serial.printf ("NOAASW: invalid class: %s\n", line);
+            return (false);
         }
 
-        // transaction successful
-        ok = true;
+        // for each of N_NOAASW_V values
+        char *lp = line+1;
+        for (int j = 0; j < N_NOAASW_V; j++) {
 
-        // collect content lines and extract both magnetic values, oldest first (newest last :-)
-        // # UNIX        Bx     By     Bz     Bt
-        // 1684087500    1.0   -2.7   -3.2    4.3
-        bzbt_i = 0;
-        while (bzbt_i < BZBT_NV && getTCPLine (bzbt_client, line, sizeof(line), NULL)) {
-
-            // crack
-            // Serial.printf("BZBT: %d %s\n", bzbt_i, line);
-            long unix;
-            float this_bz, this_bt;
-            if (sscanf (line, "%ld %*f %*f %f %f", &unix, &this_bz, &this_bt) != 3) {
-                // Serial.printf ("BZBT: rejecting %s\n", line);
-                continue;
+            // convert next int
+            char *endptr;
+            noaasw.val[i][j] = strtol (lp, &endptr, 10);
+            if (lp == endptr) {
+                Serial.printf ("NOAASW: invalid line: %s\n", line);
+                return (false);
             }
+            lp = endptr;
 
-            // store at bzbt_i
-            bzbt_cache.bz[bzbt_i] = this_bz;
-            bzbt_cache.bt[bzbt_i] = this_bt;
-
-            // time in hours back from now but clamp at 0 in case we are slightly late
-            bzbt_cache.x[bzbt_i] = unix < t0 ? (unix - t0)/3600.0 : 0;
-
-            // n read
-            bzbt_i++;
+            // find max
+            if (noaasw.val[i][j] > noaasw_max)
+                noaasw_max = noaasw.val[i][j];
         }
+    }
+
+    // values ok
+    value = noaasw_max;
+    return (true);
+}
 
-        // proceed iff we found all and current
-        if (bzbt_i == BZBT_NV && bzbt_cache.x[BZBT_NV-1] > -0.25F) {
+/* parse aurora reply into AuroraData, return whether enough and recent and if so pass back newest
+ * SPCWX_AURORA.
+ * N.B. runs in a bgfetch worker.
+ */
+static bool parseAurora (WiFiClient &client, void *data, float &value)
+{
+    AuroraData &aurora = *(AuroraData *)data;
+    char line[100];                                                     // text line
 
-            // capture latest
-            space_wx[SPCWX_BZ].value = bzbt_cache.bz[BZBT_NV-1];
-            space_wx[SPCWX_BZ].value_ok = true;
-            bzbt_cache.data_ok = true;
-            bzbt = bzbt_cache;
+    // init state
+    time_t t_now = myNow();
+    float prev_age = 1e10;
+    aurora.n_points = 0;
 
-        } else {
+    // read lines keep up to AURORA_NPTS newest
+    while (getTCPLine (client, line, sizeof(line), NULL)) {
 
-            if (bzbt_i < BZBT_NV)
-                Serial.printf ("BZBT: data short %d of %d\n", bzbt_i, BZBT_NV);
-            else
-                Serial.printf ("BZBT: data %g hrs old\n", -bzbt_cache.x[BZBT_NV-1]);
+        // crack
+        long utime;
+        float percent;
+        if (sscanf (line, "%ld %f", &utime, &percent) != 2) {
+            Serial.printf ("AURORA: garbled: %s\n", line);
+            return (false);
         }
+        // Serial.printf ("AURORA: %ld %g\n", utime, percent
 
-    } else {
+        // find age for this datum, skip if crazy new or too old or out of order
+        float age = (t_now - utime)/3600.0F;        // seconds to hours
+        if (age < 0 || age > AURORA_MAXAGE || age >= prev_age) {
+            Serial.printf ("AURORA: skipping age %g hrs\n", age);
+            continue;
+        }
+        prev_age = age;
 
-        Serial.print ("BZBT: connection failed\n");
+        // add to list, shift out oldest if full
+        if (aurora.n_points == AURORA_MAXPTS) {
+            memmove (&aurora.age_hrs[0], &aurora.age_hrs[1], (AURORA_MAXPTS-1)*sizeof(float));
+            memmove (&aurora.percent[0], &aurora.percent[1], (AURORA_MAXPTS-1)*sizeof(float));
+            aurora.n_points = AURORA_MAXPTS - 1;
+        }
+        aurora.age_hrs[aurora.n_points] = -age;                         // want "ago"
+        aurora.percent[aurora.n_points] = percent;
+        aurora.n_points++;
     }
 
-out:
+    // require at least a few recent
+    if (aurora.n_points < 5) {
+        Serial.printf ("AURORA: only %d points\n", aurora.n_points);
+        return (false);
+    }
+    if (aurora.age_hrs[aurora.n_points-1] <= -1.0F) {
+        Serial.printf ("AURORA: newest is too old: %g hrs\n", -aurora.age_hrs[aurora.n_points-1]);
+        return (false);
+    }
 
-    // set next update
-    bzbt_cache.next_update = ok ? nextRetrieval (PLOT_CH_BZBT, BZBT_INTERVAL) : nextWiFiRetry(PLOT_CH_BZBT);
+    // good
+    Serial.printf ("AURORA: found %d points [%g,%g] hrs old\n", aurora.n_points,
+                -aurora.age_hrs[0], -aurora.age_hrs[aurora.n_points-1]);
 
-    // clean up
-    updateClocks(false);
-    bzbt_client.stop();
-    return (ok);
+    // capture newest value for space wx
+    value = aurora.percent[aurora.n_points-1];
+    return (true);
 }
 
-/* return whether fresh SPCWX_BZBT data are ready, even if bad.
- */
-static bool checkForNewBzBt(void)
-{
-    if (myNow() < bzbt_cache.next_update)
-        return (false);
-    BzBtData bzbt;
-    return (retrieveBzBt (bzbt));
-}
 
+/* background retrieval state for each space_wx stat, indexed by SPCWX_t.
+ * a bgfetch worker reads the page and parses it into fresh, then the main thread copies fresh into the cache
+ * and updates space_wx. Thus the cache, space_wx and everything else here belongs to the main thread except
+ * fresh, value and parsed_ok while bgf is pending.
+ */
+typedef struct {
+    SPCWX_t sp;                                 // which one we are, just to check the table order
+    const char *page;                           // backend page
+    int interval;                               // seconds to next retrieval after io success
+    bool (*parse)(WiFiClient &client, void *data, float &value);       // worker parser
+    void *cache;                                // installed data
+    void *fresh;                                // worker's private copy while fetching
+    size_t size;                                // sizeof cache and fresh
+    time_t *next_update;                        // &cache.next_update
+    bool *data_ok;                              // &cache.data_ok
+    float value;                                // new space_wx value parsed along with fresh
+    bool parsed_ok;                             // whether fresh and value are good
+    bool io_ok;                                 // whether the most recent fetch io was ok
+    bool installed;                             // set when cache changes, cleared by checkForNewSpaceWx()
+    int n_installed;                            // n fetches installed, 0 until first arrives
+    BGFetch bgf;                                // background job
+} SpcWxFetch;
+
+#define _SWF(sp,page,intvl,parse,cache,fresh)  \
+    {sp, page, intvl, parse, &cache, &fresh, sizeof(cache), &cache.next_update, &cache.data_ok, 0, false, \
+     false, false, 0, {}}
+static SpcWxFetch spcwx_fetch[SPCWX_N] = {
+    _SWF (SPCWX_SSN,     ssn_page,     SSN_INTERVAL,      parseSunSpots,  ssn_cache,    ssn_fresh),
+    _SWF (SPCWX_XRAY,    xray_page,    XRAY_INTERVAL,     parseXRay,      xray_cache,   xray_fresh),
+    _SWF (SPCWX_FLUX,    sf_page,      SFLUX_INTERVAL,    parseSolarFlux, sf_cache,     sf_fresh),
+    _SWF (SPCWX_KP,      kp_page,      KP_INTERVAL,       parseKp,        kp_cache,     kp_fresh),
+    _SWF (SPCWX_SOLWIND, swind_page,   SWIND_INTERVAL,    parseSolarWind, sw_cache,     sw_fresh),
+    _SWF (SPCWX_DRAP,    drap_page,    DRAPPLOT_INTERVAL, parseDRAP,      drap_cache,   drap_fresh),
+    _SWF (SPCWX_BZ,      bzbt_page,    BZBT_INTERVAL,     parseBzBt,      bzbt_cache,   bzbt_fresh),
+    _SWF (SPCWX_NOAASPW, noaaswx_page, NOAASPW_INTERVAL,  parseNOAASWx,   noaasw_cache, noaasw_fresh),
+    _SWF (SPCWX_AURORA,  aurora_page,  AURORA_INTERVAL,   parseAurora,    aurora_cache, aurora_fresh),
+    _SWF (SPCWX_DST,     dst_page,     DST_INTERVAL,      parseDST,       dst_cache,    dst_fresh),
+};
+#undef _SWF
 
-/* retrieve solar wind and SPCWX_SOLWIND if it's time, else use cache.
- * return whether transaction was ok (even if data was not)
+/* bgfetch worker to read and parse the page for the SpcWxFetch in bgf.arg, return whether io was ok.
  */
-bool retrieveSolarWind(SolarWindData &sw)
+static bool fetchSpcWx (BGFetch &bgf)
 {
-    // check cache first
-    if (myNow() < sw_cache.next_update) {
-        sw = sw_cache;
-        return (true);
-    }
-
-    // get fresh
-    WiFiClient swind_client;
-    char line[80];
+    SpcWxFetch &f = *(SpcWxFetch *)bgf.arg;
+    const char *name = space_wx[f.sp].name;
+    WiFiClient client;
     bool ok = false;
 
-    // mark value as bad until proven otherwise
-    space_wx[SPCWX_SOLWIND].value_ok = false;
-    sw.data_ok = sw_cache.data_ok = false;
+    // start clean, parsers rely on this
+    memset (f.fresh, 0, f.size);
+    f.parsed_ok = false;
+    f.value = 0;
 
-    Serial.println (swind_page);
-    if (swind_client.connect(backend_host, backend_port)) {
-        updateClocks(false);
+    Serial.println (f.page);
+    if (client.connect(backend_host, backend_port)) {
 
-        // query web page
-        httpHCGET (swind_client, backend_host, swind_page);
+        // query web page, N.B. with the User-Agent prepared by startBGFetch()
+        httpHCGET (client, backend_host, f.page, NULL, bgf.ua);
 
-        // skip response header
-        if (!httpSkipHeader (swind_client)) {
-            Serial.println ("SolWind: header short");
-            goto out;
-        }
-
-        // transaction successful
-        ok = true;
-
-        // read lines into wind array and build corresponding x/y values
-        time_t t0 = myNow();
-        time_t start_t = t0 - SWIND_PER;
-        time_t prev_unixs = 0;
-        float max_y = 0;
-        for (sw_cache.n_values = 0; sw_cache.n_values < SWIND_MAXN
-                                                && getTCPLine (swind_client, line, sizeof(line), NULL); ) {
-            // Serial.printf ("SolWind: %3d: %s\n", nsw, line);
-            long unixs;         // unix seconds
-            float density;      // /cm^2
-            float speed;        // km/s
-            if (sscanf (line, "%ld %f %f", &unixs, &density, &speed) != 3) {
-                Serial.println ("SolWind: data garbled");
-                goto out;
-            }
-
-            // want y axis to be 10^12 /s /m^2
-            float this_y = density * speed * 1e-3;
+        // skip response header, N.B. not the remote_addr flavor, that belongs to the main thread
+        if (httpSkipHeader (client, NULL, NULL, 0)) {
 
-            // capture largest value in this period
-            if (this_y > max_y)
-                max_y = this_y;
-
-            // skip until find within period and new interval or always included last
-            if ((unixs < start_t || unixs - prev_unixs < SWIND_DT) && sw_cache.n_values != SWIND_MAXN-1)
-                continue;
-            prev_unixs = unixs;
-
-            // want x axis to be hours back from now
-            sw_cache.x[sw_cache.n_values] = (t0 - unixs)/(-3600.0F);
-            sw_cache.y[sw_cache.n_values] = max_y;
-            // Serial.printf ("SolWind: %3d %5.2f %5.2f\n", nsw, x[nsw], y[nsw]);
-
-            // good one
-            max_y = 0;
-            sw_cache.n_values++;
-        }
-
-        updateClocks(false);
-
-        // good iff found enough
-        if (sw_cache.n_values >= SWIND_MINN) {
-
-            // capture latest
-            space_wx[SPCWX_SOLWIND].value = sw_cache.y[sw_cache.n_values-1];
-            space_wx[SPCWX_SOLWIND].value_ok = true;
-            sw_cache.data_ok = true;
-            sw = sw_cache;
+            // transaction successful even if data are not
+            ok = true;
+            f.parsed_ok = (*f.parse)(client, f.fresh, f.value);
 
         } else {
-            Serial.println ("SolWind:: data error");
+            Serial.printf ("%s: header short\n", name);
         }
 
     } else {
 
-        Serial.println ("SolWind: connection failed");
+        Serial.printf ("%s: connection failed\n", name);
     }
 
-out:
-
-    // set next update
-    sw_cache.next_update = ok ? nextRetrieval (PLOT_CH_SOLWIND, SWIND_INTERVAL)
-                              : nextWiFiRetry(PLOT_CH_SOLWIND);
-
     // clean up
-    updateClocks(false);
-    swind_client.stop();
+    client.stop();
     return (ok);
 }
 
-/* return whether fresh SPCWX_SOLWIND data are ready, even if bad.
+/* main thread bgfetch completion: install the results of the SpcWxFetch in bgf.arg.
  */
-static bool checkForNewSolarWind (void)
+static void installSpcWx (BGFetch &bgf)
 {
-    if (myNow() < sw_cache.next_update)
-        return (false);
+    SpcWxFetch &f = *(SpcWxFetch *)bgf.arg;
+    SpaceWeather_t &swx = space_wx[f.sp];
+
+    // install fresh data, if any, and their status
+    if (bgf.ok)
+        memcpy (f.cache, f.fresh, f.size);
+    *f.data_ok = bgf.ok && f.parsed_ok;
+    swx.value = f.value;
+    swx.value_ok = *f.data_ok;
+
+    // set next update
+    *f.next_update = bgf.ok ? nextRetrieval (swx.pc, f.interval) : nextWiFiRetry (swx.pc);
 
-    SolarWindData sw;
-    return (retrieveSolarWind (sw));
+    // record and redraw its pane if showing
+    f.io_ok = bgf.ok;
+    f.installed = true;
+    f.n_installed++;
+    scheduleNewPlot (swx.pc);
 }
 
-/* retrieve NOAA space weather indices and SPCWX_NOAASPW if it's time, else use cache.
- * return whether transaction was ok (even if data was not)
+/* start a background retrieval of the given stat if it is due and not already underway.
  */
-bool retrieveNOAASWx (NOAASpaceWxData &noaasw)
+static void startSpcWxFetch (SpcWxFetch &f)
 {
-    // check cache first
-    if (myNow() < noaasw_cache.next_update) {
-        noaasw = noaasw_cache;
-        return (true);
-    }
-
-    // expecting 3 reply lines of the following form, anything else is an error message
-    //  R  0 0 0 0
-    //  S  0 0 0 0
-    //  G  0 0 0 0
-
-    // get fresh
-    WiFiClient noaaswx_client;
-    bool ok = false;
-
-    // mark data as bad until proven otherwise
-    space_wx[SPCWX_NOAASPW].value_ok = false;
-    noaasw.data_ok = noaasw_cache.data_ok = false;
-
-    // read scales
-    Serial.println(noaaswx_page);
-    char line[100];
-    if (noaaswx_client.connect(backend_host, backend_port)) {
-
-        updateClocks(false);
-
-        // fetch page
-        httpHCGET (noaaswx_client, backend_host, noaaswx_page);
-
-        // skip header then read the data lines
-        if (httpSkipHeader (noaaswx_client)) {
-
-            // transaction successful
-            ok = true;
-
-            // find max
-            int noaasw_max = 0;
-
-            // for each of N_NOAASW_C categories
-            for (int i = 0; i < N_NOAASW_C; i++) {
-
-                // read next line
-                if (!getTCPLine (noaaswx_client, line, sizeof(line), NULL)) {
-                    Serial.println ("NOAASW: missing data");
-                    goto out;
-                }
-                // Serial.printf ("NOAA: %d %s\n", i, line);
-
-                // category in first char must match
-                if (noaasw_cache.cat[i] != line[0]) {
-                    Serial.printf ("NOAASW: invalid class: %s\n", line);
-                    goto out;
-                }
-
-                // for each of N_NOAASW_V values
-                char *lp = line+1;
-                for (int j = 0; j < N_NOAASW_V; j++) {
+    if (myNow() < *f.next_update || f.bgf.pending)
+        return;
+
+    f.bgf.name = space_wx[f.sp].name;
+    f.bgf.fetch = fetchSpcWx;
+    f.bgf.done = installSpcWx;
+    f.bgf.arg = &f;
+    (void) startBGFetch (f.bgf);
+}
 
-                    // convert next int
-                    char *endptr;
-                    noaasw_cache.val[i][j] = strtol (lp, &endptr, 10);
-                    if (lp == endptr) {
-                        Serial.printf ("NOAASW: invalid line: %s\n", line);
-                        goto out;
-                    }
-                    lp = endptr;
+/* copy the cached data of the given stat to data, starting a fresh background retrieval if it's time.
+ * only the very first time do we wait for the retrieval so callers always have something real to show;
+ * after that, new data arrive later via installSpcWx() which causes the pane to redraw.
+ * return whether the most recent transaction was ok (even if data were not).
+ */
+static bool retrieveSpcWx (SPCWX_t sp, void *data)
+{
+    SpcWxFetch &f = spcwx_fetch[sp];
 
-                    // find max
-                    if (noaasw_cache.val[i][j] > noaasw_max)
-                        noaasw_max = noaasw_cache.val[i][j];
-                }
+    startSpcWxFetch (f);
+    if (f.n_installed == 0)
+        waitBGFetch (f.bgf);
 
-            }
+    memcpy (data, f.cache, f.size);
+    return (f.io_ok);
+}
 
-            // values ok
-            space_wx[SPCWX_NOAASPW].value = noaasw_max;
-            space_wx[SPCWX_NOAASPW].value_ok = true;
-            noaasw_cache.data_ok = true;
-            noaasw = noaasw_cache;
+/* retrieve sun spot and SPCWX_SSN if it's time, else use cache.
+ * return whether transaction was ok (even if data was not)
+ */
+bool retrieveSunSpots (SunSpotData &ssn)
+{
+    return (retrieveSpcWx (SPCWX_SSN, &ssn));
+}
 
-        } else {
-            Serial.println ("NOAASW: header short");
-            goto out;
-        }
+/* retrieve solar flux and SPCWX_FLUX if it's time, else use cache.
+ * return whether transaction was ok (even if data was not)
+ */
+bool retrieveSolarFlux (SolarFluxData &sf)
+{
+    return (retrieveSpcWx (SPCWX_FLUX, &sf));
+}
 
-    } else {
+/* retrieve DRAP and SPCWX_DRAP if it's time, else use cache.
+ * return whether transaction was ok (even if data was not)
+ */
+bool retrieveDRAP (DRAPData &drap)
+{
+    return (retrieveSpcWx (SPCWX_DRAP, &drap));
+}
 
-        Serial.println ("NOAASW: connection failed");
-    }
+/* retrieve Kp and SPCWX_KP if it's time, else use cache.
+ * return whether transaction was ok (even if data was not)
+ */
+bool retrieveKp (KpData &kp)
+{
+    return (retrieveSpcWx (SPCWX_KP, &kp));
+}
 
-out:
+/* retrieve DST and SPCWX_DST if it's time, else use cache.
+ * return whether transaction was ok (even if data was not)
+ */
+bool retrieveDST (DSTData &dst)
+{
+    return (retrieveSpcWx (SPCWX_DST, &dst));
+}
 
-    // set next update
-    noaasw_cache.next_update = ok ? nextRetrieval (PLOT_CH_NOAASPW, NOAASPW_INTERVAL)
-                                  : nextWiFiRetry(PLOT_CH_NOAASPW);
+/* retrieve XRay and SPCWX_XRAY if it's time, else use cache.
+ * return whether transaction was ok (even if data was not)
+ */
+bool retrieveXRay (XRayData &xray)
+{
+    return (retrieveSpcWx (SPCWX_XRAY, &xray));
+}
 
-    // clean up
-    updateClocks(false);
-    noaaswx_client.stop();
-    return (ok);
+/* retrieve BzBt data and SPCWX_BZBT if it's time, else use cache.
+ * return whether transaction was ok (even if data was not)
+ */
+bool retrieveBzBt (BzBtData &bzbt)
+{
+    return (retrieveSpcWx (SPCWX_BZ, &bzbt));
 }
 
-/* return whether fresh SPCWX_NOAASPW data are ready, even if bad.
+/* retrieve solar wind and SPCWX_SOLWIND if it's time, else use cache.
+ * return whether transaction was ok (even if data was not)
  */
-static bool checkForNewNOAASWx (void)
+bool retrieveSolarWind(SolarWindData &sw)
 {
-    if (myNow() < noaasw_cache.next_update)
-        return (false);
-    NOAASpaceWxData noaasw;
-    return (retrieveNOAASWx(noaasw));
+    return (retrieveSpcWx (SPCWX_SOLWIND, &sw));
 }
 
+/* retrieve NOAA space weather indices and SPCWX_NOAASPW if it's time, else use cache.
+ * return whether transaction was ok (even if data was not)
+ */
+bool retrieveNOAASWx (NOAASpaceWxData &noaasw)
+{
+    return (retrieveSpcWx (SPCWX_NOAASPW, &noaasw));
+}
 
 /* retrieve aurora and SPCWX_AURORA if it's time, else use cache.
  * return whether transaction was ok (even if data was not)
  */
 bool retrieveAurora (AuroraData &aurora)
 {
-    // check cache first
-    if (myNow() < aurora_cache.next_update) {
-        aurora = aurora_cache;
-        return (true);
-    }
-
-    // get fresh
-    WiFiClient aurora_client;                                           // wifi client connection
-    char line[100];                                                     // text line
-    bool ok = false;                                                    // set iff all ok
-
-    // mark data as bad until proven otherwise
-    space_wx[SPCWX_AURORA].value_ok = false;
-    aurora.data_ok = aurora_cache.data_ok = false;
-
-    Serial.println (aurora_page);
-    if (aurora_client.connect(backend_host, backend_port)) {
-        updateClocks(false);
-
-        // query web page
-        httpHCGET (aurora_client, backend_host, aurora_page);
-
-        // skip response header
-        if (!httpSkipHeader (aurora_client)) {
-            Serial.print ("AURORA: header short\n");
-            goto out;
-        }
-
-        // transaction itself is successful
-        ok = true;
-
-        // init state
-        time_t t_now = myNow();
-        float prev_age = 1e10;
-        aurora_cache.n_points = 0;
-
-        // read lines keep up to AURORA_NPTS newest
-        while (getTCPLine (aurora_client, line, sizeof(line), NULL)) {
-
-            // crack
-            long utime;
-            float percent;
-            if (sscanf (line, "%ld %f", &utime, &percent) != 2) {
-                Serial.printf ("AURORA: garbled: %s\n", line);
-                goto out;
-            }
-            // Serial.printf ("AURORA: %ld %g\n", utime, percent
-
-            // find age for this datum, skip if crazy new or too old or out of order
-            float age = (t_now - utime)/3600.0F;        // seconds to hours
-            if (age < 0 || age > AURORA_MAXAGE || age >= prev_age) {
-                Serial.printf ("AURORA: skipping age %g hrs\n", age);
-                continue;
-            }
-            prev_age = age;
-
-            // add to list, shift out oldest if full
-            if (aurora_cache.n_points == AURORA_MAXPTS) {
-                memmove (&aurora_cache.age_hrs[0], &aurora_cache.age_hrs[1], (AURORA_MAXPTS-1)*sizeof(float));
-                memmove (&aurora_cache.percent[0], &aurora_cache.percent[1], (AURORA_MAXPTS-1)*sizeof(float));
-                aurora_cache.n_points = AURORA_MAXPTS - 1;
-            }
-            aurora_cache.age_hrs[aurora_cache.n_points] = -age;               // want "ago"
-            aurora_cache.percent[aurora_cache.n_points] = percent;
-            aurora_cache.n_points++;
-        }
-
-        // look alive
-        updateClocks(false);
-
-        // require at least a few recent
-        if (aurora_cache.n_points < 5) {
-            Serial.printf ("AURORA: only %d points\n", aurora_cache.n_points);
-        } else if (aurora_cache.age_hrs[aurora_cache.n_points-1] <= -1.0F) {
-            Serial.printf ("AURORA: newest is too old: %g hrs\n",
-                                -aurora_cache.age_hrs[aurora_cache.n_points-1]);
-        } else {
-
-            // good
-            Serial.printf ("AURORA: found %d points [%g,%g] hrs old\n", aurora_cache.n_points,
-                    -aurora_cache.age_hrs[0], -aurora_cache.age_hrs[aurora_cache.n_points-1]);
-
-            // capture newest value for space wx
-            space_wx[SPCWX_AURORA].value = aurora_cache.percent[aurora_cache.n_points-1];
-            space_wx[SPCWX_AURORA].value_ok = true;
-            aurora_cache.data_ok = true;
-            aurora = aurora_cache;
-        }
-
-    } else {
-
-        Serial.print ("AURORA: connection failed\n");
-    }
-
-out:
-
-    // set next update
-    aurora_cache.next_update = ok ? nextRetrieval (PLOT_CH_AURORA, AURORA_INTERVAL)
-                                  : nextWiFiRetry(PLOT_CH_AURORA);
+    return (retrieveSpcWx (SPCWX_AURORA, &aurora));
+}
 
-    // clean up
-    updateClocks(false);
-    aurora_client.stop();
-    return (ok);
+/* start a fresh SPCWX_DRAP retrieval if it's time.
+ * return whether new data have arrived and not yet been reported by checkForNewSpaceWx().
+ */
+bool checkForNewDRAP ()
+{
+    SpcWxFetch &f = spcwx_fetch[SPCWX_DRAP];
+    startSpcWxFetch (f);
+    return (f.installed);
 }
 
-/* return whether fresh SPCWX_AURORA data are ready, even if bad.
+/* start a fresh SPCWX_AURORA retrieval if it's time.
+ * return whether new data have arrived and not yet been reported by checkForNewSpaceWx().
  */
 bool checkForNewAurora ()
 {
-    if (myNow() < aurora_cache.next_update)
-        return (false);
-    AuroraData a;
-    return (retrieveAurora(a));
+    SpcWxFetch &f = spcwx_fetch[SPCWX_AURORA];
+    startSpcWxFetch (f);
+    return (f.installed);
 }
 
-/* update all space_wx stats but no faster than their respective panes would do.
- * return whether any actually updated.
+/* start background retrievals of all space_wx stats but no faster than their respective panes would do.
+ * return whether any have been installed since the last call, even if bad.
  */
 bool checkForNewSpaceWx()
 {
-    // check each
-    bool sf = checkForNewSolarFlux();
-    bool kp = checkForNewKp();
-    bool ds = checkForNewDST();
-    bool xr = checkForNewXRay();
-    bool bz = checkForNewBzBt();
-    bool dr = checkForNewDRAP();
-    bool sw = checkForNewSolarWind();
-    bool ss = checkForNewSunSpots();
-    bool na = checkForNewNOAASWx();
-    bool au = checkForNewAurora();
-
-    // check whether any changed
-    bool any_new = sf || ds || kp || xr || bz || dr || sw || ss || na || au;
+    bool any_new = false;
+    for (int i = 0; i < SPCWX_N; i++) {
+        SpcWxFetch &f = spcwx_fetch[i];
+        startSpcWxFetch (f);
+        if (f.installed) {
+            f.installed = false;
+            any_new = true;
+        }
+    }
 
     // if so redo ranking unless Auto
     if (any_new && spcwx_chmask == SPCWX_AUTO)
@@ -1452,6 +1096,11 @@ bool checkForNewSpaceWx()
  */
 void initSpaceWX(void)
 {
+    // insure spcwx_fetch[] is in SPCWX_t order
+    for (int i = 0; i < SPCWX_N; i++)
+        if (spcwx_fetch[i].sp != i)
+            fatalError ("Bug! spcwx_fetch[%d] is %d", i, spcwx_fetch[i].sp);
+
     // init all space_wx m and b
     bool mb_ok = initSWFit();
     if (!mb_ok)
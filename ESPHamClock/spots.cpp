@@ -4,55 +4,113 @@
 #include "HamClock.h"
 
 
-/* find list element, subject to possible filtering, that is closest to ll on the given end(s).
- * return whether found one within MAX_CSR_DIST.
+// context for acceptSpotNode()
+typedef struct {
+    const SpotIndex *sip;                       // index being searched
+    SpotFilter sfp;                             // filter to apply to each candidate spot
+} SpotNodeFilter;
+
+
+/* qsort-style compare two list indices
  */
-bool getClosestSpot (DXSpot *list, int n_list, SpotFilter sfp, LabelOnMapEnd which_end,
-LatLong &from_ll, DXSpot *closest_sp, LatLong *closest_llp)
+static int qsSpotIndex (const void *v1, const void *v2)
 {
-    // linear search -- not worth kdtree etc
-    const DXSpot *min_sp = NULL;   
-    float min_d = 1e10;
-    bool min_is_de = false;         
-    for (int i = 0; i < n_list; i++) {
+    return (*(const int *)v1 - *(const int *)v2);
+}
 
-        DXSpot *sp = &list[i];
+/* called by the owner of si whenever the contents of its list change so it is rebuilt before next use.
+ */
+void spotIndexChanged (SpotIndex &si)
+{
+    si.changed = true;
+}
 
-        // skip if filtered out
-        if (sfp && !(*sfp)(sp))
-            continue;
+/* return the list index of the spot containing the given node, and whether it is the rx end.
+ * N.B. each node's data points to the rx_ll or tx_ll of its spot.
+ */
+static int spotIndexNode (const SpotIndex &si, const KD3Node *np, bool *is_rx)
+{
+    int i = ((const char *)np->data - (const char *)si.list) / sizeof(DXSpot);
+    *is_rx = np->data == &si.list[i].rx_ll;
+    return (i);
+}
 
-        // check RX end if used
-        if (which_end == LOME_RXEND || which_end == LOME_BOTH) {
-            float d = sp->rx_ll.GSD(from_ll);
-            if (d < min_d) {
-                min_d = d;
-                min_sp = sp;
-                min_is_de = true;
-            }
-        }
+/* insure si indexes the given end(s) of list, rebuilding if anything changed since last time.
+ */
+static void refreshSpotIndex (SpotIndex &si, DXSpot *list, int n_list, LabelOnMapEnd which_end)
+{
+    if (!si.changed && si.list == list && si.n_list == n_list && si.ends == which_end)
+        return;
 
-        // check TX end if used
-        if (which_end == LOME_TXEND || which_end == LOME_BOTH) {
-            float d = sp->tx_ll.GSD(from_ll);
-            if (d < min_d) {
-                min_d = d;
-                min_sp = sp;
-                min_is_de = false;
-            }
+    bool use_rx = which_end == LOME_RXEND || which_end == LOME_BOTH;
+    bool use_tx = which_end == LOME_TXEND || which_end == LOME_BOTH;
+    int n_nodes = n_list * ((int)use_rx + (int)use_tx);
+    if (n_nodes > si.n_malloc) {
+        si.nodes = (KD3Node *) realloc (si.nodes, n_nodes * sizeof(KD3Node));
+        if (!si.nodes)
+            fatalError ("No memory for %d spot index nodes", n_nodes);
+        si.n_malloc = n_nodes;
+    }
+
+    // rx before tx of each spot so data addresses increase as they would in a linear scan
+    KD3Node *np = si.nodes;
+    for (int i = 0; i < n_list; i++) {
+        if (use_rx) {
+            ll2KD3Node (list[i].rx_ll, np);
+            np++->data = &list[i].rx_ll;
+        }
+        if (use_tx) {
+            ll2KD3Node (list[i].tx_ll, np);
+            np++->data = &list[i].tx_ll;
         }
     }
+    si.root = mkKD3NodeTree (si.nodes, n_nodes, 0);
 
-    // use if close enough
-    if (min_sp && min_d*ERAD_M < MAX_CSR_DIST) {
+    si.list = list;
+    si.n_list = n_list;
+    si.ends = which_end;
+    si.changed = false;
+}
+
+/* KD3Accept that passes the spot containing np through the SpotNodeFilter in arg
+ */
+static bool acceptSpotNode (const KD3Node *np, void *arg)
+{
+    const SpotNodeFilter &snf = *(const SpotNodeFilter *)arg;
+    bool is_rx;
+    return ((*snf.sfp)(&snf.sip->list[spotIndexNode (*snf.sip, np, &is_rx)]));
+}
 
-        // return ll depending on end
-        *closest_llp = min_is_de ? min_sp->rx_ll : min_sp->tx_ll;
+/* find list element, subject to possible filtering, that is closest to ll on the given end(s).
+ * si is the index the caller keeps for list; ties go to the earlier spot, and its rx end, as in a linear scan.
+ * if n_near is not NULL also report how many such spots lie within MAX_CSR_DIST of the one found, including it.
+ * return whether found one within MAX_CSR_DIST.
+ */
+bool getClosestSpot (SpotIndex &si, DXSpot *list, int n_list, SpotFilter sfp, LabelOnMapEnd which_end,
+LatLong &from_ll, DXSpot *closest_sp, LatLong *closest_llp, int *n_near)
+{
+    refreshSpotIndex (si, list, n_list, which_end);
 
-        // return spot
-        *closest_sp = *min_sp;
+    KD3Node from_nd;
+    ll2KD3Node (from_ll, &from_nd);
+
+    SpotNodeFilter snf = {&si, sfp};
+    const KD3Node *best = NULL;
+    float best_dist = 0;
+    int n_visited = 0;
+    nearestKD3NodeIf (si.root, &from_nd, 0, sfp ? acceptSpotNode : NULL, &snf, &best, &best_dist, &n_visited);
+    if (!best)
+        return (false);
 
-        // ok
+    // use if close enough
+    bool is_rx;
+    DXSpot *min_sp = &list[spotIndexNode (si, best, &is_rx)];
+    LatLong &min_ll = is_rx ? min_sp->rx_ll : min_sp->tx_ll;
+    if (from_ll.GSD(min_ll)*ERAD_M < MAX_CSR_DIST) {
+        *closest_llp = min_ll;
+        *closest_sp = *min_sp;
+        if (n_near)
+            *n_near = getSpotsWithin (si, list, n_list, sfp, which_end, min_ll, MAX_CSR_DIST, NULL, 0);
         return (true);
     }
 
@@ -60,6 +118,45 @@ LatLong &from_ll, DXSpot *closest_sp, LatLong *closest_llp)
     return (false);
 }
 
+/* find the spots in list, subject to possible filtering, with either given end within the given distance of ll,
+ * using the caller's index si.
+ * store up to max_indices of their list indices in ascending order, each spot at most once.
+ * return total number of such spots, which may be more than max_indices.
+ */
+int getSpotsWithin (SpotIndex &si, DXSpot *list, int n_list, SpotFilter sfp, LabelOnMapEnd which_end,
+const LatLong &ll, float miles, int *indices, int max_indices)
+{
+    refreshSpotIndex (si, list, n_list, which_end);
+    if (!si.root)
+        return (0);
+
+    KD3Node ll_nd;
+    ll2KD3Node (ll, &ll_nd);
+
+    // N.B. with both ends the same spot may be found twice, so collect all then sort and remove dups
+    int n_nodes = si.n_list * (si.ends == LOME_BOTH ? 2 : 1);
+    StackMalloc found_mem (n_nodes * sizeof(const KD3Node *));
+    StackMalloc ix_mem (n_nodes * sizeof(int));
+    const KD3Node **found = (const KD3Node **) found_mem.getMem();
+    int *ix = (int *) ix_mem.getMem();
+    int n_found = findKD3NodesWithin (si.root, &ll_nd, 0, miles2KD3Dist(miles), found, n_nodes);
+    for (int i = 0; i < n_found; i++) {
+        bool is_rx;
+        ix[i] = spotIndexNode (si, found[i], &is_rx);
+    }
+    qsort (ix, n_found, sizeof(int), qsSpotIndex);
+
+    int n_spots = 0;
+    for (int i = 0; i < n_found; i++) {
+        if ((i > 0 && ix[i] == ix[i-1]) || (sfp && !(*sfp)(&list[ix[i]])))
+            continue;
+        if (n_spots < max_indices)
+            indices[n_spots] = ix[i];
+        n_spots++;
+    }
+
+    return (n_spots);
+}
 
 /* draw a dot and/or label at the given end of a spot path, as per setup options.
  * N.B. this only handles LOME_RXEND or LOME_TXEND, not LOME_BOTH.
@@ -128,6 +225,85 @@ void drawSpotLabelOnMap (DXSpot &spot, LabelOnMapEnd txrx, LabelOnMapDot dot)
         drawSpotTXRXOnMap (spot, LOME_RXEND, dot);
 }
 
+/* recently drawn spot paths projected to raw screen coords, so redrawing them each map sweep just replays
+ * line segments. each path is found in a small set-associative table by its ends and line width, and is
+ * projected again when getMapProjGen() changes.
+ */
+#define SPOTPATH_NSETS  512                             // n sets, power of 2
+#define SPOTPATH_NWAYS  4                               // n paths in each set
+typedef struct {
+    float rx_lat, rx_lng, tx_lat, tx_lng;               // path ends, rads
+    int raw_pw;                                         // ll2sRaw() edge
+    uint32_t gen;                                       // getMapProjGen() when pts were found, 0 if never
+    uint32_t used;                                      // spotpath_tick when last drawn, to pick replacement
+    int n_pts, n_malloc;                                // n pts used, n malloced
+    SCoord *pts;                                        // malloced raw screen coords from rx to tx
+} SpotPath;
+static SpotPath spot_paths[SPOTPATH_NSETS][SPOTPATH_NWAYS];
+static uint32_t spotpath_tick;                          // incremented each use
+static int spotpath_hits, spotpath_misses;              // stats
+
+/* return the given path projected for the current map, finding it again only if necessary.
+ */
+static const SpotPath &findSpotPath (const LatLong &rx_ll, const LatLong &tx_ll, int raw_pw)
+{
+    // hash the ends and width
+    float key[5] = {rx_ll.lat, rx_ll.lng, tx_ll.lat, tx_ll.lng, (float)raw_pw};
+    uint32_t h = 2166136261U;
+    for (unsigned i = 0; i < sizeof(key); i++)
+        h = (h ^ ((uint8_t *)key)[i]) * 16777619U;
+    SpotPath *set = spot_paths[h & (SPOTPATH_NSETS-1)];
+
+    // use if already current, else replace one never used, stale or used longest ago
+    uint32_t gen = getMapProjGen();
+    SpotPath *oldest = &set[0];
+    for (int i = 0; i < SPOTPATH_NWAYS; i++) {
+        SpotPath &sp = set[i];
+        if (sp.gen == gen && sp.raw_pw == raw_pw && sp.rx_lat == rx_ll.lat && sp.rx_lng == rx_ll.lng
+                                            && sp.tx_lat == tx_ll.lat && sp.tx_lng == tx_ll.lng) {
+            sp.used = ++spotpath_tick;
+            spotpath_hits++;
+            return (sp);
+        }
+        if (sp.gen != gen)
+            sp.used = 0;
+        if (sp.used < oldest->used)
+            oldest = &sp;
+    }
+    SpotPath &sp = *oldest;
+    spotpath_misses++;
+
+    // walk from rx to tx
+    float slat = sinf (rx_ll.lat);
+    float clat = cosf (rx_ll.lat);
+    float dist, bear;
+    propPath (false, rx_ll, slat, clat, tx_ll, &dist, &bear);
+    const int n_step = ((int)ceilf(dist/deg2rad(PATH_SEGLEN))) | 1;     // always odd so both ends are drawn
+    const float step = dist/n_step;
+    if (n_step + 1 > sp.n_malloc) {
+        sp.n_malloc = n_step + 1;
+        sp.pts = (SCoord *) realloc (sp.pts, sp.n_malloc * sizeof(SCoord));
+        if (!sp.pts)
+            fatalError ("No memory for %d spot path points", sp.n_malloc);
+    }
+    for (int i = 0; i <= n_step; i++) {                                 // fence posts
+        float r = i*step;
+        float ca, B;
+        solveSphere (bear, r, slat, clat, &ca, &B);
+        ll2sRaw (asinf(ca), fmodf(rx_ll.lng+B+5*M_PIF,2*M_PIF)-M_PIF, sp.pts[i], raw_pw);
+    }
+    sp.n_pts = n_step + 1;
+
+    sp.rx_lat = rx_ll.lat;
+    sp.rx_lng = rx_ll.lng;
+    sp.tx_lat = tx_ll.lat;
+    sp.tx_lng = tx_ll.lng;
+    sp.raw_pw = raw_pw;
+    sp.gen = gen;
+    sp.used = ++spotpath_tick;
+    return (sp);
+}
+
 /* draw path if enabled as per setup options.
  * N.B. we don't draw ends or labels; use drawSpotLabelOnMap() for those.
  */
@@ -143,22 +319,13 @@ void drawSpotPathOnMap (const DXSpot &spot)
     const uint16_t color = getBandColor(spot.kHz);
 
     // draw from rx to tx
-    float slat = sinf (spot.rx_ll.lat);
-    float clat = cosf (spot.rx_ll.lat);
-    float dist, bear;
-    propPath (false, spot.rx_ll, slat, clat, spot.tx_ll, &dist, &bear);
-    const int n_step = ((int)ceilf(dist/deg2rad(PATH_SEGLEN))) | 1;     // always odd so both ends are drawn
-    const float step = dist/n_step;
+    const SpotPath &path = findSpotPath (spot.rx_ll, spot.tx_ll, raw_pw);
+    const int n_step = path.n_pts - 1;
     const bool dashed = getBandPathDashed (spot.kHz);
     SCoord prev_s = {0, 0};                                             // .x == 0 means don't show
 
-
     for (int i = 0; i <= n_step; i++) {                                 // fence posts
-        float r = i*step;
-        float ca, B;
-        SCoord s;
-        solveSphere (bear, r, slat, clat, &ca, &B);
-        ll2sRaw (asinf(ca), fmodf(spot.rx_ll.lng+B+5*M_PIF,2*M_PIF)-M_PIF, s, raw_pw);
+        SCoord s = path.pts[i];
         if (prev_s.x > 0) {
             if (segmentSpanOkRaw(prev_s, s, raw_pw)) {
                 if (!dashed || n_step < 7 || (i & 1))
@@ -170,6 +337,20 @@ void drawSpotPathOnMap (const DXSpot &spot)
     }
 }
 
+/* pass back the number of spot paths now saved, and the number of times one was reused or had to be found.
+ */
+void getSpotPathStats (int &n_paths, int &n_hits, int &n_misses)
+{
+    uint32_t gen = getMapProjGen();
+    n_paths = 0;
+    for (int i = 0; i < SPOTPATH_NSETS; i++)
+        for (int j = 0; j < SPOTPATH_NWAYS; j++)
+            if (spot_paths[i][j].gen == gen)
+                n_paths++;
+    n_hits = spotpath_hits;
+    n_misses = spotpath_misses;
+}
+
 /* draw the given spot in the given pane row with given bg color, known to be visible.
  */
 void drawSpotOnList (const SBox &box, const DXSpot &spot, int row, uint16_t bg_col)
@@ -263,6 +263,7 @@ static SWDisplayState sws_display;              // what is _displaying_
 static uint32_t countdown_period;               // count down from here, ms
 static uint8_t swdigits[SW_NDIG];               // current digits
 static uint32_t start_t, stop_dt;               // millis() at start, since stop
+static SchedTimer sw_timer = {"stopwatch"};     // next update while a stopwatch page is up
 AlarmOnce alarm_once = {
     0, false, ALMS_OFF,
     {ALMO_LX0, ALMO_Y0, ALMO_LW, SW_BH},
@@ -2538,6 +2539,7 @@ bool runStopwatch()
                 static uint32_t main_time_gate;
                 if (timesUp (&main_time_gate, 41))      // prime number insures all digits change
                     drawSWTime(millis() - start_t);
+                armSchedTimer (sw_timer, 41);
             }
             break;
 
@@ -2558,6 +2560,9 @@ bool runStopwatch()
         followBrightness();
         readBME280();
 
+        // the clocks and countdown change each second
+        armSchedTimerSecond (sw_timer);
+
         // stopwatch is up
         return (true);
 
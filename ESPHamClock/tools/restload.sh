@@ -0,0 +1,50 @@
+#!/usr/bin/env bash
+# hammer the RESTful get_ commands of a running HamClock from several concurrent keep-alive clients,
+# then report request latency percentiles.
+#
+# usage: restload.sh [-c clients] [-n requests_per_client] [host:port] [command ...]
+# default: 8 clients, 200 requests each, localhost:8080, get_sys.txt get_spacewx.txt get_dxspots.txt
+
+set -euo pipefail
+
+CLIENTS=8
+NREQ=200
+while getopts "c:n:" opt; do
+    case $opt in
+        c) CLIENTS=$OPTARG ;;
+        n) NREQ=$OPTARG ;;
+        *) echo "usage: $0 [-c clients] [-n requests_per_client] [host:port] [command ...]" >&2; exit 1 ;;
+    esac
+done
+shift $((OPTIND-1))
+
+HOST=${1:-localhost:8080}
+[[ $# -gt 0 ]] && shift
+CMDS=("$@")
+[[ ${#CMDS[@]} -eq 0 ]] && CMDS=(get_sys.txt get_spacewx.txt get_dxspots.txt)
+
+TMP="$(mktemp -d)"
+trap 'rm -rf "$TMP"' EXIT
+
+# each client is one curl reusing its connection for all of its requests, rotating through CMDS
+T0=$(date +%s.%N)
+for ((c = 0; c < CLIENTS; c++)); do
+    args=()
+    for ((i = 0; i < NREQ; i++)); do
+        args+=(-o /dev/null "http://$HOST/${CMDS[(c+i) % ${#CMDS[@]}]}")
+    done
+    curl -s -w '%{time_total} %{http_code}\n' "${args[@]}" > "$TMP/$c" &
+done
+wait
+T1=$(date +%s.%N)
+
+# report
+cat "$TMP"/* | sort -n | awk -v clients="$CLIENTS" -v t0="$T0" -v t1="$T1" '
+    { ms[NR] = 1000*$1; if ($2 != 200) bad++ }
+    function pct(p,  i) { i = int(NR*p + 0.999); if (i < 1) i = 1; return ms[i] }
+    END {
+        if (NR == 0) { print "no replies"; exit 1 }
+        printf "%d requests from %d clients in %.2f s = %.0f req/s, %d not OK\n",
+                NR, clients, t1-t0, NR/(t1-t0), bad
+        printf "latency ms: p50 %.2f  p90 %.2f  p99 %.2f  max %.2f\n", pct(0.50), pct(0.90), pct(0.99), ms[NR]
+    }'
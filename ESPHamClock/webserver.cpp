@@ -739,9 +739,11 @@ static void spotsHelper (WiFiClient &client, const DXSpot *spots, int nspots, ch
 {
     // print each row
     client.print ("#  kHz   Call        UTC     Mode Grid      Lat     Lng     DEDist   DEBearing\n");
-    for (uint8_t i = 0; i < nspots; i++) {
+    for (int i = 0; i < nspots; i++) {
 
         const DXSpot &spot = spots[i];
+        if (spot.tx_call[0] == '\0')
+            continue;                                   // empty slot
 
         // start with pretty freq, fixed 8 chars
         const char *f_fmt = spot.kHz < 1e6 ? "%8.1f" : "%8.0f";
@@ -777,7 +779,7 @@ static bool getWiFiDXSpots (WiFiClient &client, char line[], size_t line_len)
 
     // retrieve spots, if available
     DXSpot *spots;
-    uint8_t nspots;
+    int nspots;
     if (!getDXClusterSpots (&spots, &nspots)) {
         strcpy (line, "No dx spots");
         return (false);
@@ -1451,6 +1453,111 @@ static bool getWiFiAllSatellites (WiFiClient &client, char line[], size_t line_l
     return (true);
 }
 
+/* send the upcoming DE passes of all satellites in the catalog, in order of rise.
+ */
+static bool getWiFiSatPasses (WiFiClient &client, char line[], size_t line_len)
+{
+    // get pass index
+    const SatPass *passes;
+    time_t t0;
+    int n_sats;
+    int n_passes = findAllSatPasses (&passes, &t0, &n_sats);
+    if (n_sats == 0) {
+        (void) snprintf (line, line_len, "No sats");
+        return (false);
+    }
+
+    // send html header
+    startPlainText(client);
+
+    // send content header
+    snprintf (line, line_len, "# %d passes of %d sats over %d hours from %04d-%02d-%02dT%02d:%02d:%02dZ\n",
+                n_passes, n_sats, SATPASS_HOURS, year(t0), month(t0), day(t0), hour(t0), minute(t0), second(t0));
+    client.print (line);
+    client.print ("#   Rise UTC ISO 8601   Az         Set UTC ISO 8601   Az  Mins MaxEl Name\n");
+
+    // send each pass not yet over, az is blank if clipped to the prediction span
+    time_t now = nowWO();
+    for (int i = 0; i < n_passes; i++) {
+        const SatPass &sp = passes[i];
+        if (sp.set < now)
+            continue;
+        char raz[10], saz[10];
+        if (sp.raz == SAT_NOAZ)
+            strcpy (raz, "-");
+        else
+            snprintf (raz, sizeof(raz), "%.0f", sp.raz);
+        if (sp.saz == SAT_NOAZ)
+            strcpy (saz, "-");
+        else
+            snprintf (saz, sizeof(saz), "%.0f", sp.saz);
+        snprintf (line, line_len,
+                "%04d-%02d-%02dT%02d:%02d:%02dZ %4s %04d-%02d-%02dT%02d:%02d:%02dZ %4s %5.1f %5.1f %s\n",
+                year(sp.rise), month(sp.rise), day(sp.rise), hour(sp.rise), minute(sp.rise), second(sp.rise), raz,
+                year(sp.set), month(sp.set), day(sp.set), hour(sp.set), minute(sp.set), second(sp.set), saz,
+                (sp.set - sp.rise)/60.0F, sp.max_el, sp.name);
+        client.print (line);
+    }
+
+    // ok
+    return (true);
+}
+
+
+/* send the main loop wakeup statistics and each timer.
+ */
+static bool getWiFiTimers (WiFiClient &client, char *unused_line, size_t line_len)
+{
+    (void)(unused_line);
+    (void)(line_len);
+
+    // get info
+    SchedStats ss;
+    const SchedTimer *timers = getSchedTimers (ss);
+    uint32_t now = millis();
+    float secs = (now - ss.ms)/1000.0F;
+    if (secs < 1)
+        secs = 1;
+
+    // send html header
+    startPlainText(client);
+
+    // send wakeup summary
+    char buf[200];
+    snprintf (buf, sizeof(buf), "Loops    %u in %.0f s = %.1f per sec, %.1f%% asleep\n", ss.n_loops, secs,
+                        ss.n_loops/secs, 100.0F*ss.sleep_ms/(1000.0F*secs));
+    client.print (buf);
+    snprintf (buf, sizeof(buf), "Wakeups  %u timer, %u wake, %u poll\n", ss.n_timer, ss.n_wake, ss.n_poll);
+    client.print (buf);
+
+    // send display thread summary, these count from when the display started
+    Adafruit_RA8875::DisplayStats ds;
+    tft.getDisplayStats (ds);
+    float dsecs = now/1000.0F;
+    if (dsecs < 1)
+        dsecs = 1;
+    snprintf (buf, sizeof(buf), "Display  %u wakeups in %.0f s = %.1f per sec, %u frames, %u restaged\n",
+                        ds.n_wakes, dsecs, ds.n_wakes/dsecs, ds.n_frames, ds.n_retries);
+    client.print (buf);
+    snprintf (buf, sizeof(buf), "Canvas   %u draws, %u fb_lock = %.1f per sec\n", ds.n_draws, ds.n_locks,
+                        ds.n_locks/dsecs);
+    client.print (buf);
+
+    // send each timer
+    client.print ("Timer         Due ms  N Fired  Late ms  Max late ms\n");
+    for (const SchedTimer *st = timers; st; st = st->next) {
+        char due[20];
+        if (st->armed)
+            snprintf (due, sizeof(due), "%d", (int32_t)(st->due_ms - now));
+        else
+            strcpy (due, "-");
+        snprintf (buf, sizeof(buf), "%-12s %7s %8u %8u %12u\n", st->name, due, st->n_fired, st->late_ms,
+                        st->max_late_ms);
+        client.print (buf);
+    }
+
+    return (true);
+}
 
 /* send the current collection of sensor data to client in tabular format.
  */
@@ -1616,6 +1723,19 @@ static bool getWiFiSys (WiFiClient &client, char *unused_line, size_t line_len)
     client.print ("Platform "); client.println (platform);
     client.print ("BEHost   "); client.println (backend_host);
     client.print ("BEPort   "); client.println (backend_port);
+
+    // show connection pool and DNS cache effectiveness
+    WiFiPoolStats ps;
+    WiFiClient::getPoolStats (ps);
+    unsigned long n_conn = ps.n_new + ps.n_reused;
+    float avg_new_ms = ps.n_new > 0 ? ps.new_ms/ps.n_new : 0;
+    snprintf (buf, sizeof(buf),
+                "ConnPool %lu new, %lu reused = %.0f%%, ~%.0f ms connect saved, %d idle, %lu resent\n",
+                ps.n_new, ps.n_reused, n_conn > 0 ? 100.0F*ps.n_reused/n_conn : 0.0F,
+                ps.n_reused*avg_new_ms, ps.n_idle, ps.n_resent);
+    client.print (buf);
+    snprintf (buf, sizeof(buf), "DNSCache %lu hits, %lu lookups\n", ps.dns_hits, ps.dns_misses);
+    client.print (buf);
     client.print ("MACaddr  "); client.println (WiFi.macAddress().c_str());
     client.print ("S/N      "); client.println (ESP.getChipId());
 
@@ -1647,6 +1767,36 @@ static bool getWiFiSys (WiFiClient &client, char *unused_line, size_t line_len)
         client.print (buf);
     }
 
+    // show map lat/lng table
+    size_t mapll_bytes;
+    float mapll_ms;
+    int mapll_builds;
+    getMapLLTableStats (mapll_bytes, mapll_ms, mapll_builds);
+    snprintf (buf, sizeof(buf), "MapTable %lu KB, built %d times, last in %.1f ms\n",
+                                (unsigned long)(mapll_bytes/1024), mapll_builds, mapll_ms);
+    client.print (buf);
+    int sp_paths, sp_hits, sp_misses;
+    getSpotPathStats (sp_paths, sp_hits, sp_misses);
+    snprintf (buf, sizeof(buf), "MapPaths %d saved, %d reused, %d projected\n", sp_paths, sp_hits, sp_misses);
+    client.print (buf);
+    uint32_t map_pix_min;
+    bool map_incr;
+    getMapPixelStats (map_pix_min, map_incr);
+    snprintf (buf, sizeof(buf), "MapPix   %u per minute, %s sweep\n", map_pix_min, map_incr ? "incremental" : "full");
+    client.print (buf);
+    int map_n_workers;
+    float map_tile_ms[MAX_MAP_TILES];
+    int map_n_tiles = getMapTileStats (map_n_workers, map_tile_ms);
+    if (map_n_workers > 0) {
+        snprintf (buf, sizeof(buf), "MapTiles %d workers, ms:", map_n_workers);
+        client.print (buf);
+        for (int i = 0; i < map_n_tiles; i++) {
+            snprintf (buf, sizeof(buf), " %.1f", map_tile_ms[i]);
+            client.print (buf);
+        }
+        client.println ("");
+    }
+
     // show debug levels
     const char *db_names[DEBUG_SUBSYS_N];
     int db_levels[DEBUG_SUBSYS_N];
@@ -1747,6 +1897,115 @@ static bool getWiFiVOACAP (WiFiClient &client, char *line, size_t line_len)
 }
 
 
+/* render a full earth map in each projection and report how long each took.
+ */
+static bool doWiFiBenchMap (WiFiClient &client, char *unused_line, size_t line_len)
+{
+    (void)(unused_line);
+    (void)(line_len);
+
+    // time each projection
+    float build_ms[MAPP_N], draw_ms[MAPP_N];
+    benchmarkEarthMap (build_ms, draw_ms);
+
+    // send html header
+    startPlainText(client);
+
+    // report
+    char buf[100];
+    for (int i = 0; i < MAPP_N; i++) {
+        snprintf (buf, sizeof(buf), "%-12s build %8.1f draw %8.1f ms\n", map_projnames[i],
+                                build_ms[i], draw_ms[i]);
+        client.print (buf);
+    }
+
+    return (true);
+}
+
+/* time the display driver's raster primitives and report operations per second.
+ */
+static bool doWiFiBenchDraw (WiFiClient &client, char *unused_line, size_t line_len)
+{
+    (void)(unused_line);
+    (void)(line_len);
+
+    Adafruit_RA8875::DrawBench db;
+    tft.benchmarkDraw (db);
+
+    // send html header
+    startPlainText(client);
+
+    // report
+    char buf[100];
+    snprintf (buf, sizeof(buf), "%-8s %12s %12s %8s\n", "", "span/sec", "pixel/sec", "speedup");
+    client.print (buf);
+    snprintf (buf, sizeof(buf), "%-8s %12.0f %12.0f %8.1f\n", "fills", db.fill_span, db.fill_pix,
+                                db.fill_pix > 0 ? db.fill_span/db.fill_pix : 0);
+    client.print (buf);
+    snprintf (buf, sizeof(buf), "%-8s %12.0f %12.0f %8.1f\n", "circles", db.circle_span, db.circle_pix,
+                                db.circle_pix > 0 ? db.circle_span/db.circle_pix : 0);
+    client.print (buf);
+    snprintf (buf, sizeof(buf), "%-8s %12.0f %12.0f %8.1f\n", "chars", db.text_span, db.text_pix,
+                                db.text_pix > 0 ? db.text_span/db.text_pix : 0);
+    client.print (buf);
+    snprintf (buf, sizeof(buf), "pixels %s\n", db.same ? "identical" : "DIFFER");
+    client.print (buf);
+
+    return (true);
+}
+
+/* capture live web frames or replay them through each live web codec.
+ */
+static bool doWiFiBenchLive (WiFiClient &client, char line[], size_t line_len)
+{
+    // define all possible args
+    WebArgs wa;
+    wa.nargs = 0;
+    wa.name[wa.nargs++] = "capture";
+
+    // parse
+    if (!parseWebCommand (wa, line, line_len))
+        return (false);
+
+    // start capture if requested
+    Message ynot;
+    if (wa.found[0]) {
+        int n = wa.value[0] ? atoi (wa.value[0]) : 0;
+        if (!captureLiveFrames (n, ynot)) {
+            quietStrncpy (line, ynot.get(), line_len);
+            return (false);
+        }
+        startPlainText(client);
+        char buf[100];
+        snprintf (buf, sizeof(buf), "capturing next %d live web frames\n", n);
+        client.print (buf);
+        return (true);
+    }
+
+    // else replay the captured frames
+    LiveCodecBench lcb[N_LIVE_CODECS];
+    if (!benchmarkLiveCodecs (lcb, ynot)) {
+        quietStrncpy (line, ynot.get(), line_len);
+        return (false);
+    }
+
+    // send html header
+    startPlainText(client);
+
+    // report
+    char buf[100];
+    snprintf (buf, sizeof(buf), "%-6s %8s %12s %10s %s\n", "codec", "frames", "bytes/frame", "usec/frame",
+                                "check");
+    client.print (buf);
+    for (int i = 0; i < N_LIVE_CODECS; i++) {
+        snprintf (buf, sizeof(buf), "%-6s %8d %12.0f %10.0f %s\n", lcb[i].name, lcb[i].n_frames, lcb[i].bytes,
+                                lcb[i].usecs, lcb[i].lossless ? "lossless" : "LOSSY");
+        client.print (buf);
+    }
+
+    return (true);
+}
+
 /* send current clock time
  */
 static bool getWiFiTime (WiFiClient &client, char *unused_line, size_t line_len)
@@ -4320,10 +4579,12 @@ static const CmdTble command_table[] = {
     { "get_ontheair.txt ",  getWiFiOnTheAir,       "get POTA/SOTA activators" },
     { "get_satellite.txt ", getWiFiSatellite,      "get current sat info" },
     { "get_satellites.txt ",getWiFiAllSatellites,  "get list of all sats" },
+    { "get_satpasses.txt ", getWiFiSatPasses,      "get next 48 hours of passes of all sats" },
     { "get_sensors.txt ",   getWiFiSensorData,     "get sensor data" },
     { "get_spacewx.txt ",   getWiFiSpaceWx,        "get space weather info" },
     { "get_sys.txt ",       getWiFiSys,            "get system stats" },
     { "get_time.txt ",      getWiFiTime,           "get current time" },
+    { "get_timers.txt ",    getWiFiTimers,         "get main loop timers and wakeups" },
     { "get_voacap.txt ",    getWiFiVOACAP,         "get current band conditions matrix" },
     { "set_adif?",          setWiFiADIF,           "pane=[0123] (POST)" },
     { "set_alarm?",         setWiFiAlarm,          "state=off|armed&time=HR:MN&utc=yes|no" },
@@ -4346,7 +4607,7 @@ static const CmdTble command_table[] = {
     { "set_panzoom?",       setWiFiPanZoom,        "pan_x=X&pan_y=Y&pan_dx=dX&pan_dy=dY&zoom=Z" },
     { "set_rotator?",       setWiFiRotator,        "state=[un]stop|[un]auto&az=X&el=X" },
     { "set_rss?",           setWiFiRSS,            "reset|add=X|network|interval=secs|on|off|file (POST)" },
-    { "set_satname?",       setWiFiSatName,        "abc|none" },
+    { "set_satname?",       setWiFiSatName,        "abc|NORAD|none" },
     { "set_sattle?",        setWiFiSatTLE,         "name=abc&t1=line1&t2=line2" },
     { "set_screenlock?",    setWiFiScreenLock,     "lock=on|off" },
     { "set_senscorr?",      setWiFiSensorCorr,     "sensor=76|77&dTemp=X&dPres=Y" },
@@ -4366,10 +4627,13 @@ static const CmdTble command_table[] = {
     // the following entries are never shown with --help -- update N_UNDOC_CMD if change
     { "set_demo?",          setWiFiDemo,           "on|off|n=N" },
     { "set_spot?",          setWiFiSpot,           "tx_call=x&rx_call=x&kHz=x" },
+    { "bench_map ",         doWiFiBenchMap,        "time map table build and render in each projection" },
+    { "bench_draw ",        doWiFiBenchDraw,       "time span raster primitives against per-pixel drawing" },
+    { "bench_live?",        doWiFiBenchLive,       "capture=N live frames, else compare live web codecs" },
 };
 
 #define N_CMDTABLE      NARRAY(command_table)           // real n entries in command table
-#define N_UNDOC_CMD     2                               // n undocumented commands at end of table
+#define N_UNDOC_CMD     5                               // n undocumented commands at end of table
 
 /* return whether the given command is allowed in read-only web service
  */
@@ -4388,11 +4652,14 @@ static bool roCommandOk (const char *cmd)
 
 /* run the given web server command.
  * send ack or error messages to client.
- * return strictly whether command was recognized, regardless of whether it returned an error.
+ * return strictly whether command was recognized, regardless of whether it returned an error, and pass back
+ * in cmd_ok whether it was recognized and did not return an error.
  * N.B. caller must close client, we don't.
  */
-static bool runWebserverCommand (WiFiClient &client, bool ro, char *command, size_t max_cmd_len)
+static bool runWebserverCommand (WiFiClient &client, bool ro, char *command, size_t max_cmd_len, bool &cmd_ok)
 {
+    cmd_ok = false;
+
     // search for command depending on context, execute its implementation function if found
     if (!ro || roCommandOk (command)) {
         resetWatchdog();
@@ -4416,7 +4683,8 @@ static bool runWebserverCommand (WiFiClient &client, bool ro, char *command, siz
                 // run handler, passing string starting right after the command, reply with error if trouble.
                 resetWatchdog();
                 PCTF funp = CT_FUNP(ctp);
-                if (!(*funp)(client, params, max_cmd_len - cmd_len))
+                cmd_ok = (*funp)(client, params, max_cmd_len - cmd_len);
+                if (!cmd_ok)
                     sendHTTPError (client, "%.*s error: %s\n", cmd_len, command, params);
 
                 // command found, even if it reported an error
@@ -4446,59 +4714,18 @@ static bool isGET (const char *line)
     return (strncmp (line, "GET /", 5) == 0);
 }
 
-/* service remote restful connection.
- * if ro, only accept the get commands and a few more as listed in roCommandOk().
- * N.B. caller must close client, we don't.
+/* send the list of commands to client as the answer to an unknown command.
+ * if ro, only list those allowed by roCommandOk().
  */
-static void serveRemote(WiFiClient &client, bool ro)
+static void sendRESTHelp (WiFiClient &client, bool ro, char line[], size_t line_len)
 {
-    StackMalloc line_mem(TLE_LINEL*4);          // accommodate longest query, probably set_sattle with %20s
-    char *line = (char *) line_mem.getMem();    // handy access to malloced buffer
-
-    // read query
-    if (!getTCPLine (client, line, line_mem.getSize(), NULL)) {
-        sendHTTPError (client, "empty RESTful query\n");
-        return;
-    }
-
-    // first line must be the GET except a few can be POST
-    if (!isGET(line) && !isPOST(line)) {
-        sendHTTPError (client, "Method must be GET or selected POST:\n");
-        Serial.println (line);
-        return;
-    }
-    // Serial.printf ("web: %s\n", line);
-
-    // discard remainder of header, but capture content length if available
-    content_length = 0;
-    char cl_str[20];
-    if (httpSkipHeader (client, "Content-Length:", cl_str, sizeof(cl_str)))
-        content_length = atol (cl_str);
-    else {
-        Serial.printf ("bogus header after %s\n", line);
-        return;
-    }
-
-    // log sender
-    Serial.printf ("Command from %s: %s\n", client.remoteIP().toString().c_str(), line);
-    if (content_length)
-        Serial.printf ("Content-Length: %ld\n", content_length);
-
-    // find beginning just after first -- we aleady know there is a /
-    char *cmd_start = strchr (line,'/')+1;
-
-    // run command
-    if (runWebserverCommand (client, ro, cmd_start, line + line_mem.getSize() - cmd_start))
-        return;
-
-    // if get here, command was not found but client is still open for help
     startPlainText(client);
     if (liveweb_rw_port > 0) {
-        snprintf (line, line_mem.getSize(), "HamClock Live is R/W on port %d\r\n", liveweb_rw_port);
+        snprintf (line, line_len, "HamClock Live is R/W on port %d\r\n", liveweb_rw_port);
         client.print (line);
     }
     if (liveweb_ro_port > 0) {
-        snprintf (line, line_mem.getSize(), "HamClock Live is R/O on port %d\r\n", liveweb_ro_port);
+        snprintf (line, line_len, "HamClock Live is R/O on port %d\r\n", liveweb_ro_port);
         client.print (line);
     }
     for (uint8_t i = 0; i < N_CMDTABLE-N_UNDOC_CMD; i++) {
@@ -4512,7 +4739,7 @@ static void serveRemote(WiFiClient &client, bool ro)
         const int indent = 22;
         int cmd_len = strlen (ctp->command);
         client.print (ctp->command);
-        snprintf (line, line_mem.getSize(), "%*s", indent-cmd_len, "");
+        snprintf (line, line_len, "%*s", indent-cmd_len, "");
         client.print (line);
         client.println (ctp->help);
 
@@ -4525,8 +4752,8 @@ static void serveRemote(WiFiClient &client, bool ro)
             for (int i = 0; i < PLOT_CH_N; i++) {
                 if (plotChoiceIsAvailable ((PlotChoice)i)) {
                     if (ll == 0)
-                        ll = snprintf (line, line_mem.getSize(), "%s", indent);
-                    ll += snprintf (line+ll, line_mem.getSize()-ll, " %s", plot_names[i]);
+                        ll = snprintf (line, line_len, "%s", indent);
+                    ll += snprintf (line+ll, line_len-ll, " %s", plot_names[i]);
                     if (ll > max_w) {
                         client.println (line);
                         ll = 0;
@@ -4538,24 +4765,413 @@ static void serveRemote(WiFiClient &client, bool ro)
     }
 }
 
-/* check if someone is trying to tell/ask us something.
- * N.B, all such commands bypass the password system.
+
+/* RESTful connections are accepted and watched while idle by one poll thread, restPollThread(). when a
+ * connection has something to say it is handed to one of a small pool of restWorkerThread()s which read and
+ * answer requests for as long as they keep arriving, then return it to the poll thread to wait for more.
+ * HamClock state is owned by the main thread so commands are run there by checkWebServer() with their
+ * reply captured for the worker to send, except get_ commands without arguments are answered directly by the
+ * worker from a snapshot of their previous reply if it is no older than REST_SNAP_MS. thus any number of
+ * clients polling the same few get_ commands costs the main thread at most one run of each per REST_SNAP_MS.
+ * replies are sent with Content-Length so HTTP/1.1 clients may keep their connection open.
  */
-void checkWebServer(bool ro)
+#define REST_NWORKERS   4                               // n request worker threads
+#define REST_MAXCONN    32                              // max open connections
+#define REST_IDLE_MS    30000                           // close idle connections after this long
+#define REST_SNAP_MS    1000                            // max age of a get_ reply snapshot
+
+typedef struct {
+    WiFiClient client;                                  // connection
+    int fd;                                             // client.fd(), for poll
+    uint32_t idle_ms;                                   // millis() when last returned to the poll thread
+} RESTConn;
+
+typedef struct {
+    RESTConn *conn;                                     // requesting connection
+    char *cmd;                                          // command, starting just after GET /
+    size_t cmd_len;                                     // room in cmd[]
+    long content_length;                                // POST content length
+    bool direct;                                        // reply directly to conn, else capture in reply
+    int snap_i;                                         // command_table index if may use a snapshot, else -1
+    std::string reply;                                  // captured reply unless direct
+    bool done;                                          // set by main thread when finished
+} RESTJob;
+
+typedef struct {
+    std::string reply;                                  // complete reply including header
+    uint32_t ms;                                        // millis() when captured, 0 if never
+} RESTSnap;
+
+static RESTConn *rest_ready[REST_MAXCONN];              // connections waiting for a worker, FIFO
+static int rest_n_ready;                                // n in rest_ready[]
+static RESTConn *rest_idle[REST_MAXCONN];               // connections waiting for their next request
+static int rest_n_idle;                                 // n in rest_idle[]
+static int rest_n_conn;                                 // total open connections
+static RESTJob *rest_jobs[REST_NWORKERS];               // jobs waiting for the main thread, FIFO
+static volatile int rest_n_jobs;                        // n in rest_jobs[]
+static int rest_wake[2] = {-1, -1};                     // pipe to wake restPollThread when rest_idle grows
+static pthread_mutex_t rest_lock = PTHREAD_MUTEX_INITIALIZER;   // all of the above
+static pthread_cond_t rest_ready_cv = PTHREAD_COND_INITIALIZER; // rest_ready[] grew
+static pthread_cond_t rest_done_cv = PTHREAD_COND_INITIALIZER;  // a job is done
+
+static RESTSnap rest_snaps[N_CMDTABLE];                 // reply snapshots by command_table index
+static pthread_mutex_t rest_snap_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* return the command_table index of cmd if it is a get_ command without arguments, else -1.
+ */
+static int restSnapIndex (const char *cmd)
+{
+    if (strncmp (cmd, "get_", 4) != 0)
+        return (-1);
+    for (int i = 0; i < N_CMDTABLE; i++) {
+        const char *tcmd = command_table[i].command;
+        int tcmd_len = strlen (tcmd);
+        if (tcmd[tcmd_len-1] == ' ' && strncmp (cmd, tcmd, tcmd_len) == 0)
+            return (i);
+    }
+    return (-1);
+}
+
+/* pass back the snapshot reply of command_table[i] and return true if it is fresh, else return false.
+ */
+static bool getRESTSnap (int i, std::string &reply)
+{
+    pthread_mutex_lock (&rest_snap_lock);
+    RESTSnap &rs = rest_snaps[i];
+    bool fresh = rs.ms && millis() - rs.ms < REST_SNAP_MS;
+    if (fresh)
+        reply = rs.reply;
+    pthread_mutex_unlock (&rest_snap_lock);
+    return (fresh);
+}
+
+/* save reply as the current snapshot of command_table[i]
+ */
+static void saveRESTSnap (int i, const std::string &reply)
+{
+    pthread_mutex_lock (&rest_snap_lock);
+    rest_snaps[i].reply = reply;
+    rest_snaps[i].ms = millis() | 1;                    // never 0
+    pthread_mutex_unlock (&rest_snap_lock);
+}
+
+/* forget all snapshots, such as after a command that may have changed what they report
+ */
+static void clearRESTSnaps (void)
+{
+    pthread_mutex_lock (&rest_snap_lock);
+    for (int i = 0; i < N_CMDTABLE; i++)
+        rest_snaps[i].ms = 0;
+    pthread_mutex_unlock (&rest_snap_lock);
+}
+
+/* run the given job on behalf of a worker.
+ * N.B. main thread only
+ */
+static void runRESTJob (RESTJob &job, bool ro)
+{
+    // use the real connection or capture
+    WiFiClient capture;
+    capture.captureOutput (&job.reply);
+    WiFiClient &client = job.direct ? job.conn->client : capture;
+
+    // log sender
+    Serial.printf ("Command from %s: %s\n", job.conn->client.remoteIP().toString().c_str(), job.cmd);
+    if (job.content_length)
+        Serial.printf ("Content-Length: %ld\n", job.content_length);
+
+    // run, offer help if command is not found
+    content_length = job.content_length;
+    bypass_pw = true;
+    bool cmd_ok;
+    if (!runWebserverCommand (client, ro, job.cmd, job.cmd_len, cmd_ok))
+        sendRESTHelp (client, ro, job.cmd, job.cmd_len);
+    bypass_pw = false;
+
+    // show any effect on the map promptly
+    if (strncmp (job.cmd, "set_", 4) == 0)
+        hurryMapSweep();
+
+    // any other command may have changed what the snapshots report; only a successful reply is worth reusing
+    if (job.snap_i < 0)
+        clearRESTSnaps();
+    else if (cmd_ok)
+        saveRESTSnap (job.snap_i, job.reply);
+}
+
+/* queue the given job for the main thread and wait for it to finish.
+ * N.B. worker threads only
+ */
+static void runRESTJobOnMain (RESTJob &job)
+{
+    pthread_mutex_lock (&rest_lock);
+    job.done = false;
+    rest_jobs[rest_n_jobs++] = &job;                    // room for one per worker
+    wakeMainLoop();
+    while (!job.done)
+        pthread_cond_wait (&rest_done_cv, &rest_lock);
+    pthread_mutex_unlock (&rest_lock);
+}
+
+/* send a reply captured from a command handler with a fresh Connection header and a Content-Length.
+ * return whether the connection may be kept open.
+ */
+static bool sendRESTReply (WiFiClient &client, const std::string &reply, bool keep)
 {
-    if (restful_server) {
-        // not crazy fast
-        static uint32_t ws_ms;
-        if (timesUp (&ws_ms, 250)) {
+    // find end of header, just send as-is if none
+    size_t hdr_end = reply.find ("\r\n\r\n");
+    if (hdr_end == std::string::npos) {
+        client.write ((const uint8_t *) reply.data(), reply.size());
+        return (false);
+    }
+
+    // copy header lines except Connection, speaking HTTP/1.1 if we keep the connection
+    std::string hdr;
+    for (size_t l0 = 0; l0 < hdr_end + 2; ) {
+        size_t l1 = reply.find ("\r\n", l0);
+        std::string hline = reply.substr (l0, l1 - l0);
+        l0 = l1 + 2;
+        if (strncasecmp (hline.c_str(), "Connection:", 11) == 0)
+            continue;
+        if (keep && hline.compare (0, 8, "HTTP/1.0") == 0)
+            hline.replace (0, 8, "HTTP/1.1");
+        hdr += hline;
+        hdr += "\r\n";
+    }
+
+    // add our own then the body, all in one write to avoid Nagle stalling the body
+    size_t body_len = reply.size() - (hdr_end + 4);
+    char buf[100];
+    snprintf (buf, sizeof(buf), "Content-Length: %lu\r\nConnection: %s\r\n\r\n", (unsigned long)body_len,
+                                keep ? "keep-alive" : "close");
+    hdr += buf;
+    hdr.append (reply, hdr_end + 4, body_len);
+    client.write ((const uint8_t *) hdr.data(), hdr.size());
+
+    return (keep && client.connected());
+}
+
+/* read and answer one request from the given connection.
+ * return whether the connection may be kept open for another.
+ * N.B. worker threads only
+ */
+static bool serveRESTRequest (RESTConn *conn, char line[], size_t line_len)
+{
+    WiFiClient &client = conn->client;
+
+    // read query
+    if (!getTCPLine (client, line, line_len, NULL))
+        return (false);                                 // typically just the client closing
+
+    // first line must be the GET except a few can be POST
+    if (!isGET(line) && !isPOST(line)) {
+        sendHTTPError (client, "Method must be GET or selected POST:\n");
+        Serial.println (line);
+        return (false);
+    }
+
+    // read remainder of header for content length and whether client wants to keep the connection.
+    // HTTP/1.1 keeps by default, 1.0 only if asked.
+    long cl = 0;
+    bool keep = strstr (line, " HTTP/1.1") != NULL;
+    char hdr[200];
+    do {
+        if (!getTCPLine (client, hdr, sizeof(hdr), NULL)) {
+            Serial.printf ("bogus header after %s\n", line);
+            return (false);
+        }
+        if (strncasecmp (hdr, "Content-Length:", 15) == 0)
+            cl = atol (hdr+15);
+        else if (strncasecmp (hdr, "Connection:", 11) == 0)
+            keep = strcistr (hdr+11, "keep-alive") != NULL;
+    } while (hdr[0] != '\0');
+
+    // prepare job, beginning just after first / -- we already know there is one.
+    // POST content and commands that may not return are given the connection itself.
+    RESTJob job;
+    job.conn = conn;
+    job.cmd = strchr (line,'/') + 1;
+    job.cmd_len = line + line_len - job.cmd;
+    job.content_length = cl;
+    job.direct = isPOST(line) || (strncmp (job.cmd, "get_", 4) != 0 && strncmp (job.cmd, "set_", 4) != 0);
+    job.snap_i = restSnapIndex (job.cmd);
+
+    // answer from snapshot if possible, else let the main thread run it
+    if (job.snap_i < 0 || !getRESTSnap (job.snap_i, job.reply))
+        runRESTJobOnMain (job);
+    if (job.direct)
+        return (false);
+    return (sendRESTReply (client, job.reply, keep));
+}
+
+/* close and forget the given connection.
+ * N.B. we assume rest_lock is held
+ */
+static void closeRESTConn (RESTConn *conn)
+{
+    conn->client.stop();
+    delete conn;
+    rest_n_conn--;
+}
+
+/* thread that answers requests from connections in rest_ready[]
+ */
+static void *restWorkerThread (void *unused)
+{
+    (void) unused;
+
+    // private line buffer, room for longest query, probably set_sattle with %20s
+    const size_t line_len = TLE_LINEL*4;
+    char *line = (char *) malloc (line_len);
+    if (!line)
+        fatalError ("No memory for RESTful worker");
+
+    for (;;) {
+
+        // wait for a connection
+        pthread_mutex_lock (&rest_lock);
+        while (rest_n_ready == 0)
+            pthread_cond_wait (&rest_ready_cv, &rest_lock);
+        RESTConn *conn = rest_ready[0];
+        memmove (rest_ready, rest_ready+1, --rest_n_ready * sizeof(RESTConn*));
+        pthread_mutex_unlock (&rest_lock);
+
+        // serve requests as long as they keep coming
+        bool keep;
+        do
+            keep = serveRESTRequest (conn, line, line_len);
+        while (keep && conn->client.available(0));
+
+        // return to the poll thread to wait for more, or close
+        pthread_mutex_lock (&rest_lock);
+        if (keep && conn->client.connected()) {
+            conn->idle_ms = millis();
+            rest_idle[rest_n_idle++] = conn;
+            if (write (rest_wake[1], "", 1) < 0)
+                Serial.printf ("RESTful wake: %s\n", strerror(errno));
+        } else
+            closeRESTConn (conn);
+        pthread_mutex_unlock (&rest_lock);
+    }
+
+    return (NULL);
+}
+
+/* thread that accepts new connections and watches idle ones, moving each to rest_ready[] when it has
+ * something to say.
+ */
+static void *restPollThread (void *unused)
+{
+    (void) unused;
+
+    struct pollfd pfd[REST_MAXCONN+2];
+    RESTConn *pconn[REST_MAXCONN+2];
+
+    for (;;) {
+
+        // watch server, wake pipe and each idle connection
+        int n_pfd = 0;
+        pfd[n_pfd].fd = restful_server->fd();
+        pfd[n_pfd++].events = POLLIN;
+        pfd[n_pfd].fd = rest_wake[0];
+        pfd[n_pfd++].events = POLLIN;
+        pthread_mutex_lock (&rest_lock);
+        for (int i = 0; i < rest_n_idle; i++) {
+            pconn[n_pfd] = rest_idle[i];
+            pfd[n_pfd].fd = rest_idle[i]->fd;
+            pfd[n_pfd++].events = POLLIN;
+        }
+        pthread_mutex_unlock (&rest_lock);
+
+        if (poll (pfd, n_pfd, 1000) < 0) {
+            if (errno != EINTR)
+                fatalError ("RESTful poll: %s", strerror(errno));
+            continue;
+        }
+
+        // drain wake pipe, it just gets us here to refresh the list
+        if (pfd[1].revents) {
+            char buf[64];
+            if (read (rest_wake[0], buf, sizeof(buf)) < 0)
+                Serial.printf ("RESTful wake: %s\n", strerror(errno));
+        }
+
+        // hand active connections to a worker, close those idle too long.
+        // N.B. only we remove from rest_idle[] so all in pconn[] are still there
+        uint32_t now = millis();
+        pthread_mutex_lock (&rest_lock);
+        for (int i = 2; i < n_pfd; i++) {
+            RESTConn *conn = pconn[i];
+            bool active = pfd[i].revents != 0;
+            if (!active && now - conn->idle_ms < REST_IDLE_MS)
+                continue;
+            for (int j = 0; j < rest_n_idle; j++) {
+                if (rest_idle[j] == conn) {
+                    rest_idle[j] = rest_idle[--rest_n_idle];
+                    break;
+                }
+            }
+            if (active) {
+                rest_ready[rest_n_ready++] = conn;
+                pthread_cond_signal (&rest_ready_cv);
+            } else
+                closeRESTConn (conn);
+        }
+        pthread_mutex_unlock (&rest_lock);
+
+        // accept new connection, assume it is about to send a request
+        if (pfd[0].revents & POLLIN) {
             WiFiClient client = restful_server->available();
             if (client) {
-                bypass_pw = true;
-                serveRemote(client, ro);
-                bypass_pw = false;
-                client.stop();
+                pthread_mutex_lock (&rest_lock);
+                if (rest_n_conn < REST_MAXCONN) {
+                    RESTConn *conn = new RESTConn {client, client.fd(), 0};
+                    rest_n_conn++;
+                    rest_ready[rest_n_ready++] = conn;
+                    pthread_cond_signal (&rest_ready_cv);
+                } else {
+                    Serial.printf ("RESTful: refusing %s, already %d connections\n",
+                                        client.remoteIP().toString().c_str(), rest_n_conn);
+                    client.stop();
+                }
+                pthread_mutex_unlock (&rest_lock);
             }
         }
     }
+
+    return (NULL);
+}
+
+/* run commands the RESTful workers are waiting for.
+ * if ro, only accept the get commands and a few more as listed in roCommandOk().
+ * N.B, all such commands bypass the password system.
+ */
+void checkWebServer(bool ro)
+{
+    // quick check without lock, never nest, eg, from wdDelay() within a command
+    static bool busy;
+    if (busy || rest_n_jobs == 0)
+        return;
+    busy = true;
+
+    // run no more than were waiting when we got here so we don't stall the main loop for long
+    pthread_mutex_lock (&rest_lock);
+    for (int n_run = 0; rest_n_jobs > 0 && n_run < REST_NWORKERS; n_run++) {
+        RESTJob *job = rest_jobs[0];
+        memmove (rest_jobs, rest_jobs+1, --rest_n_jobs * sizeof(RESTJob*));
+        pthread_mutex_unlock (&rest_lock);
+
+        // another worker may have just asked for the same snapshot
+        if (job->snap_i < 0 || !getRESTSnap (job->snap_i, job->reply))
+            runRESTJob (*job, ro);
+
+        pthread_mutex_lock (&rest_lock);
+        job->done = true;
+        pthread_cond_broadcast (&rest_done_cv);
+    }
+    pthread_mutex_unlock (&rest_lock);
+
+    busy = false;
 }
 
 /* call to start restful server unless disabled.
@@ -4576,6 +5192,21 @@ void initWebServer()
     if (!restful_server->begin(ynot))
         fatalError ("Failed to start RESTful server on port %d: %s", restful_port, ynot);
 
+    // start threads
+    if (pipe (rest_wake) < 0)
+        fatalError ("RESTful pipe: %s", strerror(errno));
+    pthread_t tid;
+    int e = pthread_create (&tid, NULL, restPollThread, NULL);
+    if (e)
+        fatalError ("RESTful poll thread failed: %s", strerror(e));
+    pthread_detach (tid);
+    for (int i = 0; i < REST_NWORKERS; i++) {
+        e = pthread_create (&tid, NULL, restWorkerThread, NULL);
+        if (e)
+            fatalError ("RESTful worker thread failed: %s", strerror(e));
+        pthread_detach (tid);
+    }
+
     tftMsg (true, 0, "RESTful API server on port %d", restful_port);
 
 }
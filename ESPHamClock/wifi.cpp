@@ -31,8 +31,18 @@ time_t usr_datetime;
 uint16_t bc_powers[] = {1, 5, 10, 50, 100, 500, 1000};
 const int n_bc_powers = NARRAY(bc_powers);
 static const char bc_page[] = "/fetchBandConditions.pl";
-static time_t bc_time;                          // nowWO() when bc_matrix was loaded
+static time_t bc_time;                          // nowWO() when bc_matrix was requested
 BandCdtnMatrix bc_matrix;                       // percentage reliability for each band
+static char bc_config[100];                     // config line retrieved along with bc_matrix
+
+// background band conditions retrieval, see startBCFetch()
+static BGFetch bc_bgf;                          // background job
+static char bc_query[sizeof(bc_page) + 200];    // query being fetched, built by main before starting
+static BandCdtnMatrix bc_fresh;                 // worker's private matrix while fetching
+static char bc_fresh_config[sizeof(bc_config)]; // worker's private config line while fetching
+static bool bc_io_ok = true;                    // whether the most recent fetch io was ok
+static bool bc_again;                           // settings changed while pending so fetch again when done
+static int bc_n_installed;                      // n fetches installed, 0 until first arrives
 uint16_t bc_power;                              // VOACAP power setting
 float bc_toa;                                   // VOACAP take off angle
 uint8_t bc_utc_tl;                              // label band conditions timeline in utc else DE local
@@ -769,35 +779,26 @@ char *xrayLevel (char *buf, const SpaceWeather_t &xray)
 }
 
 
-/* retrieve bc_matrix and optional config line underneath PLOT_CH_BC.
+/* bgfetch worker to retrieve bc_query into bc_fresh and bc_fresh_config.
  * return whether at least config line was received (even if data was not)
  */
-static bool retrieveBandConditions (char *config)
+static bool fetchBandConditions (BGFetch &bgf)
 {
-    WiFiClient bc_client;
     bool ok = false;
 
     // init data unknown
-    bc_matrix.ok = false;
+    bc_fresh.ok = false;
 
     // start by cleaning cache.
     // N.B. make sure search string match name we use below
     (void) cleanCache ("bc-", BC_INTERVAL);
 
-    // build query
-    time_t t = nowWO();
-    char query[sizeof(bc_page) + 200];
-    snprintf (query, sizeof(query),
-        "%s?YEAR=%d&MONTH=%d&RXLAT=%.3f&RXLNG=%.3f&TXLAT=%.3f&TXLNG=%.3f&UTC=%d&PATH=%d&POW=%d&MODE=%d&TOA=%.1f",
-        bc_page, year(t), month(t), dx_ll.lat_d, dx_ll.lng_d, de_ll.lat_d, de_ll.lng_d,
-        hour(t), show_lp, bc_power, bc_modevalue, bc_toa);
-
     // build local cache file name
     char cache_fn[100];
-    snprintf (cache_fn, sizeof(cache_fn), "bc-%010u.txt", stringHash(query)); // N.B. see cleanCache() above
+    snprintf (cache_fn, sizeof(cache_fn), "bc-%010u.txt", stringHash(bc_query)); // N.B. see cleanCache() above
 
-    // open cache or get fresh
-    FILE *fp = openCachedFile (cache_fn, query, 12*3600L, 100);
+    // open cache or get fresh, N.B. with the User-Agent prepared by startBGFetch()
+    FILE *fp = openCachedFile (cache_fn, bc_query, 12*3600L, 100, bgf.ua);
     if (fp) {
 
         char buf[100];
@@ -808,15 +809,13 @@ static bool retrieveBandConditions (char *config)
             goto out;
         }
 
-        // next line is configuration summary, save if interested
+        // next line is configuration summary
         if (!fgets (buf, sizeof(buf), fp)) {
             Serial.println ("BC: No config line");
             goto out;
         }
-        if (config) {
-            chompString (buf);
-            strcpy (config, buf);
-        }
+        chompString (buf);
+        quietStrncpy (bc_fresh_config, buf, sizeof(bc_fresh_config));
 
         // transaction for at least config is ok
         ok = true;
@@ -845,23 +844,20 @@ static bool retrieveBandConditions (char *config)
             // insure correct utc
             utc_hr %= 24;
 
-            // add to bc_matrix as integer percent
+            // add to bc_fresh as integer percent
             for (int c = 0; c < BMTRX_COLS; c++)
-                bc_matrix.m[utc_hr][c] = (uint8_t)(100*rel[c]);
+                bc_fresh.m[utc_hr][c] = (uint8_t)(100*rel[c]);
         }
 
         // #define _TEST_BAND_MATRIX
         #if defined(_TEST_BAND_MATRIX)
             for (int r = 0; r < BMTRX_ROWS; r++)                    // time 0 .. 23
                 for (int c = 0; c < BMTRX_COLS; c++)                // band 80 .. 10
-                    bc_matrix.m[r][c] = 100*r*c/BMTRX_ROWS/BMTRX_COLS;
+                    bc_fresh.m[r][c] = 100*r*c/BMTRX_ROWS/BMTRX_COLS;
         #endif
 
         // matrix ok
-        bc_matrix.ok = true;
-
-        // finished with file
-        fclose(fp);
+        bc_fresh.ok = true;
 
     } else {
         Serial.println ("VOACAP connection failed");
@@ -869,10 +865,63 @@ static bool retrieveBandConditions (char *config)
 
 out:
 
+    // finished with file
+    if (fp)
+        fclose (fp);
+
     // out
     return (ok);
 }
 
+static void installBandConditions (BGFetch &bgf);
+
+/* start a background retrieval of bc_matrix for the current settings.
+ * N.B. caller must insure bc_bgf is not already pending.
+ */
+static void startBCFetch (void)
+{
+    // build query from main thread state
+    time_t t = nowWO();
+    snprintf (bc_query, sizeof(bc_query),
+        "%s?YEAR=%d&MONTH=%d&RXLAT=%.3f&RXLNG=%.3f&TXLAT=%.3f&TXLNG=%.3f&UTC=%d&PATH=%d&POW=%d&MODE=%d&TOA=%.1f",
+        bc_page, year(t), month(t), dx_ll.lat_d, dx_ll.lng_d, de_ll.lat_d, de_ll.lng_d,
+        hour(t), show_lp, bc_power, bc_modevalue, bc_toa);
+
+    // note time of attempt to coordinate with maps
+    bc_time = t;
+
+    bc_bgf.name = "BC";
+    bc_bgf.fetch = fetchBandConditions;
+    bc_bgf.done = installBandConditions;
+    (void) startBGFetch (bc_bgf);
+}
+
+/* main thread bgfetch completion: install bc_fresh and bc_fresh_config then show them.
+ */
+static void installBandConditions (BGFetch &bgf)
+{
+    // these are already stale if the settings changed meanwhile
+    if (bc_again) {
+        bc_again = false;
+        startBCFetch();
+        return;
+    }
+
+    // install
+    memcpy (bc_matrix.m, bc_fresh.m, sizeof(bc_matrix.m));
+    bc_matrix.ok = bc_fresh.ok;
+    if (bgf.ok) {
+        strcpy (bc_config, bc_fresh_config);
+        bc_matrix.next_update = nextRetrieval (PLOT_CH_BC, BC_INTERVAL);
+    } else
+        bc_matrix.next_update = nextWiFiRetry(PLOT_CH_BC);
+    bc_io_ok = bgf.ok;
+    bc_n_installed++;
+
+    // show
+    scheduleRedrawPlot (PLOT_CH_BC);
+}
+
 /* convert an array of 4 big-endian network-order bytes into a uint32_t
  */
 static uint32_t crackBE32 (uint8_t bp[])
@@ -1169,17 +1218,17 @@ bool getTCPChar (WiFiClient &client, char *cp)
     return (true);
 }
 
-/* send User-Agent to client
+/* build the complete User-Agent header field, including its trailing \r\n, into ua[ua_len].
+ * N.B. this reads NV and much main thread state so call only from the main thread. Background fetches
+ *   build it when they are queued and pass it to httpHCGET() as user_agent.
  */
-void sendUserAgent (WiFiClient &client)
+void getUserAgent (char *ua, size_t ua_len)
 {
     // don't send full list until first time main page is up to insure all subsystems are up.
     static bool ready;
     if (mainpage_up)
         ready = true;
 
-    char ua[400];
-
     if (logUsageOk() && ready) {
 
         // display mode: 0=X11 1=fb0 2=X11full 3=X11+live 4=X11full+live 5=noX
@@ -1361,7 +1410,7 @@ void sendUserAgent (WiFiClient &client)
         (void) autoUpgrade (aup_hr);
 
 
-        snprintf (ua, sizeof(ua),
+        snprintf (ua, ua_len,
             "User-Agent: %s/%s (id %u up %lld) crc %d "
                 "LV7 %s %d %d %d %d %d %d %d %d %d %d %d %d %d %.2f %.2f %d %d %d %d "
                 "%d %d %d %d %d %d %d %d %d %d %d %d "
@@ -1392,65 +1441,146 @@ void sendUserAgent (WiFiClient &client)
             aup_hr, 0);
 
     } else {
-        snprintf (ua, sizeof(ua), "User-Agent: %s/%s (id %u up %lld) crc %d\r\n",
+        snprintf (ua, ua_len, "User-Agent: %s/%s (id %u up %lld) crc %d\r\n",
             platform, hc_version, ESP.getChipId(), (long long)getUptime(NULL,NULL,NULL,NULL), flash_crc_ok);
     }
+}
 
-    // send
+/* send User-Agent to client
+ * N.B. main thread only, see getUserAgent()
+ */
+void sendUserAgent (WiFiClient &client)
+{
+    char ua[USER_AGENT_LEN];
+    getUserAgent (ua, sizeof(ua));
     client.print(ua);
-
 }
 
-/* issue an HTTP Get for an arbitary page
+/* issue an HTTP Get for an arbitary page, adding any extra_hdrs each ending with \r\n unless NULL.
+ * send user_agent as prepared by getUserAgent() unless NULL in which case build one now; worker threads
+ * must always pass one prepared on the main thread.
+ * we ask to keep the connection open so client.stop() can pool it once httpSkipHeader() has framed the body.
  */
-static void httpGET (WiFiClient &client, const char *server, const char *page)
+static void httpGET (WiFiClient &client, const char *server, const char *page, const char *extra_hdrs,
+const char *user_agent)
 {
-    client.print ("GET "); client.print (page); client.print (" HTTP/1.0\r\n");
+    client.print ("GET "); client.print (page); client.print (" HTTP/1.1\r\n");
     client.print ("Host: "); client.println (server);
-    sendUserAgent (client);
-    client.print ("Connection: close\r\n\r\n");
+    if (user_agent)
+        client.print (user_agent);
+    else
+        sendUserAgent (client);
+    if (extra_hdrs)
+        client.print (extra_hdrs);
+    client.print ("Connection: keep-alive\r\n\r\n");
 }
 
-/* issue an HTTP Get to a /ham/HamClock page named in ram
+/* issue an HTTP Get to a /ham/HamClock page named in ram with optional extra header fields and optional
+ * User-Agent prepared by getUserAgent(), see httpGET().
  */
-void httpHCGET (WiFiClient &client, const char *server, const char *hc_page)
+void httpHCGET (WiFiClient &client, const char *server, const char *hc_page, const char *extra_hdrs,
+const char *user_agent)
 {
     static const char hc[] = "/ham/HamClock";
     StackMalloc full_mem(strlen(hc_page) + sizeof(hc));         // sizeof includes the EOS
     char *full_hc_page = (char *) full_mem.getMem();
     snprintf (full_hc_page, full_mem.getSize(), "%s%s", hc, hc_page);
-    httpGET (client, server, full_hc_page);
+    httpGET (client, server, full_hc_page, extra_hdrs, user_agent);
+}
+
+/* issue an HTTP Get to a /ham/HamClock page named in ram with optional extra header fields.
+ */
+void httpHCGET (WiFiClient &client, const char *server, const char *hc_page, const char *extra_hdrs)
+{
+    httpHCGET (client, server, hc_page, extra_hdrs, NULL);
+}
+
+/* issue an HTTP Get to a /ham/HamClock page named in ram
+ */
+void httpHCGET (WiFiClient &client, const char *server, const char *hc_page)
+{
+    httpHCGET (client, server, hc_page, NULL);
 }
 
 /* skip the given wifi client stream ahead to just after the first blank line, return whether ok.
  * this is often used so subsequent stop() on client doesn't slam door in client's face with RST.
- * Along the way, if find a header field with the given name (unless NULL) return value in the given string.
- * if header is not found, we still return true but value[0] will be '\0'.
+ * Along the way, return the response status code, 0 if none, and the value of each of the n_fields
+ * fields[] found, else its value[0] will be '\0'. N.B. fields match only at the start of a line, in any
+ * case, see HTTPHeaderField.
+ * the framing headers are also noted so the client reports EOF at the end of the body and may then be reused.
  */
-bool httpSkipHeader (WiFiClient &client, const char *header, char *value, int value_len)
+bool httpSkipHeader (WiFiClient &client, int &status, HTTPHeaderField fields[], int n_fields)
 {
     char line[200];
 
     // prep
-    int hdr_len = header ? strlen(header) : 0;
-    if (value)
-        value[0] = '\0';
-    char *hdr;
+    status = 0;
+    for (int i = 0; i < n_fields; i++)
+        fields[i].value[0] = '\0';
+
+    // body framing and connection persistence
+    bool http11 = false;
+    bool no_body = false;
+    bool chunked = false;
+    bool conn_close = false;
+    bool conn_ka = false;
+    long content_length = -1;
+    int ka_s = -1;
 
     // read until find a blank line
+    bool status_line = true;
     do {
         if (!getTCPLine (client, line, sizeof(line), NULL))
             return (false);
         // Serial.println (line);
 
-        if (header && value && (hdr = strstr (line, header)) != NULL)
-            snprintf (value, value_len, "%s", hdr + hdr_len);
+        if (status_line) {
+            http11 = strncmp (line, "HTTP/1.1 ", 9) == 0;
+            if (sscanf (line, "HTTP/%*s %d", &status) == 1 && (status/100 == 1 || status == 204 || status == 304))
+                no_body = true;
+            status_line = false;
+        } else if (strncasecmp (line, "Content-Length:", 15) == 0) {
+            content_length = atol (line+15);
+        } else if (strncasecmp (line, "Transfer-Encoding:", 18) == 0) {
+            chunked = strcistr (line+18, "chunked") != NULL;
+        } else if (strncasecmp (line, "Connection:", 11) == 0) {
+            conn_close = strcistr (line+11, "close") != NULL;
+            conn_ka = strcistr (line+11, "keep-alive") != NULL;
+        } else if (strncasecmp (line, "Keep-Alive:", 11) == 0) {
+            const char *to = strcistr (line+11, "timeout=");
+            if (to)
+                ka_s = atoi (to+8);
+        }
+
+        for (int i = 0; i < n_fields; i++) {
+            int name_len = strlen (fields[i].name);
+            if (strncasecmp (line, fields[i].name, name_len) == 0)
+                snprintf (fields[i].value, sizeof(fields[i].value), "%s", line + name_len);
+        }
 
     } while (line[0] != '\0');  // getTCPLine absorbs \r\n so this tests for a blank line
 
+    // 1.1 persists unless told otherwise, 1.0 only if told so
+    bool persist = http11 ? !conn_close : conn_ka;
+    client.frameBody (no_body ? 0 : content_length, chunked && !no_body, persist ? ka_s : 0);
+
     return (true);
 }
 
+/* same but when we only care about the value of one header field, unless header is NULL.
+ * if header is not found, we still return true but value[0] will be '\0'.
+ */
+bool httpSkipHeader (WiFiClient &client, const char *header, char *value, int value_len)
+{
+    HTTPHeaderField field;
+    field.name = header;
+    int status;
+    bool ok = httpSkipHeader (client, status, &field, header && value ? 1 : 0);
+    if (header && value)
+        quietStrncpy (value, field.value, value_len);
+    return (ok);
+}
+
 /* same but when we don't care about any header field;
  * so we pick up Remote_Addr for postDiags()
  */
@@ -1732,8 +1862,10 @@ static bool updateBzBt (const SBox &box)
     return (ok);
 }
 
-/* retrieve and draw latest band conditions in box b if needed or requested.
- * return whether io ok.
+/* draw latest band conditions in box b, starting a fresh background retrieval if needed or requested.
+ * only the very first time do we wait for the retrieval; after that, new data arrive later via
+ * installBandConditions() which causes the pane to redraw.
+ * return whether the most recent io was ok.
  */
 static bool updateBandConditions(const SBox &box, bool force)
 {
@@ -1742,28 +1874,20 @@ static bool updateBandConditions(const SBox &box, bool force)
                            || (tdiff (nowWO(), bc_time) >= 3600)
                            || myNow() >= bc_matrix.next_update;
 
-    static char config[100];    // retain value after each retrieval
-
-    // download if so and note whether io ok
-    bool io_ok = true;
+    // start a fresh download if so, or another after the one underway if that is already out of date
     if (update_bc) {
-
-        // fresh download
-        if (retrieveBandConditions (config))
-            bc_matrix.next_update = nextRetrieval (PLOT_CH_BC, BC_INTERVAL);
-        else {
-            bc_matrix.next_update = nextWiFiRetry(PLOT_CH_BC);
-            io_ok = false;
-        }
-
-        // note time of attemp to coordinate with maps
-        bc_time = nowWO();
+        if (!bc_bgf.pending)
+            startBCFetch();
+        else if (force)
+            bc_again = true;
     }
+    if (bc_n_installed == 0)
+        waitBGFetch (bc_bgf);
 
     // plot
     if (bc_matrix.ok) {
 
-        plotBandConditions (box, 0, &bc_matrix, config);
+        plotBandConditions (box, 0, &bc_matrix, bc_config);
 
     } else {
 
@@ -1773,7 +1897,7 @@ static bool updateBandConditions(const SBox &box, bool force)
         map_time = bc_time = nowWO() - 1000;
     }
 
-    return (io_ok);
+    return (bc_io_ok);
 }
 
 /* display the RSG NOAA solar environment scale values in the given box.
@@ -2070,6 +2194,9 @@ void updateWiFi(void)
     // time now
     time_t t0 = myNow();
 
+    // install any background retrievals that have completed, these may schedule their panes to redraw below
+    (void) checkBGFetch();
+
     // update each pane
     for (int i = PANE_0; i < PANE_N; i++) {
 
@@ -2343,21 +2470,36 @@ bool getTCPLine (WiFiClient &client, char line[], uint16_t line_len, uint16_t *l
     // decrement available length so there's always room to add '\0'
     line_len -= 1;
 
+    // scan whole spans of the client read buffer for the newline rather than reading one char at a time
     uint16_t i = 0;
     while (true) {
-        char c;
-        if (!getTCPChar (client, &c))
+        int n_span;
+        const char *span = (const char *) client.readSpan (n_span);
+        if (!span)
             return (false);
-        if (c == '\r')
-            continue;
-        if (c == '\n') {
+        const char *nl = (const char *) memchr (span, '\n', n_span);
+        int n_use = nl ? nl - span : n_span;
+
+        // append what fits, dropping any \r
+        if (memchr (span, '\r', n_use)) {
+            for (int j = 0; j < n_use && i < line_len; j++)
+                if (span[j] != '\r')
+                    line[i++] = span[j];
+        } else {
+            int n_copy = n_use < line_len - i ? n_use : line_len - i;
+            memcpy (line + i, span, n_copy);
+            i += n_copy;
+        }
+
+        if (nl) {
+            client.skip (n_use + 1);
             line[i] = '\0';
             if (ll)
                 *ll = i;
             // Serial.println(line);
             return (true);
-        } else if (i < line_len)
-            line[i++] = c;
+        }
+        client.skip (n_use);
     }
 }
 
@@ -2451,6 +2593,17 @@ void scheduleNewPlot (PlotChoice pc)
     }
 }
 
+/* redraw the given pane at once if it is currently visible, without asking for fresh data.
+ * this is how a background retrieval shows its new results; scheduleNewPlot() would instead ask the
+ * pane to start yet another retrieval.
+ */
+void scheduleRedrawPlot (PlotChoice pc)
+{
+    PlotPane pp = findPaneChoiceNow (pc);
+    if (pp != PANE_NONE)
+        next_update[pp] = 0;
+}
+
 /* called to schedule an update of the give core map.
  */
 void scheduleNewCoreMap (CoreMaps cm)
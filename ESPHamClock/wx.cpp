@@ -16,13 +16,21 @@ static const char ww_page[] = "/worldwx/wx.txt";        // URL for the gridded w
 #define WWXTBL_INTERVAL (45*60)                         // "fast" world wx table update interval, secs
 #define MAX_WXTZ_AGE    (55*60)                         // max age of info for same location, secs
 
-// WXInfo and exactly where it applies and when it should be updated
+/* WXInfo and exactly where it applies and when it should be updated.
+ * a bgfetch worker retrieves fresh_ll into fresh and fresh_ynot, then the main thread installs them in info
+ * and ynot. Thus everything here belongs to the main thread except the fresh_ fields while bgf is pending.
+ */
 typedef struct {
     WXInfo info;                                        // timezone and wx for ...
     float lat_d, lng_d;                                 // this location
     bool ok;                                            // whether info is valid
     char ynot[100];                                     // or why not
     time_t next_update;                                 // next routine update of same lat/lng
+    bool is_de;                                         // whether DE, else DX
+    LatLong fresh_ll;                                   // location being fetched
+    WXInfo fresh;                                       // worker's private info while fetching
+    char fresh_ynot[100];                               // worker's reason if fetch fails
+    BGFetch bgf;                                        // background job
 } WXCache;
 static WXCache de_cache, dx_cache;
 static time_t next_err_update;                          // next update if net trouble, shared
@@ -39,6 +47,11 @@ typedef struct {
 } WWTable;
 static WWTable wwt;
 
+// background world wx retrieval, the worker builds wwt_fresh which the main thread then swaps into wwt
+static WWTable wwt_fresh;                               // worker's private table while fetching
+static BGFetch wwt_bgf;                                 // background job
+static int wwt_n_installed;                             // n fetches installed, 0 until first arrives
+
 /* bit masks of WeatherStats for DE and DX
  */
 static uint16_t dewx_chmask, dxwx_chmask;
@@ -91,26 +104,26 @@ static bool windDeg2Name (float deg, char dirname[4])
     return (dirname[0] != '?');
 }
 
-/* download world wx grid data into wwt.table every 
+/* bgfetch worker to download world wx grid data into wwt_fresh.
+ * return whether table is complete.
  */
-static bool retrieveWorldWx(void)
+static bool fetchWorldWx (BGFetch &bgf)
 {
     WiFiClient ww_client;
     bool ok = false;
 
     // reset table
-    free (wwt.table);
-    wwt.table = NULL;
-    wwt.n_rows = wwt.n_cols = 0;
+    free (wwt_fresh.table);
+    wwt_fresh.table = NULL;
+    wwt_fresh.n_rows = wwt_fresh.n_cols = 0;
 
     Serial.printf ("WWX: %s\n", ww_page);
 
     // get
     if (ww_client.connect(backend_host, backend_port)) {
-        updateClocks(false);
 
-        // query web page
-        httpHCGET (ww_client, backend_host, ww_page);
+        // query web page, N.B. with the User-Agent prepared by startBGFetch()
+        httpHCGET (ww_client, backend_host, ww_page, NULL, bgf.ua);
 
         // prep for scanning (ahead of skipping header to avoid stupid g++ goto errors)
         int line_n = 0;                         // line number
@@ -120,8 +133,8 @@ static bool retrieveWorldWx(void)
         float del_lat = 0, del_lng = 0;         // check constant step sizes
         float prev_lat = 0, prev_lng = 0;       // for checking step sizes
 
-        // skip response header
-        if (!httpSkipHeader (ww_client)) {
+        // skip response header, N.B. not the remote_addr flavor, that belongs to the main thread
+        if (!httpSkipHeader (ww_client, NULL, NULL, 0)) {
             Serial.printf ("WWX: header timeout");
             goto out;
         }
@@ -161,12 +174,12 @@ static bool retrieveWorldWx(void)
                 // confirm regular spacing
                 if (n_lngcols > 0 && lng != prev_lng) {
                     Serial.printf ("WWX: irregular lng: %d x %d  lng %g != %g\n",
-                                wwt.n_rows, n_lngcols, lng, prev_lng);
+                                wwt_fresh.n_rows, n_lngcols, lng, prev_lng);
                     goto out;
                 }
                 if (n_lngcols > 1 && lat != prev_lat + del_lat) {
                     Serial.printf ("WWX: irregular lat: %d x %d    lat %g != %g + %g\n",
-                                wwt.n_rows, n_lngcols,  lat, prev_lat, del_lat);
+                                wwt_fresh.n_rows, n_lngcols,  lat, prev_lat, del_lat);
                     goto out;
                 }
 
@@ -176,10 +189,10 @@ static bool retrieveWorldWx(void)
                     goto out;
                 }
 
-                // add to wwt.table
+                // add to wwt_fresh.table
                 if (n_wwtable + 1 > n_wwmalloc)
-                    wwt.table = (WXInfo *) realloc (wwt.table, (n_wwmalloc += 100) * sizeof(WXInfo));
-                memcpy (&wwt.table[n_wwtable++], &wx, sizeof(WXInfo));
+                    wwt_fresh.table = (WXInfo *) realloc (wwt_fresh.table, (n_wwmalloc += 100) * sizeof(WXInfo));
+                memcpy (&wwt_fresh.table[n_wwtable++], &wx, sizeof(WXInfo));
 
                 // update walk
                 if (n_lngcols == 0)
@@ -194,17 +207,17 @@ static bool retrieveWorldWx(void)
                 // blank line separates blocks of constant longitude
 
                 // check consistency so far
-                if (wwt.n_rows == 0) {
+                if (wwt_fresh.n_rows == 0) {
                     // we know n cols after completing the first lng block, all remaining must equal this 
-                    wwt.n_cols = n_lngcols;
-                } else if (n_lngcols != wwt.n_cols) {
+                    wwt_fresh.n_cols = n_lngcols;
+                } else if (n_lngcols != wwt_fresh.n_cols) {
                     Serial.printf ("WWX: inconsistent columns %d != %d after %d rows\n",
-                                                n_lngcols, wwt.n_cols, wwt.n_rows);
+                                                n_lngcols, wwt_fresh.n_cols, wwt_fresh.n_rows);
                     goto out;
                 }
 
-                // one more wwt.table row
-                wwt.n_rows++;
+                // one more wwt_fresh.table row
+                wwt_fresh.n_rows++;
 
                 // reset block stats
                 n_lngcols = 0;
@@ -217,23 +230,23 @@ static bool retrieveWorldWx(void)
         }
 
         // final check
-        if (wwt.n_rows != 360/del_lng || wwt.n_cols != 1 + 180/del_lat) {
+        if (wwt_fresh.n_rows != 360/del_lng || wwt_fresh.n_cols != 1 + 180/del_lat) {
             Serial.printf ("WWX: incomplete table: rows %d != 360/%g   cols %d != 1 + 180/%g\n",
-                                        wwt.n_rows, del_lng,  wwt.n_cols, del_lat);
+                                        wwt_fresh.n_rows, del_lng,  wwt_fresh.n_cols, del_lat);
             goto out;
         }
 
         // yah!
         ok = true;
-        Serial.printf ("WWX: fast table %d lat x %d lng\n", wwt.n_cols, wwt.n_rows);
+        Serial.printf ("WWX: fast table %d lat x %d lng\n", wwt_fresh.n_cols, wwt_fresh.n_rows);
 
     out:
 
         if (!ok) {
             // reset table
-            free (wwt.table);
-            wwt.table = NULL;
-            wwt.n_rows = wwt.n_cols = 0;
+            free (wwt_fresh.table);
+            wwt_fresh.table = NULL;
+            wwt_fresh.n_rows = wwt_fresh.n_cols = 0;
         }
 
         ww_client.stop();
@@ -242,33 +255,31 @@ static bool retrieveWorldWx(void)
     return (ok);
 }
 
-/* download current weather and time info for the given exact location.
- * if wxc.info is filled ok return true, else return false with short reason in wxc.ynot
+/* bgfetch worker to download current weather and time info for wxc.fresh_ll of the WXCache in bgf.arg.
+ * if wxc.fresh is filled ok return true, else return false with short reason in wxc.fresh_ynot
  */
-static bool retrieveCurrentWX (const LatLong &ll, bool is_de, WXCache &wxc)
+static bool fetchCurrentWX (BGFetch &bgf)
 {
-    WXInfo &wxi = wxc.info;
+    WXCache &wxc = *(WXCache *)bgf.arg;
+    const LatLong &ll = wxc.fresh_ll;
+    WXInfo &wxi = wxc.fresh;
 
     WiFiClient wx_client;
     char line[100];
 
     bool ok = false;
 
-    resetWatchdog();
-
     // get
     if (wx_client.connect(backend_host, backend_port)) {
-        updateClocks(false);
-        resetWatchdog();
 
-        // query web page
-        snprintf (line, sizeof(line), "%s?is_de=%d&lat=%g&lng=%g", wx_ll, is_de, ll.lat_d, ll.lng_d);
+        // query web page, N.B. with the User-Agent prepared by startBGFetch()
+        snprintf (line, sizeof(line), "%s?is_de=%d&lat=%g&lng=%g", wx_ll, wxc.is_de, ll.lat_d, ll.lng_d);
         Serial.printf ("WX: %s\n", line);
-        httpHCGET (wx_client, backend_host, line);
+        httpHCGET (wx_client, backend_host, line, NULL, bgf.ua);
 
-        // skip response header
-        if (!httpSkipHeader (wx_client)) {
-            quietStrncpy (wxc.ynot, "WX timeout", sizeof(wxc.ynot));
+        // skip response header, N.B. not the remote_addr flavor, that belongs to the main thread
+        if (!httpSkipHeader (wx_client, NULL, NULL, 0)) {
+            quietStrncpy (wxc.fresh_ynot, "WX timeout", sizeof(wxc.fresh_ynot));
             goto out;
         }
 
@@ -282,11 +293,9 @@ static bool retrieveCurrentWX (const LatLong &ll, bool is_de, WXCache &wxc)
             if (debugLevel (DEBUG_WX, 1))
                 Serial.printf ("WX: %s\n", line);
 
-            updateClocks(false);
-
             // check for error message in which case abandon further search
             if (strncmp (line, "error=", 6) == 0) {
-                quietStrncpy (wxc.ynot, line+6, sizeof(wxc.ynot));
+                quietStrncpy (wxc.fresh_ynot, line+6, sizeof(wxc.fresh_ynot));
                 goto out;
             }
 
@@ -336,7 +345,7 @@ static bool retrieveCurrentWX (const LatLong &ll, bool is_de, WXCache &wxc)
         }
 
         if (n_found < N_WXINFO_FIELDS) {
-            quietStrncpy (wxc.ynot, "Missing WX data", sizeof(wxc.ynot));
+            quietStrncpy (wxc.fresh_ynot, "Missing WX data", sizeof(wxc.fresh_ynot));
             goto out;
         }
 
@@ -345,7 +354,7 @@ static bool retrieveCurrentWX (const LatLong &ll, bool is_de, WXCache &wxc)
 
     } else {
 
-        quietStrncpy (wxc.ynot, "WX connection failed", sizeof(wxc.ynot));
+        quietStrncpy (wxc.fresh_ynot, "WX connection failed", sizeof(wxc.fresh_ynot));
 
     }
 
@@ -615,47 +624,91 @@ bool drawNCDXFWx (BRB_MODE m)
 
 
 
-/* return current WXInfo for the given de or dx, else NULL
+/* main thread bgfetch completion: install the retrieval of the WXCache in bgf.arg and show it if up.
+ */
+static void installCurrentWX (BGFetch &bgf)
+{
+    WXCache &wxc = *(WXCache *)bgf.arg;
+
+    if (bgf.ok) {
+
+        // ok! update location and next routine expiration
+        wxc.info = wxc.fresh;
+        wxc.ok = true;
+        wxc.lat_d = wxc.fresh_ll.lat_d;
+        wxc.lng_d = wxc.fresh_ll.lng_d;
+        wxc.next_update = myNow() + MAX_WXTZ_AGE;
+
+        // log
+        int at = millis()/1000 + MAX_WXTZ_AGE;
+        Serial.printf ("WXTZ: expires in %d sec at %d\n", MAX_WXTZ_AGE, at);
+
+    } else {
+
+        // schedule retry
+        char retry_msg[50];
+        snprintf (retry_msg, sizeof(retry_msg), "%s WX/TZ", wxc.is_de ? "DE" : "DX");
+        next_err_update = nextWiFiRetry (retry_msg);
+        wxc.ok = false;
+        quietStrncpy (wxc.ynot, wxc.fresh_ynot, sizeof(wxc.ynot));
+    }
+
+    // show
+    scheduleRedrawPlot (wxc.is_de ? PLOT_CH_DEWX : PLOT_CH_DXWX);
+}
+
+/* start a background retrieval of wx at ll into the given WXCache unless one is already underway.
+ */
+static void startCurrentWXFetch (const LatLong &ll, bool is_de, WXCache &wxc)
+{
+    if (wxc.bgf.pending)
+        return;
+
+    wxc.is_de = is_de;
+    wxc.fresh_ll = ll;
+    wxc.bgf.name = is_de ? "DE WX" : "DX WX";
+    wxc.bgf.fetch = fetchCurrentWX;
+    wxc.bgf.done = installCurrentWX;
+    wxc.bgf.arg = &wxc;
+    (void) startBGFetch (wxc.bgf);
+}
+
+/* return current WXInfo for the given de or dx, else NULL.
+ * a routine refresh of the same location runs in the background while we keep returning the current info;
+ * only for a new location, or if we have nothing good yet, do we wait for the retrieval.
  */
 static const WXInfo *findWXTXCache (const LatLong &ll, bool is_de, Message &ynot)
 {
     // who are we?
     WXCache &wxc = is_de ? de_cache : dx_cache;
 
-    // prep err msg if needed
-    char retry_msg[50];
-    snprintf (retry_msg, sizeof(retry_msg), "%s WX/TZ", is_de ? "DE" : "DX");
-
     // new location?
     bool new_loc = ll.lat_d != wxc.lat_d || ll.lng_d != wxc.lng_d;
 
     // update depending same location and how well things are working
     if (myNow() > next_err_update && (new_loc || myNow() > wxc.next_update)) {
 
-        // get fresh, schedule retry if fail
-        if (!retrieveCurrentWX (ll, is_de, wxc)) {
-            next_err_update = nextWiFiRetry (retry_msg);
-            wxc.ok = false;
+        // a retrieval already underway might be for an earlier location
+        if (new_loc)
+            waitBGFetch (wxc.bgf);
+
+        startCurrentWXFetch (ll, is_de, wxc);
+        if (new_loc || !wxc.ok)
+            waitBGFetch (wxc.bgf);
+
+        // report failure now
+        if (!wxc.ok) {
             ynot.set(wxc.ynot);
             return (NULL);
         }
-
-        // ok! update location and next routine expiration
-
-        wxc.ok = true;
-        wxc.lat_d = ll.lat_d;
-        wxc.lng_d = ll.lng_d;
-        wxc.next_update = myNow() + MAX_WXTZ_AGE;
-
-        // log
-        int at = millis()/1000 + MAX_WXTZ_AGE;
-        Serial.printf ("WXTZ: expires in %d sec at %d\n", MAX_WXTZ_AGE, at);
     }
 
     // return requested info else why not
     if (wxc.ok)
         return (&wxc.info);
 
+    char retry_msg[50];
+    snprintf (retry_msg, sizeof(retry_msg), "%s WX/TZ", is_de ? "DE" : "DX");
     next_err_update = nextWiFiRetry (retry_msg);
     ynot.set ("update failed");
     return (NULL);
@@ -677,22 +730,45 @@ const WXInfo *findTZCache (const LatLong &ll, bool is_de, Message &ynot)
 
 
 
+/* main thread bgfetch completion: swap wwt_fresh into wwt and schedule the next refresh.
+ * if the retrieval failed we keep using the previous table, if any.
+ */
+static void installWorldWx (BGFetch &bgf)
+{
+    static const char wwx_label[] = "FastWXTable";
+
+    if (bgf.ok) {
+        free (wwt.table);
+        wwt.table = wwt_fresh.table;
+        wwt.n_rows = wwt_fresh.n_rows;
+        wwt.n_cols = wwt_fresh.n_cols;
+        wwt_fresh.table = NULL;                         // now owned by wwt
+        wwt.next_update = myNow() + WWXTBL_INTERVAL;
+        int at = millis()/1000 + WWXTBL_INTERVAL;
+        Serial.printf ("WWX: Next %s update in %d sec at %d\n", wwx_label, WWXTBL_INTERVAL, at);
+    } else {
+        wwt.next_update = nextWiFiRetry (wwx_label);
+    }
+
+    wwt_n_installed++;
+}
+
 /* return closest WXInfo to ll within grid, else NULL.
+ * a stale table is refreshed in the background; only the very first time do we wait for it.
  */
 const WXInfo *findWXFast (const LatLong &ll)
 {
     // update wwt cache if stale
-    if (myNow() > wwt.next_update) {
-        static const char wwx_label[] = "FastWXTable";
-        if (retrieveWorldWx()) {
-            wwt.next_update = myNow() + WWXTBL_INTERVAL;
-            int at = millis()/1000 + WWXTBL_INTERVAL;
-            Serial.printf ("WWX: Next %s update in %d sec at %d\n", wwx_label, WWXTBL_INTERVAL, at);
-        } else {
-            wwt.next_update = nextWiFiRetry (wwx_label);
-            return (NULL);
-        }
+    if (myNow() > wwt.next_update && !wwt_bgf.pending) {
+        wwt_bgf.name = "WWX";
+        wwt_bgf.fetch = fetchWorldWx;
+        wwt_bgf.done = installWorldWx;
+        (void) startBGFetch (wwt_bgf);
     }
+    if (wwt_n_installed == 0)
+        waitBGFetch (wwt_bgf);
+    if (!wwt.table)
+        return (NULL);
 
     // find closest indices
     int row = floorf (wwt.n_rows*(ll.lng_d+180)/360);